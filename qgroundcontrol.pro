@@ -494,10 +494,14 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/MultiSignalSpyV2.h \
         src/qgcunittest/UnitTest.h \
+        src/QmlControls/QmlObjectListModelTest.h \
+        src/QtLocationPlugin/QGCTileDownloadControlTest.h \
         src/Vehicle/FTPManagerTest.h \
         src/Vehicle/RequestMessageTest.h \
         src/Vehicle/SendMavCommandWithHandlerTest.h \
         src/Vehicle/SendMavCommandWithSignallingTest.h \
+        src/Vehicle/TelemetryRecorderTest.h \
+        src/Vehicle/TrajectoryTrackTest.h \
         src/Vehicle/VehicleLinkManagerTest.h \
         #src/qgcunittest/RadioConfigTest.h \
         #src/AnalyzeView/LogDownloadTest.h \
@@ -541,10 +545,14 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest/MultiSignalSpyV2.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
+        src/QmlControls/QmlObjectListModelTest.cc \
+        src/QtLocationPlugin/QGCTileDownloadControlTest.cc \
         src/Vehicle/FTPManagerTest.cc \
         src/Vehicle/RequestMessageTest.cc \
         src/Vehicle/SendMavCommandWithHandlerTest.cc \
         src/Vehicle/SendMavCommandWithSignallingTest.cc \
+        src/Vehicle/TelemetryRecorderTest.cc \
+        src/Vehicle/TrajectoryTrackTest.cc \
         src/Vehicle/VehicleLinkManagerTest.cc \
         #src/qgcunittest/RadioConfigTest.cc \
         #src/AnalyzeView/LogDownloadTest.cc \
@@ -689,9 +697,11 @@ HEADERS += \
     src/Vehicle/MultiVehicleManager.h \
     src/Vehicle/StateMachine.h \
     src/Vehicle/SysStatusSensorInfo.h \
+    src/Vehicle/TelemetryRecorder.h \
     src/Vehicle/TerrainFactGroup.h \
     src/Vehicle/TerrainProtocolHandler.h \
     src/Vehicle/TrajectoryPoints.h \
+    src/Vehicle/TrajectoryTrack.h \
     src/Vehicle/Vehicle.h \
     src/Vehicle/VehicleObjectAvoidance.h \
     src/Vehicle/VehicleBatteryFactGroup.h \
@@ -709,6 +719,7 @@ HEADERS += \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
     src/comm/LogReplayLink.h \
+    src/comm/MAVLinkMessageStats.h \
     src/comm/MAVLinkProtocol.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
@@ -918,9 +929,11 @@ SOURCES += \
     src/Vehicle/MultiVehicleManager.cc \
     src/Vehicle/StateMachine.cc \
     src/Vehicle/SysStatusSensorInfo.cc \
+    src/Vehicle/TelemetryRecorder.cc \
     src/Vehicle/TerrainFactGroup.cc \
     src/Vehicle/TerrainProtocolHandler.cc \
     src/Vehicle/TrajectoryPoints.cc \
+    src/Vehicle/TrajectoryTrack.cc \
     src/Vehicle/Vehicle.cc \
     src/Vehicle/VehicleObjectAvoidance.cc \
     src/Vehicle/VehicleBatteryFactGroup.cc \
@@ -938,6 +951,7 @@ SOURCES += \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/MAVLinkMessageStats.cc \
     src/comm/MAVLinkProtocol.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
@@ -1014,6 +1028,7 @@ HEADERS+= \
     src/FirmwarePlugin/CameraMetaData.h \
     src/FirmwarePlugin/FirmwarePlugin.h \
     src/FirmwarePlugin/FirmwarePluginManager.h \
+    src/FirmwarePlugin/ParameterMetaDataCache.h \
     src/VehicleSetup/VehicleComponent.h \
 
 !MobileBuild { !NoSerialBuild {
@@ -1036,6 +1051,7 @@ SOURCES += \
     src/FirmwarePlugin/CameraMetaData.cc \
     src/FirmwarePlugin/FirmwarePlugin.cc \
     src/FirmwarePlugin/FirmwarePluginManager.cc \
+    src/FirmwarePlugin/ParameterMetaDataCache.cc \
     src/VehicleSetup/VehicleComponent.cc \
 
 !MobileBuild { !NoSerialBuild {
@@ -1194,9 +1210,13 @@ HEADERS += \
     src/FactSystem/FactGroup.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
+    src/FactSystem/FactValueHistory.h \
     src/FactSystem/FactValueSliderListModel.h \
+    src/FactSystem/ParameterCache.h \
     src/FactSystem/ParameterManager.h \
+    src/FactSystem/ParameterRequestScheduler.h \
     src/FactSystem/SettingsFact.h \
+    src/FactSystem/TelemetryFrame.h \
 
 SOURCES += \
     src/FactSystem/Fact.cc \
@@ -1204,9 +1224,13 @@ SOURCES += \
     src/FactSystem/FactGroup.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
+    src/FactSystem/FactValueHistory.cc \
     src/FactSystem/FactValueSliderListModel.cc \
+    src/FactSystem/ParameterCache.cc \
     src/FactSystem/ParameterManager.cc \
+    src/FactSystem/ParameterRequestScheduler.cc \
     src/FactSystem/SettingsFact.cc \
+    src/FactSystem/TelemetryFrame.cc \
 
 #-------------------------------------------------------------------------------------
 # MAVLink Inspector
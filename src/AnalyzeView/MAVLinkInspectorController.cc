@@ -20,6 +20,8 @@ Q_DECLARE_METATYPE(QAbstractSeries*)
 
 #define UPDATE_FREQUENCY (1000 / 15)    // 15Hz
 
+const int QGCMAVLinkMessageField::_maxValues;
+
 //-----------------------------------------------------------------------------
 QGCMAVLinkMessageField::QGCMAVLinkMessageField(QGCMAVLinkMessage *parent, QString name, QString type)
     : QObject(parent)
@@ -37,8 +39,9 @@ QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries
     if(!_pSeries) {
         _chart = chart;
         _pSeries = series;
+        _clearValues();
+        _values.resize(_maxValues);
         emit seriesChanged();
-        _dataIndex = 0;
         _msg->updateFieldSelection();
     }
 }
@@ -48,9 +51,10 @@ void
 QGCMAVLinkMessageField::delSeries()
 {
     if(_pSeries) {
-        _values.clear();
+        _clearValues();
+        _values = QVector<QPointF>();
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(_values);
+        lineSeries->replace(QVector<QPointF>());
         _pSeries = nullptr;
         _chart   = nullptr;
         emit seriesChanged();
@@ -58,6 +62,17 @@ QGCMAVLinkMessageField::delSeries()
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::_clearValues()
+{
+    _valuesHead     = 0;
+    _valuesCount    = 0;
+    _valueSequence  = 0;
+    _minDeque.clear();
+    _maxDeque.clear();
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCMAVLinkMessageField::label()
@@ -87,33 +102,50 @@ QGCMAVLinkMessageField::chartIndex()
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
+QGCMAVLinkMessageField::updateValue(const QString& newValue)
 {
     if(_value != newValue) {
         _value = newValue;
         emit valueChanged();
     }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::addChartValue(qreal v)
+{
     if(_pSeries && _chart) {
-        int count = _values.count();
-        //-- Arbitrary limit of 1 minute of data at 50Hz for now
-        if(count < (50 * 60)) {
-            QPointF p(QGC::bootTimeMilliseconds(), v);
-            _values.append(p);
+        QPointF p(QGC::bootTimeMilliseconds(), v);
+        if(_valuesCount < _maxValues) {
+            _values[(_valuesHead + _valuesCount) % _maxValues] = p;
+            _valuesCount++;
         } else {
-            if(_dataIndex >= count) _dataIndex = 0;
-            _values[_dataIndex].setX(QGC::bootTimeMilliseconds());
-            _values[_dataIndex].setY(v);
-            _dataIndex++;
+            _values[_valuesHead] = p;
+            _valuesHead = (_valuesHead + 1) % _maxValues;
         }
-        //-- Auto Range
-        if(_chart->rangeYIndex() == 0) {
-            qreal vmin  = std::numeric_limits<qreal>::max();
-            qreal vmax  = std::numeric_limits<qreal>::min();
-            for(int i = 0; i < _values.count(); i++) {
-                qreal v = _values[i].y();
-                if(vmax < v) vmax = v;
-                if(vmin > v) vmin = v;
+        //-- Track min/max in O(1): each deque only holds values which can still become the min/max of the buffer
+        quint64 sequence = _valueSequence++;
+        if(!qIsNaN(v)) {
+            while(!_minDeque.empty() && _minDeque.back().value >= v) {
+                _minDeque.pop_back();
+            }
+            _minDeque.push_back(Extreme_t{sequence, v});
+            while(!_maxDeque.empty() && _maxDeque.back().value <= v) {
+                _maxDeque.pop_back();
             }
+            _maxDeque.push_back(Extreme_t{sequence, v});
+        }
+        quint64 oldestSequence = _valueSequence - static_cast<quint64>(_valuesCount);
+        while(!_minDeque.empty() && _minDeque.front().sequence < oldestSequence) {
+            _minDeque.pop_front();
+        }
+        while(!_maxDeque.empty() && _maxDeque.front().sequence < oldestSequence) {
+            _maxDeque.pop_front();
+        }
+        //-- Auto Range
+        if(_chart->rangeYIndex() == 0 && !_minDeque.empty()) {
+            qreal vmin  = _minDeque.front().value;
+            qreal vmax  = _maxDeque.front().value;
             bool changed = false;
             if(std::abs(_rangeMin - vmin) > 0.000001) {
                 _rangeMin = vmin;
@@ -132,21 +164,70 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessageField::updateSeries()
+QGCMAVLinkMessageField::updateSeries(qint64 startMsecs, qint64 endMsecs, int plotWidth)
 {
-    int count = _values.count();
-    if (count > 1) {
-        QList<QPointF> s;
-        s.reserve(count);
-        int idx = _dataIndex;
-        for(int i = 0; i < count; i++, idx++) {
-            if(idx >= count) idx = 0;
-            QPointF p(_values[idx]);
-            s.append(p);
+    if (_valuesCount < 2) {
+        return;
+    }
+    //-- Binary search for the first visible value, values are in time order
+    int first = 0;
+    int last  = _valuesCount;
+    while(first < last) {
+        int middle = first + ((last - first) / 2);
+        if(_valueAt(middle).x() < startMsecs) {
+            first = middle + 1;
+        } else {
+            last = middle;
         }
-        QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(s);
     }
+    //-- Include the value before the range so the line starts at the left edge
+    first = qMax(first - 1, 0);
+
+    QVector<QPointF> s;
+    int visibleCount = _valuesCount - first;
+    plotWidth = qMax(plotWidth, 1);
+    if(visibleCount <= plotWidth * 2) {
+        s.reserve(visibleCount);
+        for(int i = first; i < _valuesCount; i++) {
+            s.append(_valueAt(i));
+        }
+    } else {
+        //-- More values than can be drawn: keep the min and max of each pixel column, in time order
+        s.reserve(plotWidth * 2 + 2);
+        qreal   columnMsecs = qMax(static_cast<qreal>(endMsecs - startMsecs) / plotWidth, 1.0);
+        qint64  column      = -1;
+        int     minIndex    = -1;
+        int     maxIndex    = -1;
+        auto flushColumn = [this, &s, &minIndex, &maxIndex]() {
+            if(minIndex >= 0) {
+                s.append(_valueAt(qMin(minIndex, maxIndex)));
+                if(minIndex != maxIndex) {
+                    s.append(_valueAt(qMax(minIndex, maxIndex)));
+                }
+            }
+            minIndex = maxIndex = -1;
+        };
+        for(int i = first; i < _valuesCount; i++) {
+            const QPointF& p = _valueAt(i);
+            qint64 pointColumn = static_cast<qint64>((p.x() - startMsecs) / columnMsecs);
+            if(pointColumn != column) {
+                flushColumn();
+                column = pointColumn;
+            }
+            if(qIsNaN(p.y())) {
+                continue;
+            }
+            if(minIndex < 0 || p.y() < _valueAt(minIndex).y()) {
+                minIndex = i;
+            }
+            if(maxIndex < 0 || p.y() > _valueAt(maxIndex).y()) {
+                maxIndex = i;
+            }
+        }
+        flushColumn();
+    }
+    QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
+    lineSeries->replace(s);
 }
 
 //-----------------------------------------------------------------------------
@@ -159,6 +240,7 @@ QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message
         qCWarning(MAVLinkInspectorLog) << QStringLiteral("QGCMAVLinkMessage NULL msgInfo msgid(%1)").arg(message->msgid);
         return;
     }
+    _msgInfo = msgInfo;
     _name = QString(msgInfo->name);
     qCDebug(MAVLinkInspectorLog) << "New Message:" << _name;
     for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
@@ -209,11 +291,10 @@ QGCMAVLinkMessage::updateFieldSelection()
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessage::updateFreq()
+QGCMAVLinkMessage::updateFreq(const MAVLinkMessageStats::Totals_t& totals)
 {
-    quint64 msgCount = _count - _lastCount;
-    _messageHz = (0.2 * _messageHz) + (0.8 * msgCount);
-    _lastCount = _count;
+    _messageHz      = totals.messagesPerSecond[MAVLinkMessageStats::Horizon1Sec];
+    _bytesPerSecond = totals.bytesPerSecond[MAVLinkMessageStats::Horizon1Sec];
     emit freqChanged();
 }
 
@@ -230,19 +311,71 @@ void QGCMAVLinkMessage::setSelected(bool sel)
 void
 QGCMAVLinkMessage::update(mavlink_message_t* message)
 {
+    // Only the raw message is kept here. Fields are formatted by refresh at the ui rate, and only for the selected message.
     _count++;
     _message = *message;
+    _dirty = true;
 
-    if (_selected) {
-        // Don't update field info unless selected to reduce perf hit of message processing
-        _updateFields();
+    if (_fieldSelected) {
+        // Charts need every sample
+        _updateChartValues();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessage::refresh()
+{
+    if (_dirty) {
+        _dirty = false;
+        if (_selected) {
+            _updateFields();
+        }
+        emit countChanged();
     }
-    emit countChanged();
 }
 
+//-----------------------------------------------------------------------------
+/// Decodes the first element of a numeric field as used for charting
+static qreal
+_chartValue(const mavlink_field_info_t& fieldInfo, const uint8_t* payload)
+{
+    const uint8_t* p = payload + fieldInfo.wire_offset;
+    switch (fieldInfo.type) {
+    case MAVLINK_TYPE_UINT8_T:  return static_cast<qreal>(*p);
+    case MAVLINK_TYPE_INT8_T:   return static_cast<qreal>(*reinterpret_cast<const int8_t*>(p));
+    case MAVLINK_TYPE_UINT16_T: { uint16_t n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_INT16_T:  { int16_t  n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_UINT32_T: { uint32_t n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_INT32_T:  { int32_t  n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_FLOAT:    { float    n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_DOUBLE:   { double   n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_UINT64_T: { uint64_t n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    case MAVLINK_TYPE_INT64_T:  { int64_t  n; memcpy(&n, p, sizeof(n)); return static_cast<qreal>(n); }
+    default:                    return 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessage::_updateChartValues()
+{
+    if (!_msgInfo || _fields.count() != static_cast<int>(_msgInfo->num_fields)) {
+        return;
+    }
+    const uint8_t* m = reinterpret_cast<const uint8_t*>(&_message.payload64[0]);
+    for (int i = 0; i < _fields.count(); ++i) {
+        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
+        if(f && f->selected()) {
+            f->addChartValue(_chartValue(_msgInfo->fields[i], m));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
 void QGCMAVLinkMessage::_updateFields(void)
 {
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&_message);
+    const mavlink_message_info_t* msgInfo = _msgInfo;
     if (!msgInfo) {
         qWarning() << QStringLiteral("QGCMAVLinkMessage::update NULL msgInfo msgid(%1)").arg(_message.msgid);
         return;
@@ -266,12 +399,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                     // Enforce null termination
                     str[array_length - 1] = '\0';
                     QString v(str);
-                    f->updateValue(v, 0);
+                    f->updateValue(v);
                 } else {
                     // Single char
                     char b = *(reinterpret_cast<char*>(m + offset));
                     QString v(b);
-                    f->updateValue(v, 0);
+                    f->updateValue(v);
                 }
                 break;
             case MAVLINK_TYPE_UINT8_T:
@@ -283,11 +416,11 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     uint8_t u = *(m + offset);
-                    f->updateValue(QString::number(u), static_cast<qreal>(u));
+                    f->updateValue(QString::number(u));
                 }
                 break;
             case MAVLINK_TYPE_INT8_T:
@@ -299,11 +432,11 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     int8_t n = *(reinterpret_cast<int8_t*>(m + offset));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->updateValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_UINT16_T:
@@ -316,12 +449,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     uint16_t n;
                     memcpy(&n, m + offset, sizeof(uint16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->updateValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_INT16_T:
@@ -334,12 +467,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     int16_t n;
                     memcpy(&n, m + offset, sizeof(int16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->updateValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_UINT32_T:
@@ -352,7 +485,7 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     uint32_t n;
@@ -360,9 +493,9 @@ void QGCMAVLinkMessage::_updateFields(void)
                     //-- Special case
                     if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
                         QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n),Qt::UTC,0);
-                        f->updateValue(d.toString("HH:mm:ss"), static_cast<qreal>(n));
+                        f->updateValue(d.toString("HH:mm:ss"));
                     } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
+                        f->updateValue(QString::number(n));
                     }
                 }
                 break;
@@ -376,12 +509,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     int32_t n;
                     memcpy(&n, m + offset, sizeof(int32_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->updateValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_FLOAT:
@@ -394,12 +527,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                        string += tmp.arg(static_cast<double>(nums[j]));
                     }
                     string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     float fv;
                     memcpy(&fv, m + offset, sizeof(float));
-                    f->updateValue(QString::number(static_cast<double>(fv)), static_cast<qreal>(fv));
+                    f->updateValue(QString::number(static_cast<double>(fv)));
                 }
                 break;
             case MAVLINK_TYPE_DOUBLE:
@@ -412,12 +545,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     double d;
                     memcpy(&d, m + offset, sizeof(double));
-                    f->updateValue(QString::number(d), static_cast<qreal>(d));
+                    f->updateValue(QString::number(d));
                 }
                 break;
             case MAVLINK_TYPE_UINT64_T:
@@ -430,7 +563,7 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     uint64_t n;
@@ -438,9 +571,9 @@ void QGCMAVLinkMessage::_updateFields(void)
                     //-- Special case
                     if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
                         QDateTime d = QDateTime::fromMSecsSinceEpoch(n/1000,Qt::UTC,0);
-                        f->updateValue(d.toString("yyyy MM dd HH:mm:ss"), static_cast<qreal>(n));
+                        f->updateValue(d.toString("yyyy MM dd HH:mm:ss"));
                     } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
+                        f->updateValue(QString::number(n));
                     }
                 }
                 break;
@@ -454,12 +587,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->updateValue(string);
                 } else {
                     // Single value
                     int64_t n;
                     memcpy(&n, m + offset, sizeof(int64_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->updateValue(QString::number(n));
                 }
                 break;
             }
@@ -485,15 +618,15 @@ QGCMAVLinkSystem::~QGCMAVLinkSystem()
 QGCMAVLinkMessage*
 QGCMAVLinkSystem::findMessage(uint32_t id, uint8_t cid)
 {
-    for(int i = 0; i < _messages.count(); i++) {
-        QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(_messages.get(i));
-        if(m) {
-            if(m->id() == id && m->cid() == cid) {
-                return m;
-            }
-        }
-    }
-    return nullptr;
+    return _messageMap.value(_messageKey(id, cid), nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkSystem::clearMessages()
+{
+    _messageMap.clear();
+    _messages.clearAndDeleteContents();
 }
 
 //-----------------------------------------------------------------------------
@@ -562,6 +695,7 @@ QGCMAVLinkSystem::append(QGCMAVLinkMessage* message)
         message->setSelected(true);
     }
     _messages.append(message);
+    _messageMap[_messageKey(message->id(), message->cid())] = message;
     //-- Sort messages by id and then cid
     if (_messages.count() > 0) {
         _messages.beginReset();
@@ -622,6 +756,16 @@ MAVLinkChartController::setRangeYIndex(quint32 r)
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkChartController::setPlotWidth(int plotWidth)
+{
+    if(plotWidth > 0 && plotWidth != _plotWidth) {
+        _plotWidth = plotWidth;
+        emit plotWidthChanged();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 MAVLinkChartController::setRangeXIndex(quint32 t)
@@ -650,7 +794,7 @@ MAVLinkChartController::updateYRange()
 {
     if(_chartFields.count()) {
         qreal vmin  = std::numeric_limits<qreal>::max();
-        qreal vmax  = std::numeric_limits<qreal>::min();
+        qreal vmax  = std::numeric_limits<qreal>::lowest();
         for(int i = 0; i < _chartFields.count(); i++) {
             QObject* object = qvariant_cast<QObject*>(_chartFields.at(i));
             QGCMAVLinkMessageField* pField = qobject_cast<QGCMAVLinkMessageField*>(object);
@@ -675,11 +819,13 @@ void
 MAVLinkChartController::_refreshSeries()
 {
     updateXRange();
+    qint64 startMsecs   = _rangeXMin.toMSecsSinceEpoch();
+    qint64 endMsecs     = _rangeXMax.toMSecsSinceEpoch();
     for(int i = 0; i < _chartFields.count(); i++) {
         QObject* object = qvariant_cast<QObject*>(_chartFields.at(i));
         QGCMAVLinkMessageField* pField = qobject_cast<QGCMAVLinkMessageField*>(object);
         if(pField) {
-            pField->updateSeries();
+            pField->updateSeries(startMsecs, endMsecs, _plotWidth);
         }
     }
 }
@@ -733,6 +879,8 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
+    connect(&_refreshMessagesTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshMessages);
+    _refreshMessagesTimer.start(UPDATE_FREQUENCY);
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &MAVLinkInspectorController::_setActiveVehicle);
     _timeScaleSt.append(new TimeScale_st(this, tr("5 Sec"),   5 * 1000));
@@ -820,26 +968,43 @@ MAVLinkInspectorController::_findVehicle(uint8_t id)
 void
 MAVLinkInspectorController::_refreshFrequency()
 {
+    //-- Rates come from the protocol's counters, summed over all links
+    MAVLinkMessageStats* stats = qgcApp()->toolbox()->mavlinkProtocol()->messageStats();
     for(int i = 0; i < _systems.count(); i++) {
         QGCMAVLinkSystem* v = qobject_cast<QGCMAVLinkSystem*>(_systems.get(i));
         if(v) {
             for(int i = 0; i < v->messages()->count(); i++) {
                 QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(v->messages()->get(i));
                 if(m) {
-                    m->updateFreq();
+                    m->updateFreq(stats->messageTotals(-1, v->id(), m->cid(), m->id()));
                 }
             }
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkInspectorController::_refreshMessages()
+{
+    //-- Only the active system is visible
+    if(_activeSystem) {
+        for(int i = 0; i < _activeSystem->messages()->count(); i++) {
+            QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(_activeSystem->messages()->get(i));
+            if(m) {
+                m->refresh();
+            }
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 MAVLinkInspectorController::_vehicleAdded(Vehicle* vehicle)
 {
     QGCMAVLinkSystem* v = _findVehicle(static_cast<uint8_t>(vehicle->id()));
     if(v) {
-        v->messages()->clearAndDeleteContents();
+        v->clearMessages();
     } else {
         v = new QGCMAVLinkSystem(this, static_cast<uint8_t>(vehicle->id()));
         _systems.append(v);
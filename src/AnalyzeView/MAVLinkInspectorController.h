@@ -20,8 +20,11 @@
 #include <QString>
 #include <QDebug>
 #include <QVariantList>
+#include <QHash>
 #include <QtCharts/QAbstractSeries>
 
+#include <deque>
+
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkInspectorLog)
 
 QT_CHARTS_USE_NAMESPACE
@@ -53,17 +56,20 @@ public:
     bool            selectable      () { return _selectable; }
     bool            selected        () { return _pSeries != nullptr; }
     QAbstractSeries*series          () { return _pSeries; }
-    QList<QPointF>* values          () { return &_values;}
+    int             valueCount      () { return _valuesCount; }
     qreal           rangeMin        () { return _rangeMin; }
     qreal           rangeMax        () { return _rangeMax; }
     int             chartIndex      ();
 
     void            setSelectable   (bool sel);
-    void            updateValue     (QString newValue, qreal v);
+    void            updateValue     (const QString& newValue);
+    void            addChartValue   (qreal v);
 
     void            addSeries       (MAVLinkChartController* chart, QAbstractSeries* series);
     void            delSeries       ();
-    void            updateSeries    ();
+
+    /// Replaces the series points with the values within the time range, decimated to at most two points per pixel column
+    void            updateSeries    (qint64 startMsecs, qint64 endMsecs, int plotWidth);
 
 signals:
     void            seriesChanged       ();
@@ -71,18 +77,36 @@ signals:
     void            valueChanged        ();
 
 private:
+    typedef struct {
+        quint64 sequence;
+        qreal   value;
+    } Extreme_t;
+
+    const QPointF&  _valueAt        (int index) const { return _values[(_valuesHead + index) % _maxValues]; }
+    void            _clearValues    ();
+
     QString     _type;
     QString     _name;
     QString     _value;
     bool        _selectable = true;
-    int         _dataIndex  = 0;
     qreal       _rangeMin   = 0;
     qreal       _rangeMax   = 0;
 
     QAbstractSeries*    _pSeries = nullptr;
     QGCMAVLinkMessage*  _msg     = nullptr;
     MAVLinkChartController*      _chart   = nullptr;
-    QList<QPointF>      _values;
+
+    // Circular buffer of the charted values, oldest value at _valuesHead
+    QVector<QPointF>    _values;
+    int                 _valuesHead     = 0;
+    int                 _valuesCount    = 0;
+    quint64             _valueSequence  = 0;
+
+    // Monotonic deques of the values within the buffer: the front is always the current min/max
+    std::deque<Extreme_t>   _minDeque;
+    std::deque<Extreme_t>   _maxDeque;
+
+    static const int    _maxValues = 50 * 60;   ///< Arbitrary limit of 1 minute of data at 50Hz
 };
 
 //-----------------------------------------------------------------------------
@@ -94,6 +118,7 @@ public:
     Q_PROPERTY(quint32              cid             READ cid            CONSTANT)
     Q_PROPERTY(QString              name            READ name           CONSTANT)
     Q_PROPERTY(qreal                messageHz       READ messageHz      NOTIFY freqChanged)
+    Q_PROPERTY(qreal                bytesPerSecond  READ bytesPerSecond NOTIFY freqChanged)
     Q_PROPERTY(quint64              count           READ count          NOTIFY countChanged)
     Q_PROPERTY(QmlObjectListModel*  fields          READ fields         CONSTANT)
     Q_PROPERTY(bool                 fieldSelected   READ fieldSelected  NOTIFY fieldSelectedChanged)
@@ -106,15 +131,16 @@ public:
     quint8              cid             () { return _message.compid; }
     QString             name            () { return _name;  }
     qreal               messageHz       () { return _messageHz; }
+    qreal               bytesPerSecond  () { return _bytesPerSecond; }
     quint64             count           () { return _count; }
-    quint64             lastCount       () { return _lastCount; }
     QmlObjectListModel* fields          () { return &_fields; }
     bool                fieldSelected   () { return _fieldSelected; }
     bool                selected        () { return _selected; }
 
     void                updateFieldSelection();
-    void                update          (mavlink_message_t* message);
-    void                updateFreq      ();
+    void                update          (mavlink_message_t* message);   ///< Called for each received message
+    void                refresh         ();                             ///< Called at the ui refresh rate
+    void                updateFreq      (const MAVLinkMessageStats::Totals_t& totals);
     void                setSelected     (bool sel);
 
 signals:
@@ -124,16 +150,19 @@ signals:
     void selectedChanged                ();
 
 private:
-    void _updateFields(void);
+    void _updateFields      (void);
+    void _updateChartValues (void);
 
+    const mavlink_message_info_t* _msgInfo = nullptr;
     QmlObjectListModel  _fields;
     QString             _name;
     qreal               _messageHz      = 0.0;
+    qreal               _bytesPerSecond = 0.0;
     uint64_t            _count          = 1;
-    uint64_t            _lastCount      = 0;
     mavlink_message_t   _message;
     bool                _fieldSelected  = false;
     bool                _selected       = false;
+    bool                _dirty          = false;    ///< true: message received since last refresh
 };
 
 //-----------------------------------------------------------------------------
@@ -157,9 +186,10 @@ public:
     int                 selected        () { return _selected; }
 
     void                setSelected     (int sel);
-    QGCMAVLinkMessage*  findMessage     (uint32_t id, uint8_t cid);
+    QGCMAVLinkMessage*  findMessage     (uint32_t id, uint8_t cid);     ///< Called for each received message, hashed lookup
     int                 findMessage     (QGCMAVLinkMessage* message);
     void                append          (QGCMAVLinkMessage* message);
+    void                clearMessages   ();
 
 signals:
     void compIDsChanged                 ();
@@ -169,11 +199,14 @@ private:
     void _checkCompID                   (QGCMAVLinkMessage *message);
     void _resetSelection                ();
 
+    static quint32 _messageKey          (uint32_t id, uint8_t cid) { return (id << 8) | cid; }
+
 private:
     quint8              _id;
     QList<int>          _compIDs;
     QStringList         _compIDsStr;
     QmlObjectListModel  _messages;      //-- List of QGCMAVLinkMessage
+    QHash<quint32, QGCMAVLinkMessage*> _messageMap;  //-- Messages by id and cid
     int                 _selected = 0;
 };
 
@@ -190,6 +223,7 @@ public:
     Q_PROPERTY(qreal        rangeYMin           READ rangeYMin              NOTIFY rangeYMinChanged)
     Q_PROPERTY(qreal        rangeYMax           READ rangeYMax              NOTIFY rangeYMaxChanged)
     Q_PROPERTY(int          chartIndex          READ chartIndex             CONSTANT)
+    Q_PROPERTY(int          plotWidth           READ plotWidth              WRITE setPlotWidth      NOTIFY plotWidthChanged)   ///< Width of the plot area in pixels
 
     Q_PROPERTY(quint32      rangeYIndex         READ rangeYIndex            WRITE setRangeYIndex    NOTIFY rangeYIndexChanged)
     Q_PROPERTY(quint32      rangeXIndex         READ rangeXIndex            WRITE setRangeXIndex    NOTIFY rangeXIndexChanged)
@@ -207,8 +241,10 @@ public:
     quint32                 rangeXIndex         () { return _rangeXIndex; }
     quint32                 rangeYIndex         () { return _rangeYIndex; }
     int                     chartIndex          () { return _index; }
+    int                     plotWidth           () { return _plotWidth; }
 
     void                    setRangeXIndex      (quint32 t);
+    void                    setPlotWidth        (int plotWidth);
     void                    setRangeYIndex      (quint32 r);
     void                    updateXRange        ();
     void                    updateYRange        ();
@@ -221,6 +257,7 @@ signals:
     void rangeYMaxChanged   ();
     void rangeYIndexChanged ();
     void rangeXIndexChanged ();
+    void plotWidthChanged   ();
 
 private slots:
     void _refreshSeries     ();
@@ -234,6 +271,7 @@ private:
     qreal               _rangeYMax           = 1;
     quint32             _rangeXIndex         = 0;                    ///< 5 Seconds
     quint32             _rangeYIndex         = 0;                    ///< Auto Range
+    int                 _plotWidth           = 1000;
     QVariantList        _chartFields;
     MAVLinkInspectorController* _controller  = nullptr;
 };
@@ -295,6 +333,7 @@ private slots:
     void _vehicleRemoved    (Vehicle* vehicle);
     void _setActiveVehicle  (Vehicle* vehicle);
     void _refreshFrequency  ();
+    void _refreshMessages   ();
 
 private:
     QGCMAVLinkSystem* _findVehicle (uint8_t id);
@@ -307,6 +346,7 @@ private:
     QStringList         _rangeList;
     QGCMAVLinkSystem*   _activeSystem           = nullptr;
     QTimer              _updateFrequencyTimer;
+    QTimer              _refreshMessagesTimer;
     QStringList         _systemNames;
     QmlObjectListModel  _systems;                           ///< List of QGCMAVLinkSystem
     QmlObjectListModel  _charts;                            ///< List of MAVLinkCharts
@@ -143,7 +143,7 @@ AnalyzePage {
                         }
                         QGCLabel {
                             color:      qgcPal.buttonHighlight
-                            text:       curMessage ? curMessage.name + ' (' + curMessage.id + ') ' + curMessage.messageHz.toFixed(1) + 'Hz' : ""
+                            text:       curMessage ? curMessage.name + ' (' + curMessage.id + ') ' + curMessage.messageHz.toFixed(1) + 'Hz ' + curMessage.bytesPerSecond.toFixed(0) + 'B/s' : ""
                         }
                         QGCLabel {
                             text:       qsTr("Component:")
@@ -12,9 +12,14 @@
 #include "QGCMAVLink.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
+#include "TelemetryFrame.h"
+#include "FactValueHistory.h"
 
 #include <QtQml>
 #include <QQmlEngine>
+#include <QDateTime>
+
+#include <limits>
 
 static const char* kMissingMetadata = "Meta data pointer missing";
 
@@ -79,6 +84,14 @@ Fact::Fact(const Fact& other, QObject* parent)
     _init();
 }
 
+Fact::~Fact()
+{
+    if (_telemetryFrame) {
+        _telemetryFrame->removeFact(_telemetryFrameSlot);
+    }
+    delete _history;
+}
+
 void Fact::_init(void)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
@@ -100,6 +113,7 @@ const Fact& Fact::operator=(const Fact& other)
     } else {
         _metaData = nullptr;
     }
+    _invalidateValueCache();
     
     return *this;
 }
@@ -112,7 +126,8 @@ void Fact::forceSetRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
+            _invalidateValueCache();
+            _sendValueChangedSignal();
             //-- Must be in this order
             emit _containerRawValueChanged(rawValue());
             emit rawValueChanged(_rawValue);
@@ -125,16 +140,15 @@ void Fact::forceSetRawValue(const QVariant& value)
 void Fact::setRawValue(const QVariant& value)
 {
     if (_metaData) {
-        QVariant    typedValue;
-        QString     errorString;
-        
-        if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
-            if (typedValue != _rawValue) {
-                _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
-                //-- Must be in this order
-                emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+        if (value.userType() == FactMetaData::typeToMetaType(_metaData->type())) {
+            // Conversion would only produce a copy of the same value
+            _setTypedRawValue(value);
+        } else {
+            QVariant    typedValue;
+            QString     errorString;
+
+            if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
+                _setTypedRawValue(typedValue);
             }
         }
     } else {
@@ -142,6 +156,82 @@ void Fact::setRawValue(const QVariant& value)
     }
 }
 
+void Fact::_setTypedRawValue(const QVariant& typedValue)
+{
+    if (typedValue != _rawValue) {
+        _rawValue.setValue(typedValue);
+        _invalidateValueCache();
+        _sendValueChangedSignal();
+        //-- Must be in this order
+        emit _containerRawValueChanged(rawValue());
+        emit rawValueChanged(_rawValue);
+    }
+}
+
+void Fact::setRawValueDouble(double value)
+{
+    if (!_metaData) {
+        qWarning() << kMissingMetadata << name();
+        return;
+    }
+
+    switch (_metaData->type()) {
+    case FactMetaData::valueTypeDouble:
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+        _setTypedRawValue(QVariant(value));
+        break;
+    case FactMetaData::valueTypeFloat:
+        _setTypedRawValue(QVariant(static_cast<float>(value)));
+        break;
+    default:
+        setRawValue(QVariant(value));
+        break;
+    }
+}
+
+void Fact::setRawValueInt(qint64 value)
+{
+    if (!_metaData) {
+        qWarning() << kMissingMetadata << name();
+        return;
+    }
+
+    switch (_metaData->type()) {
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()) {
+            _setTypedRawValue(QVariant(static_cast<int>(value)));
+            return;
+        }
+        break;
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        if (value >= 0 && value <= std::numeric_limits<uint>::max()) {
+            _setTypedRawValue(QVariant(static_cast<uint>(value)));
+            return;
+        }
+        break;
+    case FactMetaData::valueTypeInt64:
+        _setTypedRawValue(QVariant(static_cast<qlonglong>(value)));
+        return;
+    default:
+        break;
+    }
+
+    setRawValue(QVariant(static_cast<qlonglong>(value)));
+}
+
+void Fact::setRawValueBool(bool value)
+{
+    if (_metaData && _metaData->type() == FactMetaData::valueTypeBool) {
+        _setTypedRawValue(QVariant(value));
+    } else {
+        setRawValue(QVariant(value));
+    }
+}
+
 void Fact::setCookedValue(const QVariant& value)
 {
     if (_metaData) {
@@ -181,7 +271,8 @@ void Fact::_containerSetRawValue(const QVariant& value)
 {
     if(_rawValue != value) {
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
+        _invalidateValueCache();
+        _sendValueChangedSignal();
         emit rawValueChanged(_rawValue);
     }
 
@@ -199,10 +290,24 @@ int Fact::componentId(void) const
     return _componentId;
 }
 
+void Fact::_validateValueCache(void) const
+{
+    if (_metaData && _metaData->generation() != _valueCacheMetaDataGeneration) {
+        _valueCacheMetaDataGeneration   = _metaData->generation();
+        _cookedValueCacheValid          = false;
+        _cookedValueStringCacheValid    = false;
+    }
+}
+
 QVariant Fact::cookedValue(void) const
 {
     if (_metaData) {
-        return _metaData->rawTranslator()(_rawValue);
+        _validateValueCache();
+        if (!_cookedValueCacheValid) {
+            _cookedValueCache       = _metaData->rawTranslator()(_rawValue);
+            _cookedValueCacheValid  = true;
+        }
+        return _cookedValueCache;
     } else {
         qWarning() << kMissingMetadata << name();
         return _rawValue;
@@ -364,7 +469,16 @@ QString Fact::rawValueString(void) const
 
 QString Fact::cookedValueString(void) const
 {
-    return _variantToString(cookedValue(), decimalPlaces());
+    if (!_metaData) {
+        return _variantToString(cookedValue(), decimalPlaces());
+    }
+
+    _validateValueCache();
+    if (!_cookedValueStringCacheValid) {
+        _cookedValueStringCache         = _variantToString(cookedValue(), decimalPlaces());
+        _cookedValueStringCacheValid    = true;
+    }
+    return _cookedValueStringCache;
 }
 
 QVariant Fact::rawDefaultValue(void) const
@@ -545,7 +659,12 @@ QString Fact::group(void) const
 
 void Fact::setMetaData(FactMetaData* metaData, bool setDefaultFromMetaData)
 {
+    // The placeholder meta data allocated by the constructors is no longer needed once real meta data is provided
+    if (_metaData && _metaData != metaData && _metaData->parent() == this) {
+        delete _metaData;
+    }
     _metaData = metaData;
+    _invalidateValueCache();
     if (setDefaultFromMetaData && metaData->defaultValueAvailable()) {
         setRawValue(rawDefaultValue());
     }
@@ -637,21 +756,65 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+void Fact::_sendValueChangedSignal(void)
 {
+    if (_history) {
+        _history->append(QDateTime::currentMSecsSinceEpoch(), _rawValue.toDouble());
+    }
+    if (_telemetryFrame) {
+        _telemetryFrame->write(_telemetryFrameSlot, _rawValue);
+    }
     if (_sendValueChangedSignals) {
-        emit valueChanged(value);
+        emit valueChanged(cookedValue());
         _deferredValueChangeSignal = false;
     } else {
         _deferredValueChangeSignal = true;
     }
 }
 
+FactValueHistory* Fact::enableHistory(int depth)
+{
+    if (type() == FactMetaData::valueTypeString || type() == FactMetaData::valueTypeCustom) {
+        qWarning() << "Fact::enableHistory history not supported for type" << name() << type();
+        return nullptr;
+    }
+    if (!_history || _history->capacity() != depth) {
+        delete _history;
+        _history = new FactValueHistory(depth);
+        _history->append(QDateTime::currentMSecsSinceEpoch(), _rawValue.toDouble());
+    }
+    return _history;
+}
+
+void Fact::disableHistory(void)
+{
+    delete _history;
+    _history = nullptr;
+}
+
+QVariantList Fact::historyPoints(double startMsecs, double endMsecs, int maxPoints) const
+{
+    QVariantList points;
+
+    if (_history) {
+        for (const QPointF& point: _history->lttbPoints(static_cast<qint64>(startMsecs), static_cast<qint64>(endMsecs), maxPoints)) {
+            double cookedY = _metaData ? _metaData->rawTranslator()(point.y()).toDouble() : point.y();
+            points.append(QPointF(point.x(), cookedY));
+        }
+    }
+    return points;
+}
+
 void Fact::sendDeferredValueChangedSignal(void)
 {
+    static const QMetaMethod valueChangedSignal = QMetaMethod::fromSignal(&Fact::valueChanged);
+
+    // Consumers of whole groups listen to FactGroup::valuesChanged instead, so the fact is only signalled if something binds to it
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        if (isSignalConnected(valueChangedSignal)) {
+            emit valueChanged(cookedValue());
+        }
     }
 }
 
@@ -669,6 +832,33 @@ QString Fact::enumOrValueString(void)
     return QString();
 }
 
+QString Fact::enumOrValueString(const QVariant& rawValue) const
+{
+    static const double accuracy = 1.0 / 1000000.0;
+
+    if (!_metaData) {
+        qWarning() << kMissingMetadata << name();
+        return QString();
+    }
+
+    if (_metaData->enumStrings().count()) {
+        const QVariantList& enumValues = _metaData->enumValues();
+        for (int i=0; i<enumValues.count(); i++) {
+            if (enumValues[i] == rawValue) {
+                return _metaData->enumStrings()[i];
+            }
+            //-- Float comparissons don't always work
+            if (type() == FactMetaData::valueTypeFloat || type() == FactMetaData::valueTypeDouble) {
+                if (fabs(enumValues[i].toDouble() - rawValue.toDouble()) < accuracy) {
+                    return _metaData->enumStrings()[i];
+                }
+            }
+        }
+        return tr("Unknown: %1").arg(rawValue.toString());
+    }
+    return _variantToString(_metaData->rawTranslator()(rawValue), decimalPlaces());
+}
+
 double Fact::rawIncrement(void) const
 {
     if (_metaData) {
@@ -18,6 +18,8 @@
 #include <QAbstractListModel>
 
 class FactValueSliderListModel;
+class TelemetryFrame;
+class FactValueHistory;
 
 /// @brief A Fact is used to hold a single value within the system.
 class Fact : public QObject
@@ -33,6 +35,8 @@ public:
     /// custom builds to override the metadata.
     Fact(const QString& settingsGroup, FactMetaData* metaData, QObject* parent = nullptr);
 
+    ~Fact();
+
     const Fact& operator=(const Fact& other);
 
     Q_PROPERTY(int          componentId             READ componentId                                        CONSTANT)
@@ -80,8 +84,10 @@ public:
     /// Convert and clamp value
     Q_INVOKABLE QVariant clamp(const QString& cookedValue);
 
-    QVariant        cookedValue             (void) const;   /// Value after translation
+    QVariant        cookedValue             (void) const;   /// Value after translation, cached until the raw value or meta data changes
     QVariant        rawValue                (void) const { return _rawValue; }  /// value prior to translation, careful
+    double          rawValueDouble          (void) const { return _rawValue.toDouble(); }
+    double          cookedValueDouble       (void) const { return cookedValue().toDouble(); }
     int             componentId             (void) const;
     int             decimalPlaces           (void) const;
     QVariant        rawDefaultValue         (void) const;
@@ -116,6 +122,7 @@ public:
     bool            vehicleRebootRequired   (void) const;
     bool            qgcRebootRequired       (void) const;
     QString         enumOrValueString       (void);         // This is not const, since an unknown value can modify the enum lists
+    QString         enumOrValueString       (const QVariant& rawValue) const;   ///< Same as above for the specified raw value, for example a published telemetry snapshot
     double          rawIncrement            (void) const;
     double          cookedIncrement         (void) const;
     bool            typeIsString            (void) const { return type() == FactMetaData::valueTypeString; }
@@ -131,10 +138,21 @@ public:
 
     Q_INVOKABLE FactValueSliderListModel* valueSliderModel(void);
 
+    /// Returns the cooked history values within the time range downsampled to maxPoints, as points of msecs since epoch and value.
+    /// Empty if history is not enabled.
+    Q_INVOKABLE QVariantList historyPoints(double startMsecs, double endMsecs, int maxPoints) const;
+
     /// Returns the values as a string with full 18 digit precision if float/double.
     QString rawValueStringFullPrecision(void) const;
 
     void setRawValue        (const QVariant& value);
+
+    // Typed fast path for high rate telemetry values. If the value already matches the type of the fact it is stored as is
+    // instead of going through FactMetaData::convertAndValidateRaw. Otherwise these behave the same as setRawValue.
+    void setRawValueDouble  (double value);
+    void setRawValueInt     (qint64 value);
+    void setRawValueBool    (bool value);
+
     void setCookedValue     (const QVariant& value);
     void setEnumIndex       (int index);
     void setEnumStringValue (const QString& value);
@@ -149,6 +167,19 @@ public:
     void clearDeferredValueChangeSignal(void) { _deferredValueChangeSignal = false; }
     void sendDeferredValueChangedSignal(void);
 
+    /// Value changes are written to the specified slot of the frame. Set by TelemetryFrame::addFact, cleared when the group leaves it.
+    void setTelemetryFrame          (TelemetryFrame* telemetryFrame, int slot) { _telemetryFrame = telemetryFrame; _telemetryFrameSlot = slot; }
+    int  telemetryFrameSlot         (void) const { return _telemetryFrameSlot; }
+
+    /// Starts keeping a time series of the raw value, recorded on each value change. Only numeric facts keep history.
+    ///     @param depth Number of samples kept, the oldest samples are dropped once full
+    /// @return History for the fact, nullptr if the fact is not numeric
+    FactValueHistory*   enableHistory   (int depth = defaultHistoryDepth);
+    void                disableHistory  (void);
+    FactValueHistory*   history         (void) const { return _history; }
+
+    static const int defaultHistoryDepth = 36000;   ///< One hour at 10 Hz
+
     // C++ methods
 
     /// Sets and sends new value to vehicle even if value is the same
@@ -198,7 +229,12 @@ private:
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
+    void _setTypedRawValue(const QVariant& typedValue);
+    void _validateValueCache(void) const;
+
+    /// Must be called whenever _rawValue is changed directly
+    void _invalidateValueCache(void) { _cookedValueCacheValid = false; _cookedValueStringCacheValid = false; }
 
     QString                     _name;
     int                         _componentId;
@@ -209,4 +245,14 @@ protected:
     bool                        _deferredValueChangeSignal;
     FactValueSliderListModel*   _valueSliderModel;
     bool                        _ignoreQGCRebootRequired;
+    TelemetryFrame*             _telemetryFrame         = nullptr;
+    int                         _telemetryFrameSlot     = -1;
+    FactValueHistory*           _history                = nullptr;
+
+    // Cooked value and its string are only computed when asked for, most telemetry updates are never displayed
+    mutable QVariant            _cookedValueCache;
+    mutable QString             _cookedValueStringCache;
+    mutable bool                _cookedValueCacheValid          = false;
+    mutable bool                _cookedValueStringCacheValid    = false;
+    mutable uint32_t            _valueCacheMetaDataGeneration   = 0;
 };
@@ -18,13 +18,14 @@
 #include <QFile>
 #include <QQmlEngine>
 
+QMap<QString, QMap<QString, FactMetaData*>> FactGroup::_metaDataFileMaps;
+
 FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent, bool ignoreCamelCase)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
-    _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
+    _nameToFactMetaDataMap = _sharedMetaDataMap(metaDataFile);
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
 
@@ -33,23 +34,80 @@ FactGroup::FactGroup(int updateRateMsecs, QObject* parent, bool ignoreCamelCase)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
 
+FactGroup::~FactGroup()
+{
+    if (_telemetryFrame) {
+        _telemetryFrame->removeGroup(this);
+    }
+}
+
+QMap<QString, FactMetaData*> FactGroup::_sharedMetaDataMap(const QString& metaDataFile)
+{
+    // Every vehicle creates the same set of groups, so the json is only parsed the first time
+    if (!_metaDataFileMaps.contains(metaDataFile)) {
+        _metaDataFileMaps[metaDataFile] = FactMetaData::createMapFromJsonFile(metaDataFile, nullptr /* metaDataParent */);
+    }
+    return _metaDataFileMaps[metaDataFile];
+}
+
 void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
 {
     QMap<QString, QString> defineMap;
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonArray(jsonArray, defineMap, this);
 }
 
-void FactGroup::_setupTimer()
+TelemetryFrame* FactGroup::_frame(void)
 {
-    if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
-        _updateTimer.start();
+    if (!_telemetryFrame) {
+        _telemetryFrame = new TelemetryFrame(this);
+        _telemetryFrame->addGroup(this, _updateRateMSecs);
+    }
+    return _telemetryFrame;
+}
+
+void FactGroup::_setTelemetryFrame(TelemetryFrame* telemetryFrame)
+{
+    if (telemetryFrame == _telemetryFrame) {
+        return;
+    }
+
+    TelemetryFrame* previousFrame = _telemetryFrame;
+    if (previousFrame) {
+        previousFrame->removeGroup(this);
+    }
+
+    _telemetryFrame = telemetryFrame;
+    _telemetryFrame->addGroup(this, _updateRateMSecs);
+    for (Fact* fact: _nameToFactMap) {
+        _telemetryFrame->addFact(this, fact);
+    }
+
+    for (FactGroup* factGroup: _nameToFactGroupMap) {
+        if (factGroup != this && factGroup->_updateRateMSecs > 0) {
+            factGroup->_setTelemetryFrame(telemetryFrame);
+        }
+    }
+
+    if (previousFrame && previousFrame->parent() == this && previousFrame->groupCount() == 0) {
+        delete previousFrame;
+    }
+}
+
+void FactGroup::_telemetryFrameDestroyed(TelemetryFrame* telemetryFrame)
+{
+    if (_telemetryFrame != telemetryFrame) {
+        return;
+    }
+
+    _telemetryFrame = nullptr;
+    if (!_nameToFactMap.isEmpty()) {
+        TelemetryFrame* frame = _frame();
+        for (Fact* fact: _nameToFactMap) {
+            frame->addFact(this, fact);
+        }
     }
 }
 
@@ -135,6 +193,9 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
     }
     _nameToFactMap[name] = fact;
     _factNames.append(name);
+    if (_updateRateMSecs > 0) {
+        _frame()->addFact(this, fact);
+    }
 
     emit factNamesChanged();
 }
@@ -147,28 +208,52 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
     }
 
     _nameToFactGroupMap[name] = factGroup;
+    if (factGroup != this && _updateRateMSecs > 0 && factGroup->_updateRateMSecs > 0) {
+        factGroup->_setTelemetryFrame(_frame());
+    }
 
     emit factGroupNamesChanged();
 }
 
 void FactGroup::_updateAllValues(void)
 {
-    for(Fact* fact: _nameToFactMap) {
-        fact->sendDeferredValueChangedSignal();
+    if (_telemetryFrame && _telemetryFrame->publishGroup(this)) {
+        emit valuesChanged();
     }
 }
 
+QVariant FactGroup::publishedValue(const QString& name)
+{
+    Fact* fact = getFact(name);
+    if (!fact) {
+        return QVariant();
+    }
+    if (!_telemetryFrame || fact->telemetryFrameSlot() == -1) {
+        return fact->cookedValue();
+    }
+    QVariant rawValue = _telemetryFrame->value(fact->telemetryFrameSlot());
+    return fact->metaData() ? fact->metaData()->rawTranslator()(rawValue) : rawValue;
+}
+
+QString FactGroup::publishedValueString(const QString& name)
+{
+    Fact* fact = getFact(name);
+    if (!fact) {
+        return QString();
+    }
+    if (!_telemetryFrame || fact->telemetryFrameSlot() == -1) {
+        return fact->enumOrValueString();
+    }
+    return fact->enumOrValueString(_telemetryFrame->value(fact->telemetryFrameSlot()));
+}
+
 void FactGroup::setLiveUpdates(bool liveUpdates)
 {
-    if (_updateTimer.interval() == 0) {
+    if (_updateRateMSecs == 0) {
         return;
     }
 
-    if (liveUpdates) {
-        _updateTimer.stop();
-    } else {
-        _updateTimer.start();
-    }
+    // Live facts signal right away and no longer queue in the frame
     for(Fact* fact: _nameToFactMap) {
         fact->setSendValueChangedSignals(liveUpdates);
     }
@@ -10,23 +10,29 @@
 #pragma once
 
 #include "Fact.h"
+#include "TelemetryFrame.h"
 #include "QGCMAVLink.h"
 #include "QGCLoggingCategory.h"
 
 #include <QStringList>
 #include <QMap>
-#include <QTimer>
+#include <QPointer>
 
 class Vehicle;
 
 /// Used to group Facts together into an object hierarachy.
+///
+/// Rate limited groups publish their values through a TelemetryFrame. A group added to a rate limited parent joins the
+/// parent's frame, so a vehicle and all of its groups share a single frame.
 class FactGroup : public QObject
 {
     Q_OBJECT
     
 public:
+    /// Meta data loaded from metaDataFile is shared by all groups created from the same file and must not be modified
     FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent = nullptr, bool ignoreCamelCase = false);
     FactGroup(int updateRateMsecs, QObject* parent = nullptr, bool ignoreCamelCase = false);
+    ~FactGroup();
 
     Q_PROPERTY(QStringList  factNames           READ factNames          NOTIFY factNamesChanged)
     Q_PROPERTY(QStringList  factGroupNames      READ factGroupNames     NOTIFY factGroupNamesChanged)
@@ -46,10 +52,19 @@ public:
     /// Turning on live updates will allow value changes to flow through as they are received.
     Q_INVOKABLE void setLiveUpdates(bool liveUpdates);
 
+    /// @return Cooked value of the fact as of the group's last publish. Falls back to the current value if the group is not rate limited.
+    Q_INVOKABLE QVariant publishedValue(const QString& name);
+
+    /// @return Display string of the fact's value as of the group's last publish
+    Q_INVOKABLE QString publishedValueString(const QString& name);
+
     QStringList factNames           (void) const { return _factNames; }
     QStringList factGroupNames      (void) const { return _nameToFactGroupMap.keys(); }
     bool        telemetryAvailable  (void) const { return _telemetryAvailable; }
 
+    /// @return Frame the group's values are published through, nullptr if the group is not rate limited or has no facts yet
+    TelemetryFrame* telemetryFrame  (void) const { return _telemetryFrame; }
+
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message);
 
@@ -58,6 +73,9 @@ signals:
     void factGroupNamesChanged      (void);
     void telemetryAvailableChanged  (bool telemetryAvailable);
 
+    /// Signalled once per publish of a rate limited group in which at least one of its values changed
+    void valuesChanged              (void);
+
 protected slots:
     virtual void _updateAllValues(void);
 
@@ -75,10 +93,18 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
+    static QMap<QString, FactMetaData*> _sharedMetaDataMap(const QString& metaDataFile);
+
+    TelemetryFrame* _frame                  (void);
+    void            _setTelemetryFrame      (TelemetryFrame* telemetryFrame);
+    void            _telemetryFrameDestroyed(TelemetryFrame* telemetryFrame);
+    QString         _camelCase              (const QString& text);
+
+    bool                        _ignoreCamelCase    = false;
+    QPointer<TelemetryFrame>    _telemetryFrame;
+    bool                        _telemetryAvailable = false;
+
+    static QMap<QString, QMap<QString, FactMetaData*>> _metaDataFileMaps;  ///< Meta data json file name to parsed meta data, shared by all instances
 
-    bool    _ignoreCamelCase    = false;
-    QTimer  _updateTimer;
-    bool    _telemetryAvailable = false;
+    friend class TelemetryFrame;
 };
@@ -243,6 +243,7 @@ const FactMetaData& FactMetaData::operator=(const FactMetaData& other)
     _readOnly               = other._readOnly;
     _writeOnly              = other._writeOnly;
     _volatile               = other._volatile;
+    _generation++;
     return *this;
 }
 
@@ -703,6 +704,7 @@ void FactMetaData::setTranslators(Translator rawTranslator, Translator cookedTra
 {
     _rawTranslator = rawTranslator;
     _cookedTranslator = cookedTranslator;
+    _generation++;
 }
 
 void FactMetaData::setBuiltInTranslator(void)
@@ -940,6 +942,37 @@ QString FactMetaData::typeToString(ValueType_t type)
     return QStringLiteral("UnknownType%1").arg(type);
 }
 
+int FactMetaData::typeToMetaType(ValueType_t type)
+{
+    switch (type) {
+    case valueTypeUint8:
+    case valueTypeUint16:
+    case valueTypeUint32:
+        return QMetaType::UInt;
+    case valueTypeInt8:
+    case valueTypeInt16:
+    case valueTypeInt32:
+        return QMetaType::Int;
+    case valueTypeUint64:
+        return QMetaType::ULongLong;
+    case valueTypeInt64:
+        return QMetaType::LongLong;
+    case valueTypeFloat:
+        return QMetaType::Float;
+    case valueTypeDouble:
+    case valueTypeElapsedTimeInSeconds:
+        return QMetaType::Double;
+    case valueTypeString:
+        return QMetaType::QString;
+    case valueTypeBool:
+        return QMetaType::Bool;
+    case valueTypeCustom:
+        return QMetaType::QByteArray;
+    }
+
+    return QMetaType::UnknownType;
+}
+
 size_t FactMetaData::typeToSize(ValueType_t type)
 {
     switch (type) {
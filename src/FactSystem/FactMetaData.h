@@ -140,13 +140,17 @@ public:
     Translator      rawTranslator           (void) const { return _rawTranslator; }
     Translator      cookedTranslator        (void) const { return _cookedTranslator; }
 
+    /// Changes whenever something which affects the cooked value or its formatting changes. Used by Fact to know when
+    /// its cached cooked value is stale.
+    uint32_t        generation              (void) const { return _generation; }
+
     /// Used to add new values to the bitmask lists after the meta data has been loaded
     void addBitmaskInfo(const QString& name, const QVariant& value);
 
     /// Used to add new values to the enum lists after the meta data has been loaded
     void addEnumInfo(const QString& name, const QVariant& value);
 
-    void setDecimalPlaces           (int decimalPlaces)                 { _decimalPlaces = decimalPlaces; }
+    void setDecimalPlaces           (int decimalPlaces)                 { _decimalPlaces = decimalPlaces; _generation++; }
     void setRawDefaultValue         (const QVariant& rawDefaultValue);
     void setBitmaskInfo             (const QStringList& strings, const QVariantList& values);
     void setEnumInfo                (const QStringList& strings, const QVariantList& values);
@@ -160,7 +164,7 @@ public:
     void setRawUnits                (const QString& rawUnits);
     void setVehicleRebootRequired   (bool rebootRequired)               { _vehicleRebootRequired = rebootRequired; }
     void setQGCRebootRequired       (bool rebootRequired)               { _qgcRebootRequired = rebootRequired; }
-    void setRawIncrement            (double increment)                  { _rawIncrement = increment; }
+    void setRawIncrement            (double increment)                  { _rawIncrement = increment; _generation++; }
     void setHasControl              (bool bValue)                       { _hasControl = bValue; }
     void setReadOnly                (bool bValue)                       { _readOnly = bValue; }
     void setWriteOnly               (bool bValue)                       { _writeOnly = bValue; }
@@ -201,6 +205,9 @@ public:
     static QString typeToString(ValueType_t type);
     static size_t typeToSize(ValueType_t type);
 
+    /// @return QMetaType id which convertAndValidateRaw produces for the specified type
+    static int typeToMetaType(ValueType_t type);
+
     static const char* qgcFileType;
 
 private:
@@ -323,6 +330,7 @@ private:
     bool            _writeOnly;
     bool            _volatile;
     CustomCookedValidator _customCookedValidator = nullptr;
+    uint32_t        _generation = 0;
 
     // Exact conversion constants
     static const struct UnitConsts_s {
@@ -19,8 +19,31 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "FactGroup.h"
+#include "VehicleGPSFactGroup.h"
+#include "FactValueHistory.h"
 
 #include <QQuickItem>
+#include <QtMath>
+#include <QDateTime>
+
+class TelemetryFrameTestFactGroup : public FactGroup
+{
+public:
+    TelemetryFrameTestFactGroup(QObject* parent = nullptr)
+        : FactGroup (50, parent)
+        , rollFact  (0, "roll",     FactMetaData::valueTypeDouble)
+        , modeFact  (0, "mode",     FactMetaData::valueTypeString)
+    {
+        _addFact(&rollFact, "roll");
+        _addFact(&modeFact, "mode");
+    }
+
+    void addFactGroup(FactGroup* factGroup, const QString& name) { _addFactGroup(factGroup, name); }
+
+    Fact rollFact;
+    Fact modeFact;
+};
 
 /// FactSystem Unit Test
 FactSystemTestBase::FactSystemTestBase(void)
@@ -116,3 +139,235 @@ void FactSystemTestBase::_qmlUpdate_test(void)
 #endif
 }
 
+
+/// Test that rate limited groups share the vehicle frame and publish a snapshot with a single notification per group
+void FactSystemTestBase::_telemetryFrame_test(void)
+{
+    QVERIFY(_vehicle->telemetryFrame());
+    QCOMPARE(_vehicle->gpsFactGroup()->telemetryFrame(), _vehicle->telemetryFrame());
+
+    TelemetryFrameTestFactGroup parentGroup;
+    TelemetryFrameTestFactGroup childGroup;
+
+    TelemetryFrame* childFrame = childGroup.telemetryFrame();
+    QVERIFY(childFrame);
+    QVERIFY(childFrame != parentGroup.telemetryFrame());
+
+    parentGroup.addFactGroup(&childGroup, "child");
+    TelemetryFrame* frame = parentGroup.telemetryFrame();
+    QCOMPARE(childGroup.telemetryFrame(), frame);
+    QCOMPARE(frame->groupCount(), 2);
+    QCOMPARE(frame->slotCount(), 4);
+
+    int rollSlot = parentGroup.rollFact.telemetryFrameSlot();
+    int modeSlot = parentGroup.modeFact.telemetryFrameSlot();
+    QVERIFY(rollSlot != -1);
+    QVERIFY(modeSlot != -1);
+
+    QSignalSpy parentValuesSpy  (&parentGroup,              &FactGroup::valuesChanged);
+    QSignalSpy childValuesSpy   (&childGroup,               &FactGroup::valuesChanged);
+    QSignalSpy rollValueSpy     (&parentGroup.rollFact,     &Fact::valueChanged);
+    QSignalSpy modeValueSpy     (&parentGroup.modeFact,     &Fact::valueChanged);
+
+    // Writes land in the back buffer, the snapshot only changes when the group is published
+    double publishedRoll = frame->valueDouble(rollSlot);
+    parentGroup.rollFact.setRawValue(1.5);
+    parentGroup.rollFact.setRawValue(2.5);
+    parentGroup.modeFact.setRawValue(QStringLiteral("Hold"));
+    QCOMPARE(parentValuesSpy.count(), 0);
+    QCOMPARE(rollValueSpy.count(), 0);
+    QCOMPARE(frame->valueDouble(rollSlot), publishedRoll);
+
+    // Several changes between frames go out as one group notification with the last written values
+    QVERIFY(parentValuesSpy.wait(1000));
+    QCOMPARE(parentValuesSpy.count(), 1);
+    QCOMPARE(frame->valueDouble(rollSlot), 2.5);
+    QCOMPARE(frame->value(rollSlot).type(), QVariant::Double);
+    QCOMPARE(frame->value(modeSlot).toString(), QStringLiteral("Hold"));
+    QCOMPARE(parentGroup.publishedValue("roll").toDouble(), 2.5);
+    QCOMPARE(rollValueSpy.count(), 1);
+    QCOMPARE(rollValueSpy[0][0].toDouble(), 2.5);
+    QCOMPARE(modeValueSpy.count(), 1);
+    QCOMPARE(childValuesSpy.count(), 0);
+
+    childGroup.rollFact.setRawValue(-1.0);
+    QVERIFY(childValuesSpy.wait(1000));
+    QCOMPARE(childValuesSpy.count(), 1);
+    QCOMPARE(frame->valueDouble(childGroup.rollFact.telemetryFrameSlot()), -1.0);
+
+    // Nothing written, nothing published
+    QTest::qWait(200);
+    QCOMPARE(parentValuesSpy.count(), 1);
+    QCOMPARE(childValuesSpy.count(), 1);
+
+    // A group which leaves the frame detaches its facts
+    frame->removeGroup(&childGroup);
+    QCOMPARE(frame->groupCount(), 1);
+    QCOMPARE(childGroup.rollFact.telemetryFrameSlot(), -1);
+    childGroup.rollFact.setRawValue(3.0);
+    QTest::qWait(200);
+    QCOMPARE(childValuesSpy.count(), 1);
+}
+
+/// Test the typed setters and the cooked value caching
+void FactSystemTestBase::_typedValue_test(void)
+{
+    Fact doubleFact (0, "double",   FactMetaData::valueTypeDouble);
+    Fact floatFact  (0, "float",    FactMetaData::valueTypeFloat);
+    Fact uint8Fact  (0, "uint8",    FactMetaData::valueTypeUint8);
+    Fact boolFact   (0, "bool",     FactMetaData::valueTypeBool);
+
+    doubleFact.metaData()->setRawUnits("radians");
+    doubleFact.metaData()->setDecimalPlaces(1);
+
+    // Typed setters store the same values as the QVariant path
+    doubleFact.setRawValueDouble(M_PI);
+    QCOMPARE(doubleFact.rawValue().userType(), static_cast<int>(QMetaType::Double));
+    QCOMPARE(doubleFact.rawValueDouble(), M_PI);
+    floatFact.setRawValueDouble(1.5);
+    QCOMPARE(floatFact.rawValue().userType(), static_cast<int>(QMetaType::Float));
+    QCOMPARE(floatFact.rawValue().toFloat(), 1.5f);
+    uint8Fact.setRawValueInt(200);
+    QCOMPARE(uint8Fact.rawValue().userType(), static_cast<int>(QMetaType::UInt));
+    QCOMPARE(uint8Fact.rawValue().toUInt(), 200u);
+    boolFact.setRawValueBool(true);
+    QCOMPARE(boolFact.rawValue().userType(), static_cast<int>(QMetaType::Bool));
+    QCOMPARE(boolFact.rawValue().toBool(), true);
+
+    // Wrong typed values still go through conversion
+    doubleFact.setRawValue(QVariant(static_cast<float>(0.5f)));
+    QCOMPARE(doubleFact.rawValue().userType(), static_cast<int>(QMetaType::Double));
+    uint8Fact.setRawValue(QStringLiteral("12"));
+    QCOMPARE(uint8Fact.rawValue().userType(), static_cast<int>(QMetaType::UInt));
+    QCOMPARE(uint8Fact.rawValue().toUInt(), 12u);
+
+    // Cooked value and string follow raw value and meta data changes
+    doubleFact.setRawValueDouble(M_PI);
+    QCOMPARE(doubleFact.cookedValueString(), QStringLiteral("180.0"));
+    doubleFact.setRawValueDouble(M_PI / 2.0);
+    QCOMPARE(doubleFact.cookedValueDouble(), 90.0);
+    QCOMPARE(doubleFact.cookedValueString(), QStringLiteral("90.0"));
+    doubleFact.metaData()->setDecimalPlaces(2);
+    QCOMPARE(doubleFact.cookedValueString(), QStringLiteral("90.00"));
+    doubleFact.metaData()->setRawUnits("centi-degrees");
+    QCOMPARE(doubleFact.cookedValueDouble(), (M_PI / 2.0) / 100.0);
+
+    // Signals still carry the cooked value
+    QSignalSpy valueSpy(&doubleFact, &Fact::valueChanged);
+    doubleFact.metaData()->setRawUnits("radians");
+    doubleFact.setRawValueDouble(M_PI);
+    QCOMPARE(valueSpy.count(), 1);
+    QCOMPARE(valueSpy[0][0].toDouble(), 180.0);
+    doubleFact.setRawValueDouble(M_PI);
+    QCOMPARE(valueSpy.count(), 1);
+}
+
+/// Test that groups loaded from the same json share their meta data
+void FactSystemTestBase::_sharedMetaData_test(void)
+{
+    VehicleGPSFactGroup gpsFactGroup;
+
+    Fact* vehicleHdopFact   = _vehicle->gpsFactGroup()->getFact("hdop");
+    Fact* hdopFact          = gpsFactGroup.getFact("hdop");
+    QVERIFY(vehicleHdopFact && hdopFact);
+    QVERIFY(hdopFact->metaData());
+    QCOMPARE(hdopFact->metaData(), vehicleHdopFact->metaData());
+    QCOMPARE(hdopFact->metaData()->name(), QStringLiteral("hdop"));
+
+    // The placeholder meta data allocated by the Fact constructor is released once real meta data is set
+    QCOMPARE(hdopFact->findChildren<FactMetaData*>().count(), 0);
+}
+
+/// Per update cost of a deferred telemetry value going through the QVariant path, displayed every tenth update
+void FactSystemTestBase::_setRawValue_benchmark(void)
+{
+    Fact fact(0, "roll", FactMetaData::valueTypeDouble);
+    fact.metaData()->setRawUnits("radians");
+    fact.setSendValueChangedSignals(false);
+
+    float   value = 0;
+    int     count = 0;
+    QBENCHMARK {
+        fact.setRawValue(value += 0.001f);
+        if (++count % 10 == 0) {
+            fact.cookedValueString();
+        }
+    }
+}
+
+/// Same as _setRawValue_benchmark using the typed path
+void FactSystemTestBase::_setRawValueDouble_benchmark(void)
+{
+    Fact fact(0, "roll", FactMetaData::valueTypeDouble);
+    fact.metaData()->setRawUnits("radians");
+    fact.setSendValueChangedSignals(false);
+
+    double  value = 0;
+    int     count = 0;
+    QBENCHMARK {
+        fact.setRawValueDouble(value += 0.001);
+        if (++count % 10 == 0) {
+            fact.cookedValueString();
+        }
+    }
+}
+
+/// Validates the ring buffer and range queries of the fact value history
+void FactSystemTestBase::_valueHistory_test(void)
+{
+    Fact stringFact(0, "mode", FactMetaData::valueTypeString);
+    QVERIFY(!stringFact.enableHistory(10));
+
+    // Samples wrap once the history is full
+    FactValueHistory history(100);
+    for (int i=0; i<250; i++) {
+        double value = i;
+        if (i == 200) {
+            value = 1000;
+        } else if (i == 210) {
+            value = qQNaN();
+        }
+        history.append(i * 10, value);
+    }
+    QCOMPARE(history.count(), 100);
+    QCOMPARE(history.at(0).msecs, 1500ll);
+    QCOMPARE(history.at(99).msecs, 2490ll);
+    QCOMPARE(history.lowerBound(2000), 50);
+
+    double min, max;
+    QVERIFY(history.minMax(0, 3000, min, max));
+    QCOMPARE(min, 150.0);
+    QCOMPARE(max, 1000.0);
+    QVERIFY(!history.minMax(3000, 4000, min, max));
+    QCOMPARE(history.points(2000, 2100).count(), 11);
+
+    // Both the min/max and LTTB reductions keep the spike
+    QVector<QPointF> points = history.minMaxPoints(1500, 2490, 10);
+    QVERIFY(points.count() <= 20);
+    QVERIFY(points.contains(QPointF(2000, 1000)));
+
+    points = history.lttbPoints(0, 3000, 10);
+    QCOMPARE(points.count(), 10);
+    QCOMPARE(points.first(), QPointF(1500, 150));
+    QCOMPARE(points.last(), QPointF(2490, 249));
+    QVERIFY(points.contains(QPointF(2000, 1000)));
+
+    // Times going backwards are clamped to keep the history ordered
+    history.append(5, 1);
+    QCOMPARE(history.at(99).msecs, 2490ll);
+
+    // Fact value changes are recorded
+    Fact fact(0, "roll", FactMetaData::valueTypeDouble);
+    FactValueHistory* factHistory = fact.enableHistory(10);
+    QVERIFY(factHistory);
+    QCOMPARE(fact.history(), factHistory);
+    QCOMPARE(factHistory->count(), 1);
+    fact.setRawValueDouble(1.5);
+    fact.setRawValueDouble(1.5);
+    fact.setRawValueDouble(2.5);
+    QCOMPARE(factHistory->count(), 3);
+    QCOMPARE(factHistory->at(2).value, 2.5);
+    QCOMPARE(fact.historyPoints(0, QDateTime::currentMSecsSinceEpoch() + 1000, 100).count(), 3);
+    fact.disableHistory();
+    QVERIFY(!fact.history());
+}
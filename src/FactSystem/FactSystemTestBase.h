@@ -34,6 +34,12 @@ protected:
     void _parameter_specific_component_id_test(void);
     void _qml_test(void);
     void _qmlUpdate_test(void);
+    void _telemetryFrame_test(void);
+    void _typedValue_test(void);
+    void _sharedMetaData_test(void);
+    void _valueHistory_test(void);
+    void _setRawValue_benchmark(void);
+    void _setRawValueDouble_benchmark(void);
     
     AutoPilotPlugin*                _plugin;
 };
@@ -34,6 +34,12 @@ private slots:
     void parameter_specific_component_id_test(void) { _parameter_specific_component_id_test(); }
     void qml_test(void) { _qml_test(); }
     void qmlUpdate_test(void) { _qmlUpdate_test(); }
+    void telemetryFrame_test(void) { _telemetryFrame_test(); }
+    void typedValue_test(void) { _typedValue_test(); }
+    void sharedMetaData_test(void) { _sharedMetaData_test(); }
+    void valueHistory_test(void) { _valueHistory_test(); }
+    void setRawValue_benchmark(void) { _setRawValue_benchmark(); }
+    void setRawValueDouble_benchmark(void) { _setRawValueDouble_benchmark(); }
 };
 
 #endif
@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactValueHistory.h"
+
+#include <QtMath>
+
+#include <limits>
+
+FactValueHistory::FactValueHistory(int capacity)
+{
+    _samples.resize(qMax(capacity, 1));
+}
+
+void FactValueHistory::append(qint64 msecs, double value)
+{
+    if (_count > 0) {
+        msecs = qMax(msecs, at(_count - 1).msecs);
+    }
+
+    int capacity = _samples.count();
+    if (_count < capacity) {
+        Sample_t& sample = _samples[(_head + _count) % capacity];
+        sample.msecs = msecs;
+        sample.value = value;
+        _count++;
+    } else {
+        Sample_t& sample = _samples[_head];
+        sample.msecs = msecs;
+        sample.value = value;
+        _head = (_head + 1) % capacity;
+    }
+}
+
+int FactValueHistory::lowerBound(qint64 msecs) const
+{
+    int first = 0;
+    int last = _count;
+
+    while (first < last) {
+        int middle = first + ((last - first) / 2);
+        if (at(middle).msecs < msecs) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+void FactValueHistory::_range(qint64 startMsecs, qint64 endMsecs, int& firstIndex, int& endIndex) const
+{
+    firstIndex  = lowerBound(startMsecs);
+    endIndex    = endMsecs == std::numeric_limits<qint64>::max() ? _count : lowerBound(endMsecs + 1);
+    if (endIndex < firstIndex) {
+        endIndex = firstIndex;
+    }
+}
+
+bool FactValueHistory::minMax(qint64 startMsecs, qint64 endMsecs, double& min, double& max) const
+{
+    int     firstIndex, endIndex;
+    bool    found = false;
+
+    _range(startMsecs, endMsecs, firstIndex, endIndex);
+    for (int i=firstIndex; i<endIndex; i++) {
+        double value = at(i).value;
+        if (qIsNaN(value)) {
+            continue;
+        }
+        if (!found) {
+            min = max = value;
+            found = true;
+        } else {
+            min = qMin(min, value);
+            max = qMax(max, value);
+        }
+    }
+    return found;
+}
+
+QVector<QPointF> FactValueHistory::points(qint64 startMsecs, qint64 endMsecs) const
+{
+    int                 firstIndex, endIndex;
+    QVector<QPointF>    result;
+
+    _range(startMsecs, endMsecs, firstIndex, endIndex);
+    result.reserve(endIndex - firstIndex);
+    for (int i=firstIndex; i<endIndex; i++) {
+        const Sample_t& sample = at(i);
+        result.append(QPointF(sample.msecs, sample.value));
+    }
+    return result;
+}
+
+QVector<QPointF> FactValueHistory::minMaxPoints(qint64 startMsecs, qint64 endMsecs, int bucketCount) const
+{
+    int                 firstIndex, endIndex;
+    QVector<QPointF>    result;
+
+    _range(startMsecs, endMsecs, firstIndex, endIndex);
+    if (firstIndex == endIndex || bucketCount < 1) {
+        return result;
+    }
+    result.reserve(qMin(endIndex - firstIndex, bucketCount * 2));
+
+    double  rangeMsecs      = static_cast<double>(endMsecs - startMsecs) + 1;
+    int     currentBucket   = -1;
+    int     minIndex        = -1;
+    int     maxIndex        = -1;
+
+    auto flushBucket = [this, &result, &minIndex, &maxIndex]() {
+        if (minIndex == -1) {
+            return;
+        }
+        int firstOut    = qMin(minIndex, maxIndex);
+        int secondOut   = qMax(minIndex, maxIndex);
+        result.append(QPointF(at(firstOut).msecs, at(firstOut).value));
+        if (secondOut != firstOut) {
+            result.append(QPointF(at(secondOut).msecs, at(secondOut).value));
+        }
+        minIndex = maxIndex = -1;
+    };
+
+    for (int i=firstIndex; i<endIndex; i++) {
+        const Sample_t& sample = at(i);
+        if (qIsNaN(sample.value)) {
+            continue;
+        }
+        int bucket = qMin(static_cast<int>((sample.msecs - startMsecs) * bucketCount / rangeMsecs), bucketCount - 1);
+        if (bucket != currentBucket) {
+            flushBucket();
+            currentBucket = bucket;
+        }
+        if (minIndex == -1 || sample.value < at(minIndex).value) {
+            minIndex = i;
+        }
+        if (maxIndex == -1 || sample.value > at(maxIndex).value) {
+            maxIndex = i;
+        }
+    }
+    flushBucket();
+
+    return result;
+}
+
+QVector<QPointF> FactValueHistory::lttbPoints(qint64 startMsecs, qint64 endMsecs, int maxPoints) const
+{
+    int                 firstIndex, endIndex;
+    QVector<int>        indices;
+    QVector<QPointF>    result;
+
+    _range(startMsecs, endMsecs, firstIndex, endIndex);
+    indices.reserve(endIndex - firstIndex);
+    for (int i=firstIndex; i<endIndex; i++) {
+        if (!qIsNaN(at(i).value)) {
+            indices.append(i);
+        }
+    }
+
+    int sampleCount = indices.count();
+    if (sampleCount <= maxPoints || maxPoints < 3) {
+        result.reserve(sampleCount);
+        for (int index: indices) {
+            result.append(QPointF(at(index).msecs, at(index).value));
+        }
+        return result;
+    }
+
+    // Points are compared relative to the start of the range to keep precision in the area calculation
+    auto x = [this, &indices, startMsecs](int i) -> double { return static_cast<double>(at(indices[i]).msecs - startMsecs); };
+    auto y = [this, &indices](int i) -> double { return at(indices[i]).value; };
+
+    result.reserve(maxPoints);
+    result.append(QPointF(at(indices[0]).msecs, at(indices[0]).value));
+
+    // The first and last samples have their own buckets, the rest are split evenly across maxPoints - 2 buckets
+    double  bucketSize  = static_cast<double>(sampleCount - 2) / (maxPoints - 2);
+    int     selected    = 0;
+
+    for (int bucket=0; bucket<maxPoints-2; bucket++) {
+        // Average of the next bucket is the third point of the triangle
+        int     nextStart   = static_cast<int>(qFloor((bucket + 1) * bucketSize)) + 1;
+        int     nextEnd     = qMin(static_cast<int>(qFloor((bucket + 2) * bucketSize)) + 1, sampleCount);
+        double  averageX    = 0;
+        double  averageY    = 0;
+        for (int i=nextStart; i<nextEnd; i++) {
+            averageX += x(i);
+            averageY += y(i);
+        }
+        int nextCount = nextEnd - nextStart;
+        averageX /= nextCount;
+        averageY /= nextCount;
+
+        // Pick the point of this bucket which forms the largest triangle with the previously selected point and the average
+        int     bucketStart = static_cast<int>(qFloor(bucket * bucketSize)) + 1;
+        int     bucketEnd   = static_cast<int>(qFloor((bucket + 1) * bucketSize)) + 1;
+        double  selectedX   = x(selected);
+        double  selectedY   = y(selected);
+        double  maxArea     = -1;
+        int     maxAreaIndex = bucketStart;
+        for (int i=bucketStart; i<bucketEnd; i++) {
+            double area = qAbs(((selectedX - averageX) * (y(i) - selectedY)) - ((selectedX - x(i)) * (averageY - selectedY)));
+            if (area > maxArea) {
+                maxArea = area;
+                maxAreaIndex = i;
+            }
+        }
+
+        selected = maxAreaIndex;
+        result.append(QPointF(at(indices[selected]).msecs, at(indices[selected]).value));
+    }
+
+    result.append(QPointF(at(indices[sampleCount - 1]).msecs, at(indices[sampleCount - 1]).value));
+
+    return result;
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QPointF>
+
+/// Fixed size time series of the values of a numeric Fact.
+///
+/// Storage is allocated once when the history is created. Appends overwrite the oldest sample once the history is
+/// full, so recording never allocates. Samples are kept in time order which allows range queries to binary search
+/// for their start and end.
+///
+/// Range queries return points with x as msecs since epoch and y as the raw value, matching what the charts use. Large
+/// ranges can be reduced to screen resolution either by min/max per bucket, which keeps every spike, or by Largest
+/// Triangle Three Buckets (LTTB), which keeps the visual shape with a fixed number of points.
+class FactValueHistory
+{
+public:
+    typedef struct {
+        qint64  msecs;
+        double  value;
+    } Sample_t;
+
+    FactValueHistory(int capacity);
+
+    int     capacity    (void) const { return _samples.count(); }
+    int     count       (void) const { return _count; }
+    bool    isEmpty     (void) const { return _count == 0; }
+    void    clear       (void) { _head = 0; _count = 0; }
+
+    /// Adds a sample, overwriting the oldest sample when full. A time earlier than the last sample (clock adjustment) is
+    /// stored as the time of the last sample to keep the history ordered.
+    void append(qint64 msecs, double value);
+
+    /// @return Sample at index, 0 being the oldest
+    const Sample_t& at(int index) const { return _samples[(_head + index) % _samples.count()]; }
+
+    /// @return Index of the first sample at or after msecs, count() if there is none
+    int lowerBound(qint64 msecs) const;
+
+    /// Finds the minimum and maximum value within [startMsecs, endMsecs]. NaN values are ignored.
+    /// @return false: no values within range
+    bool minMax(qint64 startMsecs, qint64 endMsecs, double& min, double& max) const;
+
+    /// @return All samples within [startMsecs, endMsecs]
+    QVector<QPointF> points(qint64 startMsecs, qint64 endMsecs) const;
+
+    /// Splits [startMsecs, endMsecs] into bucketCount equal time buckets and returns the minimum and maximum sample of
+    /// each bucket in time order. At most 2 * bucketCount points are returned.
+    QVector<QPointF> minMaxPoints(qint64 startMsecs, qint64 endMsecs, int bucketCount) const;
+
+    /// Downsamples the samples within [startMsecs, endMsecs] to at most maxPoints using Largest Triangle Three Buckets.
+    /// The first and last samples are always kept. NaN values are skipped.
+    QVector<QPointF> lttbPoints(qint64 startMsecs, qint64 endMsecs, int maxPoints) const;
+
+private:
+    void _range(qint64 startMsecs, qint64 endMsecs, int& firstIndex, int& endIndex) const;
+
+    QVector<Sample_t>   _samples;
+    int                 _head   = 0;    ///< Index within _samples of the oldest sample
+    int                 _count  = 0;
+};
@@ -0,0 +1,335 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCache.h"
+#include "QGCLoggingCategory.h"
+#include "QGC.h"
+
+#include <QSaveFile>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+const char ParameterCache::_magic[4] = { 'Q', 'P', 'C', '3' };
+
+ParameterCache::ParameterCache(const QString& fileName)
+    : _file(fileName)
+{
+    static_assert(sizeof(FileHeader_t) == 16, "ParameterCache header packing");
+    static_assert(sizeof(FileEntry_t) == 24, "ParameterCache entry packing");
+}
+
+ParameterCache::~ParameterCache()
+{
+    _unmap();
+}
+
+void ParameterCache::_unmap(void)
+{
+    if (_map) {
+        _file.unmap(_map);
+        _map = nullptr;
+    }
+    _mappedEntryIndex.clear();
+    _file.close();
+}
+
+bool ParameterCache::load(void)
+{
+    _unmap();
+    _entries.clear();
+
+    if (!_file.exists() || !_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    qint64 fileSize = _file.size();
+    if (fileSize < static_cast<qint64>(sizeof(FileHeader_t))) {
+        qCWarning(ParameterManagerLog) << "Parameter cache too short" << _file.fileName();
+        _file.close();
+        return false;
+    }
+
+    _map = _file.map(0, fileSize);
+    if (!_map) {
+        qCWarning(ParameterManagerLog) << "Unable to map parameter cache" << _file.fileName() << _file.errorString();
+        _file.close();
+        return false;
+    }
+
+    const FileHeader_t* header = reinterpret_cast<const FileHeader_t*>(_map);
+    qint64 entriesEnd = static_cast<qint64>(sizeof(FileHeader_t)) + static_cast<qint64>(header->count) * static_cast<qint64>(sizeof(FileEntry_t));
+    if (memcmp(header->magic, _magic, sizeof(_magic)) || entriesEnd > header->stringTableOffset || header->stringTableOffset > fileSize) {
+        qCWarning(ParameterManagerLog) << "Parameter cache corrupt" << _file.fileName();
+        _unmap();
+        return false;
+    }
+
+    const FileEntry_t* fileEntries = reinterpret_cast<const FileEntry_t*>(_map + sizeof(FileHeader_t));
+    const char*        strings     = reinterpret_cast<const char*>(_map + header->stringTableOffset);
+    qint64             stringsSize = fileSize - header->stringTableOffset;
+
+    for (uint32_t i=0; i<header->count; i++) {
+        const FileEntry_t& fileEntry = fileEntries[i];
+        if (static_cast<qint64>(fileEntry.nameOffset) + fileEntry.nameLength > stringsSize) {
+            qCWarning(ParameterManagerLog) << "Parameter cache corrupt name" << _file.fileName();
+            _unmap();
+            _entries.clear();
+            return false;
+        }
+
+        QString name = QString::fromLatin1(strings + fileEntry.nameOffset, fileEntry.nameLength);
+
+        Entry_t entry;
+        entry.index = static_cast<int>(fileEntry.index);
+        entry.type  = static_cast<FactMetaData::ValueType_t>(fileEntry.type);
+        entry.value = _rawToVariant(entry.type, fileEntry.value);
+        entry.hash  = fileEntry.hash;
+        entry.flags = fileEntry.flags;
+
+        _entries[name]          = entry;
+        _mappedEntryIndex[name] = static_cast<int>(i);
+    }
+
+    return true;
+}
+
+bool ParameterCache::save(void)
+{
+    _unmap();
+
+    // Sort by index so the file mirrors the vehicle's parameter order
+    QList<QString> sortedNames = _entries.keys();
+    std::stable_sort(sortedNames.begin(), sortedNames.end(), [this](const QString& a, const QString& b) {
+        return _entries[a].index < _entries[b].index;
+    });
+
+    QByteArray          stringTable;
+    QVector<FileEntry_t> fileEntries;
+    fileEntries.reserve(sortedNames.count());
+
+    for (const QString& name: sortedNames) {
+        const Entry_t&  entry       = _entries[name];
+        QByteArray      latinName   = name.toLatin1();
+        FileEntry_t     fileEntry;
+
+        memset(&fileEntry, 0, sizeof(fileEntry));
+        fileEntry.index         = static_cast<uint32_t>(entry.index);
+        fileEntry.nameOffset    = static_cast<uint32_t>(stringTable.size());
+        fileEntry.nameLength    = static_cast<uint16_t>(latinName.size());
+        fileEntry.type          = static_cast<uint8_t>(entry.type);
+        fileEntry.flags         = entry.flags;
+        fileEntry.hash          = entry.hash;
+        fileEntry.value         = _variantToRaw(entry.type, entry.value);
+        fileEntries.append(fileEntry);
+        stringTable.append(latinName);
+    }
+
+    FileHeader_t header;
+    memcpy(header.magic, _magic, sizeof(_magic));
+    header.count                = static_cast<uint32_t>(fileEntries.count());
+    header.stringTableOffset    = static_cast<uint32_t>(sizeof(FileHeader_t) + (fileEntries.count() * sizeof(FileEntry_t)));
+    header.reserved             = 0;
+
+    QSaveFile saveFile(_file.fileName());
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        qCWarning(ParameterManagerLog) << "Unable to write parameter cache" << _file.fileName() << saveFile.errorString();
+        return false;
+    }
+    saveFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    saveFile.write(reinterpret_cast<const char*>(fileEntries.constData()), fileEntries.count() * static_cast<int>(sizeof(FileEntry_t)));
+    saveFile.write(stringTable);
+    if (!saveFile.commit()) {
+        qCWarning(ParameterManagerLog) << "Unable to write parameter cache" << _file.fileName() << saveFile.errorString();
+        return false;
+    }
+
+    // Re-map the new file so further single entry updates can be patched in place
+    return load();
+}
+
+void ParameterCache::remove(const QString& name)
+{
+    // Removal changes the file layout, it only reaches disk on the next save
+    _entries.remove(name);
+    _mappedEntryIndex.remove(name);
+}
+
+QStringList ParameterCache::namesWithFlags(uint8_t flagMask) const
+{
+    QStringList names;
+
+    for (auto it = _entries.constBegin(); it != _entries.constEnd(); it++) {
+        if (it.value().flags & flagMask) {
+            names.append(it.key());
+        }
+    }
+
+    return names;
+}
+
+ParameterCache::FileEntry_t* ParameterCache::_mappedEntry(const QString& name)
+{
+    if (!_map || !_mappedEntryIndex.contains(name)) {
+        return nullptr;
+    }
+    return reinterpret_cast<FileEntry_t*>(_map + sizeof(FileHeader_t)) + _mappedEntryIndex[name];
+}
+
+bool ParameterCache::setValue(const QString& name, int index, FactMetaData::ValueType_t type, const QVariant& value)
+{
+    uint32_t    hash    = entryHash(name, type, value);
+    bool        changed = true;
+
+    if (_entries.contains(name)) {
+        Entry_t& entry = _entries[name];
+        changed     = entry.hash != hash || entry.type != type;
+        entry.type  = type;
+        entry.value = value;
+        entry.hash  = hash;
+        if (index >= 0) {
+            entry.index = index;
+        }
+
+        FileEntry_t* fileEntry = _mappedEntry(name);
+        if (fileEntry && fileEntry->type == static_cast<uint8_t>(type)) {
+            fileEntry->value = _variantToRaw(type, value);
+            fileEntry->hash  = hash;
+        }
+    } else {
+        Entry_t entry;
+        entry.index = index;
+        entry.type  = type;
+        entry.value = value;
+        entry.hash  = hash;
+        entry.flags = 0;
+        _entries[name] = entry;
+    }
+
+    return changed;
+}
+
+void ParameterCache::setFlags(const QString& name, uint8_t flags, bool set)
+{
+    if (!_entries.contains(name)) {
+        return;
+    }
+
+    Entry_t& entry = _entries[name];
+    if (set) {
+        entry.flags |= flags;
+    } else {
+        entry.flags &= ~flags;
+    }
+
+    FileEntry_t* fileEntry = _mappedEntry(name);
+    if (fileEntry) {
+        fileEntry->flags = entry.flags;
+    }
+}
+
+uint32_t ParameterCache::paramSetCrc(std::function<bool(const QString&)> isVolatile) const
+{
+    uint32_t crc32Value = 0;
+
+    // Crc is calculated over name sorted parameters, which is the order QMap iterates in
+    for (auto it = _entries.constBegin(); it != _entries.constEnd(); it++) {
+        const QString& name = it.key();
+        if (isVolatile(name)) {
+            continue;
+        }
+        const Entry_t&  entry   = it.value();
+        uint64_t        raw     = _variantToRaw(entry.type, entry.value);
+        QByteArray      latin   = name.toLatin1();
+        crc32Value = QGC::crc32(reinterpret_cast<const uint8_t*>(latin.constData()), static_cast<unsigned>(latin.length()), crc32Value);
+        crc32Value = QGC::crc32(reinterpret_cast<const uint8_t*>(&raw), static_cast<unsigned>(FactMetaData::typeToSize(entry.type)), crc32Value);
+    }
+
+    return crc32Value;
+}
+
+uint32_t ParameterCache::entryHash(const QString& name, FactMetaData::ValueType_t type, const QVariant& value)
+{
+    uint64_t    raw     = _variantToRaw(type, value);
+    QByteArray  latin   = name.toLatin1();
+    uint32_t    hash    = QGC::crc32(reinterpret_cast<const uint8_t*>(latin.constData()), static_cast<unsigned>(latin.length()), 0);
+    return QGC::crc32(reinterpret_cast<const uint8_t*>(&raw), static_cast<unsigned>(FactMetaData::typeToSize(type)), hash);
+}
+
+/// Packs the value into the low bytes of a little endian 64 bit word, which matches the in memory layout used for the crc
+uint64_t ParameterCache::_variantToRaw(FactMetaData::ValueType_t type, const QVariant& value)
+{
+    uint64_t raw = 0;
+
+    switch (type) {
+    case FactMetaData::valueTypeFloat:
+    {
+        float f = value.toFloat();
+        memcpy(&raw, &f, sizeof(f));
+        break;
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double d = value.toDouble();
+        memcpy(&raw, &d, sizeof(d));
+        break;
+    }
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+    case FactMetaData::valueTypeUint64:
+        raw = value.toULongLong();
+        break;
+    default:
+        raw = static_cast<uint64_t>(value.toLongLong());
+        break;
+    }
+
+    // Clear anything above the size of the type so sign extension doesn't leak into the crc
+    size_t size = FactMetaData::typeToSize(type);
+    if (size < sizeof(raw)) {
+        raw &= (static_cast<uint64_t>(1) << (size * 8)) - 1;
+    }
+
+    return raw;
+}
+
+QVariant ParameterCache::_rawToVariant(FactMetaData::ValueType_t type, uint64_t raw)
+{
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+        return QVariant(static_cast<uint8_t>(raw));
+    case FactMetaData::valueTypeInt8:
+        return QVariant(static_cast<int8_t>(raw));
+    case FactMetaData::valueTypeUint16:
+        return QVariant(static_cast<uint16_t>(raw));
+    case FactMetaData::valueTypeInt16:
+        return QVariant(static_cast<int16_t>(raw));
+    case FactMetaData::valueTypeUint32:
+        return QVariant(static_cast<uint32_t>(raw));
+    case FactMetaData::valueTypeUint64:
+        return QVariant(static_cast<qulonglong>(raw));
+    case FactMetaData::valueTypeInt64:
+        return QVariant(static_cast<qlonglong>(raw));
+    case FactMetaData::valueTypeFloat:
+    {
+        float f;
+        memcpy(&f, &raw, sizeof(f));
+        return QVariant(f);
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double d;
+        memcpy(&d, &raw, sizeof(d));
+        return QVariant(d);
+    }
+    default:
+        return QVariant(static_cast<int32_t>(raw));
+    }
+}
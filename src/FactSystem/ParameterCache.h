@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QMap>
+#include <QVariant>
+#include <QStringList>
+#include <functional>
+
+#include "FactMetaData.h"
+
+/// On disk parameter cache for a single vehicle component.
+///
+/// File layout (little endian):
+///     Header:         char magic[4], uint32 entry count, uint32 string table offset, uint32 reserved
+///     Entries:        fixed size Entry_t records sorted by parameter index
+///     String table:   parameter names (Latin1, not terminated)
+///
+/// Entries are fixed size so a single value or flag change can be patched in place in the memory mapped file
+/// without rewriting the whole cache.
+class ParameterCache
+{
+public:
+    ParameterCache(const QString& fileName);
+    ~ParameterCache();
+
+    enum EntryFlags {
+        FlagWritePending        = 0x01,     ///< Value was sent to the vehicle but the write was never acknowledged
+        FlagChangedOnVehicle    = 0x02,     ///< Value differed from the cache during the last full load
+    };
+
+    typedef struct {
+        int                         index;
+        FactMetaData::ValueType_t   type;
+        QVariant                    value;
+        uint32_t                    hash;   ///< Hash of name and value, used to detect changed values without a QVariant compare
+        uint8_t                     flags;
+    } Entry_t;
+
+    /// Loads the cache from disk and maps it for in place updates
+    /// @return false: no cache or cache is corrupt
+    bool load(void);
+
+    /// Rewrites the full cache file from the in memory entries
+    bool save(void);
+
+    bool            isEmpty     (void) const { return _entries.isEmpty(); }
+    int             count       (void) const { return _entries.count(); }
+    bool            contains    (const QString& name) const { return _entries.contains(name); }
+    const Entry_t   entry       (const QString& name) const { return _entries.value(name); }
+    QStringList     names       (void) const { return _entries.keys(); }
+
+    /// @return Names of all entries which have any of the specified flags set
+    QStringList namesWithFlags(uint8_t flagMask) const;
+
+    /// Updates the value of an entry. Existing entries of the same type are patched in place on disk.
+    /// @return true: value differs from the previously cached value
+    bool setValue(const QString& name, int index, FactMetaData::ValueType_t type, const QVariant& value);
+
+    void remove(const QString& name);
+
+    /// Sets or clears flags on an existing entry, patching the file in place
+    void setFlags(const QString& name, uint8_t flags, bool set);
+
+    /// Computes the PX4 style crc of the full parameter set, skipping the parameters for which isVolatile returns true
+    uint32_t paramSetCrc(std::function<bool(const QString&)> isVolatile) const;
+
+    /// @return Hash of a single parameter name and value
+    static uint32_t entryHash(const QString& name, FactMetaData::ValueType_t type, const QVariant& value);
+
+private:
+    typedef struct {
+        char        magic[4];
+        uint32_t    count;
+        uint32_t    stringTableOffset;
+        uint32_t    reserved;
+    } FileHeader_t;
+
+    typedef struct {
+        uint32_t    index;
+        uint32_t    nameOffset;
+        uint16_t    nameLength;
+        uint8_t     type;
+        uint8_t     flags;
+        uint32_t    hash;
+        uint64_t    value;
+    } FileEntry_t;
+
+    void            _unmap          (void);
+    FileEntry_t*    _mappedEntry    (const QString& name);
+
+    static uint64_t _variantToRaw   (FactMetaData::ValueType_t type, const QVariant& value);
+    static QVariant _rawToVariant   (FactMetaData::ValueType_t type, uint64_t raw);
+
+    QFile                       _file;
+    uchar*                      _map = nullptr;
+    QMap<QString, Entry_t>      _entries;
+    QMap<QString, int>          _mappedEntryIndex;  ///< Name to record number in the mapped file
+
+    static const char           _magic[4];
+};
@@ -17,12 +17,14 @@
 #include "JsonHelper.h"
 #include "ComponentInformationManager.h"
 #include "CompInfoParam.h"
+#include "FTPManager.h"
 
 #include <QEasingCurve>
 #include <QFile>
 #include <QDebug>
 #include <QVariantAnimation>
 #include <QJsonArray>
+#include <QStandardPaths>
 
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose1Log,           "ParameterManagerVerbose1Log")
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose2Log,           "ParameterManagerVerbose2Log")
@@ -102,13 +104,26 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     connect(&_initialRequestTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_initialRequestTimeout);
 
     _waitingParamTimeoutTimer.setSingleShot(true);
-    _waitingParamTimeoutTimer.setInterval(3000);
+    _waitingParamTimeoutTimer.setInterval(ParameterRequestScheduler::initialRetryTimeoutMsecs);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _sendQueuedRequestsTimer.setSingleShot(true);
+    connect(&_sendQueuedRequestsTimer, &QTimer::timeout, this, &ParameterManager::_sendQueuedRequests);
+
+    _requestClock.start();
+    _primaryLinkChanged();
+    connect(_vehicle->vehicleLinkManager(), &VehicleLinkManager::primaryLinkChanged, this, &ParameterManager::_primaryLinkChanged);
+
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 }
 
+ParameterManager::~ParameterManager()
+{
+    qDeleteAll(_paramCacheMap);
+    delete _ftpDownloadDir;
+}
+
 void ParameterManager::_updateProgressBar(void)
 {
     int waitingReadParamIndexCount = 0;
@@ -142,6 +157,7 @@ void ParameterManager::_updateProgressBar(void)
             _writeParamProgressActive = false;
             _waitingWriteParamBatchCount = 0;
             _setLoadProgress(0.0);
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Writes complete" << _requestStatisticsReport();
             emit pendingWritesChanged(false);
             return;
         }
@@ -167,9 +183,28 @@ void ParameterManager::_updateProgressBar(void)
 }
 
 
+/// Sends a parameter protocol message on the primary link and counts its bytes for the request statistics
+void ParameterManager::_sendMessage(mavlink_message_t& message)
+{
+    _vehicle->sendMessageOnLinkThreadSafe(_vehicle->vehicleLinkManager()->primaryLink(), message);
+    _requestScheduler.bytesSent(mavlink_msg_get_send_buffer_length(&message), _requestClock.elapsed());
+}
+
+QList<ParameterRequestScheduler::Statistics_t> ParameterManager::requestStatistics(void)
+{
+    return _requestScheduler.allStatistics(_requestClock.elapsed());
+}
+
+QString ParameterManager::_requestStatisticsReport(void)
+{
+    return ParameterRequestScheduler::report(_requestScheduler.statistics(_requestClock.elapsed()));
+}
+
 void ParameterManager::mavlinkMessageReceived(mavlink_message_t message)
 {
     if (message.msgid == MAVLINK_MSG_ID_PARAM_VALUE) {
+        _requestScheduler.bytesReceived(mavlink_msg_get_send_buffer_length(&message), _requestClock.elapsed());
+
         mavlink_param_value_t param_value;
         mavlink_msg_param_value_decode(&message, &param_value);
 
@@ -282,6 +317,38 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     _initialRequestTimeoutTimer.stop();
     _waitingParamTimeoutTimer.stop();
 
+    // Free up the request window before any re-requests below are sent. While the initial list streams in nothing is
+    // outstanding, so no request keys are built for it.
+    if (_requestScheduler.outstanding()) {
+        qint64 responseMsecs = _requestClock.elapsed();
+        if (!_requestScheduler.responseReceived(_requestKey(componentId, parameterName, -1), responseMsecs)) {
+            _requestScheduler.responseReceived(_requestKey(componentId, QString(), parameterIndex), responseMsecs);
+        }
+    }
+
+    // A read which is still queued is answered by this value. A write which is still queued was never sent, so this
+    // value is not its response.
+    bool writeSent = true;
+    if (!_queuedRequests.isEmpty()) {
+        for (int i=_queuedRequests.count()-1; i>=0; i--) {
+            const QueuedRequest_t& request = _queuedRequests[i];
+            if (request.componentId != componentId) {
+                continue;
+            }
+            if (request.write) {
+                if (request.name == parameterName) {
+                    if (request.resend) {
+                        _queuedRequests.removeAt(i);
+                    } else {
+                        writeSent = false;
+                    }
+                }
+            } else if (request.name.isEmpty() ? request.index == parameterIndex : request.name == parameterName) {
+                _queuedRequests.removeAt(i);
+            }
+        }
+    }
+
     // Update our total parameter counts
     if (!_paramCountMap.contains(componentId)) {
         _paramCountMap[componentId] = parameterCount;
@@ -316,7 +383,9 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
-    _waitingWriteParamNameMap[componentId].remove(parameterName);
+    if (writeSent) {
+        _waitingWriteParamNameMap[componentId].remove(parameterName);
+    }
     if (_waitingReadParamIndexMap[componentId].count()) {
         qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
     }
@@ -358,13 +427,13 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     int totalWaitingParamCount = readWaitingParamCount + waitingWriteParamNameCount;
     if (totalWaitingParamCount) {
         // More params to wait for, restart timer
-        _waitingParamTimeoutTimer.start();
+        _restartWaitingParamTimeoutTimer();
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
     } else {
         if (!_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
             // Still waiting for parameters from default component
             qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer (still waiting for default component params)";
-            _waitingParamTimeoutTimer.start();
+            _waitingParamTimeoutTimer.start(ParameterRequestScheduler::initialRetryTimeoutMsecs);
         } else {
             qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(-1) << "Not restarting _waitingParamTimeoutTimer (all requests satisfied)";
         }
@@ -395,7 +464,8 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     // Update param cache. The param cache is only used on PX4 Firmware since ArduPilot and Solo have volatile params
     // which invalidate the cache. The Solo also streams param updates in flight for things like gimbal values
     // which in turn causes a perf problem with all the param cache updates.
-    if (!_logReplay && _vehicle->px4Firmware()) {
+    if (!_logReplay && _vehicle->px4Firmware() && !_loadingFromCache) {
+        _updateLocalParamCache(componentId, parameterName, parameterIndex, fact->type(), parameterValue);
         if (_prevWaitingReadParamIndexCount + _prevWaitingReadParamNameCount != 0 && readWaitingParamCount == 0) {
             // All reads just finished, update the cache
             _writeLocalParamCache(_vehicle->id(), componentId);
@@ -409,9 +479,15 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     _checkInitialLoadComplete();
 
     qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_parameterUpdate complete";
+
+    if (!_loadingFromCache) {
+        _checkDeltaRefreshComplete(componentId, parameterName);
+    }
+
+    _sendQueuedRequests();
 }
 
-/// Writes the parameter update to mavlink, sets up for write wait
+/// Queues the parameter update to be written to mavlink, sets up for write wait
 void ParameterManager::_factRawValueUpdateWorker(int componentId, const QString& name, FactMetaData::ValueType_t valueType, const QVariant& rawValue)
 {
     if (_waitingWriteParamNameMap.contains(componentId)) {
@@ -422,14 +498,103 @@ void ParameterManager::_factRawValueUpdateWorker(int componentId, const QString&
         }
         _waitingWriteParamNameMap[componentId][name] = 0; // Add new entry and set retry count
         _updateProgressBar();
-        _waitingParamTimeoutTimer.start();
+        _restartWaitingParamTimeoutTimer();
         _saveRequired = true;
+        if (!_logReplay && _vehicle->px4Firmware()) {
+            // If the write is never acked the vehicle value is unknown, so this param is a candidate for delta refresh next connect
+            _paramCache(componentId)->setFlags(name, ParameterCache::FlagWritePending, true);
+        }
     } else {
         qWarning() << "Internal error ParameterManager::_factValueUpdateWorker: component id not found" << componentId;
     }
 
-    _sendParamSetToVehicle(componentId, name, valueType, rawValue);
+    // Writes go out through the request window so loading a parameter file doesn't flood the link. A newer value for a
+    // write which is still queued replaces the older one.
+    int queuedIndex = _queuedRequestIndex(componentId, name, -1, true /* write */);
+    if (queuedIndex != -1) {
+        QueuedRequest_t& queuedWrite = _queuedRequests[queuedIndex];
+        queuedWrite.valueType   = valueType;
+        queuedWrite.value       = rawValue;
+        queuedWrite.resend      = false;
+    } else {
+        _queuedRequests.append({ componentId, name, -1, true /* write */, false /* resend */, valueType, rawValue });
+    }
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Update parameter (_waitingParamTimeoutTimer started) - compId:name:rawValue" << componentId << name << rawValue;
+
+    _sendQueuedRequests();
+}
+
+/// Queues a PARAM_REQUEST_READ to go out through the request window. Reads which are already queued are not queued twice.
+void ParameterManager::_queueParamRead(int componentId, const QString& paramName, int paramIndex)
+{
+    if (_queuedRequestIndex(componentId, paramName, paramIndex, false /* write */) == -1) {
+        _queuedRequests.append({ componentId, paramName, paramIndex, false /* write */, false /* resend */, FactMetaData::valueTypeInt32, QVariant() });
+    }
+}
+
+/// @return Index of the queued request in _queuedRequests, -1 if not queued
+int ParameterManager::_queuedRequestIndex(int componentId, const QString& paramName, int paramIndex, bool write) const
+{
+    for (int i=0; i<_queuedRequests.count(); i++) {
+        const QueuedRequest_t& request = _queuedRequests[i];
+        if (request.componentId == componentId && request.write == write &&
+                (paramName.isEmpty() ? request.name.isEmpty() && request.index == paramIndex : request.name == paramName)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// Sends queued reads and writes as fast as the request window and pacing allow
+void ParameterManager::_sendQueuedRequests(void)
+{
+    _sendQueuedRequestsTimer.stop();
+
+    while (!_queuedRequests.isEmpty()) {
+        int sendDelay = _requestScheduler.sendDelayMsecs(_requestClock.elapsed());
+        if (sendDelay > 0) {
+            _sendQueuedRequestsTimer.start(sendDelay);
+            return;
+        } else if (sendDelay < 0) {
+            // Window is full, the next response or timeout restarts the queue
+            return;
+        }
+
+        QueuedRequest_t request = _queuedRequests.takeFirst();
+        if (request.write) {
+            _sendParamSetToVehicle(request.componentId, request.name, request.valueType, request.value);
+        } else {
+            _readParameterRaw(request.componentId, request.name, request.index);
+        }
+    }
+}
+
+void ParameterManager::_restartWaitingParamTimeoutTimer(void)
+{
+    // While the vehicle streams the initial list nothing is outstanding, so gaps in the stream use the fixed timeout.
+    // Once requests are outstanding the timeout follows the measured round trip time.
+    if (_requestScheduler.outstanding() || _indexBatchQueueActive) {
+        _waitingParamTimeoutTimer.start(_requestScheduler.retryTimeoutMsecs());
+    } else {
+        _waitingParamTimeoutTimer.start(ParameterRequestScheduler::initialRetryTimeoutMsecs);
+    }
+}
+
+void ParameterManager::_primaryLinkChanged(void)
+{
+    LinkInterface* primaryLink = _vehicle->vehicleLinkManager()->primaryLink();
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Request statistics" << _requestStatisticsReport();
+    _requestScheduler.setLink(primaryLink ? primaryLink->linkConfiguration()->name() : QString());
+}
+
+QString ParameterManager::_requestKey(int componentId, const QString& paramName, int paramIndex)
+{
+    if (paramName.isEmpty()) {
+        return QStringLiteral("%1#%2").arg(componentId).arg(paramIndex);
+    } else {
+        return QStringLiteral("%1:%2").arg(componentId).arg(paramName);
+    }
 }
 
 void ParameterManager::_factRawValueUpdated(const QVariant& rawValue)
@@ -459,6 +624,16 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
         emit missingParametersChanged(_missingParameters);
     }
 
+    if (!_logReplay && _startFTPParameterDownload(componentId)) {
+        return;
+    }
+
+    _requestParameterList(componentId);
+}
+
+/// Requests the full parameter set using PARAM_REQUEST_LIST
+void ParameterManager::_requestParameterList(uint8_t componentId)
+{
     if (!_initialLoadComplete) {
         _initialRequestTimeoutTimer.start();
     }
@@ -483,12 +658,255 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
                                              &msg,
                                              _vehicle->id(),
                                              componentId);
-    _vehicle->sendMessageOnLinkThreadSafe(_vehicle->vehicleLinkManager()->primaryLink(), msg);
+    _sendMessage(msg);
 
     QString what = (componentId == MAV_COMP_ID_ALL) ? "MAV_COMP_ID_ALL" : QString::number(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Request to refresh all parameters for component ID:" << what;
 }
 
+/// Starts a bulk download of the parameter file over MAVLink FTP if the firmware supports it
+/// @return true: download started, false: use PARAM_REQUEST_LIST instead
+bool ParameterManager::_startFTPParameterDownload(uint8_t componentId)
+{
+    if (_ftpDownloadActive) {
+        return true;
+    }
+    if (_ftpDownloadFailed || (componentId != MAV_COMP_ID_ALL && componentId != _vehicle->defaultComponentId())) {
+        return false;
+    }
+
+    QString paramFilePath = _vehicle->firmwarePlugin()->parameterFileFTPPath(_vehicle);
+    if (paramFilePath.isEmpty()) {
+        return false;
+    }
+
+    // Each download gets its own directory, so vehicles downloading the same file name at the same time don't collide
+    _ftpDownloadDir = new QTemporaryDir(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).filePath(QStringLiteral("QGCParams-XXXXXX")));
+    if (!_ftpDownloadDir->isValid()) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "FTP parameter download directory could not be created, falling back to PARAM_REQUEST_LIST";
+        _ftpDownloadDone();
+        return false;
+    }
+
+    // The vehicle's FTP manager is shared, only the completion of this file in this directory belongs to the download
+    _ftpDownloadFilePath = QDir(_ftpDownloadDir->path()).absoluteFilePath(QFileInfo(paramFilePath).fileName());
+
+    FTPManager* ftpManager = _vehicle->ftpManager();
+    connect(ftpManager, &FTPManager::downloadComplete,  this, &ParameterManager::_ftpDownloadComplete);
+    connect(ftpManager, &FTPManager::commandProgress,   this, &ParameterManager::_ftpDownloadProgress);
+    if (!ftpManager->download(paramFilePath, _ftpDownloadDir->path())) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "FTP parameter download could not be started, falling back to PARAM_REQUEST_LIST";
+        _ftpDownloadDone();
+        return false;
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Requesting parameter file over FTP" << paramFilePath;
+    _ftpDownloadActive = true;
+
+    // A stalled download falls back to PARAM_REQUEST_LIST through the initial request timeout
+    if (!_initialLoadComplete) {
+        _initialRequestTimeoutTimer.start();
+    }
+    return true;
+}
+
+/// Stops listening to the FTP download and removes its directory. A download which is still running is cancelled first,
+/// so the FTP manager is free for other downloads and no longer writes to the directory.
+void ParameterManager::_ftpDownloadDone(void)
+{
+    FTPManager* ftpManager = _vehicle->ftpManager();
+    disconnect(ftpManager, &FTPManager::downloadComplete,  this, &ParameterManager::_ftpDownloadComplete);
+    disconnect(ftpManager, &FTPManager::commandProgress,   this, &ParameterManager::_ftpDownloadProgress);
+    if (_ftpDownloadActive) {
+        ftpManager->cancelDownload();
+        _ftpDownloadActive = false;
+    }
+    _ftpDownloadFilePath.clear();
+    delete _ftpDownloadDir;
+    _ftpDownloadDir = nullptr;
+}
+
+void ParameterManager::_ftpDownloadProgress(int value)
+{
+    // Still making progress, so not stalled
+    if (_initialRequestTimeoutTimer.isActive()) {
+        _initialRequestTimeoutTimer.start();
+    }
+    _setLoadProgress(static_cast<double>(value) / 100.0);
+}
+
+void ParameterManager::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
+{
+    if (!_ftpDownloadActive || fileName != _ftpDownloadFilePath) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Ignoring FTP download which is not the parameter file" << fileName;
+        return;
+    }
+
+    // The transfer has ended, there is nothing left to cancel
+    _ftpDownloadActive = false;
+    _initialRequestTimeoutTimer.stop();
+
+    QList<ParamFileEntry_t> params;
+    int                     totalCount = 0;
+    QString                 decodeError = errorMsg;
+
+    if (decodeError.isEmpty()) {
+        QFile paramFile(fileName);
+        if (paramFile.open(QIODevice::ReadOnly)) {
+            decodeParameterFile(paramFile.readAll(), params, totalCount, decodeError);
+        } else {
+            decodeError = paramFile.errorString();
+        }
+        paramFile.close();
+    }
+    _ftpDownloadDone();
+
+    if (!decodeError.isEmpty() || params.isEmpty()) {
+        qCWarning(ParameterManagerLog) << _logVehiclePrefix(-1) << "FTP parameter download failed, falling back to PARAM_REQUEST_LIST:" << decodeError;
+        _ftpDownloadFailed = true;
+        _setLoadProgress(0.0);
+        _requestParameterList(MAV_COMP_ID_ALL);
+        return;
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Parameter file decoded - count:total" << params.count() << totalCount;
+
+    // Any indices missing from the file are left in the wait list and picked up by the regular index based retries
+    int componentId = _vehicle->defaultComponentId();
+    for (int index=0; index<params.count(); index++) {
+        const ParamFileEntry_t& param = params[index];
+        _handleParamValue(componentId, param.name, totalCount, index, param.mavType, param.value);
+    }
+    _setLoadProgress(0.0);
+}
+
+bool ParameterManager::decodeParameterFile(const QByteArray& bytes, QList<ParamFileEntry_t>& params, int& totalCount, QString& errorMsg)
+{
+    // File layout:
+    //  Header: uint16 magic, uint16 param count in file, uint16 total param count on vehicle
+    //  Entries, in index order:
+    //      uint8 type (low nibble) / flags (high nibble)
+    //      uint8 common prefix length with previous name (low nibble) / name length - 1 (high nibble)
+    //      name suffix
+    //      value, followed by the default value if the file has defaults and flags bit 0 is set
+    //  Zero bytes between entries are padding.
+    const uint16_t magic            = 0x671b;
+    const uint16_t magicDefaults    = 0x671c;
+    const int      headerSize       = 6;
+
+    params.clear();
+    totalCount = 0;
+
+    if (bytes.size() < headerSize) {
+        errorMsg = tr("Parameter file too short");
+        return false;
+    }
+
+    const uint8_t* data     = reinterpret_cast<const uint8_t*>(bytes.constData());
+    const int      cBytes   = bytes.size();
+    uint16_t       fileMagic    = data[0] | (data[1] << 8);
+    uint16_t       fileCount    = data[2] | (data[3] << 8);
+    totalCount                  = data[4] | (data[5] << 8);
+
+    if (fileMagic != magic && fileMagic != magicDefaults) {
+        errorMsg = tr("Parameter file has unknown format: 0x%1").arg(fileMagic, 4, 16, QChar('0'));
+        return false;
+    }
+    bool withDefaults = fileMagic == magicDefaults;
+
+    params.reserve(fileCount);
+
+    QByteArray  lastName;
+    int         offset = headerSize;
+    while (true) {
+        while (offset < cBytes && data[offset] == 0) {
+            offset++;
+        }
+        if (offset >= cBytes) {
+            break;
+        }
+        if (offset + 2 > cBytes) {
+            errorMsg = tr("Parameter file truncated");
+            return false;
+        }
+
+        uint8_t ptype       = data[offset] & 0x0F;
+        uint8_t flags       = (data[offset] >> 4) & 0x0F;
+        int     commonLen   = data[offset + 1] & 0x0F;
+        int     nameLen     = ((data[offset + 1] >> 4) & 0x0F) + 1;
+        offset += 2;
+
+        ParamFileEntry_t    param;
+        int                 valueSize;
+        switch (ptype) {
+        case 1:
+            param.mavType = MAV_PARAM_TYPE_INT8;
+            valueSize = 1;
+            break;
+        case 2:
+            param.mavType = MAV_PARAM_TYPE_INT16;
+            valueSize = 2;
+            break;
+        case 3:
+            param.mavType = MAV_PARAM_TYPE_INT32;
+            valueSize = 4;
+            break;
+        case 4:
+            param.mavType = MAV_PARAM_TYPE_REAL32;
+            valueSize = 4;
+            break;
+        default:
+            errorMsg = tr("Parameter file has unknown parameter type %1").arg(ptype);
+            return false;
+        }
+        int defaultSize = (withDefaults && (flags & 1)) ? valueSize : 0;
+
+        if (commonLen > lastName.length() || offset + nameLen + valueSize + defaultSize > cBytes) {
+            errorMsg = tr("Parameter file truncated");
+            return false;
+        }
+
+        QByteArray name = lastName.left(commonLen) + QByteArray(reinterpret_cast<const char*>(&data[offset]), nameLen);
+        offset += nameLen;
+
+        const uint8_t* v = &data[offset];
+        uint32_t raw = 0;
+        for (int i=valueSize-1; i>=0; i--) {
+            raw = (raw << 8) | v[i];
+        }
+        switch (param.mavType) {
+        case MAV_PARAM_TYPE_INT8:
+            param.value = QVariant(static_cast<int8_t>(raw));
+            break;
+        case MAV_PARAM_TYPE_INT16:
+            param.value = QVariant(static_cast<int16_t>(raw));
+            break;
+        case MAV_PARAM_TYPE_INT32:
+            param.value = QVariant(static_cast<int32_t>(raw));
+            break;
+        default:
+        {
+            float f;
+            memcpy(&f, &raw, sizeof(f));
+            param.value = QVariant(f);
+            break;
+        }
+        }
+        offset += valueSize + defaultSize;
+
+        param.name = QString::fromLatin1(name);
+        lastName = name;
+        params.append(param);
+    }
+
+    if (params.count() != fileCount) {
+        errorMsg = tr("Parameter file count mismatch: expected %1 got %2").arg(fileCount).arg(params.count());
+        return false;
+    }
+
+    return true;
+}
+
 /// Translates FactSystem::defaultComponentId to real component id if needed
 int ParameterManager::_actualComponentId(int componentId)
 {
@@ -518,12 +936,13 @@ void ParameterManager::refreshParameter(int componentId, const QString& paramNam
         _waitingReadParamNameMap[componentId][mappedParamName] = 0;     // Add new wait entry and update retry count
         _updateProgressBar();
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "restarting _waitingParamTimeout";
-        _waitingParamTimeoutTimer.start();
+        _restartWaitingParamTimeoutTimer();
     } else {
         qWarning() << "Internal error";
     }
 
-    _readParameterRaw(componentId, paramName, -1);
+    _queueParamRead(componentId, paramName, -1);
+    _sendQueuedRequests();
 }
 
 void ParameterManager::refreshParametersPrefix(int componentId, const QString& namePrefix)
@@ -583,8 +1002,6 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         return false;
     }
 
-    const int maxBatchSize = 10;
-
     if (waitingParamTimeout) {
         // We timed out, clear the queue and try again
         qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to timeout";
@@ -605,10 +1022,16 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
                 continue;
             }
 
-            if (_indexBatchQueue.count() > maxBatchSize) {
+            if (_indexBatchQueue.count() >= _requestScheduler.window()) {
                 break;
             }
 
+            if (_queuedRequestIndex(componentId, QString(), paramIndex, false /* write */) != -1) {
+                // Not sent yet, so this is not a retry
+                _indexBatchQueue.append(paramIndex);
+                continue;
+            }
+
             _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
             if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
@@ -618,7 +1041,7 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
             } else {
                 // Retry again
                 _indexBatchQueue.append(paramIndex);
-                _readParameterRaw(componentId, "", paramIndex);
+                _queueParamRead(componentId, QString(), paramIndex);
                 qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
             }
         }
@@ -634,11 +1057,16 @@ void ParameterManager::_waitingParamTimeout(void)
     }
 
     bool paramsRequested = false;
-    const int maxBatchSize = 10;
     int batchCount = 0;
 
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_waitingParamTimeout";
 
+    // Anything still outstanding is considered lost, which shrinks the request window before the retries below are sized
+    if (_requestScheduler.outstanding()) {
+        _requestScheduler.timeout();
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Request timeout" << _requestStatisticsReport();
+    }
+
     // Now that we have timed out for possibly the first time we can activate the index batch queue
     _indexBatchQueueActive = true;
 
@@ -649,7 +1077,7 @@ void ParameterManager::_waitingParamTimeout(void)
         // Initial load is complete but we still don't have any default component params. Wait one more cycle to see if the
         // any show up.
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId();
-        _waitingParamTimeoutTimer.start();
+        _waitingParamTimeoutTimer.start(ParameterRequestScheduler::initialRetryTimeoutMsecs);
         _waitingForDefaultComponent = true;
         return;
     }
@@ -661,12 +1089,16 @@ void ParameterManager::_waitingParamTimeout(void)
         for(int componentId: _waitingWriteParamNameMap.keys()) {
             for(const QString &paramName: _waitingWriteParamNameMap[componentId].keys()) {
                 paramsRequested = true;
+                if (_queuedRequestIndex(componentId, paramName, -1, true /* write */) != -1) {
+                    // Not sent yet, so nothing to retry
+                    continue;
+                }
                 _waitingWriteParamNameMap[componentId][paramName]++;   // Bump retry count
                 if (_waitingWriteParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
                     Fact* fact = getParameter(componentId, paramName);
-                    _sendParamSetToVehicle(componentId, paramName, fact->type(), fact->rawValue());
+                    _queuedRequests.append({ componentId, paramName, -1, true /* write */, true /* resend */, fact->type(), fact->rawValue() });
                     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << _waitingWriteParamNameMap[componentId][paramName] << ")";
-                    if (++batchCount > maxBatchSize) {
+                    if (++batchCount >= _requestScheduler.window()) {
                         goto Out;
                     }
                 } else {
@@ -684,11 +1116,15 @@ void ParameterManager::_waitingParamTimeout(void)
         for(int componentId: _waitingReadParamNameMap.keys()) {
             for(const QString &paramName: _waitingReadParamNameMap[componentId].keys()) {
                 paramsRequested = true;
+                if (_queuedRequestIndex(componentId, paramName, -1, false /* write */) != -1) {
+                    // Not sent yet, so nothing to retry
+                    continue;
+                }
                 _waitingReadParamNameMap[componentId][paramName]++;   // Bump retry count
                 if (_waitingReadParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
-                    _readParameterRaw(componentId, paramName, -1);
+                    _queueParamRead(componentId, paramName, -1);
                     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramName:" << paramName << "retryCount:" << _waitingReadParamNameMap[componentId][paramName] << ")";
-                    if (++batchCount > maxBatchSize) {
+                    if (++batchCount >= _requestScheduler.window()) {
                         goto Out;
                     }
                 } else {
@@ -705,8 +1141,10 @@ void ParameterManager::_waitingParamTimeout(void)
 Out:
     if (paramsRequested) {
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer - re-request";
-        _waitingParamTimeoutTimer.start();
+        _restartWaitingParamTimeoutTimer();
     }
+
+    _sendQueuedRequests();
 }
 
 void ParameterManager::_readParameterRaw(int componentId, const QString& paramName, int paramIndex)
@@ -723,7 +1161,8 @@ void ParameterManager::_readParameterRaw(int componentId, const QString& paramNa
                                              componentId,                    // Target component id
                                              fixedParamName,                 // Named parameter being requested
                                              paramIndex);                    // Parameter index being requested, -1 for named
-    _vehicle->sendMessageOnLinkThreadSafe(_vehicle->vehicleLinkManager()->primaryLink(), msg);
+    _sendMessage(msg);
+    _requestScheduler.requestSent(_requestKey(componentId, paramName, paramIndex), _requestClock.elapsed());
 }
 
 void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& paramName, FactMetaData::ValueType_t valueType, const QVariant& value)
@@ -781,23 +1220,65 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
                                       _vehicle->vehicleLinkManager()->primaryLink()->mavlinkChannel(),
                                       &msg,
                                       &p);
-    _vehicle->sendMessageOnLinkThreadSafe(_vehicle->vehicleLinkManager()->primaryLink(), msg);
+    _sendMessage(msg);
+    _requestScheduler.requestSent(_requestKey(componentId, paramName, -1), _requestClock.elapsed());
 }
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    Q_UNUSED(vehicleId);
 
+    ParameterCache* cache = _paramCache(componentId);
+
+    // Drop anything the vehicle no longer has
+    for (const QString& paramName: cache->names()) {
+        if (!_mapCompId2FactMap[componentId].contains(paramName)) {
+            cache->remove(paramName);
+        }
+    }
     for (const QString& paramName: _mapCompId2FactMap[componentId].keys()) {
         const Fact *fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+        cache->setValue(paramName, -1 /* keep index */, fact->type(), fact->rawValue());
+    }
+
+    cache->save();
+}
+
+/// Keeps the local cache entry for a single param in sync with the vehicle
+void ParameterManager::_updateLocalParamCache(int componentId, const QString& paramName, int paramIndex, FactMetaData::ValueType_t valueType, const QVariant& value)
+{
+    ParameterCache* cache = _paramCache(componentId);
+    bool            known = cache->contains(paramName);
+
+    if (paramIndex < 0 || paramIndex == 65535) {
+        paramIndex = -1;
     }
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    bool changed = cache->setValue(paramName, paramIndex, valueType, value);
+    if (!_initialLoadComplete && known) {
+        // Remember which values moved on the vehicle between sessions, they are the candidates for the next delta refresh
+        cache->setFlags(paramName, ParameterCache::FlagChangedOnVehicle, changed);
+    }
+    // Any value from the vehicle resolves an outstanding write
+    cache->setFlags(paramName, ParameterCache::FlagWritePending, false);
+}
 
-    QDataStream ds(&cacheFile);
-    ds << cacheMap;
+ParameterCache* ParameterManager::_paramCache(int componentId)
+{
+    if (!_paramCacheMap.contains(componentId)) {
+        ParameterCache* cache = new ParameterCache(parameterCacheFile(_vehicle->id(), componentId));
+        cache->load();
+        _paramCacheMap[componentId] = cache;
+    }
+    return _paramCacheMap[componentId];
+}
+
+uint32_t ParameterManager::_paramCacheCrc(ParameterCache* cache)
+{
+    CompInfoParam* compInfoParam = _vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1);
+    return cache->paramSetCrc([compInfoParam](const QString& name) {
+        return compInfoParam->_isParameterVolatile(name);
+    });
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -808,103 +1289,156 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QString("%1_%2.v3").arg(vehicleId).arg(componentId));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
+    Q_UNUSED(vehicleId);
+
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    ParameterCache* cache = _paramCache(componentId);
+    if (cache->isEmpty()) {
         /* no local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
-
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
 
     /* compute the crc of the local cache to check against the remote */
+    uint32_t crc32_value = _paramCacheCrc(cache);
 
-    for (const QString& name: cacheMap.keys()) {
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->_isParameterVolatile(name)) {
-            // Does not take part in CRC
-            qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const void *vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
+    /* if the two param set hashes match, just load from the disk */
+    if (crc32_value == hash_value.toUInt()) {
+        _loadFromCache(componentId, crc32_value);
+        return;
+    }
+
+    // The set differs. If we have a short list of params which are likely to have changed (unacked writes, or params which
+    // changed between previous sessions) re-request just those. If the set then matches, the rest comes from the cache.
+    // The full stream the vehicle started in response to the request list continues in the meantime as the fallback.
+    QStringList candidates = cache->namesWithFlags(ParameterCache::FlagWritePending | ParameterCache::FlagChangedOnVehicle);
+    if (candidates.count() && candidates.count() <= _maxDeltaRefreshCount) {
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed, delta refresh of" << candidates.count() << "params";
+        _deltaRefreshHash[componentId] = hash_value.toUInt();
+        _deltaRefreshPending[componentId].clear();
+        for (const QString& paramName: candidates) {
+            _deltaRefreshPending[componentId].insert(paramName);
+            _queueParamRead(componentId, paramName, -1);
         }
+        _sendQueuedRequests();
+        return;
     }
 
-    /* if the two param set hashes match, just load from the disk */
-    if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        int count = cacheMap.count();
-        int index = 0;
-        for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(fact_type);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
+    qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(parameterCacheFile(_vehicle->id(), componentId));
+    if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
+        _debugCacheCRC[componentId] = true;
+        for (const QString& name: cache->names()) {
+            const ParameterCache::Entry_t entry = cache->entry(name);
+            _debugCacheMap[componentId][name] = ParamTypeVal(entry.type, entry.value);
+            _debugCacheParamSeen[componentId][name] = false;
         }
+        qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
+    }
+}
 
-        // Return the hash value to notify we don't want any more updates
-        mavlink_param_set_t     p;
-        mavlink_param_union_t   union_value;
-        memset(&p, 0, sizeof(p));
-        p.param_type = MAV_PARAM_TYPE_UINT32;
-        strncpy(p.param_id, "_HASH_CHECK", sizeof(p.param_id));
-        union_value.param_uint32 = crc32_value;
-        p.param_value = union_value.param_float;
-        p.target_system = (uint8_t)_vehicle->id();
-        p.target_component = (uint8_t)componentId;
-        mavlink_message_t msg;
-        mavlink_msg_param_set_encode_chan(_mavlink->getSystemId(),
-                                          _mavlink->getComponentId(),
-                                          _vehicle->vehicleLinkManager()->primaryLink()->mavlinkChannel(),
-                                          &msg,
-                                          &p);
-        _vehicle->sendMessageOnLinkThreadSafe(_vehicle->vehicleLinkManager()->primaryLink(), msg);
-
-        // Give the user some feedback things loaded properly
-        QVariantAnimation *ani = new QVariantAnimation(this);
-        ani->setEasingCurve(QEasingCurve::OutCubic);
-        ani->setStartValue(0.0);
-        ani->setEndValue(1.0);
-        ani->setDuration(750);
-
-        connect(ani, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
-            _setLoadProgress(value.toDouble());
-        });
+/// Called as params arrive during a delta refresh. Once all re-requested params are in, the cache is re-checked
+/// against the vehicle hash.
+void ParameterManager::_checkDeltaRefreshComplete(int componentId, const QString& paramName)
+{
+    if (!_deltaRefreshPending.contains(componentId)) {
+        return;
+    }
+    if (_initialLoadComplete) {
+        // Full stream finished first
+        _deltaRefreshPending.remove(componentId);
+        _deltaRefreshHash.remove(componentId);
+        return;
+    }
 
-        // Hide 500ms after animation finishes
-        connect(ani, &QVariantAnimation::finished, this, [this] {
-            QTimer::singleShot(500, [this] {
-                _setLoadProgress(0);
-            });
-        });
+    _deltaRefreshPending[componentId].remove(paramName);
+    if (!_deltaRefreshPending[componentId].isEmpty()) {
+        return;
+    }
 
-        ani->start(QAbstractAnimation::DeleteWhenStopped);
+    _deltaRefreshPending.remove(componentId);
+    uint32_t vehicleHash = _deltaRefreshHash.take(componentId);
+    uint32_t crc32_value = _paramCacheCrc(_paramCache(componentId));
+    if (crc32_value == vehicleHash) {
+        qCInfo(ParameterManagerLog) << "Delta refresh matched vehicle parameter hash";
+        _loadFromCache(componentId, crc32_value);
+        _paramCache(componentId)->save();
     } else {
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-        if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
-            _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
-            for (const QString& name: cacheMap.keys()) {
-                _debugCacheParamSeen[componentId][name] = false;
-            }
-            qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
+        qCInfo(ParameterManagerLog) << "Delta refresh did not match vehicle parameter hash, continuing full load";
+    }
+}
+
+void ParameterManager::_loadFromCache(int componentId, uint32_t crc32_value)
+{
+    ParameterCache* cache = _paramCache(componentId);
+
+    qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(parameterCacheFile(_vehicle->id(), componentId));
+
+    // Use the cached vehicle indices if they are a complete set, otherwise fall back to name order (which is PX4 index order)
+    const QStringList   names = cache->names();
+    int                 count = names.count();
+    QVector<bool>       indexSeen(count, false);
+    bool                useCachedIndices = true;
+    for (const QString& name: names) {
+        int index = cache->entry(name).index;
+        if (index < 0 || index >= count || indexSeen[index]) {
+            useCachedIndices = false;
+            break;
         }
+        indexSeen[index] = true;
+    }
+
+    _loadingFromCache = true;
+    int index = 0;
+    for (const QString& name: names) {
+        const ParameterCache::Entry_t entry = cache->entry(name);
+        const MAV_PARAM_TYPE mavParamType = factTypeToMavType(entry.type);
+        _handleParamValue(componentId, name, count, useCachedIndices ? entry.index : index, mavParamType, entry.value);
+        index++;
     }
+    _loadingFromCache = false;
+
+    // Return the hash value to notify we don't want any more updates
+    mavlink_param_set_t     p;
+    mavlink_param_union_t   union_value;
+    memset(&p, 0, sizeof(p));
+    p.param_type = MAV_PARAM_TYPE_UINT32;
+    strncpy(p.param_id, "_HASH_CHECK", sizeof(p.param_id));
+    union_value.param_uint32 = crc32_value;
+    p.param_value = union_value.param_float;
+    p.target_system = (uint8_t)_vehicle->id();
+    p.target_component = (uint8_t)componentId;
+    mavlink_message_t msg;
+    mavlink_msg_param_set_encode_chan(_mavlink->getSystemId(),
+                                      _mavlink->getComponentId(),
+                                      _vehicle->vehicleLinkManager()->primaryLink()->mavlinkChannel(),
+                                      &msg,
+                                      &p);
+    _sendMessage(msg);
+
+    // Give the user some feedback things loaded properly
+    QVariantAnimation *ani = new QVariantAnimation(this);
+    ani->setEasingCurve(QEasingCurve::OutCubic);
+    ani->setStartValue(0.0);
+    ani->setEndValue(1.0);
+    ani->setDuration(750);
+
+    connect(ani, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
+        _setLoadProgress(value.toDouble());
+    });
+
+    // Hide 500ms after animation finishes
+    connect(ani, &QVariantAnimation::finished, this, [this] {
+        QTimer::singleShot(500, [this] {
+            _setLoadProgress(0);
+        });
+    });
+
+    ani->start(QAbstractAnimation::DeleteWhenStopped);
 }
 
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
@@ -1106,7 +1640,7 @@ void ParameterManager::_checkInitialLoadComplete(void)
     }
     _debugCacheCRC.clear();
 
-    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Initial load complete";
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Initial load complete" << _requestStatisticsReport();
 
     // Check for index based load failures
     QString indexList;
@@ -1145,6 +1679,15 @@ void ParameterManager::_checkInitialLoadComplete(void)
 
 void ParameterManager::_initialRequestTimeout(void)
 {
+    if (_ftpDownloadActive) {
+        qCWarning(ParameterManagerLog) << _logVehiclePrefix(-1) << "FTP parameter download stalled, falling back to PARAM_REQUEST_LIST";
+        _ftpDownloadDone();
+        _ftpDownloadFailed = true;
+        _setLoadProgress(0.0);
+        _requestParameterList(MAV_COMP_ID_ALL);
+        return;
+    }
+
     if (!_disableAllRetries && ++_initialRequestRetryCount <= _maxInitialRequestListRetry) {
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Retrying initial parameter request list";
         refreshAllParameters();
@@ -11,13 +11,18 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSet>
 #include <QXmlStreamReader>
 #include <QLoggingCategory>
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 
 #include "FactSystem.h"
+#include "ParameterCache.h"
+#include "ParameterRequestScheduler.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
@@ -38,6 +43,7 @@ class ParameterManager : public QObject
 public:
     /// @param uas Uas which this set of facts is associated with
     ParameterManager(Vehicle* vehicle);
+    ~ParameterManager();
 
     Q_PROPERTY(bool     parametersReady     READ parametersReady    NOTIFY parametersReadyChanged)      ///< true: Parameters are ready for use
     Q_PROPERTY(bool     missingParameters   READ missingParameters  NOTIFY missingParametersChanged)    ///< true: Parameters are missing from firmware response, false: all parameters received from firmware
@@ -91,11 +97,28 @@ public:
 
     bool pendingWrites(void);
 
+    /// @return Round trip, window, retry and measured throughput statistics for parameter requests on each link, the primary link first
+    QList<ParameterRequestScheduler::Statistics_t> requestStatistics(void);
+
     Vehicle* vehicle(void) { return _vehicle; }
 
     static MAV_PARAM_TYPE               factTypeToMavType(FactMetaData::ValueType_t factType);
     static FactMetaData::ValueType_t    mavTypeToFactType(MAV_PARAM_TYPE mavType);
 
+    typedef struct {
+        QString         name;
+        MAV_PARAM_TYPE  mavType;
+        QVariant        value;
+    } ParamFileEntry_t;
+
+    /// Decodes a packed parameter file as served by ArduPilot over MAVLink FTP (@PARAM/param.pck)
+    ///     @param bytes            Raw file contents
+    ///     @param params[out]      Decoded parameters in index order
+    ///     @param totalCount[out]  Total number of parameters on the vehicle
+    ///     @param errorMsg[out]    Reason for failure
+    /// @return true: success, false: file is corrupt or unsupported
+    static bool decodeParameterFile(const QByteArray& bytes, QList<ParamFileEntry_t>& params, int& totalCount, QString& errorMsg);
+
 signals:
     void parametersReadyChanged     (bool parametersReady);
     void missingParametersChanged   (bool missingParameters);
@@ -105,6 +128,8 @@ signals:
 
 private slots:
     void    _factRawValueUpdated                (const QVariant& rawValue);
+    void    _ftpDownloadComplete                (const QString& fileName, const QString& errorMsg);
+    void    _ftpDownloadProgress                (int value);
 
 private:
     void    _handleParamValue                   (int componentId, QString parameterName, int parameterCount, int parameterIndex, MAV_PARAM_TYPE mavParamType, QVariant parameterValue);
@@ -117,6 +142,11 @@ private:
     void    _sendParamSetToVehicle              (int componentId, const QString& paramName, FactMetaData::ValueType_t valueType, const QVariant& value);
     void    _writeLocalParamCache               (int vehicleId, int componentId);
     void    _tryCacheHashLoad                   (int vehicleId, int componentId, QVariant hash_value);
+    void    _loadFromCache                      (int componentId, uint32_t crc32Value);
+    void    _updateLocalParamCache              (int componentId, const QString& paramName, int paramIndex, FactMetaData::ValueType_t valueType, const QVariant& value);
+    void    _checkDeltaRefreshComplete          (int componentId, const QString& paramName);
+    ParameterCache* _paramCache                 (int componentId);
+    uint32_t _paramCacheCrc                     (ParameterCache* cache);
     void    _loadMetaData                       (void);
     void    _clearMetaData                      (void);
     QString _remapParamNameToVersion            (const QString& paramName);
@@ -126,6 +156,27 @@ private:
     bool    _fillIndexBatchQueue                (bool waitingParamTimeout);
     void    _updateProgressBar                  (void);
     void    _checkInitialLoadComplete           (void);
+    bool    _startFTPParameterDownload          (uint8_t componentId);
+    void    _ftpDownloadDone                    (void);
+    void    _sendMessage                        (mavlink_message_t& message);
+    QString _requestStatisticsReport            (void);
+    void    _requestParameterList               (uint8_t componentId);
+    void    _queueParamRead                     (int componentId, const QString& paramName, int paramIndex);
+    int     _queuedRequestIndex                 (int componentId, const QString& paramName, int paramIndex, bool write) const;
+    void    _sendQueuedRequests                 (void);
+    void    _primaryLinkChanged                 (void);
+    void    _restartWaitingParamTimeoutTimer    (void);
+    static QString _requestKey                  (int componentId, const QString& paramName, int paramIndex);
+
+    typedef struct {
+        int                         componentId;
+        QString                     name;       ///< Empty for index based reads
+        int                         index;      ///< -1 for named requests
+        bool                        write;
+        bool                        resend;     ///< Write which was sent before, its response clears the write wait
+        FactMetaData::ValueType_t   valueType;
+        QVariant                    value;
+    } QueuedRequest_t;
 
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
 
@@ -150,6 +201,12 @@ private:
     QMap<int /* component id */, CacheMapName2ParamTypeVal>                         _debugCacheMap;
     QMap<int /* component id */, QMap<QString /* param name */, bool /* seen */>>   _debugCacheParamSeen;
 
+    QMap<int /* component id */, ParameterCache*>   _paramCacheMap;
+    bool                                            _loadingFromCache = false;  ///< true: _handleParamValue is being fed from the local cache
+    QMap<int /* component id */, uint32_t>          _deltaRefreshHash;          ///< Vehicle param set hash to match once the delta refresh completes
+    QMap<int /* component id */, QSet<QString>>     _deltaRefreshPending;       ///< Params re-requested for a delta refresh which have not yet arrived
+    static const int                                _maxDeltaRefreshCount = 32; ///< Above this many candidates a full load is cheaper
+
     // Wait counts from previous parameter update cycle
     int _prevWaitingReadParamIndexCount;
     int _prevWaitingReadParamNameCount;
@@ -164,6 +221,10 @@ private:
     static const int    _maxInitialLoadRetrySingleParam = 5;    ///< Maximum retries for initial index based load of a single param
     static const int    _maxReadWriteRetry = 5;                 ///< Maximum retries read/write
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
+    bool                _ftpDownloadActive = false;             ///< true: Parameter file download over FTP in progress
+    bool                _ftpDownloadFailed = false;             ///< true: Parameter file download failed, don't try again
+    QTemporaryDir*      _ftpDownloadDir = nullptr;              ///< Directory the parameter file is downloaded to, removed with its contents
+    QString             _ftpDownloadFilePath;                   ///< Local path the parameter file is downloaded to
 
     bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
     QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
@@ -181,6 +242,11 @@ private:
     QTimer _initialRequestTimeoutTimer;
     QTimer _waitingParamTimeoutTimer;
 
+    ParameterRequestScheduler       _requestScheduler;      ///< Request window, pacing and retry timeout for the primary link
+    QElapsedTimer                   _requestClock;          ///< Time base for _requestScheduler
+    QList<QueuedRequest_t>          _queuedRequests;            ///< Reads and writes waiting for room in the request window
+    QTimer                          _sendQueuedRequestsTimer;   ///< Fires when pacing allows the next queued request
+
     Fact _defaultFact;   ///< Used to return default fact, when parameter not found
 
     static const char* _jsonParametersKey;
@@ -12,6 +12,12 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "ParameterCache.h"
+#include "ParameterRequestScheduler.h"
+#include "ParameterMetaDataCache.h"
+
+#include <QTemporaryDir>
+#include <QDir>
 
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
@@ -51,6 +57,12 @@ void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t fai
     arguments = spyProgress.takeLast();
     QCOMPARE(arguments.count(), 1);
     QCOMPARE(arguments.at(0).toFloat(), 0.0f);
+
+    // Parameter traffic is measured on the primary link
+    QList<ParameterRequestScheduler::Statistics_t> statistics = vehicle->parameterManager()->requestStatistics();
+    QVERIFY(!statistics.isEmpty());
+    QVERIFY(statistics[0].bytesSent > 0);
+    QVERIFY(statistics[0].bytesReceived > statistics[0].bytesSent);
 }
 
 
@@ -138,3 +150,237 @@ void ParameterManagerTest::_requestListMissingParamFail(void)
     // User should have been notified
     checkExpectedMessageBox();
 }
+
+void ParameterManagerTest::_decodeParameterFile(void)
+{
+    const char rgFile[] = {
+        0x1b, 0x67,                             // magic
+        0x03, 0x00,                             // param count in file
+        0x03, 0x00,                             // total param count
+        0x04, 0x40, 'A', 'B', 'C', '_', 'X',    // float, common:0, name len:5
+        0x00, 0x00, (char)0xc0, 0x3f,           // 1.5f
+        0x01, 0x04, 'Y',                        // int8, common:4 ("ABC_"), name len:1
+        (char)0xfd,                             // -3
+        0x00, 0x00,                             // padding
+        0x03, 0x00, 'Z',                        // int32, common:0, name len:1
+        (char)0xa0, (char)0x86, 0x01, 0x00,     // 100000
+    };
+
+    QList<ParameterManager::ParamFileEntry_t>   params;
+    int                                         totalCount;
+    QString                                     errorMsg;
+
+    QVERIFY(ParameterManager::decodeParameterFile(QByteArray(rgFile, sizeof(rgFile)), params, totalCount, errorMsg));
+    QVERIFY(errorMsg.isEmpty());
+    QCOMPARE(totalCount, 3);
+    QCOMPARE(params.count(), 3);
+
+    QCOMPARE(params[0].name,            QStringLiteral("ABC_X"));
+    QCOMPARE(params[0].mavType,         MAV_PARAM_TYPE_REAL32);
+    QCOMPARE(params[0].value.toFloat(), 1.5f);
+    QCOMPARE(params[1].name,            QStringLiteral("ABC_Y"));
+    QCOMPARE(params[1].mavType,         MAV_PARAM_TYPE_INT8);
+    QCOMPARE(params[1].value.toInt(),   -3);
+    QCOMPARE(params[2].name,            QStringLiteral("Z"));
+    QCOMPARE(params[2].mavType,         MAV_PARAM_TYPE_INT32);
+    QCOMPARE(params[2].value.toInt(),   100000);
+
+    // Truncated file must be rejected
+    QVERIFY(!ParameterManager::decodeParameterFile(QByteArray(rgFile, sizeof(rgFile) - 2), params, totalCount, errorMsg));
+    QVERIFY(!errorMsg.isEmpty());
+}
+
+void ParameterManagerTest::_parameterCacheRoundTrip(void)
+{
+    QTemporaryDir   tempDir;
+    QString         cacheFile = tempDir.filePath("1_1.v3");
+    auto            noVolatile = [](const QString&) { return false; };
+
+    uint32_t crc;
+    {
+        ParameterCache cache(cacheFile);
+        QCOMPARE(cache.load(), false);
+        cache.setValue("B_PARAM", 1, FactMetaData::valueTypeFloat, QVariant(2.5f));
+        cache.setValue("A_PARAM", 0, FactMetaData::valueTypeInt8, QVariant(-1));
+        crc = cache.paramSetCrc(noVolatile);
+        QVERIFY(cache.save());
+    }
+
+    ParameterCache cache(cacheFile);
+    QVERIFY(cache.load());
+    QCOMPARE(cache.count(), 2);
+    QCOMPARE(cache.entry("A_PARAM").index,          0);
+    QCOMPARE(cache.entry("A_PARAM").value.toInt(),  -1);
+    QCOMPARE(cache.entry("B_PARAM").value.toFloat(), 2.5f);
+    QCOMPARE(cache.paramSetCrc(noVolatile), crc);
+
+    // Same value is not a change, new value is patched in place and survives a reload without a save
+    QCOMPARE(cache.setValue("B_PARAM", 1, FactMetaData::valueTypeFloat, QVariant(2.5f)), false);
+    QCOMPARE(cache.setValue("B_PARAM", 1, FactMetaData::valueTypeFloat, QVariant(3.0f)), true);
+    cache.setFlags("B_PARAM", ParameterCache::FlagWritePending, true);
+    QVERIFY(cache.paramSetCrc(noVolatile) != crc);
+
+    ParameterCache reloaded(cacheFile);
+    QVERIFY(reloaded.load());
+    QCOMPARE(reloaded.entry("B_PARAM").value.toFloat(), 3.0f);
+    QCOMPARE(reloaded.namesWithFlags(ParameterCache::FlagWritePending), QStringList("B_PARAM"));
+}
+
+void ParameterManagerTest::_requestScheduler(void)
+{
+    ParameterRequestScheduler scheduler;
+
+    // Window limits outstanding requests before anything has been measured
+    QCOMPARE(scheduler.retryTimeoutMsecs(), static_cast<int>(ParameterRequestScheduler::initialRetryTimeoutMsecs));
+    for (int i=0; i<ParameterRequestScheduler::initialWindow; i++) {
+        QVERIFY(scheduler.canSend(0));
+        scheduler.requestSent(QString::number(i), 0);
+    }
+    QCOMPARE(scheduler.sendDelayMsecs(0), -1);
+
+    // Responses measure the round trip and grow the window
+    for (int i=0; i<ParameterRequestScheduler::initialWindow; i++) {
+        QVERIFY(scheduler.responseReceived(QString::number(i), 100));
+    }
+    QVERIFY(!scheduler.responseReceived(QStringLiteral("unrequested"), 100));
+    QCOMPARE(scheduler.srttMsecs(), 100);
+    QCOMPARE(scheduler.window(), ParameterRequestScheduler::initialWindow * 2);
+    QVERIFY(scheduler.retryTimeoutMsecs() < ParameterRequestScheduler::initialRetryTimeoutMsecs);
+
+    // Sends are paced across the round trip
+    scheduler.requestSent(QStringLiteral("a"), 200);
+    QVERIFY(!scheduler.canSend(200));
+    QVERIFY(scheduler.canSend(200 + (100 / scheduler.window())));
+
+    // Timeout halves the window and the retransmitted response doesn't skew the round trip
+    int window = scheduler.window();
+    scheduler.timeout();
+    QCOMPARE(scheduler.outstanding(), 0);
+    QCOMPARE(scheduler.window(), window / 2);
+    scheduler.requestSent(QStringLiteral("a"), 1000);
+    QVERIFY(scheduler.responseReceived(QStringLiteral("a"), 4000));
+    QCOMPARE(scheduler.srttMsecs(), 100);
+
+    // State is kept per link
+    scheduler.setLink(QStringLiteral("other"));
+    QCOMPARE(scheduler.srttMsecs(), 0);
+    QCOMPARE(scheduler.window(), static_cast<int>(ParameterRequestScheduler::initialWindow));
+    scheduler.setLink(QString());
+    QCOMPARE(scheduler.srttMsecs(), 100);
+}
+
+void ParameterManagerTest::_requestStatistics(void)
+{
+    ParameterRequestScheduler scheduler;
+
+    scheduler.setLink(QStringLiteral("radio"));
+    scheduler.requestSent(QStringLiteral("a"), 0);
+    scheduler.bytesSent(35, 0);
+    scheduler.requestSent(QStringLiteral("b"), 0);
+    scheduler.bytesSent(35, 0);
+    QVERIFY(scheduler.responseReceived(QStringLiteral("a"), 100));
+    scheduler.bytesReceived(37, 100);
+    scheduler.timeout();
+    scheduler.requestSent(QStringLiteral("b"), 1000);
+    scheduler.bytesSent(35, 1000);
+
+    ParameterRequestScheduler::Statistics_t statistics = scheduler.statistics(1000);
+    QCOMPARE(statistics.linkName,           QStringLiteral("radio"));
+    QCOMPARE(statistics.rttMsecs,           100);
+    QCOMPARE(statistics.requestsSent,       3u);
+    QCOMPARE(statistics.responsesReceived,  1u);
+    QCOMPARE(statistics.retries,            1u);
+    QCOMPARE(statistics.timeouts,           1u);
+    QCOMPARE(statistics.bytesSent,          105ull);
+    QCOMPARE(statistics.bytesReceived,      37ull);
+
+    // Rates are measured over the last two seconds
+    QCOMPARE(statistics.requestsPerSecond,      1.5);
+    QCOMPARE(statistics.responsesPerSecond,     0.5);
+    QCOMPARE(statistics.bytesSentPerSecond,     52.5);
+    QCOMPARE(statistics.bytesReceivedPerSecond, 18.5);
+    statistics = scheduler.statistics(2500);
+    QCOMPARE(statistics.requestsPerSecond,      0.5);
+    QCOMPARE(statistics.responsesPerSecond,     0.0);
+    QCOMPARE(statistics.bytesSent,              105ull);
+
+    // Each link keeps its own statistics, the current link is reported first
+    scheduler.setLink(QStringLiteral("wifi"));
+    scheduler.bytesReceived(37, 3000);
+    QList<ParameterRequestScheduler::Statistics_t> allStatistics = scheduler.allStatistics(3000);
+    QCOMPARE(allStatistics.count(), 3);
+    QCOMPARE(allStatistics[0].linkName,         QStringLiteral("wifi"));
+    QCOMPARE(allStatistics[0].requestsSent,     0u);
+    QCOMPARE(allStatistics[0].bytesReceived,    37ull);
+
+    QVERIFY(ParameterRequestScheduler::report(allStatistics[0]).contains(QStringLiteral("link:wifi")));
+}
+
+void ParameterManagerTest::_metaDataCacheRoundTrip(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QDir cacheDir(tempDir.filePath("ParamCache"));
+
+    QString sourceFile = tempDir.filePath("metadata.xml");
+    {
+        QFile file(sourceFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArrayLiteral("<parameters></parameters>"));
+    }
+
+    QList<ParameterMetaDataCache::Record_t> records;
+    ParameterMetaDataCache::Record_t record;
+    record.name     = QStringLiteral("B_PARAM");
+    record.type     = FactMetaData::valueTypeFloat;
+    record.flags    = ParameterMetaDataCache::FlagRebootRequired;
+    record.fields[ParameterMetaDataCache::FieldGroup]   = QStringLiteral("Group");
+    record.fields[ParameterMetaDataCache::FieldValues]  = ParameterMetaDataCache::encodePairs({ qMakePair(QStringLiteral("0"), QStringLiteral("Off")), qMakePair(QStringLiteral("1"), QStringLiteral("On")) });
+    records.append(record);
+    record          = ParameterMetaDataCache::Record_t();
+    record.section  = QStringLiteral("libraries");
+    record.name     = QStringLiteral("A_PARAM");
+    record.fields[ParameterMetaDataCache::FieldGroup]   = QStringLiteral("Group");
+    records.append(record);
+
+    QByteArray sourceBytes;
+    {
+        ParameterMetaDataCache cache;
+        cache.setCacheDir(cacheDir.path());
+        QCOMPARE(cache.open(sourceFile, 1, sourceBytes), false);
+        QVERIFY(!sourceBytes.isEmpty());
+        cache.setRecords(records);
+    }
+    QCOMPARE(cacheDir.entryList({ QStringLiteral("*.qpm") }, QDir::Files).count(), 1);
+
+    // Different parser version doesn't match. A match doesn't read the source.
+    ParameterMetaDataCache cache;
+    cache.setCacheDir(cacheDir.path());
+    QCOMPARE(cache.open(sourceFile, 2, sourceBytes), false);
+    QCOMPARE(cache.open(sourceFile, 1, sourceBytes), true);
+    QVERIFY(sourceBytes.isEmpty());
+    QCOMPARE(cache.count(), 2);
+
+    ParameterMetaDataCache::Record_t found;
+    QVERIFY(!cache.find(QString(), QStringLiteral("A_PARAM"), found));
+    QVERIFY(cache.find(QStringLiteral("libraries"), QStringLiteral("A_PARAM"), found));
+    QCOMPARE(found.fields[ParameterMetaDataCache::FieldGroup], QStringLiteral("Group"));
+    QVERIFY(cache.find(QString(), QStringLiteral("B_PARAM"), found));
+    QCOMPARE(found.type, static_cast<int>(FactMetaData::valueTypeFloat));
+    QCOMPARE(found.flags, static_cast<uint8_t>(ParameterMetaDataCache::FlagRebootRequired));
+    auto values = ParameterMetaDataCache::decodePairs(found.fields[ParameterMetaDataCache::FieldValues]);
+    QCOMPARE(values.count(), 2);
+    QCOMPARE(values[1].second, QStringLiteral("On"));
+
+    // A changed source is compiled again and replaces the stale cache
+    {
+        QFile file(sourceFile);
+        QVERIFY(file.open(QIODevice::Append));
+        file.write(QByteArrayLiteral("\n"));
+    }
+    QCOMPARE(cache.open(sourceFile, 1, sourceBytes), false);
+    QVERIFY(!sourceBytes.isEmpty());
+    cache.setRecords(records.mid(0, 1));
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cacheDir.entryList({ QStringLiteral("*.qpm") }, QDir::Files).count(), 1);
+}
@@ -25,6 +25,11 @@ private slots:
     void _requestListNoResponse(void);
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
+    void _decodeParameterFile(void);
+    void _parameterCacheRoundTrip(void);
+    void _requestScheduler(void);
+    void _requestStatistics(void);
+    void _metaDataCacheRoundTrip(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
@@ -0,0 +1,244 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterRequestScheduler.h"
+
+#include <QtGlobal>
+#include <cmath>
+
+const int ParameterRequestScheduler::initialRetryTimeoutMsecs;
+const int ParameterRequestScheduler::minRetryTimeoutMsecs;
+const int ParameterRequestScheduler::maxRetryTimeoutMsecs;
+const int ParameterRequestScheduler::initialWindow;
+const int ParameterRequestScheduler::maxWindow;
+
+ParameterRequestScheduler::ParameterRequestScheduler(void)
+    : _state(nullptr)
+{
+    setLink(QString());
+}
+
+void ParameterRequestScheduler::setLink(const QString& linkName)
+{
+    if (!_linkStates.contains(linkName)) {
+        _linkStates[linkName].name = linkName;
+    }
+    _state = &_linkStates[linkName];
+}
+
+int ParameterRequestScheduler::_window(const LinkState_t& state)
+{
+    return qBound(1, static_cast<int>(state.window), maxWindow);
+}
+
+int ParameterRequestScheduler::window(void) const
+{
+    return _window(*_state);
+}
+
+int ParameterRequestScheduler::_retryTimeoutMsecs(const LinkState_t& state)
+{
+    int timeout = initialRetryTimeoutMsecs;
+
+    if (state.srtt > 0) {
+        timeout = static_cast<int>(state.srtt + qMax(100.0, 4 * state.rttVar));
+    }
+
+    return qBound(minRetryTimeoutMsecs, timeout * state.backoff, maxRetryTimeoutMsecs);
+}
+
+int ParameterRequestScheduler::retryTimeoutMsecs(void) const
+{
+    return _retryTimeoutMsecs(*_state);
+}
+
+int ParameterRequestScheduler::sendDelayMsecs(qint64 nowMsecs) const
+{
+    if (outstanding() >= window()) {
+        return -1;
+    }
+    if (_state->srtt <= 0 || _state->lastSendMsecs < 0) {
+        // Nothing measured yet, let the window alone limit the rate
+        return 0;
+    }
+
+    // Spread a full window evenly over one round trip
+    qint64 interval = static_cast<qint64>(_state->srtt / window());
+    qint64 nextSend = _state->lastSendMsecs + interval;
+
+    return static_cast<int>(qMax(static_cast<qint64>(0), nextSend - nowMsecs));
+}
+
+bool ParameterRequestScheduler::canSend(qint64 nowMsecs) const
+{
+    return sendDelayMsecs(nowMsecs) == 0;
+}
+
+void ParameterRequestScheduler::requestSent(const QString& key, qint64 nowMsecs)
+{
+    Outstanding_t request;
+
+    request.sentMsecs       = nowMsecs;
+    request.retransmitted   = _state->outstanding.contains(key) || _state->lost.remove(key);
+
+    _state->outstanding[key]    = request;
+    _state->lastSendMsecs       = nowMsecs;
+    _state->sent++;
+    if (request.retransmitted) {
+        _state->retries++;
+    }
+    _addRateSample(_state->recentRequests, nowMsecs, 1);
+}
+
+bool ParameterRequestScheduler::responseReceived(const QString& key, qint64 nowMsecs)
+{
+    if (!_state->outstanding.contains(key)) {
+        return false;
+    }
+
+    Outstanding_t request = _state->outstanding.take(key);
+    _state->received++;
+    _addRateSample(_state->recentResponses, nowMsecs, 1);
+
+    // Responses to retransmitted requests are ambiguous, they don't update the rtt estimate
+    if (!request.retransmitted) {
+        double sample = static_cast<double>(nowMsecs - request.sentMsecs);
+        if (_state->srtt <= 0) {
+            _state->srtt    = qMax(1.0, sample);
+            _state->rttVar  = sample / 2;
+        } else {
+            _state->rttVar  = (0.75 * _state->rttVar) + (0.25 * std::fabs(_state->srtt - sample));
+            _state->srtt    = (0.875 * _state->srtt) + (0.125 * sample);
+        }
+        _state->backoff = 1;
+    }
+
+    // Slow start up to the threshold, then one more request per window of responses
+    if (_state->window < _state->slowStartThreshold) {
+        _state->window += 1;
+    } else {
+        _state->window += 1.0 / _state->window;
+    }
+    _state->window = qMin(_state->window, static_cast<double>(maxWindow));
+
+    return true;
+}
+
+void ParameterRequestScheduler::timeout(void)
+{
+    _state->timeouts++;
+
+    for (const QString& key: _state->outstanding.keys()) {
+        _state->lost.insert(key);
+    }
+    _state->outstanding.clear();
+
+    _state->slowStartThreshold  = qMax(2.0, _state->window / 2);
+    _state->window              = _state->slowStartThreshold;
+    _state->backoff             = qMin(_state->backoff * 2, 8);
+}
+
+void ParameterRequestScheduler::bytesSent(int bytes, qint64 nowMsecs)
+{
+    _state->bytesSent += static_cast<quint64>(bytes);
+    _addRateSample(_state->recentBytesSent, nowMsecs, bytes);
+}
+
+void ParameterRequestScheduler::bytesReceived(int bytes, qint64 nowMsecs)
+{
+    _state->bytesReceived += static_cast<quint64>(bytes);
+    _addRateSample(_state->recentBytesReceived, nowMsecs, bytes);
+}
+
+void ParameterRequestScheduler::_addRateSample(QQueue<RateSample_t>& samples, qint64 nowMsecs, int amount)
+{
+    RateSample_t sample;
+
+    sample.msecs    = nowMsecs;
+    sample.amount   = amount;
+    samples.enqueue(sample);
+
+    _pruneRateSamples(samples, nowMsecs);
+}
+
+void ParameterRequestScheduler::_pruneRateSamples(QQueue<RateSample_t>& samples, qint64 nowMsecs)
+{
+    while (!samples.isEmpty() && nowMsecs - samples.head().msecs > _rateWindowMsecs) {
+        samples.dequeue();
+    }
+}
+
+/// @return Sum of the samples inside the rate window per second
+double ParameterRequestScheduler::_ratePerSecond(QQueue<RateSample_t>& samples, qint64 nowMsecs)
+{
+    _pruneRateSamples(samples, nowMsecs);
+
+    qint64 total = 0;
+    for (const RateSample_t& sample: samples) {
+        total += sample.amount;
+    }
+    return (total * 1000.0) / _rateWindowMsecs;
+}
+
+ParameterRequestScheduler::Statistics_t ParameterRequestScheduler::_statistics(LinkState_t& state, qint64 nowMsecs)
+{
+    Statistics_t statistics;
+
+    statistics.linkName                 = state.name;
+    statistics.rttMsecs                 = static_cast<int>(state.srtt);
+    statistics.retryTimeoutMsecs        = _retryTimeoutMsecs(state);
+    statistics.window                   = _window(state);
+    statistics.requestsSent             = state.sent;
+    statistics.responsesReceived        = state.received;
+    statistics.retries                  = state.retries;
+    statistics.timeouts                 = state.timeouts;
+    statistics.bytesSent                = state.bytesSent;
+    statistics.bytesReceived            = state.bytesReceived;
+    statistics.requestsPerSecond        = _ratePerSecond(state.recentRequests,      nowMsecs);
+    statistics.responsesPerSecond       = _ratePerSecond(state.recentResponses,     nowMsecs);
+    statistics.bytesSentPerSecond       = _ratePerSecond(state.recentBytesSent,     nowMsecs);
+    statistics.bytesReceivedPerSecond   = _ratePerSecond(state.recentBytesReceived, nowMsecs);
+
+    return statistics;
+}
+
+ParameterRequestScheduler::Statistics_t ParameterRequestScheduler::statistics(qint64 nowMsecs)
+{
+    return _statistics(*_state, nowMsecs);
+}
+
+QList<ParameterRequestScheduler::Statistics_t> ParameterRequestScheduler::allStatistics(qint64 nowMsecs)
+{
+    QList<Statistics_t> statisticsList;
+
+    statisticsList.append(statistics(nowMsecs));
+    for (LinkState_t& state: _linkStates) {
+        if (&state != _state) {
+            statisticsList.append(_statistics(state, nowMsecs));
+        }
+    }
+    return statisticsList;
+}
+
+QString ParameterRequestScheduler::report(const Statistics_t& statistics)
+{
+    return QStringLiteral("link:%1 rtt:%2ms timeout:%3ms window:%4 sent:%5 received:%6 retries:%7 timeouts:%8 rate:%9/%10/s bytes:%11/%12B/s")
+            .arg(statistics.linkName.isEmpty() ? QStringLiteral("none") : statistics.linkName)
+            .arg(statistics.rttMsecs)
+            .arg(statistics.retryTimeoutMsecs)
+            .arg(statistics.window)
+            .arg(statistics.requestsSent)
+            .arg(statistics.responsesReceived)
+            .arg(statistics.retries)
+            .arg(statistics.timeouts)
+            .arg(statistics.requestsPerSecond, 0, 'f', 1)
+            .arg(statistics.responsesPerSecond, 0, 'f', 1)
+            .arg(statistics.bytesSentPerSecond, 0, 'f', 0)
+            .arg(statistics.bytesReceivedPerSecond, 0, 'f', 0);
+}
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QQueue>
+#include <QString>
+
+/// Flow control for parameter reads and writes.
+///
+/// Keeps a window of outstanding requests which grows while responses come back and halves on a timeout
+/// (additive increase, multiplicative decrease). The retry timeout is derived from the measured round trip
+/// time (RFC 6298 style smoothed rtt and variance) and sends are spread evenly over a round trip so a full
+/// window is not dumped onto the link in one burst. State is kept separately for each link so switching
+/// between, for example, a telemetry radio and a fast link does not throw away what was learned.
+///
+/// All times are msecs from a monotonic clock supplied by the caller.
+class ParameterRequestScheduler
+{
+public:
+    ParameterRequestScheduler(void);
+
+    typedef struct {
+        QString linkName;
+        int     rttMsecs;                   ///< Smoothed round trip time, 0 until measured
+        int     retryTimeoutMsecs;
+        int     window;
+        quint32 requestsSent;               ///< Includes retries
+        quint32 responsesReceived;          ///< Responses which matched an outstanding request
+        quint32 retries;                    ///< Requests which were sent again after a timeout or while still outstanding
+        quint32 timeouts;
+        quint64 bytesSent;                  ///< Parameter messages sent on the link, as encoded on the wire
+        quint64 bytesReceived;              ///< Parameter messages received from the link, as encoded on the wire
+        double  requestsPerSecond;          ///< Rates are measured over the recent past
+        double  responsesPerSecond;
+        double  bytesSentPerSecond;
+        double  bytesReceivedPerSecond;
+    } Statistics_t;
+
+    /// Switches to the state for the specified link, creating it if needed
+    void setLink(const QString& linkName);
+
+    /// @return true: Another request can be sent now
+    bool canSend(qint64 nowMsecs) const;
+
+    /// @return msecs until pacing allows the next send, -1 if the window is full
+    int sendDelayMsecs(qint64 nowMsecs) const;
+
+    /// Records a request sent for the specified key. Re-sending an outstanding key counts as a retransmission.
+    void requestSent(const QString& key, qint64 nowMsecs);
+
+    /// Records a response for the specified key
+    /// @return true: key matched an outstanding request
+    bool responseReceived(const QString& key, qint64 nowMsecs);
+
+    /// Called when requests timed out. All outstanding requests are considered lost.
+    void timeout(void);
+
+    /// Records the wire size of a parameter message sent on the current link
+    void bytesSent(int bytes, qint64 nowMsecs);
+
+    /// Records the wire size of a parameter message received from the current link
+    void bytesReceived(int bytes, qint64 nowMsecs);
+
+    int     window              (void) const;
+    int     outstanding         (void) const { return _state->outstanding.count(); }
+    int     retryTimeoutMsecs   (void) const;
+    int     srttMsecs           (void) const { return static_cast<int>(_state->srtt); }
+
+    /// @return Statistics for the current link
+    Statistics_t statistics(qint64 nowMsecs);
+
+    /// @return Statistics for each link which has been used, the current link first
+    QList<Statistics_t> allStatistics(qint64 nowMsecs);
+
+    /// @return One line summary of the specified statistics for logging
+    static QString report(const Statistics_t& statistics);
+
+    static const int initialRetryTimeoutMsecs   = 3000;
+    static const int minRetryTimeoutMsecs       = 750;
+    static const int maxRetryTimeoutMsecs       = 5000;
+    static const int initialWindow              = 4;
+    static const int maxWindow                  = 64;
+
+private:
+    typedef struct {
+        qint64  sentMsecs;
+        bool    retransmitted;
+    } Outstanding_t;
+
+    typedef struct {
+        qint64  msecs;
+        int     amount;
+    } RateSample_t;
+
+    typedef struct LinkState {
+        QString                         name;
+        double                          window      = initialWindow;
+        double                          slowStartThreshold = maxWindow;
+        double                          srtt        = 0;    ///< Smoothed round trip time, 0 until the first sample
+        double                          rttVar      = 0;
+        int                             backoff     = 1;    ///< Retry timeout multiplier after consecutive timeouts
+        qint64                          lastSendMsecs = -1;
+        QMap<QString, Outstanding_t>    outstanding;
+        QSet<QString>                   lost;               ///< Keys whose next send is a retransmission (Karn's algorithm)
+        QQueue<RateSample_t>            recentRequests;     ///< Samples inside the rate window
+        QQueue<RateSample_t>            recentResponses;
+        QQueue<RateSample_t>            recentBytesSent;
+        QQueue<RateSample_t>            recentBytesReceived;
+        quint32                         sent        = 0;
+        quint32                         received    = 0;
+        quint32                         retries     = 0;
+        quint32                         timeouts    = 0;
+        quint64                         bytesSent   = 0;
+        quint64                         bytesReceived = 0;
+    } LinkState_t;
+
+    static int          _window             (const LinkState_t& state);
+    static int          _retryTimeoutMsecs  (const LinkState_t& state);
+    static void         _addRateSample      (QQueue<RateSample_t>& samples, qint64 nowMsecs, int amount);
+    static void         _pruneRateSamples   (QQueue<RateSample_t>& samples, qint64 nowMsecs);
+    static double       _ratePerSecond      (QQueue<RateSample_t>& samples, qint64 nowMsecs);
+    static Statistics_t _statistics         (LinkState_t& state, qint64 nowMsecs);
+
+    QMap<QString, LinkState_t>  _linkStates;
+    LinkState_t*                _state;
+
+    static const int    _rateWindowMsecs    = 2000;
+};
@@ -0,0 +1,278 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryFrame.h"
+#include "FactGroup.h"
+#include "FactMetaData.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(TelemetryFrameLog, "TelemetryFrameLog")
+
+TelemetryFrame::TelemetryFrame(QObject* parent)
+    : QObject(parent)
+{
+    _frameTimer.setSingleShot(false);
+    connect(&_frameTimer, &QTimer::timeout, this, &TelemetryFrame::_frameTimeout);
+    _clock.start();
+}
+
+TelemetryFrame::~TelemetryFrame()
+{
+    QList<FactGroup*> remainingGroups;
+
+    for (const Group_t& group: _groups) {
+        if (group.group) {
+            remainingGroups.append(group.group);
+        }
+    }
+    for (FactGroup* group: remainingGroups) {
+        removeGroup(group);
+    }
+
+    // Groups which outlive the frame (for example firmware plugin groups shared across vehicles) go back to publishing on their own
+    for (FactGroup* group: remainingGroups) {
+        group->_telemetryFrameDestroyed(this);
+    }
+}
+
+int TelemetryFrame::_groupIndex(FactGroup* group) const
+{
+    for (int i=0; i<_groups.count(); i++) {
+        if (_groups[i].group == group) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int TelemetryFrame::groupCount(void) const
+{
+    int count = 0;
+
+    for (const Group_t& group: _groups) {
+        if (group.group) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void TelemetryFrame::addGroup(FactGroup* group, int updateRateMsecs)
+{
+    if (_groupIndex(group) != -1) {
+        return;
+    }
+
+    Group_t newGroup;
+    newGroup.group              = group;
+    newGroup.updateRateMsecs    = updateRateMsecs;
+    newGroup.nextPublishMsecs   = _clock.elapsed() + updateRateMsecs;
+    _groups.append(newGroup);
+
+    _updateFrameInterval();
+}
+
+void TelemetryFrame::removeGroup(FactGroup* group)
+{
+    int groupIndex = _groupIndex(group);
+    if (groupIndex == -1) {
+        return;
+    }
+
+    // Slot and group indices stay stable, the entries are just cleared. Facts which are gone already freed their slot,
+    // so the ones left are alive even when this is called from the FactGroup destructor.
+    for (Slot_t& slot: _slots) {
+        if (slot.groupIndex == groupIndex && slot.fact) {
+            slot.fact->setTelemetryFrame(nullptr, -1);
+            slot.fact       = nullptr;
+            slot.pending    = false;
+        }
+    }
+    _groups[groupIndex].group = nullptr;
+    _groups[groupIndex].pendingSlots.clear();
+
+    _updateFrameInterval();
+}
+
+void TelemetryFrame::addFact(FactGroup* group, Fact* fact)
+{
+    int groupIndex = _groupIndex(group);
+    if (groupIndex == -1) {
+        qWarning() << "TelemetryFrame::addFact group not in frame" << fact->name();
+        return;
+    }
+
+    FactMetaData::ValueType_t type = fact->type();
+
+    Slot_t slot;
+    slot.fact       = fact;
+    slot.groupIndex = groupIndex;
+    slot.pending    = false;
+    slot.numeric    = type != FactMetaData::valueTypeString && type != FactMetaData::valueTypeCustom;
+    slot.metaType   = FactMetaData::typeToMetaType(type);
+    slot.back       = qQNaN();
+    slot.front      = qQNaN();
+
+    // The front buffer starts out with the value the fact already has
+    if (slot.numeric) {
+        slot.back = slot.front = fact->rawValue().toDouble();
+    } else {
+        slot.backVariant = slot.frontVariant = fact->rawValue();
+    }
+
+    int slotIndex = _slots.count();
+    _slots.append(slot);
+
+    fact->setTelemetryFrame(this, slotIndex);
+
+    // A value which arrived before the fact joined the frame still needs to be signalled
+    if (fact->deferredValueChangeSignal()) {
+        _queue(slotIndex);
+    }
+}
+
+void TelemetryFrame::removeFact(int slot)
+{
+    if (slot < 0 || slot >= _slots.count()) {
+        return;
+    }
+
+    Slot_t& frameSlot = _slots[slot];
+    if (frameSlot.pending) {
+        _groups[frameSlot.groupIndex].pendingSlots.removeOne(slot);
+    }
+    frameSlot.fact      = nullptr;
+    frameSlot.pending   = false;
+    frameSlot.backVariant.clear();
+    frameSlot.frontVariant.clear();
+}
+
+void TelemetryFrame::write(int slot, const QVariant& rawValue)
+{
+    if (slot < 0 || slot >= _slots.count()) {
+        return;
+    }
+
+    Slot_t& frameSlot = _slots[slot];
+    if (frameSlot.numeric) {
+        frameSlot.back = rawValue.toDouble();
+    } else {
+        frameSlot.backVariant = rawValue;
+    }
+    _queue(slot);
+}
+
+void TelemetryFrame::_queue(int slot)
+{
+    Slot_t& frameSlot = _slots[slot];
+    if (!frameSlot.pending && frameSlot.fact) {
+        frameSlot.pending = true;
+        _groups[frameSlot.groupIndex].pendingSlots.append(slot);
+    }
+}
+
+QVariant TelemetryFrame::value(int slot) const
+{
+    if (slot < 0 || slot >= _slots.count()) {
+        return QVariant();
+    }
+
+    const Slot_t& frameSlot = _slots[slot];
+    if (frameSlot.numeric) {
+        QVariant typedValue(frameSlot.front);
+        if (!qIsNaN(frameSlot.front)) {
+            typedValue.convert(frameSlot.metaType);
+        }
+        return typedValue;
+    }
+    return frameSlot.frontVariant;
+}
+
+double TelemetryFrame::valueDouble(int slot) const
+{
+    if (slot < 0 || slot >= _slots.count() || !_slots[slot].numeric) {
+        return qQNaN();
+    }
+    return _slots[slot].front;
+}
+
+bool TelemetryFrame::publishGroup(FactGroup* group)
+{
+    int groupIndex = _groupIndex(group);
+    if (groupIndex == -1) {
+        return false;
+    }
+
+    // Values written from within the signal handlers below are queued past this point and go out with the next publish
+    int pendingCount = _groups[groupIndex].pendingSlots.count();
+    if (pendingCount == 0) {
+        return false;
+    }
+
+    QVector<int> changedSlots = _groups[groupIndex].pendingSlots.mid(0, pendingCount);
+    _groups[groupIndex].pendingSlots.remove(0, pendingCount);
+    for (int slotIndex: changedSlots) {
+        Slot_t& frameSlot = _slots[slotIndex];
+        frameSlot.pending = false;
+        if (frameSlot.numeric) {
+            frameSlot.front = frameSlot.back;
+        } else {
+            frameSlot.frontVariant = frameSlot.backVariant;
+        }
+    }
+
+    // A handler may destroy a fact of the group, so each one is looked up again before it is signalled
+    for (int slotIndex: changedSlots) {
+        Fact* fact = _slots[slotIndex].fact;
+        if (fact) {
+            fact->sendDeferredValueChangedSignal();
+        }
+    }
+
+    return true;
+}
+
+void TelemetryFrame::_frameTimeout(void)
+{
+    qint64  now         = _clock.elapsed();
+    qint64  tolerance   = _frameTimer.interval() / 2;
+
+    // Indices are used since a group may add groups or facts to the frame while it is being published
+    for (int i=0; i<_groups.count(); i++) {
+        FactGroup* group = _groups[i].group;
+        if (!group || now + tolerance < _groups[i].nextPublishMsecs) {
+            continue;
+        }
+
+        _groups[i].nextPublishMsecs += _groups[i].updateRateMsecs;
+        if (_groups[i].nextPublishMsecs <= now) {
+            _groups[i].nextPublishMsecs = now + _groups[i].updateRateMsecs;
+        }
+
+        group->_updateAllValues();
+    }
+}
+
+void TelemetryFrame::_updateFrameInterval(void)
+{
+    int frameInterval = 0;
+
+    for (const Group_t& group: _groups) {
+        if (group.group && group.updateRateMsecs > 0) {
+            frameInterval = frameInterval == 0 ? group.updateRateMsecs : qMin(frameInterval, group.updateRateMsecs);
+        }
+    }
+
+    if (frameInterval == 0) {
+        _frameTimer.stop();
+    } else if (frameInterval != _frameTimer.interval() || !_frameTimer.isActive()) {
+        qCDebug(TelemetryFrameLog) << "Frame interval" << frameInterval << "groups:" << groupCount();
+        _frameTimer.start(frameInterval);
+    }
+}
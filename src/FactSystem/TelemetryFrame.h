@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QVariant>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryFrameLog)
+
+class Fact;
+class FactGroup;
+
+/// Double buffered telemetry store for a vehicle's FactGroup hierarchy.
+///
+/// Each Fact in an attached FactGroup owns one typed slot. Value changes on the receive path are written to the slot's
+/// back buffer and queued for the slot's group. A single frame timer publishes each group at its own update rate: the
+/// queued slots are copied to the front buffer and the group signals FactGroup::valuesChanged once. The UI reads the
+/// front buffer, so it sees a consistent snapshot of the group which does not change between publishes.
+///
+/// Numeric facts are held as doubles, all other types as QVariant.
+class TelemetryFrame : public QObject
+{
+    Q_OBJECT
+
+public:
+    TelemetryFrame(QObject* parent = nullptr);
+    ~TelemetryFrame();
+
+    /// Adds a group to the frame. Facts must then be added with addFact.
+    void addGroup   (FactGroup* group, int updateRateMsecs);
+    /// Removes the group and detaches its remaining facts from the frame
+    void removeGroup(FactGroup* group);
+
+    /// Allocates a slot for the fact. The fact queues its changes in the frame from then on.
+    void addFact    (FactGroup* group, Fact* fact);
+    /// Frees the slot of a fact which is going away
+    void removeFact (int slot);
+
+    /// Receive path: Writes the raw value to the back buffer and queues the slot for the next publish of its group
+    void write(int slot, const QVariant& rawValue);
+
+    /// @return Raw value of the slot as of its group's last publish
+    QVariant    value       (int slot) const;
+    /// @return Raw value of a numeric slot as of its group's last publish, NaN for non-numeric slots
+    double      valueDouble (int slot) const;
+
+    int slotCount   (void) const { return _slots.count(); }
+    int groupCount  (void) const;
+
+    /// Called by FactGroup::_updateAllValues to swap the changed slots of the group to the front buffer.
+    /// Facts which still hold back their valueChanged signal are signalled as well.
+    ///     @return true: at least one value of the group changed since its last publish
+    bool publishGroup(FactGroup* group);
+
+private slots:
+    void _frameTimeout(void);
+
+private:
+    typedef struct {
+        FactGroup*      group;
+        int             updateRateMsecs;
+        qint64          nextPublishMsecs;
+        QVector<int>    pendingSlots;
+    } Group_t;
+
+    typedef struct {
+        Fact*       fact;
+        int         groupIndex;
+        bool        pending;
+        bool        numeric;
+        int         metaType;
+        double      back;
+        double      front;
+        QVariant    backVariant;
+        QVariant    frontVariant;
+    } Slot_t;
+
+    int     _groupIndex         (FactGroup* group) const;
+    void    _queue              (int slot);
+    void    _updateFrameInterval(void);
+
+    QVector<Group_t>    _groups;
+    QVector<Slot_t>     _slots;
+    QTimer              _frameTimer;
+    QElapsedTimer       _clock;
+};
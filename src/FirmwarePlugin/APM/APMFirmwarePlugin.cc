@@ -809,6 +809,15 @@ QObject* APMFirmwarePlugin::_loadParameterMetaData(const QString& metaDataFile)
     return metaData;
 }
 
+QString APMFirmwarePlugin::parameterFileFTPPath(Vehicle* vehicle)
+{
+    // ArduPilot 4.1 and above serve the full parameter set as a packed file through the @PARAM virtual directory
+    if ((vehicle->capabilityBits() & MAV_PROTOCOL_CAPABILITY_FTP) && vehicle->versionCompare(4, 1, 0) >= 0) {
+        return QStringLiteral("@PARAM/param.pck");
+    }
+    return QString();
+}
+
 bool APMFirmwarePlugin::isGuidedMode(const Vehicle* vehicle) const
 {
     return vehicle->flightMode() == "Guided";
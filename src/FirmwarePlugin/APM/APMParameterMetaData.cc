@@ -17,6 +17,7 @@
 #include <QDir>
 #include <QDebug>
 #include <QStack>
+#include <QElapsedTimer>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
@@ -143,28 +144,44 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
-    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
-    QString currentCategory;
-
     qCDebug(APMParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
-    QFile xmlFile(metaDataFile);
-    Q_ASSERT(xmlFile.exists());
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+
+    QByteArray xmlBytes;
+    if (_metaDataCache.open(metaDataFile, _parserVersion, xmlBytes)) {
+        qCDebug(APMParameterMetaDataLog) << "Parameter meta data loaded from compiled cache msecs:" << loadTimer.elapsed();
+        return;
+    }
+    if (xmlBytes.isEmpty()) {
+        qCWarning(APMParameterMetaDataLog) << "Unable to read parameter meta data file" << metaDataFile;
+        return;
+    }
+
+    QList<ParameterMetaDataCache::Record_t> records;
+    _parseMetaDataXml(xmlBytes, records);
+    _metaDataCache.setRecords(records);
+    qCDebug(APMParameterMetaDataLog) << "Parameter meta data parsed and compiled count:msecs" << records.count() << loadTimer.elapsed();
+}
 
-    bool success = xmlFile.open(QIODevice::ReadOnly);
-    Q_UNUSED(success);
-    Q_ASSERT(success);
+/// Parses the meta data xml into raw string records, section is the vehicle type or libraries. Conversion and
+/// validation of the values is done when the FactMetaData is created from the record.
+void APMParameterMetaData::_parseMetaDataXml(const QByteArray& xmlBytes, QList<ParameterMetaDataCache::Record_t>& records)
+{
+    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
+    QString currentCategory;
 
-    QXmlStreamReader xml(xmlFile.readAll());
-    xmlFile.close();
+    QXmlStreamReader xml(xmlBytes);
     if (xml.hasError()) {
         qCWarning(APMParameterMetaDataLog) << "Badly formed XML, reading failed: " << xml.errorString();
         return;
     }
 
-    bool                badMetaData = true;
-    QStack<int>         xmlState;
-    APMFactMetaDataRaw* rawMetaData = nullptr;
+    bool                                badMetaData = true;
+    QStack<int>                         xmlState;
+    ParameterMetaDataCache::Record_t*   rawMetaData = nullptr;
+    QMap<QString, QMap<QString, int>>   recordIndex;    ///< Category to parameter name to index in records
 
     xmlState.push(XmlStateNone);
 
@@ -253,22 +270,24 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                           << "group: " << group;
 
                 Q_ASSERT(!rawMetaData);
-                if (_vehicleTypeToParametersMap[currentCategory].contains(name)) {
+                if (recordIndex[currentCategory].contains(name)) {
                     qCDebug(APMParameterMetaDataLog) << "Duplicate parameter found:" << name;
-                    rawMetaData = _vehicleTypeToParametersMap[currentCategory][name];
+                    rawMetaData = &records[recordIndex[currentCategory][name]];
                 } else {
-                    rawMetaData = new APMFactMetaDataRaw(this);
-                    _vehicleTypeToParametersMap[currentCategory][name] = rawMetaData;
+                    recordIndex[currentCategory][name] = records.count();
+                    records.append(ParameterMetaDataCache::Record_t());
+                    rawMetaData = &records.last();
                     groupMembers[group] << name;
                 }
                 qCDebug(APMParameterMetaDataVerboseLog) << "inserting metadata for field" << name;
+                rawMetaData->section = currentCategory;
                 rawMetaData->name = name;
                 if (!category.isEmpty()) {
-                    rawMetaData->category = category;
+                    rawMetaData->fields[ParameterMetaDataCache::FieldCategory] = category;
                 }
-                rawMetaData->group = group;
-                rawMetaData->shortDescription = shortDescription;
-                rawMetaData->longDescription = longDescription;
+                rawMetaData->fields[ParameterMetaDataCache::FieldGroup] = group;
+                rawMetaData->fields[ParameterMetaDataCache::FieldShortDescription] = shortDescription;
+                rawMetaData->fields[ParameterMetaDataCache::FieldLongDescription] = longDescription;
             } else {
                 // We should be getting meta data now
                 if (xmlState.top() != XmlStateFoundParameter) {
@@ -295,7 +314,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 xmlState.pop();
             } else if (elementName == "parameters") {
                 qCDebug(APMParameterMetaDataVerboseLog) << "end of parameters for category: " << currentCategory;
-                correctGroupMemberships(_vehicleTypeToParametersMap[currentCategory], groupMembers);
+                correctGroupMemberships(records, recordIndex[currentCategory], groupMembers);
                 groupMembers.clear();
                 xmlState.pop();
             } else if (elementName == "vehicles") {
@@ -307,13 +326,13 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
 }
 
-void APMParameterMetaData::correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap,
+void APMParameterMetaData::correctGroupMemberships(QList<ParameterMetaDataCache::Record_t>& records, QMap<QString, int>& recordIndex,
                                                    QMap<QString,QStringList>& groupMembers)
 {
     foreach(const QString& groupName, groupMembers.keys()) {
             if (groupMembers[groupName].count() == 1) {
                 foreach(const QString& parameter, groupMembers.value(groupName)) {
-                    parameterToFactMetaDataMap[parameter]->group = FactMetaData::defaultGroup();
+                    records[recordIndex[parameter]].fields[ParameterMetaDataCache::FieldGroup] = FactMetaData::defaultGroup();
                 }
             }
         }
@@ -329,10 +348,13 @@ bool APMParameterMetaData::skipXMLBlock(QXmlStreamReader& xml, const QString& bl
     return !xml.isEndDocument();
 }
 
-bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw* rawMetaData)
+bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, ParameterMetaDataCache::Record_t* rawMetaData)
 {
     QString elementName = xml.name().toString();
     QList<QPair<QString,QString> > values;
+    QList<QPair<QString,QString> > bitmask;
+    QString& min = rawMetaData->fields[ParameterMetaDataCache::FieldMin];
+    QString& max = rawMetaData->fields[ParameterMetaDataCache::FieldMax];
     // as long as param doens't end
     while (!(elementName == "param" && xml.isEndElement())) {
         if (elementName.isEmpty()) {
@@ -357,27 +379,27 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
 
                 // everything should be good. lets collect min and max
                 if (rangeList.count() == 2) {
-                    rawMetaData->min = rangeList.first().trimmed();
-                    rawMetaData->max = rangeList.last().trimmed();
+                    min = rangeList.first().trimmed();
+                    max = rangeList.last().trimmed();
 
                     // sanitize min and max off any comments that they may have
-                    if (rawMetaData->min.contains(' ')) {
-                        rawMetaData->min = rawMetaData->min.split(' ').first();
+                    if (min.contains(' ')) {
+                        min = min.split(' ').first();
                     }
-                    if(rawMetaData->max.contains(' ')) {
-                        rawMetaData->max = rawMetaData->max.split(' ').first();
+                    if(max.contains(' ')) {
+                        max = max.split(' ').first();
                     }
-                    qCDebug(APMParameterMetaDataVerboseLog) << "read field parameter " << "min: " << rawMetaData->min
-                                                     << "max: " << rawMetaData->max;
+                    qCDebug(APMParameterMetaDataVerboseLog) << "read field parameter " << "min: " << min
+                                                     << "max: " << max;
                 }
             } else if (attributeName == "Increment") {
                 QString increment = xml.readElementText();
                 qCDebug(APMParameterMetaDataVerboseLog) << "read Increment: " << increment;
-                rawMetaData->incrementSize = increment;
+                rawMetaData->fields[ParameterMetaDataCache::FieldIncrement] = increment;
             } else if (attributeName == "Units") {
                 QString units = xml.readElementText();
                 qCDebug(APMParameterMetaDataVerboseLog) << "read Units: " << units;
-                rawMetaData->units = units;
+                rawMetaData->fields[ParameterMetaDataCache::FieldUnits] = units;
             } else if (attributeName == "Bitmask") {
                 bool    parseError = false;
 
@@ -388,7 +410,7 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
                     foreach (const QString& bitmask, bitmaskList) {
                         QStringList pair = bitmask.split(":");
                         if (pair.count() == 2) {
-                            rawMetaData->bitmask << QPair<QString, QString>(pair[0], pair[1]);
+                            bitmask << QPair<QString, QString>(pair[0], pair[1]);
                         } else {
                             qCDebug(APMParameterMetaDataLog) << "parse error: bitmask:" << bitmaskString << "pair count:" << pair.count();
                             parseError = true;
@@ -398,12 +420,13 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
                 }
 
                 if (parseError) {
-                    rawMetaData->bitmask.clear();
+                    bitmask.clear();
                 }
+                rawMetaData->fields[ParameterMetaDataCache::FieldBitmask] = ParameterMetaDataCache::encodePairs(bitmask);
             } else if (attributeName == "RebootRequired") {
                 QString strValue = xml.readElementText().trimmed();
                 if (strValue.compare("true", Qt::CaseInsensitive) == 0) {
-                    rawMetaData->rebootRequired = true;
+                    rawMetaData->flags |= ParameterMetaDataCache::FlagRebootRequired;
                 }
             }
         } else if (elementName == "values") {
@@ -414,7 +437,7 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
             qCDebug(APMParameterMetaDataVerboseLog) << "read value parameter " << "value desc: "
                                              << valueName << "code: " << valueValue;
             values << QPair<QString,QString>(valueValue, valueName);
-            rawMetaData->values = values;
+            rawMetaData->fields[ParameterMetaDataCache::FieldValues] = ParameterMetaDataCache::encodePairs(values);
         } else {
             qCWarning(APMParameterMetaDataLog) << "Unknown parameter element in XML: " << elementName;
         }
@@ -427,76 +450,82 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
 FactMetaData* APMParameterMetaData::getMetaDataForFact(const QString& name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type)
 {
     const QString mavTypeString = mavTypeToString(vehicleType);
-    APMFactMetaDataRaw* rawMetaData = nullptr;
+    ParameterMetaDataCache::Record_t record;
 
     // check if we have metadata for fact, use generic otherwise
-    if (_vehicleTypeToParametersMap[mavTypeString].contains(name)) {
-        rawMetaData = _vehicleTypeToParametersMap[mavTypeString][name];
-    } else if (_vehicleTypeToParametersMap["libraries"].contains(name)) {
-        rawMetaData = _vehicleTypeToParametersMap["libraries"][name];
-    }
+    bool found = _metaDataCache.find(mavTypeString, name, record) || _metaDataCache.find(QStringLiteral("libraries"), name, record);
 
     FactMetaData *metaData = new FactMetaData(type, this);
 
     // we don't have data for this fact
-    if (!rawMetaData) {
+    if (!found) {
         metaData->setCategory(QStringLiteral("Advanced"));
         metaData->setGroup(_groupFromParameterName(name));
         qCDebug(APMParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
         return metaData;
     }
 
-    metaData->setName(rawMetaData->name);
-    if (!rawMetaData->category.isEmpty()) {
-        metaData->setCategory(rawMetaData->category);
+    const QString&                  category            = record.fields[ParameterMetaDataCache::FieldCategory];
+    const QString&                  shortDescription    = record.fields[ParameterMetaDataCache::FieldShortDescription];
+    const QString&                  longDescription     = record.fields[ParameterMetaDataCache::FieldLongDescription];
+    const QString&                  units               = record.fields[ParameterMetaDataCache::FieldUnits];
+    const QString&                  min                 = record.fields[ParameterMetaDataCache::FieldMin];
+    const QString&                  max                 = record.fields[ParameterMetaDataCache::FieldMax];
+    const QString&                  incrementSize       = record.fields[ParameterMetaDataCache::FieldIncrement];
+    QList<QPair<QString, QString>>  values              = ParameterMetaDataCache::decodePairs(record.fields[ParameterMetaDataCache::FieldValues]);
+    QList<QPair<QString, QString>>  bitmask             = ParameterMetaDataCache::decodePairs(record.fields[ParameterMetaDataCache::FieldBitmask]);
+
+    metaData->setName(record.name);
+    if (!category.isEmpty()) {
+        metaData->setCategory(category);
     }
-    metaData->setGroup(rawMetaData->group);
-    metaData->setVehicleRebootRequired(rawMetaData->rebootRequired);
+    metaData->setGroup(record.fields[ParameterMetaDataCache::FieldGroup]);
+    metaData->setVehicleRebootRequired(record.flags & ParameterMetaDataCache::FlagRebootRequired);
 
-    if (!rawMetaData->shortDescription.isEmpty()) {
-        metaData->setShortDescription(rawMetaData->shortDescription);
+    if (!shortDescription.isEmpty()) {
+        metaData->setShortDescription(shortDescription);
     }
 
-    if (!rawMetaData->longDescription.isEmpty()) {
-        metaData->setLongDescription(rawMetaData->longDescription);
+    if (!longDescription.isEmpty()) {
+        metaData->setLongDescription(longDescription);
     }
 
-    if (!rawMetaData->units.isEmpty()) {
-        metaData->setRawUnits(rawMetaData->units);
+    if (!units.isEmpty()) {
+        metaData->setRawUnits(units);
     }
 
-    if (!rawMetaData->min.isEmpty()) {
+    if (!min.isEmpty()) {
         QVariant varMin;
         QString errorString;
-        if (metaData->convertAndValidateRaw(rawMetaData->min, false /* validate as well */, varMin, errorString)) {
+        if (metaData->convertAndValidateRaw(min, false /* validate as well */, varMin, errorString)) {
             metaData->setRawMin(varMin);
         } else {
             qCDebug(APMParameterMetaDataLog) << "Invalid min value, name:" << metaData->name()
-                                             << " type:" << metaData->type() << " min:" << rawMetaData->min
+                                             << " type:" << metaData->type() << " min:" << min
                                              << " error:" << errorString;
         }
     }
 
-    if (!rawMetaData->max.isEmpty()) {
+    if (!max.isEmpty()) {
         QVariant varMax;
         QString errorString;
-        if (metaData->convertAndValidateRaw(rawMetaData->max, false /* validate as well */, varMax, errorString)) {
+        if (metaData->convertAndValidateRaw(max, false /* validate as well */, varMax, errorString)) {
             metaData->setRawMax(varMax);
         } else {
             qCDebug(APMParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:"
-                                             << metaData->type() << " max:" << rawMetaData->max
+                                             << metaData->type() << " max:" << max
                                              << " error:" << errorString;
         }
     }
 
-    if (rawMetaData->values.count() > 0) {
+    if (values.count() > 0) {
         QStringList     enumStrings;
         QVariantList    enumValues;
 
-        for (int i=0; i<rawMetaData->values.count(); i++) {
+        for (int i=0; i<values.count(); i++) {
             QVariant    enumValue;
             QString     errorString;
-            QPair<QString, QString> enumPair = rawMetaData->values[i];
+            QPair<QString, QString> enumPair = values[i];
 
             if (metaData->convertAndValidateRaw(enumPair.first, false /* validate */, enumValue, errorString)) {
                 enumValues << enumValue;
@@ -516,14 +545,14 @@ FactMetaData* APMParameterMetaData::getMetaDataForFact(const QString& name, MAV_
         }
     }
 
-    if (rawMetaData->bitmask.count() > 0) {
+    if (bitmask.count() > 0) {
         QStringList     bitmaskStrings;
         QVariantList    bitmaskValues;
 
-        for (int i=0; i<rawMetaData->bitmask.count(); i++) {
+        for (int i=0; i<bitmask.count(); i++) {
             QVariant    bitmaskValue;
             QString     errorString;
-            QPair<QString, QString> bitmaskPair = rawMetaData->bitmask[i];
+            QPair<QString, QString> bitmaskPair = bitmask[i];
 
             bool ok = false;
             unsigned int bitSet = bitmaskPair.first.toUInt(&ok);
@@ -587,14 +616,14 @@ FactMetaData* APMParameterMetaData::getMetaDataForFact(const QString& name, MAV_
         }
     }
 
-    if (!rawMetaData->incrementSize.isEmpty()) {
+    if (!incrementSize.isEmpty()) {
         double  increment;
         bool    ok;
-        increment = rawMetaData->incrementSize.toDouble(&ok);
+        increment = incrementSize.toDouble(&ok);
         if (ok) {
             metaData->setRawIncrement(increment);
         } else {
-            qCDebug(APMParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData->incrementSize;
+            qCDebug(APMParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << incrementSize;
         }
     }
 
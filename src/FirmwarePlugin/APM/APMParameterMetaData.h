@@ -18,39 +18,14 @@
 #include <QLoggingCategory>
 
 #include "FactSystem.h"
+#include "ParameterMetaDataCache.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
 
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataLog)
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog)
 
-class APMFactMetaDataRaw : public QObject
-{
-    Q_OBJECT
-public:
-    APMFactMetaDataRaw(QObject *parent = nullptr)
-        : QObject(parent), rebootRequired(false)
-    { }
-
-    QString name;
-    QString category;
-    QString group;
-    QString shortDescription;
-    QString longDescription;
-    QString min;
-    QString max;
-    QString incrementSize;
-    QString units;
-    bool    rebootRequired;
-    QList<QPair<QString, QString> > values;
-    QList<QPair<QString, QString> > bitmask;
-};
-
-
-/// Collection of Parameter Facts for PX4 AutoPilot
-
-typedef QMap<QString, APMFactMetaDataRaw*> ParameterNametoFactMetaDataMap;
-
+/// Collection of Parameter Facts for ArduPilot
 class APMParameterMetaData : public QObject
 {
     Q_OBJECT
@@ -77,15 +52,17 @@ private:
     };    
 
     QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    void _parseMetaDataXml(const QByteArray& xmlBytes, QList<ParameterMetaDataCache::Record_t>& records);
     bool skipXMLBlock(QXmlStreamReader& xml, const QString& blockName);
-    bool parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw *rawMetaData);
-    void correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap, QMap<QString,QStringList>& groupMembers);
+    bool parseParameterAttributes(QXmlStreamReader& xml, ParameterMetaDataCache::Record_t* rawMetaData);
+    void correctGroupMemberships(QList<ParameterMetaDataCache::Record_t>& records, QMap<QString, int>& recordIndex, QMap<QString,QStringList>& groupMembers);
     QString mavTypeToString(MAV_TYPE vehicleTypeEnum);
     QString _groupFromParameterName(const QString& name);
 
-    bool                                            _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
-    // FIXME: metadata is vehicle type specific now
-    QMap<QString, ParameterNametoFactMetaDataMap>   _vehicleTypeToParametersMap;                ///< Maps from a vehicle type to paramametertoFactMeta map>
+    bool                    _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
+    ParameterMetaDataCache  _metaDataCache;                             ///< Compiled meta data records, section is the vehicle type or "libraries"
+
+    static const int        _parserVersion                  = 1;        ///< Bump when parsing changes the content of the compiled records
 };
 
 #endif
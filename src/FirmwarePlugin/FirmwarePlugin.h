@@ -256,6 +256,10 @@ public:
     /// Return the resource file which contains the set of params loaded for offline editing.
     virtual QString offlineEditingParamFile(Vehicle* /*vehicle*/) { return QString(); }
 
+    /// Return the MAVLink FTP path of the packed parameter file which allows the full parameter set to be downloaded
+    /// in bulk. Empty string if the firmware does not provide one, in which case PARAM_REQUEST_LIST is used.
+    virtual QString parameterFileFTPPath(Vehicle* /*vehicle*/) { return QString(); }
+
     /// Return the resource file which contains the brand image for the vehicle for Indoor theme.
     virtual QString brandImageIndoor(const Vehicle* /*vehicle*/) const { return QString(); }
 
@@ -19,6 +19,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QElapsedTimer>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
@@ -90,49 +91,65 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
 
     qCDebug(PX4ParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
-    QFile xmlFile(metaDataFile);
+    QElapsedTimer loadTimer;
+    loadTimer.start();
 
-    if (!xmlFile.exists()) {
-        qWarning() << "Internal error: metaDataFile mission" << metaDataFile;
+    QByteArray xmlBytes;
+    if (_metaDataCache.open(metaDataFile, _parserVersion, xmlBytes)) {
+        qCDebug(PX4ParameterMetaDataLog) << "Parameter meta data loaded from compiled cache msecs:" << loadTimer.elapsed();
         return;
     }
-    
-    if (!xmlFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Internal error: Unable to open parameter file:" << metaDataFile << xmlFile.errorString();
+    if (xmlBytes.isEmpty()) {
+        qWarning() << "Internal error: Unable to open parameter file:" << metaDataFile;
         return;
     }
-    
-    QXmlStreamReader xml(xmlFile.readAll());
-    xmlFile.close();
+
+    QList<ParameterMetaDataCache::Record_t> records;
+    _parseMetaDataXml(metaDataFile, xmlBytes, records);
+    _metaDataCache.setRecords(records);
+    qCDebug(PX4ParameterMetaDataLog) << "Parameter meta data parsed and compiled count:msecs" << records.count() << loadTimer.elapsed();
+
+#ifdef GENERATE_PARAMETER_JSON
+    _generateParameterJson(records);
+#endif
+}
+
+/// Parses the meta data xml into raw string records. Conversion and validation of the values is done when the
+/// FactMetaData is created from the record.
+void PX4ParameterMetaData::_parseMetaDataXml(const QString& metaDataFile, const QByteArray& xmlBytes, QList<ParameterMetaDataCache::Record_t>& records)
+{
+    QXmlStreamReader xml(xmlBytes);
     if (xml.hasError()) {
         qWarning() << "Badly formed XML" << xml.errorString();
         return;
     }
-    
-    QString         factGroup;
-    QString         errorString;
-    FactMetaData*   metaData = nullptr;
-    int             xmlState = XmlStateNone;
-    bool            badMetaData = true;
-    
+
+    QString                             factGroup;
+    ParameterMetaDataCache::Record_t*   record = nullptr;
+    QMap<QString, int>                  recordIndex;    ///< Parameter name to index in records
+    QList<QPair<QString, QString>>      values;
+    QList<QPair<QString, QString>>      bitmask;
+    int                                 xmlState = XmlStateNone;
+    bool                                badMetaData = true;
+
     while (!xml.atEnd()) {
         if (xml.isStartElement()) {
             QString elementName = xml.name().toString();
-            
+
             if (elementName == "parameters") {
                 if (xmlState != XmlStateNone) {
                     qWarning() << "Badly formed XML";
                     return;
                 }
                 xmlState = XmlStateFoundParameters;
-                
+
             } else if (elementName == "version") {
                 if (xmlState != XmlStateFoundParameters) {
                     qWarning() << "Badly formed XML";
                     return;
                 }
                 xmlState = XmlStateFoundVersion;
-                
+
                 bool convertOk;
                 QString strVersion = xml.readElementText();
                 int intVersion = strVersion.toInt(&convertOk);
@@ -145,7 +162,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     qDebug() << "Parameter version stamp too old, skipping load. Found:" << intVersion << "Want: 3 File:" << metaDataFile;
                     return;
                 }
-                
+
             } else if (elementName == "parameter_version_major") {
                 // Just skip over for now
             } else if (elementName == "parameter_version_minor") {
@@ -158,30 +175,30 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     return;
                 }
                 xmlState = XmlStateFoundGroup;
-                
+
                 if (!xml.attributes().hasAttribute("name")) {
                     qWarning() << "Badly formed XML";
                     return;
                 }
                 factGroup = xml.attributes().value("name").toString();
                 qCDebug(PX4ParameterMetaDataLog) << "Found group: " << factGroup;
-                
+
             } else if (elementName == "parameter") {
                 if (xmlState != XmlStateFoundGroup) {
                     qWarning() << "Badly formed XML";
                     return;
                 }
                 xmlState = XmlStateFoundParameter;
-                
+
                 if (!xml.attributes().hasAttribute("name") || !xml.attributes().hasAttribute("type")) {
                     qWarning() << "Badly formed XML";
                     return;
                 }
-                
+
                 QString name = xml.attributes().value("name").toString();
                 QString type = xml.attributes().value("type").toString();
                 QString strDefault =    xml.attributes().value("default").toString();
-                
+
                 QString category = xml.attributes().value("category").toString();
                 if (category.isEmpty()) {
                     category = QStringLiteral("Standard");
@@ -210,34 +227,36 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     qWarning() << "Parameter meta data with bad type:" << type << " name:" << name;
                     return;
                 }
-                
-                // Now that we know type we can create meta data object and add it to the system
-                metaData = new FactMetaData(foundType, this);
-                if (_mapParameterName2FactMetaData.contains(name)) {
+
+                // Now that we know type we can create the record for it
+                ParameterMetaDataCache::Record_t newRecord;
+                newRecord.name = name;
+                newRecord.type = foundType;
+                if (recordIndex.contains(name)) {
                     // We can't trust the meta data since we have dups
                     qCWarning(PX4ParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     badMetaData = true;
                     // Reset to default meta data
-                    _mapParameterName2FactMetaData[name] = metaData;
+                    newRecord.flags = ParameterMetaDataCache::FlagDuplicate;
+                    records[recordIndex[name]] = newRecord;
+                    record = &records[recordIndex[name]];
                 } else {
-                    _mapParameterName2FactMetaData[name] = metaData;
-                    metaData->setName(name);
-                    metaData->setCategory(category);
-                    metaData->setGroup(factGroup);
-                    metaData->setReadOnly(readOnly);
-                    metaData->setVolatileValue(volatileValue);
-                    
-                    if (xml.attributes().hasAttribute("default") && !strDefault.isEmpty()) {
-                        QVariant varDefault;
-                        
-                        if (metaData->convertAndValidateRaw(strDefault, false, varDefault, errorString)) {
-                            metaData->setRawDefaultValue(varDefault);
-                        } else {
-                            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << type << " default:" << strDefault << " error:" << errorString;
-                        }
+                    recordIndex[name] = records.count();
+                    records.append(newRecord);
+                    record = &records.last();
+                    record->fields[ParameterMetaDataCache::FieldCategory]   = category;
+                    record->fields[ParameterMetaDataCache::FieldGroup]      = factGroup;
+                    record->fields[ParameterMetaDataCache::FieldDefault]    = strDefault;
+                    if (readOnly) {
+                        record->flags |= ParameterMetaDataCache::FlagReadOnly;
+                    }
+                    if (volatileValue) {
+                        record->flags |= ParameterMetaDataCache::FlagVolatile;
                     }
                 }
-                
+                values.clear();
+                bitmask.clear();
+
             } else {
                 // We should be getting meta data now
                 if (xmlState != XmlStateFoundParameter) {
@@ -246,63 +265,44 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 }
 
                 if (!badMetaData) {
-                    if (metaData) {
+                    if (record) {
                         if (elementName == "short_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Short description:" << text;
-                            metaData->setShortDescription(text);
+                            record->fields[ParameterMetaDataCache::FieldShortDescription] = text;
 
                         } else if (elementName == "long_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Long description:" << text;
-                            metaData->setLongDescription(text);
+                            record->fields[ParameterMetaDataCache::FieldLongDescription] = text;
 
                         } else if (elementName == "min") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Min:" << text;
-
-                            QVariant varMin;
-                            if (metaData->convertAndValidateRaw(text, false /* convertOnly */, varMin, errorString)) {
-                                metaData->setRawMin(varMin);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << text << " error:" << errorString;
-                            }
+                            record->fields[ParameterMetaDataCache::FieldMin] = text;
 
                         } else if (elementName == "max") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Max:" << text;
-
-                            QVariant varMax;
-                            if (metaData->convertAndValidateRaw(text, false /* convertOnly */, varMax, errorString)) {
-                                metaData->setRawMax(varMax);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << text << " error:" << errorString;
-                            }
+                            record->fields[ParameterMetaDataCache::FieldMax] = text;
 
                         } else if (elementName == "unit") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Unit:" << text;
-                            metaData->setRawUnits(text);
+                            record->fields[ParameterMetaDataCache::FieldUnits] = text;
 
                         } else if (elementName == "decimal") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Decimal:" << text;
-
-                            bool convertOk;
-                            QVariant varDecimals = QVariant(text).toUInt(&convertOk);
-                            if (convertOk) {
-                                metaData->setDecimalPlaces(varDecimals.toInt());
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << text << " error: invalid number";
-                            }
+                            record->fields[ParameterMetaDataCache::FieldDecimalPlaces] = text;
 
                         } else if (elementName == "reboot_required") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "RebootRequired:" << text;
                             if (text.compare("true", Qt::CaseInsensitive) == 0) {
-                                metaData->setVehicleRebootRequired(true);
+                                record->flags |= ParameterMetaDataCache::FlagRebootRequired;
                             }
 
                         } else if (elementName == "values") {
@@ -313,60 +313,27 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QString enumString = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
                                                              << "value desc:" << enumString << "code:" << enumValueStr;
+                            values.append(qMakePair(enumValueStr, enumString));
+                            record->fields[ParameterMetaDataCache::FieldValues] = ParameterMetaDataCache::encodePairs(values);
 
-                            QVariant    enumValue;
-                            QString     errorString;
-                            if (metaData->convertAndValidateRaw(enumValueStr, false /* validate */, enumValue, errorString)) {
-                                metaData->addEnumInfo(enumString, enumValue);
-                            } else {
-                                qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
-                                                                 << " type:" << metaData->type() << " value:" << enumValueStr
-                                                                 << " error:" << errorString;
-                            }
                         } else if (elementName == "increment") {
-                            double  increment;
-                            bool    ok;
                             QString text = xml.readElementText();
-                            increment = text.toDouble(&ok);
-                            if (ok) {
-                                metaData->setRawIncrement(increment);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << text;
-                            }
+                            record->fields[ParameterMetaDataCache::FieldIncrement] = text;
 
                         } else if (elementName == "boolean") {
-                            QVariant    enumValue;
-                            metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Enabled"), enumValue);
-                            metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Disabled"), enumValue);
+                            record->flags |= ParameterMetaDataCache::FlagBoolean;
 
                         } else if (elementName == "bitmask") {
                             // doing nothing individual bits will follow anyway. May be used for sanity checking.
 
                         } else if (elementName == "bit") {
-                            bool ok = false;
-                            unsigned char bit = xml.attributes().value("index").toString().toUInt(&ok);
-                            if (ok) {
-                                QString bitDescription = xml.readElementText();
-                                qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
-                                                                 << "index:" << bit << "description:" << bitDescription;
-
-                                if (bit < 31) {
-                                    QVariant bitmaskRawValue = 1 << bit;
-                                    QVariant bitmaskValue;
-                                    QString errorString;
-                                    if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
-                                        metaData->addBitmaskInfo(bitDescription, bitmaskValue);
-                                    } else {
-                                        qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
-                                                                         << " type:" << metaData->type() << " value:" << bitmaskValue
-                                                                         << " error:" << errorString;
-                                    }
-                                } else {
-                                    qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
-                                }
-                            }
+                            QString bitIndex = xml.attributes().value("index").toString();
+                            QString bitDescription = xml.readElementText();
+                            qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
+                                                             << "index:" << bitIndex << "description:" << bitDescription;
+                            bitmask.append(qMakePair(bitIndex, bitDescription));
+                            record->fields[ParameterMetaDataCache::FieldBitmask] = ParameterMetaDataCache::encodePairs(bitmask);
+
                         } else {
                             qCDebug(PX4ParameterMetaDataLog) << "Unknown element in XML: " << elementName;
                         }
@@ -379,17 +346,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             QString elementName = xml.name().toString();
 
             if (elementName == "parameter") {
-                // Done loading this parameter, validate default value
-                if (metaData->defaultValueAvailable()) {
-                    QVariant var;
-
-                    if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
-                        qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
-                    }
-                }
-
                 // Reset for next parameter
-                metaData = nullptr;
+                record = nullptr;
                 badMetaData = false;
                 xmlState = XmlStateFoundGroup;
             } else if (elementName == "group") {
@@ -400,10 +358,137 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         }
         xml.readNext();
     }
+}
+
+/// Creates the FactMetaData for a parameter from its raw record, converting and validating the values
+FactMetaData* PX4ParameterMetaData::_createMetaData(const ParameterMetaDataCache::Record_t& record)
+{
+    FactMetaData*   metaData = new FactMetaData(static_cast<FactMetaData::ValueType_t>(record.type), this);
+    QString         errorString;
+
+    if (record.flags & ParameterMetaDataCache::FlagDuplicate) {
+        return metaData;
+    }
 
-#ifdef GENERATE_PARAMETER_JSON
-    _generateParameterJson();
-#endif
+    metaData->setName(record.name);
+    metaData->setCategory(record.fields[ParameterMetaDataCache::FieldCategory]);
+    metaData->setGroup(record.fields[ParameterMetaDataCache::FieldGroup]);
+    metaData->setReadOnly(record.flags & ParameterMetaDataCache::FlagReadOnly);
+    metaData->setVolatileValue(record.flags & ParameterMetaDataCache::FlagVolatile);
+    metaData->setVehicleRebootRequired(record.flags & ParameterMetaDataCache::FlagRebootRequired);
+
+    const QString& strDefault = record.fields[ParameterMetaDataCache::FieldDefault];
+    if (!strDefault.isEmpty()) {
+        QVariant varDefault;
+        if (metaData->convertAndValidateRaw(strDefault, false, varDefault, errorString)) {
+            metaData->setRawDefaultValue(varDefault);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << record.name << " type:" << record.type << " default:" << strDefault << " error:" << errorString;
+        }
+    }
+
+    if (!record.fields[ParameterMetaDataCache::FieldShortDescription].isEmpty()) {
+        metaData->setShortDescription(record.fields[ParameterMetaDataCache::FieldShortDescription]);
+    }
+    if (!record.fields[ParameterMetaDataCache::FieldLongDescription].isEmpty()) {
+        metaData->setLongDescription(record.fields[ParameterMetaDataCache::FieldLongDescription]);
+    }
+
+    const QString& strMin = record.fields[ParameterMetaDataCache::FieldMin];
+    if (!strMin.isEmpty()) {
+        QVariant varMin;
+        if (metaData->convertAndValidateRaw(strMin, false /* convertOnly */, varMin, errorString)) {
+            metaData->setRawMin(varMin);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << strMin << " error:" << errorString;
+        }
+    }
+
+    const QString& strMax = record.fields[ParameterMetaDataCache::FieldMax];
+    if (!strMax.isEmpty()) {
+        QVariant varMax;
+        if (metaData->convertAndValidateRaw(strMax, false /* convertOnly */, varMax, errorString)) {
+            metaData->setRawMax(varMax);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << strMax << " error:" << errorString;
+        }
+    }
+
+    if (!record.fields[ParameterMetaDataCache::FieldUnits].isEmpty()) {
+        metaData->setRawUnits(record.fields[ParameterMetaDataCache::FieldUnits]);
+    }
+
+    const QString& strDecimals = record.fields[ParameterMetaDataCache::FieldDecimalPlaces];
+    if (!strDecimals.isEmpty()) {
+        bool convertOk;
+        QVariant varDecimals = QVariant(strDecimals).toUInt(&convertOk);
+        if (convertOk) {
+            metaData->setDecimalPlaces(varDecimals.toInt());
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << strDecimals << " error: invalid number";
+        }
+    }
+
+    for (const auto& value: ParameterMetaDataCache::decodePairs(record.fields[ParameterMetaDataCache::FieldValues])) {
+        QVariant enumValue;
+        if (metaData->convertAndValidateRaw(value.first, false /* validate */, enumValue, errorString)) {
+            metaData->addEnumInfo(value.second, enumValue);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
+                                             << " type:" << metaData->type() << " value:" << value.first
+                                             << " error:" << errorString;
+        }
+    }
+
+    const QString& strIncrement = record.fields[ParameterMetaDataCache::FieldIncrement];
+    if (!strIncrement.isEmpty()) {
+        bool    ok;
+        double  increment = strIncrement.toDouble(&ok);
+        if (ok) {
+            metaData->setRawIncrement(increment);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << strIncrement;
+        }
+    }
+
+    if (record.flags & ParameterMetaDataCache::FlagBoolean) {
+        QVariant enumValue;
+        metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Enabled"), enumValue);
+        metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Disabled"), enumValue);
+    }
+
+    for (const auto& bitPair: ParameterMetaDataCache::decodePairs(record.fields[ParameterMetaDataCache::FieldBitmask])) {
+        bool ok = false;
+        unsigned char bit = bitPair.first.toUInt(&ok);
+        if (ok) {
+            if (bit < 31) {
+                QVariant bitmaskRawValue = 1 << bit;
+                QVariant bitmaskValue;
+                if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
+                    metaData->addBitmaskInfo(bitPair.second, bitmaskValue);
+                } else {
+                    qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
+                                                     << " type:" << metaData->type() << " value:" << bitmaskValue
+                                                     << " error:" << errorString;
+                }
+            } else {
+                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
+            }
+        }
+    }
+
+    // Validate default value against the final meta data
+    if (metaData->defaultValueAvailable()) {
+        QVariant var;
+
+        if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
+        }
+    }
+
+    return metaData;
 }
 
 #ifdef GENERATE_PARAMETER_JSON
@@ -416,10 +501,16 @@ void _jsonWriteLine(QFile& file, int indent, const QString& line)
     file.write("\n");
 }
 
-void PX4ParameterMetaData::_generateParameterJson()
+void PX4ParameterMetaData::_generateParameterJson(const QList<ParameterMetaDataCache::Record_t>& records)
 {
     qCDebug(ParameterManagerLog) << "PX4ParameterMetaData::_generateParameterJson";
 
+    for (const ParameterMetaDataCache::Record_t& record: records) {
+        if (!_mapParameterName2FactMetaData.contains(record.name)) {
+            _mapParameterName2FactMetaData[record.name] = _createMetaData(record);
+        }
+    }
+
     int indentLevel = 0;
     QFile jsonFile(QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).absoluteFilePath("parameter.json"));
     jsonFile.open(QFile::WriteOnly | QFile::Truncate | QFile::Text);
@@ -495,9 +586,15 @@ FactMetaData* PX4ParameterMetaData::getMetaDataForFact(const QString& name, MAV_
     Q_UNUSED(vehicleType)
 
     if (!_mapParameterName2FactMetaData.contains(name)) {
-        qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
-        FactMetaData* metaData = new FactMetaData(type, this);
-        _mapParameterName2FactMetaData[name] = metaData;
+        // Meta data is only created from the compiled records the first time it is asked for
+        ParameterMetaDataCache::Record_t record;
+        if (_metaDataCache.find(QString(), name, record)) {
+            _mapParameterName2FactMetaData[name] = _createMetaData(record);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
+            FactMetaData* metaData = new FactMetaData(type, this);
+            _mapParameterName2FactMetaData[name] = metaData;
+        }
     }
 
     return _mapParameterName2FactMetaData[name];
@@ -521,8 +618,8 @@ void PX4ParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDa
         return;
     }
 
-    QXmlStreamReader xml(xmlFile.readAll());
-    xmlFile.close();
+    // Stream from the file, the version tags are at the top so there is no need to read the whole file
+    QXmlStreamReader xml(&xmlFile);
     if (xml.hasError()) {
         _outputFileWarning(metaDataFile, QStringLiteral("Badly formed XML"), xml.errorString());
         return;
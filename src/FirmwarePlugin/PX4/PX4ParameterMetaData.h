@@ -15,6 +15,7 @@
 #include <QLoggingCategory>
 
 #include "FactSystem.h"
+#include "ParameterMetaDataCache.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
 
@@ -48,13 +49,18 @@ private:
         XmlStateDone
     };    
 
-    QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
-    static void _outputFileWarning(const QString& metaDataFile, const QString& error1, const QString& error2);
+    QVariant        _stringToTypedVariant   (const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    void            _parseMetaDataXml       (const QString& metaDataFile, const QByteArray& xmlBytes, QList<ParameterMetaDataCache::Record_t>& records);
+    FactMetaData*   _createMetaData         (const ParameterMetaDataCache::Record_t& record);
+    static void     _outputFileWarning      (const QString& metaDataFile, const QString& error1, const QString& error2);
 
 #ifdef GENERATE_PARAMETER_JSON
-    void _generateParameterJson();
+    void _generateParameterJson(const QList<ParameterMetaDataCache::Record_t>& records);
 #endif
 
     bool                                _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
-    FactMetaData::NameToMetaDataMap_t   _mapParameterName2FactMetaData;             ///< Maps from a parameter name to FactMetaData
+    ParameterMetaDataCache              _metaDataCache;                             ///< Compiled meta data records, decoded on first use
+    FactMetaData::NameToMetaDataMap_t   _mapParameterName2FactMetaData;             ///< Maps from a parameter name to FactMetaData which has been created so far
+
+    static const int                    _parserVersion                  = 1;        ///< Bump when parsing changes the content of the compiled records
 };
@@ -0,0 +1,330 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterMetaDataCache.h"
+#include "QGCLoggingCategory.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QSettings>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(ParameterMetaDataCacheLog, "ParameterMetaDataCacheLog")
+
+const char ParameterMetaDataCache::_magic[4] = { 'Q', 'P', 'M', '1' };
+
+static const QChar kPairSeparator   (0x1f);
+static const QChar kListSeparator   (0x1e);
+
+ParameterMetaDataCache::ParameterMetaDataCache(void)
+    : _cacheDir(QFileInfo(QSettings().fileName()).dir().absoluteFilePath("ParamCache"))
+{
+    static_assert(sizeof(FileHeader_t) == 32, "ParameterMetaDataCache header packing");
+    static_assert(sizeof(FileRecord_t) == 16 + 4 + (FieldCount * 8), "ParameterMetaDataCache record packing");
+}
+
+ParameterMetaDataCache::~ParameterMetaDataCache()
+{
+    _unmap();
+}
+
+bool ParameterMetaDataCache::open(const QString& sourceFile, int parserVersion, QByteArray& sourceBytes)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    _unmap();
+    _memoryRecords.clear();
+    sourceBytes.clear();
+
+    // The source is identified by its path, size and modification time so a cache hit doesn't read it at all.
+    // Resource files don't always have a modification time, they only change with the application version.
+    QFileInfo sourceInfo(sourceFile);
+    QString   sourceKey = QStringLiteral("%1\n%2\n%3\n%4").arg(sourceInfo.absoluteFilePath(),
+                                                                  QString::number(sourceInfo.size()),
+                                                                  QString::number(sourceInfo.lastModified().toMSecsSinceEpoch()),
+                                                                  QCoreApplication::applicationVersion());
+
+    _sourceHash     = QCryptographicHash::hash(sourceKey.toUtf8(), QCryptographicHash::Md5);
+    _formatVersion  = (_cacheFormatVersion << 16) | static_cast<uint32_t>(parserVersion & 0xFFFF);
+    _filePrefix     = QStringLiteral("MetaData-%1-").arg(QString::fromLatin1(QCryptographicHash::hash(sourceInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex().left(8)));
+
+    QDir cacheDir(_cacheDir);
+    cacheDir.mkpath(QStringLiteral("."));
+    _file.setFileName(cacheDir.absoluteFilePath(QStringLiteral("%1%2.qpm").arg(_filePrefix, QString::fromLatin1(_sourceHash.toHex()))));
+
+    if (_map()) {
+        qCDebug(ParameterMetaDataCacheLog) << "Using compiled meta data" << sourceFile << _file.fileName() << "records:" << _recordCount << "msecs:" << timer.elapsed();
+        return true;
+    }
+
+    QFile file(sourceFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(ParameterMetaDataCacheLog) << "Unable to open meta data file" << sourceFile << file.errorString();
+        return false;
+    }
+    sourceBytes = file.readAll();
+
+    return false;
+}
+
+void ParameterMetaDataCache::setCacheDir(const QString& cacheDir)
+{
+    _cacheDir = cacheDir;
+}
+
+/// Removes the compiled caches of earlier versions of the current source file
+void ParameterMetaDataCache::_pruneStale(void)
+{
+    QDir        cacheDir(_cacheDir);
+    QString     current = QFileInfo(_file.fileName()).fileName();
+
+    for (const QString& fileName: cacheDir.entryList({ _filePrefix + QStringLiteral("*.qpm") }, QDir::Files)) {
+        if (fileName != current) {
+            qCDebug(ParameterMetaDataCacheLog) << "Removing stale compiled meta data" << fileName;
+            cacheDir.remove(fileName);
+        }
+    }
+}
+
+bool ParameterMetaDataCache::_map(void)
+{
+    if (!_file.exists() || !_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 fileSize = _file.size();
+    if (fileSize < static_cast<qint64>(sizeof(FileHeader_t))) {
+        _unmap();
+        return false;
+    }
+
+    _mapped = _file.map(0, fileSize);
+    if (!_mapped) {
+        qCWarning(ParameterMetaDataCacheLog) << "Unable to map compiled meta data" << _file.fileName() << _file.errorString();
+        _unmap();
+        return false;
+    }
+
+    const FileHeader_t* header      = reinterpret_cast<const FileHeader_t*>(_mapped);
+    qint64              recordsEnd  = static_cast<qint64>(sizeof(FileHeader_t)) + (static_cast<qint64>(header->recordCount) * static_cast<qint64>(sizeof(FileRecord_t)));
+
+    if (memcmp(header->magic, _magic, sizeof(_magic)) ||
+            header->formatVersion != _formatVersion ||
+            _sourceHash.size() != static_cast<int>(sizeof(header->sourceHash)) ||
+            memcmp(header->sourceHash, _sourceHash.constData(), sizeof(header->sourceHash)) ||
+            recordsEnd > header->stringTableOffset ||
+            header->stringTableOffset > fileSize) {
+        qCDebug(ParameterMetaDataCacheLog) << "Compiled meta data out of date" << _file.fileName();
+        _unmap();
+        return false;
+    }
+
+    _records        = reinterpret_cast<const FileRecord_t*>(_mapped + sizeof(FileHeader_t));
+    _recordCount    = header->recordCount;
+    _strings        = reinterpret_cast<const char*>(_mapped + header->stringTableOffset);
+    _stringsSize    = fileSize - header->stringTableOffset;
+
+    return true;
+}
+
+void ParameterMetaDataCache::_unmap(void)
+{
+    if (_mapped) {
+        _file.unmap(_mapped);
+        _mapped = nullptr;
+    }
+    _file.close();
+    _records        = nullptr;
+    _recordCount    = 0;
+    _strings        = nullptr;
+    _stringsSize    = 0;
+}
+
+void ParameterMetaDataCache::setRecords(const QList<Record_t>& records)
+{
+    _unmap();
+    _memoryRecords.clear();
+
+    typedef QPair<QByteArray, QByteArray> SortKey_t;
+
+    QVector<QPair<SortKey_t, const Record_t*>> sorted;
+    sorted.reserve(records.count());
+    for (const Record_t& record: records) {
+        sorted.append(qMakePair(SortKey_t(record.section.toUtf8(), record.name.toUtf8()), &record));
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const QPair<SortKey_t, const Record_t*>& a, const QPair<SortKey_t, const Record_t*>& b) {
+        return a.first < b.first;
+    });
+
+    // Group, category, units and so on repeat across many parameters, so identical strings are stored once
+    QByteArray                  stringTable;
+    QHash<QByteArray, uint32_t> stringOffsets;
+    auto addString = [&stringTable, &stringOffsets](const QByteArray& utf8) -> FileString_t {
+        FileString_t fileString;
+        fileString.length = static_cast<uint32_t>(utf8.length());
+        if (utf8.isEmpty()) {
+            fileString.offset = 0;
+        } else if (stringOffsets.contains(utf8)) {
+            fileString.offset = stringOffsets[utf8];
+        } else {
+            fileString.offset = static_cast<uint32_t>(stringTable.length());
+            stringOffsets[utf8] = fileString.offset;
+            stringTable.append(utf8);
+        }
+        return fileString;
+    };
+
+    QVector<FileRecord_t> fileRecords;
+    fileRecords.reserve(sorted.count());
+    for (const auto& sortedRecord: sorted) {
+        const Record_t& record = *sortedRecord.second;
+        FileRecord_t    fileRecord;
+
+        memset(&fileRecord, 0, sizeof(fileRecord));
+        fileRecord.section  = addString(sortedRecord.first.first);
+        fileRecord.name     = addString(sortedRecord.first.second);
+        fileRecord.type     = static_cast<int8_t>(record.type);
+        fileRecord.flags    = record.flags;
+        for (int i=0; i<FieldCount; i++) {
+            fileRecord.fields[i] = addString(record.fields[i].toUtf8());
+        }
+        fileRecords.append(fileRecord);
+    }
+
+    FileHeader_t header;
+    memcpy(header.magic, _magic, sizeof(_magic));
+    memset(header.sourceHash, 0, sizeof(header.sourceHash));
+    memcpy(header.sourceHash, _sourceHash.constData(), qMin(static_cast<size_t>(_sourceHash.size()), sizeof(header.sourceHash)));
+    header.formatVersion        = _formatVersion;
+    header.recordCount          = static_cast<uint32_t>(fileRecords.count());
+    header.stringTableOffset    = static_cast<uint32_t>(sizeof(FileHeader_t) + (fileRecords.count() * sizeof(FileRecord_t)));
+
+    QSaveFile saveFile(_file.fileName());
+    if (saveFile.open(QIODevice::WriteOnly)) {
+        saveFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        saveFile.write(reinterpret_cast<const char*>(fileRecords.constData()), fileRecords.count() * static_cast<int>(sizeof(FileRecord_t)));
+        saveFile.write(stringTable);
+        if (saveFile.commit() && _map()) {
+            qCDebug(ParameterMetaDataCacheLog) << "Compiled meta data written" << _file.fileName() << "records:" << _recordCount;
+            _pruneStale();
+            return;
+        }
+    }
+
+    qCWarning(ParameterMetaDataCacheLog) << "Unable to write compiled meta data, holding in memory" << _file.fileName() << saveFile.errorString();
+    for (const Record_t& record: records) {
+        _memoryRecords[_memoryKey(record.section, record.name)] = record;
+    }
+}
+
+int ParameterMetaDataCache::count(void) const
+{
+    return _mapped ? static_cast<int>(_recordCount) : _memoryRecords.count();
+}
+
+QString ParameterMetaDataCache::_string(const FileString_t& fileString) const
+{
+    if (fileString.length == 0 || static_cast<qint64>(fileString.offset) + fileString.length > _stringsSize) {
+        return QString();
+    }
+    return QString::fromUtf8(_strings + fileString.offset, static_cast<int>(fileString.length));
+}
+
+int ParameterMetaDataCache::_compare(const FileRecord_t& fileRecord, const QByteArray& section, const QByteArray& name) const
+{
+    auto compareBytes = [this](const FileString_t& fileString, const QByteArray& bytes) -> int {
+        if (static_cast<qint64>(fileString.offset) + fileString.length > _stringsSize) {
+            return -1;
+        }
+        int result = memcmp(_strings + fileString.offset, bytes.constData(), qMin(static_cast<size_t>(fileString.length), static_cast<size_t>(bytes.length())));
+        if (result == 0) {
+            result = static_cast<int>(fileString.length) - bytes.length();
+        }
+        return result;
+    };
+
+    int result = compareBytes(fileRecord.section, section);
+    return result == 0 ? compareBytes(fileRecord.name, name) : result;
+}
+
+bool ParameterMetaDataCache::find(const QString& section, const QString& name, Record_t& record) const
+{
+    if (!_mapped) {
+        QString key = _memoryKey(section, name);
+        if (_memoryRecords.contains(key)) {
+            record = _memoryRecords[key];
+            return true;
+        }
+        return false;
+    }
+
+    QByteArray  utf8Section = section.toUtf8();
+    QByteArray  utf8Name    = name.toUtf8();
+    uint32_t    low         = 0;
+    uint32_t    high        = _recordCount;
+
+    while (low < high) {
+        uint32_t    mid     = low + ((high - low) / 2);
+        int         result  = _compare(_records[mid], utf8Section, utf8Name);
+
+        if (result == 0) {
+            const FileRecord_t& fileRecord = _records[mid];
+            record.section  = section;
+            record.name     = name;
+            record.type     = fileRecord.type;
+            record.flags    = fileRecord.flags;
+            for (int i=0; i<FieldCount; i++) {
+                record.fields[i] = _string(fileRecord.fields[i]);
+            }
+            return true;
+        } else if (result < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return false;
+}
+
+QString ParameterMetaDataCache::encodePairs(const QList<QPair<QString, QString>>& pairs)
+{
+    QStringList encodedPairs;
+
+    for (const auto& pair: pairs) {
+        encodedPairs.append(pair.first + kPairSeparator + pair.second);
+    }
+
+    return encodedPairs.join(kListSeparator);
+}
+
+QList<QPair<QString, QString>> ParameterMetaDataCache::decodePairs(const QString& encoded)
+{
+    QList<QPair<QString, QString>> pairs;
+
+    if (encoded.isEmpty()) {
+        return pairs;
+    }
+    for (const QString& encodedPair: encoded.split(kListSeparator)) {
+        int separator = encodedPair.indexOf(kPairSeparator);
+        if (separator >= 0) {
+            pairs.append(qMakePair(encodedPair.left(separator), encodedPair.mid(separator + 1)));
+        }
+    }
+
+    return pairs;
+}
@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterMetaDataCacheLog)
+
+/// Precompiled form of a firmware parameter meta data file.
+///
+/// The first time a meta data file is seen it is parsed by the firmware specific loader, which hands the raw string
+/// records to setRecords. These are written to a binary file keyed by the path, size and modification time of the source
+/// file, earlier compiled versions of the same source are removed. From then on the binary file is memory mapped and a
+/// record is only decoded when the meta data for that parameter is first asked for, so connecting a vehicle neither
+/// reads nor parses the full XML.
+///
+/// File layout (little endian):
+///     Header:         char magic[4], uint32 format version, uint8 source key hash[16], uint32 record count, uint32 string table offset
+///     Records:        fixed size FileRecord_t sorted by section then name, both compared as utf8 bytes
+///     String table:   de-duplicated utf8 strings, not terminated
+class ParameterMetaDataCache
+{
+public:
+    ParameterMetaDataCache(void);
+    ~ParameterMetaDataCache();
+
+    enum Field {
+        FieldCategory,
+        FieldGroup,
+        FieldShortDescription,
+        FieldLongDescription,
+        FieldMin,
+        FieldMax,
+        FieldDefault,
+        FieldUnits,
+        FieldIncrement,
+        FieldDecimalPlaces,
+        FieldValues,            ///< Encoded with encodePairs: value, description
+        FieldBitmask,           ///< Encoded with encodePairs: bit index, description
+        FieldCount
+    };
+
+    enum Flags {
+        FlagReadOnly            = 0x01,
+        FlagVolatile            = 0x02,
+        FlagRebootRequired      = 0x04,
+        FlagBoolean             = 0x08,
+        FlagDuplicate           = 0x10,     ///< Parameter was defined more than once in the source, meta data can't be trusted
+    };
+
+    typedef struct Record {
+        QString     section;                ///< Firmware specific grouping, for example the vehicle type, may be empty
+        QString     name;
+        int         type    = -1;           ///< FactMetaData::ValueType_t, -1 if the source doesn't specify a type
+        uint8_t     flags   = 0;
+        QString     fields[FieldCount];
+    } Record_t;
+
+    /// Maps the compiled cache matching the source file if there is one, otherwise reads the source file
+    ///     @param sourceFile       Meta data file as shipped or downloaded
+    ///     @param parserVersion    Bump whenever the firmware specific parser changes what ends up in the records
+    ///     @param sourceBytes      Returned: contents of the source file, for parsing when there is no cache
+    /// @return true: compiled cache is available, no need to parse the source
+    bool open(const QString& sourceFile, int parserVersion, QByteArray& sourceBytes);
+
+    /// Directory the compiled caches are kept in, defaults to ParamCache next to the settings. Set before open.
+    void setCacheDir(const QString& cacheDir);
+
+    /// Compiles the parsed records into the cache file. If the file can't be written the records are held in memory.
+    void setRecords(const QList<Record_t>& records);
+
+    /// Decodes a single record
+    /// @return false: no record for this section and name
+    bool find(const QString& section, const QString& name, Record_t& record) const;
+
+    int count(void) const;
+
+    static QString                          encodePairs(const QList<QPair<QString, QString>>& pairs);
+    static QList<QPair<QString, QString>>   decodePairs(const QString& encoded);
+
+private:
+    typedef struct {
+        char        magic[4];
+        uint32_t    formatVersion;
+        uint8_t     sourceHash[16];
+        uint32_t    recordCount;
+        uint32_t    stringTableOffset;
+    } FileHeader_t;
+
+    typedef struct {
+        uint32_t    offset;
+        uint32_t    length;
+    } FileString_t;
+
+    typedef struct {
+        FileString_t    section;
+        FileString_t    name;
+        int8_t          type;
+        uint8_t         flags;
+        uint16_t        reserved;
+        FileString_t    fields[FieldCount];
+    } FileRecord_t;
+
+    bool    _map            (void);
+    void    _unmap          (void);
+    void    _pruneStale     (void);
+    QString _string         (const FileString_t& fileString) const;
+    int     _compare        (const FileRecord_t& fileRecord, const QByteArray& section, const QByteArray& name) const;
+
+    static QString _memoryKey(const QString& section, const QString& name) { return section + QLatin1Char('\n') + name; }
+
+    QString                     _cacheDir;
+    QString                     _filePrefix;                ///< Compiled caches of the same source file share it
+    QFile                       _file;
+    uchar*                      _mapped         = nullptr;
+    const FileRecord_t*         _records        = nullptr;
+    uint32_t                    _recordCount    = 0;
+    const char*                 _strings        = nullptr;
+    qint64                      _stringsSize    = 0;
+    QByteArray                  _sourceHash;
+    uint32_t                    _formatVersion  = 0;
+    QHash<QString, Record_t>    _memoryRecords;             ///< Fallback when the cache file can't be written
+
+    static const char           _magic[4];
+    static const uint32_t       _cacheFormatVersion = 2;
+};
@@ -52,6 +52,7 @@ FlightMap {
     property bool   _airspaceEnabled:           QGroundControl.airmapSupported ? (QGroundControl.settingsManager.airMapSettings.enableAirMap.rawValue && QGroundControl.airspaceManager.connected): false
     property var    _flyViewSettings:           QGroundControl.settingsManager.flyViewSettings
     property bool   _keepMapCenteredOnVehicle:  _flyViewSettings.keepMapCenteredOnVehicle.rawValue
+    property var    _tilePrefetcher:            QGroundControl.mapEngineManager.tilePrefetcher
 
     property bool   _disableVehicleTracking:    false
     property bool   _keepVehicleCentered:       pipMode ? true : false
@@ -79,7 +80,10 @@ FlightMap {
         _saveZoomLevelSetting = true
     }
 
-    onPipModeChanged: _adjustMapZoomForPipMode()
+    onPipModeChanged: {
+        _adjustMapZoomForPipMode()
+        _updateTilePrefetcher()
+    }
 
     onVisibleChanged: {
         if (visible) {
@@ -93,6 +97,9 @@ FlightMap {
             QGroundControl.flightMapZoom = zoomLevel
             updateAirspace(false)
         }
+        if (!pipMode) {
+            _tilePrefetcher.setZoomLevel(zoomLevel)
+        }
     }
     onCenterChanged: {
         QGroundControl.flightMapPosition = center
@@ -103,6 +110,23 @@ FlightMap {
         updateAirspace(true)
     }
 
+    // Cache the tiles along the mission and ahead of the vehicle before the map gets there
+    function _updateTilePrefetcher() {
+        if (!pipMode) {
+            _tilePrefetcher.setMapType(activeMapType.name)
+            _tilePrefetcher.setZoomLevel(zoomLevel)
+            _tilePrefetcher.setMissionPath(_missionController.waypointPath)
+        }
+    }
+
+    onActiveMapTypeChanged:         _updateTilePrefetcher()
+    Component.onCompleted:          _updateTilePrefetcher()
+    on_ActiveVehicleCoordinateChanged: {
+        if (!pipMode && _activeVehicle) {
+            _tilePrefetcher.updateVehicle(_activeVehicleCoordinate, _activeVehicle.heading.rawValue, _activeVehicle.groundSpeed.rawValue)
+        }
+    }
+
     // We track whether the user has panned or not to correctly handle automatic map positioning
     Connections {
         target: gesture
@@ -213,6 +237,11 @@ FlightMap {
                 firstVehiclePositionReceived = true
             }
         }
+        onWaypointPathChanged: {
+            if (!pipMode) {
+                _tilePrefetcher.setMissionPath(_missionController.waypointPath)
+            }
+        }
     }
 
     MapFitFunctions {
@@ -230,9 +259,41 @@ FlightMap {
         z:          QGroundControl.zOrderTrajectoryLines
         visible:    !pipMode
 
+        // Only the part of the track within the viewport is shown, simplified to the map resolution
+        function updatePath() {
+            if (!_activeVehicle) {
+                path = []
+                return
+            }
+            var coordinateNW = _root.toCoordinate(Qt.point(0, 0), false /* clipToViewPort */)
+            var coordinateNE = _root.toCoordinate(Qt.point(_root.width, 0), false /* clipToViewPort */)
+            var coordinateSE = _root.toCoordinate(Qt.point(_root.width, _root.height), false /* clipToViewPort */)
+            if (coordinateNW.isValid && coordinateNE.isValid && coordinateSE.isValid && _root.width > 0) {
+                path = _activeVehicle.trajectoryPoints.viewportList(coordinateNW, coordinateSE, coordinateNW.distanceTo(coordinateNE) / _root.width)
+            } else {
+                path = _activeVehicle.trajectoryPoints.list()
+            }
+        }
+
+        // Throttles rebuilding the path while the viewport changes. Started only if not already running, so a map which
+        // follows the vehicle and changes its center on every position update still rebuilds the path.
+        Timer {
+            id:             trajectoryUpdateTimer
+            interval:       250
+            onTriggered:    trajectoryPolyline.updatePath()
+        }
+
         Connections {
             target:                 QGroundControl.multiVehicleManager
-            onActiveVehicleChanged: trajectoryPolyline.path = _activeVehicle ? _activeVehicle.trajectoryPoints.list() : []
+            onActiveVehicleChanged: trajectoryPolyline.updatePath()
+        }
+
+        Connections {
+            target:                 _root
+            onZoomLevelChanged:     trajectoryUpdateTimer.start()
+            onCenterChanged:        trajectoryUpdateTimer.start()
+            onWidthChanged:         trajectoryUpdateTimer.start()
+            onHeightChanged:        trajectoryUpdateTimer.start()
         }
 
         Connections {
@@ -240,6 +301,7 @@ FlightMap {
             onPointAdded:           trajectoryPolyline.addCoordinate(coordinate)
             onUpdateLastPoint:      trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
             onPointsCleared:        trajectoryPolyline.path = []
+            onPointsRestored:       trajectoryPolyline.updatePath()
         }
     }
 
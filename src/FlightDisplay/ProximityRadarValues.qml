@@ -11,30 +11,32 @@ import QtQuick 2.12
 
 /// Object which exposes vehicle distanceSensors FactGroup information for use in UI
 QtObject {
+    id: _root
+
     property var    vehicle
 
     property bool   telemetryAvailable: vehicle && vehicle.distanceSensors.telemetryAvailable
 
     signal rotationValueChanged ///< Signalled when any available rotation value changes
 
-    property real   rotationNoneValue:      _distanceSensors ? _distanceSensors.rotationNone.value : NaN
-    property real   rotationYaw45Value:     _distanceSensors ? _distanceSensors.rotationYaw45.value : NaN
-    property real   rotationYaw90Value:     _distanceSensors ? _distanceSensors.rotationYaw90.value : NaN
-    property real   rotationYaw135Value:    _distanceSensors ? _distanceSensors.rotationYaw135.value : NaN
-    property real   rotationYaw180Value:    _distanceSensors ? _distanceSensors.rotationYaw180.value : NaN
-    property real   rotationYaw225Value:    _distanceSensors ? _distanceSensors.rotationYaw225.value : NaN
-    property real   rotationYaw270Value:    _distanceSensors ? _distanceSensors.rotationYaw270.value : NaN
-    property real   rotationYaw315Value:    _distanceSensors ? _distanceSensors.rotationYaw315.value : NaN
-    property real   maxDistance:            _distanceSensors ? _distanceSensors.maxDistance.value : NaN
-
-    property string rotationNoneValueString:    _distanceSensors ? _distanceSensors.rotationNone.valueString : _noValueStr
-    property string rotationYaw45ValueString:   _distanceSensors ? _distanceSensors.rotationYaw45.valueString : _noValueStr
-    property string rotationYaw90ValueString:   _distanceSensors ? _distanceSensors.rotationYaw90.valueString : _noValueStr
-    property string rotationYaw135ValueString:  _distanceSensors ? _distanceSensors.rotationYaw135.valueString : _noValueStr
-    property string rotationYaw180ValueString:  _distanceSensors ? _distanceSensors.rotationYaw180.valueString : _noValueStr
-    property string rotationYaw225ValueString:  _distanceSensors ? _distanceSensors.rotationYaw225.valueString : _noValueStr
-    property string rotationYaw270ValueString:  _distanceSensors ? _distanceSensors.rotationYaw270.valueString : _noValueStr
-    property string rotationYaw315ValueString:  _distanceSensors ? _distanceSensors.rotationYaw315.valueString : _noValueStr
+    property real   rotationNoneValue:      NaN
+    property real   rotationYaw45Value:     NaN
+    property real   rotationYaw90Value:     NaN
+    property real   rotationYaw135Value:    NaN
+    property real   rotationYaw180Value:    NaN
+    property real   rotationYaw225Value:    NaN
+    property real   rotationYaw270Value:    NaN
+    property real   rotationYaw315Value:    NaN
+    property real   maxDistance:            NaN
+
+    property string rotationNoneValueString:    _noValueStr
+    property string rotationYaw45ValueString:   _noValueStr
+    property string rotationYaw90ValueString:   _noValueStr
+    property string rotationYaw135ValueString:  _noValueStr
+    property string rotationYaw180ValueString:  _noValueStr
+    property string rotationYaw225ValueString:  _noValueStr
+    property string rotationYaw270ValueString:  _noValueStr
+    property string rotationYaw315ValueString:  _noValueStr
 
     property var    rgRotationValues:           [ rotationNoneValue, rotationYaw45Value, rotationYaw90Value, rotationYaw135Value, rotationYaw180Value, rotationYaw225Value, rotationYaw270Value, rotationYaw315Value ]
     property var    rgRotationValueStrings:     [ rotationNoneValueString, rotationYaw45ValueString, rotationYaw90ValueString, rotationYaw135ValueString, rotationYaw180ValueString, rotationYaw225ValueString, rotationYaw270ValueString, rotationYaw315ValueString ]
@@ -42,13 +44,39 @@ QtObject {
     property var    _distanceSensors:       vehicle ? vehicle.distanceSensors : null
     property string _noValueStr:            qsTr("--.--")
 
-    onRotationNoneValueChanged:     rotationValueChanged()
-    onRotationYaw45ValueChanged:    rotationValueChanged()
-    onRotationYaw90ValueChanged:    rotationValueChanged()
-    onRotationYaw135ValueChanged:   rotationValueChanged()
-    onRotationYaw180ValueChanged:   rotationValueChanged()
-    onRotationYaw225ValueChanged:   rotationValueChanged()
-    onRotationYaw270ValueChanged:   rotationValueChanged()
-    onRotationYaw315ValueChanged:   rotationValueChanged()
-}
+    on_DistanceSensorsChanged:  _updateValues()
+    Component.onCompleted:      _updateValues()
+
+    // The distance sensor group publishes all of its values at once, so they are read from the published snapshot in one go
+    property var _connections: Connections {
+        target:             _distanceSensors
+        onValuesChanged:    _updateValues()
+    }
 
+    function _updateValues() {
+        var changed = false
+
+        function updateValue(property, factName) {
+            var value = _distanceSensors ? _distanceSensors.publishedValue(factName) : NaN
+            if (value !== _root[property] && !(isNaN(value) && isNaN(_root[property]))) {
+                _root[property] = value
+                changed = true
+            }
+            _root[property + "String"] = _distanceSensors ? _distanceSensors.publishedValueString(factName) : _noValueStr
+        }
+
+        updateValue("rotationNoneValue",    "rotationNone")
+        updateValue("rotationYaw45Value",   "rotationYaw45")
+        updateValue("rotationYaw90Value",   "rotationYaw90")
+        updateValue("rotationYaw135Value",  "rotationYaw135")
+        updateValue("rotationYaw180Value",  "rotationYaw180")
+        updateValue("rotationYaw225Value",  "rotationYaw225")
+        updateValue("rotationYaw270Value",  "rotationYaw270")
+        updateValue("rotationYaw315Value",  "rotationYaw315")
+        maxDistance = _distanceSensors ? _distanceSensors.publishedValue("maxDistance") : NaN
+
+        if (changed) {
+            rotationValueChanged()
+        }
+    }
+}
@@ -71,7 +71,7 @@ void InstrumentValueData::_lookForMissingFact(void)
 
 void InstrumentValueData::clearFact(void)
 {
-    _fact = nullptr;
+    _disconnectFact();
     _factName.clear();
     _text.clear();
     _icon.clear();
@@ -84,14 +84,25 @@ void InstrumentValueData::clearFact(void)
     emit textChanged            (_text);
     emit iconChanged            (_icon);
     emit showUnitsChanged       (_showUnits);
+
+    _updateValue();
 }
 
-void InstrumentValueData::_setFactWorker(void)
+void InstrumentValueData::_disconnectFact(void)
 {
+    if (_factGroup) {
+        disconnect(_factGroup, &FactGroup::valuesChanged, this, &InstrumentValueData::_updateValue);
+        _factGroup = nullptr;
+    }
     if (_fact) {
-        disconnect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateRanges);
+        disconnect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateValue);
         _fact = nullptr;
     }
+}
+
+void InstrumentValueData::_setFactWorker(void)
+{
+    _disconnectFact();
 
     FactGroup* factGroup = nullptr;
     if (_factGroupName == vehicleFactGroupName) {
@@ -112,7 +123,13 @@ void InstrumentValueData::_setFactWorker(void)
 
     if (_fact) {
         _factName = nonEmptyFactName;
-        connect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateRanges);
+        // Rate limited groups publish a snapshot of all their values at once, so the display follows the group rather than the fact
+        if (factGroup->telemetryFrame() && _fact->telemetryFrameSlot() != -1) {
+            _factGroup = factGroup;
+            connect(_factGroup, &FactGroup::valuesChanged, this, &InstrumentValueData::_updateValue);
+        } else {
+            connect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateValue);
+        }
     }
 
     emit factValueNamesChanged  ();
@@ -120,6 +137,28 @@ void InstrumentValueData::_setFactWorker(void)
     emit factNameChanged        (_factName);
     emit factGroupNameChanged   (_factGroupName);
 
+    _updateValue();
+}
+
+void InstrumentValueData::_updateValue(void)
+{
+    QString newValueString;
+
+    if (_factGroup) {
+        _rawValue = _factGroup->telemetryFrame()->value(_fact->telemetryFrameSlot());
+        newValueString = _fact->enumOrValueString(_rawValue);
+    } else if (_fact) {
+        _rawValue = _fact->rawValue();
+        newValueString = _fact->enumOrValueString();
+    } else {
+        _rawValue.clear();
+    }
+
+    if (newValueString != _valueString) {
+        _valueString = newValueString;
+        emit valueStringChanged(_valueString);
+    }
+
     _updateRanges();
 }
 void InstrumentValueData::setFact(const QString& factGroupName, const QString& factName)
@@ -284,7 +323,7 @@ void InstrumentValueData::_updateColor(void)
     int rangeIndex = -1;
 
     if (_rangeType == ColorRange && _fact) {
-        rangeIndex =_currentRangeIndex(_fact->rawValue().toDouble());
+        rangeIndex =_currentRangeIndex(_rawValue.toDouble());
     }
     if (rangeIndex != -1) {
         newColor = _rangeColors[rangeIndex].value<QColor>();
@@ -303,7 +342,7 @@ void InstrumentValueData::_updateOpacity(void)
     int rangeIndex = -1;
 
     if (_rangeType == OpacityRange && _fact) {
-        rangeIndex =_currentRangeIndex(_fact->rawValue().toDouble());
+        rangeIndex =_currentRangeIndex(_rawValue.toDouble());
     }
     if (rangeIndex != -1) {
         newOpacity = _rangeOpacities[rangeIndex].toDouble();
@@ -322,7 +361,7 @@ void InstrumentValueData::_updateIcon(void)
     int rangeIndex = -1;
 
     if (_rangeType == IconSelectRange && _fact) {
-        rangeIndex =_currentRangeIndex(_fact->rawValue().toDouble());
+        rangeIndex =_currentRangeIndex(_rawValue.toDouble());
     }
     if (rangeIndex != -1) {
         newIcon = _rangeIcons[rangeIndex].toString();
@@ -16,6 +16,7 @@
 #include <QObject>
 
 class FactValueGrid;
+class FactGroup;
 
 class InstrumentValueData : public QObject
 {
@@ -38,6 +39,7 @@ public:
     Q_PROPERTY(QString              factGroupName       READ    factGroupName                               NOTIFY factGroupNameChanged)
     Q_PROPERTY(QString              factName            READ    factName                                    NOTIFY factNameChanged)
     Q_PROPERTY(Fact*                fact                READ    fact                                        NOTIFY factChanged)
+    Q_PROPERTY(QString              valueString         READ    valueString                                 NOTIFY valueStringChanged)  ///< Fact value as of the last publish of its group
     Q_PROPERTY(QString              text                READ    text                WRITE setText           NOTIFY textChanged)
     Q_PROPERTY(QString              icon                READ    icon                WRITE setIcon           NOTIFY iconChanged)             ///< If !isEmpty icon will be show instead of label
     Q_PROPERTY(bool                 showUnits           READ    showUnits           WRITE setShowUnits      NOTIFY showUnitsChanged)
@@ -63,6 +65,7 @@ public:
     QString         factGroupName           (void) const { return _factGroupName; }
     QString         factName                (void) const { return _factName; }
     Fact*           fact                    (void) { return _fact; }
+    QString         valueString             (void) const { return _valueString; }
     QString         text                    (void) const { return _text; }
     bool            showUnits               (void) const { return _showUnits; }
     QString         icon                    (void) const { return _icon; }
@@ -85,6 +88,7 @@ public:
 
 signals:
     void factChanged            (Fact* fact);
+    void valueStringChanged     (const QString& valueString);
     void factNameChanged        (const QString& factName);
     void factGroupNameChanged   (const QString& factGroup);
     void textChanged            (QString text);
@@ -104,6 +108,7 @@ signals:
 private slots:
     void _resetRangeInfo        (void);
     void _updateRanges          (void);
+    void _updateValue           (void);
     void _activeVehicleChanged  (Vehicle* activeVehicle);
     void _lookForMissingFact    (void);
 
@@ -113,11 +118,15 @@ private:
     void _updateIcon            (void);
     void _updateOpacity         (void);
     void _setFactWorker         (void);
+    void _disconnectFact        (void);
 
     FactValueGrid*          _factValueGrid =        nullptr;
     Vehicle*                _activeVehicle =        nullptr;
     QmlObjectListModel*     _rowModel =             nullptr;
     Fact*                   _fact =                 nullptr;
+    FactGroup*              _factGroup =            nullptr;
+    QVariant                _rawValue;
+    QString                 _valueString;
     QString                 _factName;
     QString                 _factGroupName;
     QString                 _text;
@@ -48,6 +48,14 @@ ChartView {
         }
     }
 
+    // Series points are decimated to the plot width
+    Binding {
+        target:                     chartController
+        property:                   "plotWidth"
+        value:                      Math.max(1, Math.round(chartView.plotArea.width))
+        when:                       chartController !== null
+    }
+
     DateTimeAxis {
         id:                         axisX
         min:                        chartController ? chartController.rangeXMin : new Date()
@@ -16,6 +16,8 @@
 #include <QDebug>
 #include <QQmlEngine>
 
+#include <algorithm>
+
 const int QmlObjectListModel::ObjectRole = Qt::UserRole;
 const int QmlObjectListModel::TextRole = Qt::UserRole + 1;
 
@@ -88,55 +90,78 @@ bool QmlObjectListModel::setData(const QModelIndex& index, const QVariant& value
     return false;
 }
 
-bool QmlObjectListModel::insertRows(int position, int rows, const QModelIndex& parent)
+bool QmlObjectListModel::removeRows(int position, int rows, const QModelIndex& parent)
 {
     Q_UNUSED(parent);
-    
-    if (position < 0 || position > _objectList.count() + 1) {
-        qWarning() << "Invalid position position:count" << position << _objectList.count();
+
+    if (position < 0 || rows < 0 || position + rows > _objectList.count()) {
+        qWarning() << "Invalid rows position:rows:count" << position << rows << _objectList.count();
+        return false;
     }
-    
-    beginInsertRows(QModelIndex(), position, position + rows - 1);
-    endInsertRows();
-    
-    emit countChanged(count());
-    
+
+    removeRange(position, rows);
+
     return true;
 }
 
-bool QmlObjectListModel::removeRows(int position, int rows, const QModelIndex& parent)
+/// @return true: caller must signal row changes, false: a reset is active which covers the change
+bool QmlObjectListModel::_signalRowChanges(void)
 {
-    Q_UNUSED(parent);
-    
-    if (position < 0 || position >= _objectList.count()) {
-        qWarning() << "Invalid position position:count" << position << _objectList.count();
-    } else if (position + rows > _objectList.count()) {
-        qWarning() << "Invalid rows position:rows:count" << position << rows << _objectList.count();
+    if (_externalBeginResetModel) {
+        return false;
     }
-    
-    beginRemoveRows(QModelIndex(), position, position + rows - 1);
-    for (int row=0; row<rows; row++) {
-        _objectList.removeAt(position);
+    if (_batchDepth > 0) {
+        if (!_batchResetStarted) {
+            _batchResetStarted = true;
+            beginResetModel();
+        }
+        return false;
     }
-    endRemoveRows();
-    
-    emit countChanged(count());
-    
     return true;
 }
 
-void QmlObjectListModel::move(int from, int to)
+void QmlObjectListModel::_connectDirty(QObject* object, int row)
+{
+    // Look for a dirtyChanged signal on the object. The signature is already normalized.
+    if (object && object->metaObject()->indexOfSignal("dirtyChanged(bool)") != -1) {
+        if (!_skipDirtyFirstItem || row != 0) {
+            QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+        }
+    }
+}
+
+void QmlObjectListModel::_disconnectDirty(QObject* object, int row)
 {
-    if(0 <= from && from < count() && 0 <= to && to < count() && from != to) {
-        // Workaround to allow move item to the bottom. Done according to
-        // beginMoveRows() documentation and implementation specificity:
-        // https://doc.qt.io/qt-5/qabstractitemmodel.html#beginMoveRows
-        // (see 3rd picture explanation there)
-        if(from == to - 1) {
-            to = from++;
+    if (object && object->metaObject()->indexOfSignal("dirtyChanged(bool)") != -1) {
+        if (!_skipDirtyFirstItem || row != 0) {
+            QObject::disconnect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
         }
-        beginMoveRows(QModelIndex(), from, from, QModelIndex(), to);
-        _objectList.move(from, to);
+    }
+}
+
+void QmlObjectListModel::move(int from, int to)
+{
+    moveRange(from, 1, to);
+}
+
+void QmlObjectListModel::moveRange(int from, int count, int to)
+{
+    if (count < 1 || from < 0 || from + count > _objectList.count() || to < 0 || to + count > _objectList.count() || from == to) {
+        return;
+    }
+
+    // beginMoveRows wants the destination as the row index before the move happens
+    // https://doc.qt.io/qt-5/qabstractitemmodel.html#beginMoveRows
+    bool signalRows = _signalRowChanges();
+    if (signalRows) {
+        beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), to > from ? to + count : to);
+    }
+    if (to > from) {
+        std::rotate(_objectList.begin() + from, _objectList.begin() + from + count, _objectList.begin() + to + count);
+    } else {
+        std::rotate(_objectList.begin() + to, _objectList.begin() + from, _objectList.begin() + from + count);
+    }
+    if (signalRows) {
         endMoveRows();
     }
 }
@@ -159,11 +184,12 @@ const QObject* QmlObjectListModel::operator[](int index) const
 
 void QmlObjectListModel::clear()
 {
-    if (!_externalBeginResetModel) {
+    bool signalRows = _signalRowChanges();
+    if (signalRows) {
         beginResetModel();
     }
     _objectList.clear();
-    if (!_externalBeginResetModel) {
+    if (signalRows) {
         endResetModel();
         emit countChanged(count());
     }
@@ -171,61 +197,123 @@ void QmlObjectListModel::clear()
 
 QObject* QmlObjectListModel::removeAt(int i)
 {
-    QObject* removedObject = _objectList[i];
-    if(removedObject) {
-        // Look for a dirtyChanged signal on the object
-        if (_objectList[i]->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::disconnect(_objectList[i], SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
+    QObjectList removed = removeRange(i, 1);
+    return removed.isEmpty() ? nullptr : removed.first();
+}
+
+QObjectList QmlObjectListModel::removeRange(int i, int count)
+{
+    QObjectList removed;
+
+    if (i < 0 || count < 0 || i + count > _objectList.count()) {
+        qWarning() << "Invalid range index:count:list count" << i << count << _objectList.count();
+        return removed;
+    }
+    if (count == 0) {
+        return removed;
+    }
+
+    removed = _objectList.mid(i, count);
+    for (int j=0; j<count; j++) {
+        _disconnectDirty(removed[j], i + j);
     }
-    removeRows(i, 1);
+
+    bool signalRows = _signalRowChanges();
+    if (signalRows) {
+        beginRemoveRows(QModelIndex(), i, i + count - 1);
+    }
+    _objectList.erase(_objectList.begin() + i, _objectList.begin() + i + count);
+    if (signalRows) {
+        endRemoveRows();
+    }
+    if (_batchDepth == 0) {
+        emit countChanged(this->count());
+    }
+
     setDirty(true);
-    return removedObject;
+    return removed;
 }
 
-void QmlObjectListModel::insert(int i, QObject* object)
+QObject* QmlObjectListModel::replace(int i, QObject* object)
 {
-    if (i < 0 || i > _objectList.count()) {
-        qWarning() << "Invalid index index:count" << i << _objectList.count();
+    QObjectList replaced = replace(i, QObjectList({ object }));
+    return replaced.isEmpty() ? nullptr : replaced.first();
+}
+
+QObjectList QmlObjectListModel::replace(int i, const QObjectList& objects)
+{
+    QObjectList replaced;
+
+    if (i < 0 || i + objects.count() > _objectList.count()) {
+        qWarning() << "Invalid range index:count:list count" << i << objects.count() << _objectList.count();
+        return replaced;
     }
-    if(object) {
-        QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
+    if (objects.isEmpty()) {
+        return replaced;
+    }
+
+    replaced = _objectList.mid(i, objects.count());
+    for (int j=0; j<objects.count(); j++) {
+        QObject* object = objects[j];
+        _disconnectDirty(replaced[j], i + j);
+        if (object) {
+            QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
+            _connectDirty(object, i + j);
         }
+        _objectList[i + j] = object;
     }
-    _objectList.insert(i, object);
-    insertRows(i, 1);
+
+    if (_signalRowChanges()) {
+        emit dataChanged(index(i), index(i + objects.count() - 1));
+    }
+
     setDirty(true);
+    return replaced;
+}
+
+void QmlObjectListModel::insert(int i, QObject* object)
+{
+    insert(i, QObjectList({ object }));
 }
 
 void QmlObjectListModel::insert(int i, QList<QObject*> objects)
 {
     if (i < 0 || i > _objectList.count()) {
         qWarning() << "Invalid index index:count" << i << _objectList.count();
+        return;
+    }
+    if (objects.isEmpty()) {
+        return;
     }
 
-    int j = i;
-    for (QObject* object: objects) {
-        QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || j != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
+    for (int j=0; j<objects.count(); j++) {
+        QObject* object = objects[j];
+        if (object) {
+            QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
+            _connectDirty(object, i + j);
         }
-        j++;
-
-        _objectList.insert(j, object);
     }
 
-    insertRows(i, objects.count());
+    bool signalRows = _signalRowChanges();
+    if (signalRows) {
+        beginInsertRows(QModelIndex(), i, i + objects.count() - 1);
+    }
+    if (i == _objectList.count()) {
+        _objectList.append(objects);
+    } else {
+        QObjectList newList;
+        newList.reserve(_objectList.count() + objects.count());
+        newList.append(_objectList.mid(0, i));
+        newList.append(objects);
+        newList.append(_objectList.mid(i));
+        _objectList.swap(newList);
+    }
+    if (signalRows) {
+        endInsertRows();
+    }
+    if (_batchDepth == 0) {
+        emit countChanged(count());
+    }
 
     setDirty(true);
 }
@@ -243,11 +331,13 @@ void QmlObjectListModel::append(QList<QObject*> objects)
 QObjectList QmlObjectListModel::swapObjectList(const QObjectList& newlist)
 {
     QObjectList oldlist(_objectList);
-    if (!_externalBeginResetModel) {
+    bool        signalRows = _signalRowChanges();
+
+    if (signalRows) {
         beginResetModel();
     }
     _objectList = newlist;
-    if (!_externalBeginResetModel) {
+    if (signalRows) {
         endResetModel();
         emit countChanged(count());
     }
@@ -293,12 +383,10 @@ void QmlObjectListModel::deleteListAndContents()
 
 void QmlObjectListModel::clearAndDeleteContents()
 {
-    beginResetModel();
     for (int i=0; i<_objectList.count(); i++) {
         _objectList[i]->deleteLater();
     }
     clear();
-    endResetModel();
 }
 
 void QmlObjectListModel::beginReset()
@@ -318,3 +406,28 @@ void QmlObjectListModel::endReset()
     _externalBeginResetModel = false;
     endResetModel();
 }
+
+void QmlObjectListModel::beginBatch()
+{
+    if (_batchDepth++ == 0) {
+        _batchResetStarted  = false;
+        _batchStartCount    = _objectList.count();
+    }
+}
+
+void QmlObjectListModel::endBatch()
+{
+    if (_batchDepth == 0) {
+        qWarning() << "QmlObjectListModel::endBatch begin not called";
+        return;
+    }
+    if (--_batchDepth == 0) {
+        if (_batchResetStarted) {
+            _batchResetStarted = false;
+            endResetModel();
+        }
+        if (_objectList.count() != _batchStartCount) {
+            emit countChanged(count());
+        }
+    }
+}
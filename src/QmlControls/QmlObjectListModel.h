@@ -46,9 +46,39 @@ public:
     bool        contains            (QObject* object) { return _objectList.indexOf(object) != -1; }
     int         indexOf             (QObject* object) { return _objectList.indexOf(object); }
 
+    /// Removes count items starting at i with a single row removal notification
+    /// @return Removed items, ownership passes to the caller
+    QObjectList removeRange(int i, int count);
+
+    /// Replaces the item at i with a single data changed notification
+    /// @return Replaced item, ownership passes to the caller
+    QObject* replace(int i, QObject* object);
+
+    /// Replaces objects.count() items starting at i with a single data changed notification
+    /// @return Replaced items, ownership passes to the caller
+    QObjectList replace(int i, const QObjectList& objects);
+
     /// Moves an item to a new position
     void move(int from, int to);
 
+    /// Moves count items starting at from such that the first of them ends up at index to
+    void moveRange(int from, int count, int to);
+
+    /// Starts a batch of changes. Until the matching endBatch, changes do not send row or count notifications. If the
+    /// batch changes anything the views see a single model reset when the batch ends. Batches can be nested.
+    void beginBatch                 ();
+    void endBatch                   ();
+
+    /// Scoped batch: begins a batch on construction, ends it on destruction
+    class Batch {
+    public:
+        Batch(QmlObjectListModel* model) : _model(model) { _model->beginBatch(); }
+        ~Batch() { _model->endBatch(); }
+    private:
+        Q_DISABLE_COPY(Batch)
+        QmlObjectListModel* _model;
+    };
+
     QObject*    operator[]          (int i);
     const QObject* operator[]       (int i) const;
     template<class T> T value       (int index) { return qobject_cast<T>(_objectList[index]); }
@@ -71,10 +101,13 @@ private slots:
     void _childDirtyChanged         (bool dirty);
     
 private:
+    bool _signalRowChanges  (void);
+    void _connectDirty      (QObject* object, int row);
+    void _disconnectDirty   (QObject* object, int row);
+
     // Overrides from QAbstractListModel
     int         rowCount    (const QModelIndex & parent = QModelIndex()) const override;
     QVariant    data        (const QModelIndex & index, int role = Qt::DisplayRole) const override;
-    bool        insertRows  (int position, int rows, const QModelIndex &index = QModelIndex()) override;
     bool        removeRows  (int position, int rows, const QModelIndex &index = QModelIndex()) override;
     bool        setData     (const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     QHash<int, QByteArray> roleNames(void) const override;
@@ -85,6 +118,9 @@ private:
     bool _dirty;
     bool _skipDirtyFirstItem;
     bool _externalBeginResetModel;
+    int  _batchDepth        = 0;
+    bool _batchResetStarted = false;    ///< true: beginResetModel has been called for the current batch
+    int  _batchStartCount   = 0;
         
     static const int ObjectRole;
     static const int TextRole;
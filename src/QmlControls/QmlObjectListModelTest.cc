@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QmlObjectListModelTest.h"
+#include "QmlObjectListModel.h"
+
+#include <QSignalSpy>
+
+QObjectList QmlObjectListModelTest::_createObjects(int count, QObject* parent)
+{
+    QObjectList objects;
+
+    for (int i=0; i<count; i++) {
+        QObject* object = new QObject(parent);
+        object->setObjectName(QString::number(i));
+        objects.append(object);
+    }
+    return objects;
+}
+
+QStringList QmlObjectListModelTest::_names(QmlObjectListModel& model)
+{
+    QStringList names;
+
+    for (int i=0; i<model.count(); i++) {
+        names.append(model[i]->objectName());
+    }
+    return names;
+}
+
+void QmlObjectListModelTest::_testInsert(void)
+{
+    QObject             parent;
+    QmlObjectListModel  model;
+    QObjectList         objects = _createObjects(5, &parent);
+    QSignalSpy          insertedSpy (&model, &QmlObjectListModel::rowsInserted);
+    QSignalSpy          countSpy    (&model, &QmlObjectListModel::countChanged);
+
+    model.append(objects[0]);
+    model.append(objects[4]);
+    model.insert(1, QObjectList({ objects[1], objects[2], objects[3] }));
+
+    QCOMPARE(_names(model), QStringList({ "0", "1", "2", "3", "4" }));
+    QCOMPARE(insertedSpy.count(), 3);
+    QCOMPARE(countSpy.count(), 3);
+
+    // Range insert is a single notification covering all the new rows
+    QList<QVariant> arguments = insertedSpy.takeLast();
+    QCOMPARE(arguments[1].toInt(), 1);
+    QCOMPARE(arguments[2].toInt(), 3);
+    QVERIFY(model.dirty());
+}
+
+void QmlObjectListModelTest::_testRemoveRange(void)
+{
+    QObject             parent;
+    QmlObjectListModel  model;
+    QObjectList         objects = _createObjects(5, &parent);
+
+    model.append(objects);
+
+    QSignalSpy removedSpy   (&model, &QmlObjectListModel::rowsRemoved);
+    QSignalSpy countSpy     (&model, &QmlObjectListModel::countChanged);
+
+    QObjectList removed = model.removeRange(1, 3);
+    QCOMPARE(removed, QObjectList({ objects[1], objects[2], objects[3] }));
+    QCOMPARE(_names(model), QStringList({ "0", "4" }));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(countSpy.count(), 1);
+
+    QList<QVariant> arguments = removedSpy.takeFirst();
+    QCOMPARE(arguments[1].toInt(), 1);
+    QCOMPARE(arguments[2].toInt(), 3);
+
+    // Invalid ranges leave the model untouched
+    QVERIFY(model.removeRange(1, 2).isEmpty());
+    QCOMPARE(model.count(), 2);
+
+    QCOMPARE(model.removeAt(1), objects[4]);
+    QCOMPARE(_names(model), QStringList({ "0" }));
+}
+
+void QmlObjectListModelTest::_testMoveRange(void)
+{
+    QObject             parent;
+    QmlObjectListModel  model;
+
+    model.append(_createObjects(6, &parent));
+
+    QSignalSpy movedSpy(&model, &QmlObjectListModel::rowsMoved);
+
+    model.moveRange(1, 2, 3);
+    QCOMPARE(_names(model), QStringList({ "0", "3", "4", "1", "2", "5" }));
+
+    model.moveRange(3, 2, 1);
+    QCOMPARE(_names(model), QStringList({ "0", "1", "2", "3", "4", "5" }));
+
+    model.move(0, 5);
+    QCOMPARE(_names(model), QStringList({ "1", "2", "3", "4", "5", "0" }));
+
+    model.move(4, 5);
+    QCOMPARE(_names(model), QStringList({ "1", "2", "3", "4", "0", "5" }));
+
+    QCOMPARE(movedSpy.count(), 4);
+}
+
+void QmlObjectListModelTest::_testReplace(void)
+{
+    QObject             parent;
+    QmlObjectListModel  model;
+    QObjectList         objects     = _createObjects(4, &parent);
+    QObjectList         newObjects  = _createObjects(2, &parent);
+
+    model.append(objects);
+
+    QSignalSpy changedSpy   (&model, &QmlObjectListModel::dataChanged);
+    QSignalSpy countSpy     (&model, &QmlObjectListModel::countChanged);
+
+    QObjectList replaced = model.replace(1, newObjects);
+    QCOMPARE(replaced, QObjectList({ objects[1], objects[2] }));
+    QCOMPARE(model[1], newObjects[0]);
+    QCOMPARE(model[2], newObjects[1]);
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(countSpy.count(), 0);
+
+    QCOMPARE(model.replace(3, objects[1]), objects[3]);
+    QCOMPARE(model[3], objects[1]);
+    QCOMPARE(changedSpy.count(), 2);
+}
+
+void QmlObjectListModelTest::_testBatch(void)
+{
+    QObject             parent;
+    QmlObjectListModel  model;
+
+    model.append(_createObjects(10, &parent));
+
+    QSignalSpy resetSpy     (&model, &QmlObjectListModel::modelReset);
+    QSignalSpy insertedSpy  (&model, &QmlObjectListModel::rowsInserted);
+    QSignalSpy removedSpy   (&model, &QmlObjectListModel::rowsRemoved);
+    QSignalSpy countSpy     (&model, &QmlObjectListModel::countChanged);
+
+    {
+        QmlObjectListModel::Batch batch(&model);
+        for (int i=0; i<5; i++) {
+            model.removeAt(0);
+        }
+        {
+            // Nested batches are folded into the outer one
+            QmlObjectListModel::Batch nestedBatch(&model);
+            model.append(_createObjects(3, &parent));
+        }
+        QCOMPARE(resetSpy.count(), 0);
+    }
+
+    QCOMPARE(model.count(), 8);
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(countSpy.count(), 1);
+
+    // A batch without changes sends nothing
+    model.beginBatch();
+    model.endBatch();
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(countSpy.count(), 1);
+}
+
+void QmlObjectListModelTest::_benchmarkAppendSingle(void)
+{
+    QObject     parent;
+    QObjectList objects = _createObjects(_benchmarkCount, &parent);
+
+    QBENCHMARK {
+        QmlObjectListModel model;
+        for (QObject* object: objects) {
+            model.append(object);
+        }
+    }
+}
+
+void QmlObjectListModelTest::_benchmarkAppendList(void)
+{
+    QObject     parent;
+    QObjectList objects = _createObjects(_benchmarkCount, &parent);
+
+    QBENCHMARK {
+        QmlObjectListModel model;
+        model.append(objects);
+    }
+}
+
+void QmlObjectListModelTest::_benchmarkRemoveSingle(void)
+{
+    QObject     parent;
+    QObjectList objects = _createObjects(_benchmarkCount, &parent);
+
+    QBENCHMARK {
+        QmlObjectListModel model;
+        model.append(objects);
+        while (model.count()) {
+            model.removeAt(model.count() - 1);
+        }
+    }
+}
+
+void QmlObjectListModelTest::_benchmarkRemoveRange(void)
+{
+    QObject     parent;
+    QObjectList objects = _createObjects(_benchmarkCount, &parent);
+
+    QBENCHMARK {
+        QmlObjectListModel model;
+        model.append(objects);
+        model.removeRange(0, model.count());
+    }
+}
+
+void QmlObjectListModelTest::_benchmarkBatch(void)
+{
+    QObject     parent;
+    QObjectList objects = _createObjects(_benchmarkCount, &parent);
+
+    QBENCHMARK {
+        QmlObjectListModel model;
+        QmlObjectListModel::Batch batch(&model);
+        for (QObject* object: objects) {
+            model.append(object);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QmlObjectListModel;
+
+class QmlObjectListModelTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testInsert(void);
+    void _testRemoveRange(void);
+    void _testMoveRange(void);
+    void _testReplace(void);
+    void _testBatch(void);
+    void _benchmarkAppendSingle(void);
+    void _benchmarkAppendList(void);
+    void _benchmarkRemoveSingle(void);
+    void _benchmarkRemoveRange(void);
+    void _benchmarkBatch(void);
+
+private:
+    QObjectList _createObjects  (int count, QObject* parent);
+    QStringList _names          (QmlObjectListModel& model);
+
+    static const int _benchmarkCount = 10000;
+};
@@ -23,7 +23,11 @@ HEADERS += \
     $$PWD/QGCMapEngineData.h \
     $$PWD/QGCMapTileSet.h \
     $$PWD/QGCMapUrlEngine.h \
+    $$PWD/QGCTileCacheReader.h \
     $$PWD/QGCTileCacheWorker.h \
+    $$PWD/QGCTileDownloadControl.h \
+    $$PWD/QGCTileMemoryCache.h \
+    $$PWD/QGCTilePrefetcher.h \
     $$PWD/QGeoCodeReplyQGC.h \
     $$PWD/QGeoCodingManagerEngineQGC.h \
     $$PWD/QGeoMapReplyQGC.h \
@@ -44,7 +48,11 @@ SOURCES += \
     $$PWD/QGCMapEngine.cpp \
     $$PWD/QGCMapTileSet.cpp \
     $$PWD/QGCMapUrlEngine.cpp \
+    $$PWD/QGCTileCacheReader.cpp \
     $$PWD/QGCTileCacheWorker.cpp \
+    $$PWD/QGCTileDownloadControl.cpp \
+    $$PWD/QGCTileMemoryCache.cpp \
+    $$PWD/QGCTilePrefetcher.cpp \
     $$PWD/QGeoCodeReplyQGC.cpp \
     $$PWD/QGeoCodingManagerEngineQGC.cpp \
     $$PWD/QGeoMapReplyQGC.cpp \
@@ -87,7 +87,6 @@ QGCMapEngine::QGCMapEngine()
 #endif
     , _maxDiskCache(0)
     , _maxMemCache(0)
-    , _prunning(false)
     , _cacheWasReset(false)
     , _isInternetActive(false)
 {
@@ -165,6 +164,8 @@ QGCMapEngine::init()
     } else {
         qCritical() << "Could not find suitable map cache directory.";
     }
+    _updateMemoryCacheSize();
+    _worker.setMaxDiskCache(static_cast<quint64>(getMaxDiskCache()) * 1024 * 1024);
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
 }
@@ -195,51 +196,79 @@ QGCMapEngine::_wipeDirectory(const QString& dirPath)
 void
 QGCMapEngine::addTask(QGCMapTask* task)
 {
+    //-- Tiles held in memory must not outlive a reset or a replaced database
+    if(task->type() == QGCMapTask::taskReset || task->type() == QGCMapTask::taskImport) {
+        _memoryCache.clear();
+    }
     _worker.enqueueTask(task);
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCMapEngine::cacheTile(QString type, int x, int y, int z, const QByteArray& image, const QString &format, qulonglong set)
+QGCMapEngine::cacheTile(int mapId, int x, int y, int z, const QByteArray& image, const QString &format, qulonglong set)
 {
-    QString hash = getTileHash(type, x, y, z);
-    cacheTile(type, hash, image, format, set);
+    cacheTile(getTileKey(mapId, x, y, z), image, format, set);
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCMapEngine::cacheTile(QString type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set)
+QGCMapEngine::cacheTile(quint64 key, const QByteArray& image, const QString& format, qulonglong set)
 {
+    //-- Tiles of providers without a tile key index can't be cached
+    if(!key) {
+        return;
+    }
     AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
     //-- If we are allowed to persist data, save tile to cache
     if(!appSettings->disableAllPersistence()->rawValue().toBool()) {
-        QGCSaveTileTask* task = new QGCSaveTileTask(new QGCCacheTile(hash, image, format, type, set));
+        QGCSaveTileTask* task = new QGCSaveTileTask(new QGCCacheTile(key, image, format, tileKeyToMapId(key), set));
         _worker.enqueueTask(task);
     }
 }
 
 //-----------------------------------------------------------------------------
-QString
-QGCMapEngine::getTileHash(QString type, int x, int y, int z)
+//  The key packs the provider, zoom, x and y of a tile into a single integer. It is the primary key of the tile in
+//  the cache database and the key of tiles held in memory, so no strings are built when looking up a tile.
+//  Returns 0 if the provider has no tile key index or the tile is out of range.
+quint64
+QGCMapEngine::getTileKey(int mapId, int x, int y, int z)
+{
+    quint64 provider = static_cast<quint64>(getQGCMapEngine()->urlFactory()->getTileKeyIndex(mapId));
+    if(!provider || x < 0 || y < 0 || z < 0 || x >= (1 << TILE_KEY_XY_BITS) || y >= (1 << TILE_KEY_XY_BITS) || z >= (1 << (TILE_KEY_PROVIDER_SHIFT - TILE_KEY_ZOOM_SHIFT))) {
+        return 0;
+    }
+    return (provider << TILE_KEY_PROVIDER_SHIFT) |
+           (static_cast<quint64>(z) << TILE_KEY_ZOOM_SHIFT) |
+           (static_cast<quint64>(x) << TILE_KEY_X_SHIFT) |
+           static_cast<quint64>(y);
+}
+
+//-----------------------------------------------------------------------------
+quint64
+QGCMapEngine::getTileKey(QString type, int x, int y, int z)
 {
-    return QString::asprintf("%010d%08d%08d%03d", getQGCMapEngine()->urlFactory()->getIdFromType(type), x, y, z);
+    return getTileKey(getQGCMapEngine()->urlFactory()->getIdFromType(type), x, y, z);
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCMapEngine::tileKeyToMapId(quint64 key)
+{
+    return getQGCMapEngine()->urlFactory()->getIdFromTileKeyIndex(static_cast<int>(key >> TILE_KEY_PROVIDER_SHIFT));
 }
 
 //-----------------------------------------------------------------------------
 QString
-QGCMapEngine::hashToType(const QString& hash)
+QGCMapEngine::tileKeyToType(quint64 key)
 {
-    QString type = hash.mid(0,10);
-    return urlFactory()->getTypeFromId(type.toInt());
+    return urlFactory()->getTypeFromId(tileKeyToMapId(key));
 }
 
 //-----------------------------------------------------------------------------
-	QGCFetchTileTask*
-QGCMapEngine::createFetchTileTask(QString type, int x, int y, int z)
+QGCFetchTileTask*
+QGCMapEngine::createFetchTileTask(int mapId, int x, int y, int z)
 {
-	QString hash = getTileHash(type, x, y, z);
-	QGCFetchTileTask* task = new QGCFetchTileTask(hash);
-	return task;
+    return new QGCFetchTileTask(getTileKey(mapId, x, y, z));
 }
 
 //-----------------------------------------------------------------------------
@@ -278,6 +307,7 @@ QGCMapEngine::setMaxDiskCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxDiskCacheKey, size);
     _maxDiskCache = size;
+    _worker.setMaxDiskCache(static_cast<quint64>(size) * 1024 * 1024);
 }
 
 //-----------------------------------------------------------------------------
@@ -308,6 +338,16 @@ QGCMapEngine::setMaxMemCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxMemCacheKey, size);
     _maxMemCache = size;
+    _updateMemoryCacheSize();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::_updateMemoryCacheSize()
+{
+    //-- The memory cache setting is shared with the decoded texture cache of QtLocation. Encoded tiles are a
+    //   fraction of the size of decoded ones, so a quarter of it holds many more tiles than QtLocation does.
+    _memoryCache.setMaxBytes(static_cast<quint64>(getMaxMemCache()) * 1024 * 1024 / 4);
 }
 
 //-----------------------------------------------------------------------------
@@ -349,21 +389,8 @@ QGCMapEngine::numberToString(quint64 number)
 void
 QGCMapEngine::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize)
 {
+    //-- The disk cache is kept under its limit by the worker, see QGCCacheWorker::setMaxDiskCache
     emit updateTotals(totaltiles, totalsize, defaulttiles, defaultsize);
-    quint64 maxSize = static_cast<quint64>(getMaxDiskCache()) * 1024L * 1024L;
-    if(!_prunning && defaultsize > maxSize) {
-        //-- Prune Disk Cache
-        _prunning = true;
-        QGCPruneCacheTask* task = new QGCPruneCacheTask(defaultsize - maxSize);
-        connect(task, &QGCPruneCacheTask::pruned, this, &QGCMapEngine::_pruned);
-        getQGCMapEngine()->addTask(task);
-    }
-}
-//-----------------------------------------------------------------------------
-void
-QGCMapEngine::_pruned()
-{
-    _prunning = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -24,6 +24,13 @@
 #include "QGCMapUrlEngine.h"
 #include "QGCMapEngineData.h"
 #include "QGCTileCacheWorker.h"
+#include "QGCTileMemoryCache.h"
+
+//-- Tile key layout, see QGCMapEngine::getTileKey. Bit 63 stays clear since SQLite integers are signed.
+#define TILE_KEY_PROVIDER_SHIFT 53  ///< 10 bits: UrlFactory tile key index of the provider
+#define TILE_KEY_ZOOM_SHIFT     48  ///< 5 bits
+#define TILE_KEY_X_SHIFT        24  ///< 24 bits
+#define TILE_KEY_XY_BITS        24  ///< Bits for each of x and y, enough for zoom levels up to 24
 
 
 //-----------------------------------------------------------------------------
@@ -36,13 +43,13 @@ public:
 
     void                        init                ();
     void                        addTask             (QGCMapTask *task);
-    void                        cacheTile           (QString type, int x, int y, int z, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
-    void                        cacheTile           (QString type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
-    QGCFetchTileTask*           createFetchTileTask (QString type, int x, int y, int z);
+    void                        cacheTile           (int mapId, int x, int y, int z, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
+    void                        cacheTile           (quint64 key, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
+    QGCFetchTileTask*           createFetchTileTask (int mapId, int x, int y, int z);
     QStringList                 getMapNameList      ();
     const QString               userAgent           () { return _userAgent; }
     void                        setUserAgent        (const QString& ua) { _userAgent = ua; }
-    QString         hashToType          (const QString& hash);
+    QString                     tileKeyToType       (quint64 key);
     quint32                     getMaxDiskCache     ();
     void                        setMaxDiskCache     (quint32 size);
     quint32                     getMaxMemCache      ();
@@ -55,9 +62,18 @@ public:
 
     UrlFactory*                 urlFactory          () { return _urlFactory; }
 
+    //-- Recently served tiles, looked up before going to the cache database
+    QGCTileMemoryCache*         memoryCache         () { return &_memoryCache; }
+    QGCTileMemoryCache::Stats_t tileMemoryCacheStats() { return _memoryCache.stats(); }
+
+    //-- Latency of tile fetches from the cache database, over the most recent fetches
+    QGCTileCacheReaderPool::Latency_t tileFetchLatency  () { return _worker.tileFetchLatency(); }
+
     //-- Tile Math
     static QGCTileSet           getTileCount        (int zoom, double topleftLon, double topleftLat, double bottomRightLon, double bottomRightLat, QString mapType);
-    static QString              getTileHash         (QString type, int x, int y, int z);
+    static quint64              getTileKey          (int mapId, int x, int y, int z);
+    static quint64              getTileKey          (QString type, int x, int y, int z);
+    static int                  tileKeyToMapId      (quint64 key);
     static QString              getTypeFromName     (const QString &name);
     static QString              bigSizeToString     (quint64 size);
     static QString              storageFreeSizeToString(quint64 size_MB);
@@ -66,7 +82,6 @@ public:
 
 private slots:
     void _updateTotals          (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
-    void _pruned                ();
     void _internetStatus        (bool active);
 
 signals:
@@ -75,18 +90,19 @@ signals:
 
 private:
     void _wipeOldCaches         ();
+    void _updateMemoryCacheSize ();
     void _checkWipeDirectory    (const QString& dirPath);
     bool _wipeDirectory         (const QString& dirPath);
 
 private:
     QGCCacheWorker          _worker;
+    QGCTileMemoryCache      _memoryCache;
     QString                 _cachePath;
     QString                 _cacheFile;
     UrlFactory*             _urlFactory;
     QString                 _userAgent;
     quint32                 _maxDiskCache;
     quint32                 _maxMemCache;
-    bool                    _prunning;
     bool                    _cacheWasReset;
     bool                    _isInternetActive;
 };
@@ -23,6 +23,7 @@
 #include <QString>
 #include <QHash>
 #include <QDateTime>
+#include <QElapsedTimer>
 
 #include "QGCMapUrlEngine.h"
 
@@ -37,6 +38,7 @@ public:
         , _y(0)
         , _z(0)
         , _set(UINT64_MAX)
+        , _key(0)
         , _type("Invalid")
     {
     }
@@ -52,14 +54,14 @@ public:
     int                 y           () const { return _y; }
     int                 z           () const { return _z; }
     qulonglong          set         () const { return _set;  }
-    const QString       hash        () const { return _hash; }
+    quint64             key         () const { return _key; }
     QString type        () const { return _type; }
 
     void                setX        (int x) { _x = x; }
     void                setY        (int y) { _y = y; }
     void                setZ        (int z) { _z = z; }
     void                setTileSet  (qulonglong set) { _set = set;  }
-    void                setHash     (const QString& hash) { _hash = hash; }
+    void                setKey      (quint64 key) { _key = key; }
     void                setType     (QString type) { _type = type; }
 
 private:
@@ -67,7 +69,7 @@ private:
     int         _y;
     int         _z;
     qulonglong  _set;
-    QString     _hash;
+    quint64     _key;
     QString _type;
 };
 
@@ -76,30 +78,31 @@ class QGCCacheTile : public QObject
 {
     Q_OBJECT
 public:
-    QGCCacheTile    (const QString hash, const QByteArray img, const QString format, QString type, qulonglong set = UINT64_MAX)
+    QGCCacheTile    (quint64 key, const QByteArray img, const QString format, int mapId, qulonglong set = UINT64_MAX)
         : _set(set)
-        , _hash(hash)
+        , _key(key)
         , _img(img)
         , _format(format)
-        , _type(type)
+        , _mapId(mapId)
     {
     }
-    QGCCacheTile    (const QString hash, qulonglong set)
+    QGCCacheTile    (quint64 key, qulonglong set)
         : _set(set)
-        , _hash(hash)
+        , _key(key)
+        , _mapId(-1)
     {
     }
     qulonglong          set     () { return _set;   }
-    QString             hash    () { return _hash;  }
+    quint64             key     () { return _key;   }
     QByteArray          img     () { return _img;   }
     QString             format  () { return _format;}
-    QString type    () { return _type; }
+    int                 mapId   () { return _mapId; }
 private:
     qulonglong  _set;
-    QString     _hash;
+    quint64     _key;
     QByteArray  _img;
     QString     _format;
-    QString _type;
+    int         _mapId;
 };
 
 //-----------------------------------------------------------------------------
@@ -122,7 +125,8 @@ public:
         taskPruneCache,
         taskReset,
         taskExport,
-        taskImport
+        taskImport,
+        taskDeduplicate
     };
 
     QGCMapTask(TaskType type)
@@ -208,10 +212,14 @@ class QGCFetchTileTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCFetchTileTask(const QString hash)
+    //-- Low priority fetches are served only when no other fetch is waiting
+    QGCFetchTileTask(quint64 key, bool lowPriority = false)
         : QGCMapTask(QGCMapTask::taskFetchTile)
-        , _hash(hash)
-    {}
+        , _key(key)
+        , _lowPriority(lowPriority)
+    {
+        _timer.start();
+    }
 
     ~QGCFetchTileTask()
     {
@@ -222,13 +230,19 @@ public:
         emit tileFetched(tile);
     }
 
-    QString         hash() { return _hash; }
+    quint64         key() { return _key; }
+    bool            lowPriority() { return _lowPriority; }
+
+    //-- Time since the task was created
+    qint64          elapsedNsecs() { return _timer.nsecsElapsed(); }
 
 signals:
     void            tileFetched     (QGCCacheTile* tile);
 
 private:
-    QString         _hash;
+    quint64         _key;
+    bool            _lowPriority;
+    QElapsedTimer   _timer;
 };
 
 //-----------------------------------------------------------------------------
@@ -285,21 +299,34 @@ class QGCUpdateTileDownloadStateTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, const QString& hash)
+    //-- A key of 0 updates all tiles of the set
+    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, quint64 key)
         : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
         , _setID(setID)
         , _state(state)
-        , _hash(hash)
+    {
+        if(key) {
+            _keys.append(key);
+        }
+    }
+
+    //-- Updates the tiles in a single task, the list must not be empty
+    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, const QList<quint64>& keys)
+        : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
+        , _setID(setID)
+        , _state(state)
+        , _keys(keys)
     {}
 
-    QString             hash    () { return _hash; }
+    //-- Empty for all tiles of the set
+    const QList<quint64>& keys  () { return _keys; }
     qulonglong          setID   () { return _setID; }
     QGCTile::TyleState  state   () { return _state; }
 
 private:
     qulonglong          _setID;
     QGCTile::TyleState  _state;
-    QString             _hash;
+    QList<quint64>      _keys;
 };
 
 //-----------------------------------------------------------------------------
@@ -463,4 +490,29 @@ signals:
 
 };
 
+//-----------------------------------------------------------------------------
+class QGCDeduplicateTask : public QGCMapTask
+{
+    Q_OBJECT
+public:
+    QGCDeduplicateTask()
+        : QGCMapTask(QGCMapTask::taskDeduplicate)
+    {}
+
+    void setDeduplicateCompleted(quint32 tileCount, quint32 imageCount, quint64 savedSize)
+    {
+        emit deduplicateCompleted(tileCount, imageCount, savedSize);
+    }
+
+    void setProgress(int percentage)
+    {
+        emit actionProgress(percentage);
+    }
+
+signals:
+    void deduplicateCompleted   (quint32 tileCount, quint32 imageCount, quint64 savedSize);
+    void actionProgress         (int percentage);
+
+};
+
 #endif // QGC_MAP_ENGINE_DATA_H
@@ -28,6 +28,18 @@ QGC_LOGGING_CATEGORY(QGCCachedTileSetLog, "QGCCachedTileSetLog")
 
 #define TILE_BATCH_SIZE      256
 
+//-- Completed tiles are marked in the database in batches of this many
+#define STATE_BATCH_SIZE     32
+
+//-- Concurrency adapts from QGCMapEngine::concurrentDownloads up to this many times it
+#define MAX_CONCURRENCY_FACTOR  4
+
+//-- A tile throttled more than this many times is counted as an error
+#define MAX_THROTTLE_RETRIES    5
+
+//-- Rate shown while downloading is refreshed this often, also while backing off
+#define RATE_UPDATE_MSECS       1000
+
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::QGCCachedTileSet(const QString& name)
     : _name(name)
@@ -52,15 +64,24 @@ QGCCachedTileSet::QGCCachedTileSet(const QString& name)
     , _errorCount(0)
     , _noMoreTiles(false)
     , _batchRequested(false)
+    , _downloadControl(1, 1)
+    , _tilesPerSecond(0.0)
     , _manager(nullptr)
     , _selected(false)
 {
-
+    _backoffTimer.setSingleShot(true);
+    connect(&_backoffTimer, &QTimer::timeout, this, &QGCCachedTileSet::_prepareDownload);
+    _rateTimer.setInterval(RATE_UPDATE_MSECS);
+    connect(&_rateTimer, &QTimer::timeout, this, &QGCCachedTileSet::_updateTilesPerSecond);
 }
 
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::~QGCCachedTileSet()
 {
+    for(const Download_t& download: _replies) {
+        delete download.tile;
+    }
+    qDeleteAll(_tilesToDownload);
     delete _networkManager;
     _networkManager = nullptr;
 }
@@ -72,6 +93,13 @@ QGCCachedTileSet::errorCountStr()
     return QGCMapEngine::numberToString(_errorCount);
 }
 
+//-----------------------------------------------------------------------------
+QString
+QGCCachedTileSet::tilesPerSecondStr()
+{
+    return QString::number(_tilesPerSecond, 'f', 1);
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCCachedTileSet::totalTileCountStr()
@@ -136,6 +164,10 @@ QGCCachedTileSet::createDownloadTask()
         _errorCount   = 0;
         _downloading  = true;
         _noMoreTiles  = false;
+        int concurrency = QGCMapEngine::concurrentDownloads(_type);
+        _downloadControl = QGCTileDownloadControl(concurrency, concurrency * MAX_CONCURRENCY_FACTOR);
+        _downloadClock.start();
+        _rateTimer.start();
         emit downloadingChanged();
         emit errorCountChanged();
     }
@@ -154,7 +186,7 @@ void
 QGCCachedTileSet::resumeDownloadTask()
 {
     //-- Reset and download error flag (for all tiles)
-    QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, "*");
+    QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, 0);
     getQGCMapEngine()->addTask(task);
     //-- Start download
     createDownloadTask();
@@ -166,6 +198,23 @@ QGCCachedTileSet::cancelDownloadTask()
 {
     if(_downloading) {
         _downloading = false;
+        //-- Aborted replies are ignored, their tiles are left for the next download
+        QHash<quint64, Download_t> replies;
+        replies.swap(_replies);
+        for(const Download_t& download: replies) {
+            download.reply->abort();
+            delete download.tile;
+        }
+        qDeleteAll(_tilesToDownload);
+        _tilesToDownload.clear();
+        _backoffTimer.stop();
+        _rateTimer.stop();
+        _throttleRetries.clear();
+        _flushCompletedTiles();
+        //-- Tiles handed out for download go back to pending, so resuming picks them up
+        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, 0);
+        getQGCMapEngine()->addTask(task);
+        _updateTilesPerSecond();
         emit downloadingChanged();
     }
 }
@@ -175,6 +224,10 @@ void
 QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
 {
     _batchRequested = false;
+    if(!_downloading) {
+        qDeleteAll(tiles);
+        return;
+    }
     //-- Done?
     if(tiles.size() < TILE_BATCH_SIZE) {
         _noMoreTiles = true;
@@ -186,6 +239,12 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
     //-- If this is the first time, create Network Manager
     if (!_networkManager) {
         _networkManager = new QNetworkAccessManager(this);
+#if !defined(__mobile__)
+        //-- Set once, the manager keeps its connections open across requests
+        QNetworkProxy proxy;
+        proxy.setType(QNetworkProxy::DefaultProxy);
+        _networkManager->setProxy(proxy);
+#endif
     }
     //-- Add tiles to the list
     _tilesToDownload += tiles;
@@ -196,6 +255,7 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_doneWithDownload()
 {
+    _flushCompletedTiles();
     if(!_errorCount) {
         _totalTileCount = _savedTileCount;
         _totalTileSize  = _savedTileSize;
@@ -217,55 +277,78 @@ void QGCCachedTileSet::_doneWithDownload()
     emit savedTileCountChanged();
     emit uniqueTileSizeChanged();
     _downloading = false;
+    _rateTimer.stop();
+    _throttleRetries.clear();
+    _updateTilesPerSecond();
     emit downloadingChanged();
     emit completeChanged();
 }
 
+//-----------------------------------------------------------------------------
+void QGCCachedTileSet::_flushCompletedTiles()
+{
+    if(_completedKeys.count()) {
+        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, _completedKeys);
+        getQGCMapEngine()->addTask(task);
+        _completedKeys.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void QGCCachedTileSet::_updateTilesPerSecond()
+{
+    _tilesPerSecond = _downloading ? _downloadControl.tilesPerSecond(_downloadClock.elapsed()) : 0.0;
+    emit tilesPerSecondChanged();
+}
+
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_prepareDownload()
 {
+    if(!_downloading) {
+        return;
+    }
     if(!_tilesToDownload.count()) {
-        //-- Are we done?
+        //-- Are we done? Throttled replies still in flight may put their tiles back.
         if(_noMoreTiles) {
-            _doneWithDownload();
+            if(!_replies.count()) {
+                _doneWithDownload();
+            }
         } else {
             if(!_batchRequested)
                 createDownloadTask();
         }
         return;
     }
-    //-- Prepare queue (QNetworkAccessManager has a limit for concurrent downloads)
-    for(int i = _replies.count(); i < QGCMapEngine::concurrentDownloads(_type); i++) {
-        if(_tilesToDownload.count()) {
-            QGCTile* tile = _tilesToDownload.first();
-            _tilesToDownload.removeFirst();
-            QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
-            request.setAttribute(QNetworkRequest::User, tile->hash());
-#if !defined(__mobile__)
-            QNetworkProxy proxy = _networkManager->proxy();
-            QNetworkProxy tProxy;
-            tProxy.setType(QNetworkProxy::DefaultProxy);
-            _networkManager->setProxy(tProxy);
-#endif
-            QNetworkReply* reply = _networkManager->get(request);
-            reply->setParent(0);
-            connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
+    //-- Hold new requests back while the server is throttling us
+    qint64 backoff = _downloadControl.backoffMsecs(_downloadClock.elapsed());
+    if(backoff) {
+        if(!_backoffTimer.isActive()) {
+            _flushCompletedTiles();
+            _backoffTimer.start(static_cast<int>(backoff));
+        }
+        return;
+    }
+    while(_replies.count() < _downloadControl.concurrency() && _tilesToDownload.count()) {
+        QGCTile* tile = _tilesToDownload.takeFirst();
+        QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
+        request.setAttribute(QNetworkRequest::User, tile->key());
+        //-- Requests share the persistent connections of the manager, pipelined over HTTP/1.1 or multiplexed over HTTP/2
+        request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+        request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+        QNetworkReply* reply = _networkManager->get(request);
+        reply->setParent(0);
+        connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-            connect(reply, static_cast<void (QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error), this, &QGCCachedTileSet::_networkReplyError);
+        connect(reply, static_cast<void (QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error), this, &QGCCachedTileSet::_networkReplyError);
 #else
-            connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
-#endif
-            _replies.insert(tile->hash(), reply);
-#if !defined(__mobile__)
-            _networkManager->setProxy(proxy);
+        connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
 #endif
-            delete tile;
-            //-- Refill queue if running low
-            if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (QGCMapEngine::concurrentDownloads(_type) * 10)) {
-                //-- Request new batch of tiles
-                createDownloadTask();
-            }
-        }
+        _replies.insert(tile->key(), { reply, tile, _downloadClock.elapsed() });
+    }
+    //-- Refill queue if running low
+    if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (_downloadControl.concurrency() * 10)) {
+        //-- Request new batch of tiles
+        createDownloadTask();
     }
 }
 
@@ -279,27 +362,34 @@ QGCCachedTileSet::_networkReplyFinished()
         qWarning() << "QGCMapEngineManager::networkReplyFinished() NULL Reply";
         return;
     }
-    if (reply->error() == QNetworkReply::NoError) {
-        //-- Get tile hash
-        const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-        if(!hash.isEmpty()) {
-            if(_replies.contains(hash)) {
-                _replies.remove(hash);
+    if (_downloading && reply->error() == QNetworkReply::NoError) {
+        //-- Get tile key
+        const quint64 key = reply->request().attribute(QNetworkRequest::User).toULongLong();
+        if(key) {
+            qint64 now = _downloadClock.elapsed();
+            auto download = _replies.find(key);
+            if(download != _replies.end()) {
+                _downloadControl.replySucceeded(now - download->startMsecs, now);
+                _throttleRetries.remove(key);
+                delete download->tile;
+                _replies.erase(download);
             } else {
-                qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << hash;
+                qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << key;
             }
-            qCDebug(QGCCachedTileSetLog) << "Tile fetched" << hash;
+            qCDebug(QGCCachedTileSetLog) << "Tile fetched" << key << "concurrency" << _downloadControl.concurrency();
             QByteArray image = reply->readAll();
-            QString type = getQGCMapEngine()->hashToType(hash);
+            QString type = getQGCMapEngine()->tileKeyToType(key);
             if (type == "Airmap Elevation" ) {
                 image = TerrainTile::serialize(image);
             }
             QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
             if(!format.isEmpty()) {
                 //-- Cache tile
-                getQGCMapEngine()->cacheTile(type, hash, image, format, _id);
-                QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
-                getQGCMapEngine()->addTask(task);
+                getQGCMapEngine()->cacheTile(key, image, format, _id);
+                _completedKeys.append(key);
+                if(_completedKeys.count() >= STATE_BATCH_SIZE) {
+                    _flushCompletedTiles();
+                }
                 //-- Updated cached (downloaded) data
                 _savedTileSize += image.size();
                 _savedTileCount++;
@@ -317,7 +407,7 @@ QGCCachedTileSet::_networkReplyFinished()
             //-- Setup a new download
             _prepareDownload();
         } else {
-            qWarning() << "QGCMapEngineManager::networkReplyFinished() Empty Hash";
+            qWarning() << "QGCMapEngineManager::networkReplyFinished() Empty Key";
         }
     }
     reply->deleteLater();
@@ -332,25 +422,47 @@ QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
     if (!reply) {
         return;
     }
+    //-- Replies aborted by cancelDownloadTask
+    if (!_downloading) {
+        reply->deleteLater();
+        return;
+    }
+    //-- Get tile key
+    quint64 key = reply->request().attribute(QNetworkRequest::User).toULongLong();
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    auto download = _replies.find(key);
+    if (key && download != _replies.end() && (status == 429 || status == 503) && ++_throttleRetries[key] <= MAX_THROTTLE_RETRIES) {
+        //-- Throttled by the server. Not an error of the tile, it goes back to the front of the queue.
+        //   A server which keeps refusing the same tile (503 may also mean it is down) ends up counting it as an error.
+        qint64 retryAfter = reply->rawHeader("Retry-After").toLongLong() * 1000;
+        _downloadControl.replyThrottled(retryAfter, _downloadClock.elapsed());
+        _tilesToDownload.prepend(download->tile);
+        _replies.erase(download);
+        qCDebug(QGCCachedTileSetLog) << "Throttled" << status << "concurrency" << _downloadControl.concurrency()
+                                     << "backoff msecs" << _downloadControl.backoffMsecs(_downloadClock.elapsed());
+        _prepareDownload();
+        reply->deleteLater();
+        return;
+    }
     //-- Update error count
     _errorCount++;
     emit errorCountChanged();
-    //-- Get tile hash
-    QString hash = reply->request().attribute(QNetworkRequest::User).toString();
     qCDebug(QGCCachedTileSetLog) << "Error fetching tile" << reply->errorString();
-    if(!hash.isEmpty()) {
-        if(_replies.contains(hash)) {
-            _replies.remove(hash);
+    if(key) {
+        _throttleRetries.remove(key);
+        if(download != _replies.end()) {
+            delete download->tile;
+            _replies.erase(download);
         } else {
-            qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << hash;
+            qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << key;
         }
         if (error != QNetworkReply::OperationCanceledError) {
             qWarning() << "QGCMapEngineManager::networkReplyError() Error:" << reply->errorString();
         }
-        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
+        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, key);
         getQGCMapEngine()->addTask(task);
     } else {
-        qWarning() << "QGCMapEngineManager::networkReplyError() Empty Hash";
+        qWarning() << "QGCMapEngineManager::networkReplyError() Empty Key";
     }
     //-- Setup a new download
     _prepareDownload();
@@ -24,10 +24,13 @@
 #include <QHash>
 #include <QDateTime>
 #include <QImage>
+#include <QElapsedTimer>
+#include <QTimer>
 
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngineData.h"
 #include "QGCMapUrlEngine.h"
+#include "QGCTileDownloadControl.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCCachedTileSetLog)
 
@@ -71,6 +74,8 @@ public:
     Q_PROPERTY(bool         downloading         READ    downloading         NOTIFY downloadingChanged)
     Q_PROPERTY(quint32      errorCount          READ    errorCount          NOTIFY errorCountChanged)
     Q_PROPERTY(QString      errorCountStr       READ    errorCountStr       NOTIFY errorCountChanged)
+    Q_PROPERTY(double       tilesPerSecond      READ    tilesPerSecond      NOTIFY tilesPerSecondChanged)
+    Q_PROPERTY(QString      tilesPerSecondStr   READ    tilesPerSecondStr   NOTIFY tilesPerSecondChanged)
 
     Q_PROPERTY(bool         selected            READ    selected            WRITE  setSelected  NOTIFY selectedChanged)
 
@@ -111,6 +116,8 @@ public:
     bool        downloading             () { return _downloading; }
     quint32     errorCount              () { return _errorCount; }
     QString     errorCountStr           ();
+    double      tilesPerSecond          () { return _tilesPerSecond; }
+    QString     tilesPerSecondStr       ();
     bool        selected                () { return _selected; }
 
     void        setSelected             (bool sel);
@@ -148,6 +155,7 @@ signals:
     void        errorCountChanged       ();
     void        selectedChanged         ();
     void        nameChanged             ();
+    void        tilesPerSecondChanged   ();
 
 private slots:
     void _tileListFetched               (QList<QGCTile*> tiles);
@@ -157,8 +165,16 @@ private slots:
 private:
     void        _prepareDownload        ();
     void        _doneWithDownload       ();
+    void        _flushCompletedTiles    ();
+    void        _updateTilesPerSecond   ();
 
 private:
+    typedef struct {
+        QNetworkReply*  reply;
+        QGCTile*        tile;           ///< Queued again if the server throttles the request
+        qint64          startMsecs;
+    } Download_t;
+
     QString     _name;
     QString     _mapTypeStr;
     double      _topleftLat;
@@ -180,12 +196,19 @@ private:
     quint64     _id;
     QString _type;
     QNetworkAccessManager*  _networkManager;
-    QHash<QString, QNetworkReply*> _replies;
+    QHash<quint64, Download_t> _replies;
     quint32     _errorCount;
     //-- Tile download
     QList<QGCTile *> _tilesToDownload;
     bool        _noMoreTiles;
     bool        _batchRequested;
+    QGCTileDownloadControl _downloadControl;
+    QElapsedTimer _downloadClock;
+    QTimer      _backoffTimer;
+    QTimer      _rateTimer;             ///< Keeps the rate current while no tiles arrive
+    QHash<quint64, int> _throttleRetries;   ///< Times each tile was throttled in this download
+    QList<quint64> _completedKeys;      ///< Downloaded tiles whose state is not updated yet
+    double      _tilesPerSecond;
     QGCMapEngineManager* _manager;
     bool        _selected;
 };
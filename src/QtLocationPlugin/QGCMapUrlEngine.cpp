@@ -32,9 +32,55 @@ QGC_LOGGING_CATEGORY(QGCMapUrlEngineLog, "QGCMapUrlEngineLog")
 #include <QString>
 #include <QTimer>
 
+//-- Index of each provider in the tile keys of the cache database, see QGCMapEngine::getTileKey. The index is stored
+//   with every cached tile: append only, never reorder or reuse an entry. Index 0 is reserved for unknown providers.
+static const char* kTileKeyProviders[] = {
+    "",
+    "Google Street Map",
+    "Google Satellite",
+    "Google Terrain",
+    "Google Hybrid",
+    "Google Labels",
+    "Bing Road",
+    "Bing Satellite",
+    "Bing Hybrid",
+    "Statkart Topo",
+    "Eniro Topo",
+    "Esri World Street",
+    "Esri World Satellite",
+    "Esri Terrain",
+    "Mapbox Streets",
+    "Mapbox Light",
+    "Mapbox Dark",
+    "Mapbox Satellite",
+    "Mapbox Hybrid",
+    "Mapbox StreetsBasic",
+    "Mapbox Outdoors",
+    "Mapbox RunBikeHike",
+    "Mapbox HighContrast",
+    "Mapbox Custom",
+    "MapQuest Map",
+    "MapQuest Sat",
+    "VWorld Street Map",
+    "VWorld Satellite Map",
+    "Airmap Elevation",
+    "Japan-GSI Contour",
+    "Japan-GSI Seamless",
+    "Japan-GSI Anaglyph",
+    "Japan-GSI Slope",
+    "Japan-GSI Relief",
+};
+
 //-----------------------------------------------------------------------------
 UrlFactory::UrlFactory() : _timeout(5 * 1000) {
 
+    _tileKeyIds.append(-1);
+    for (size_t i = 1; i < sizeof(kTileKeyProviders) / sizeof(kTileKeyProviders[0]); i++) {
+        int id = getIdFromType(kTileKeyProviders[i]);
+        _tileKeyIds.append(id);
+        _tileKeyIndexes[id] = static_cast<int>(i);
+    }
+
     // Warning : in _providersTable, keys needs to follow this format :
     // "Provider Type"
 #ifndef QGC_NO_GOOGLE_MAPS
@@ -82,10 +128,23 @@ UrlFactory::UrlFactory() : _timeout(5 * 1000) {
     _providersTable["Japan-GSI Anaglyph"] = new JapanAnaglyphMapProvider(this);
     _providersTable["Japan-GSI Slope"] = new JapanSlopeMapProvider(this);
     _providersTable["Japan-GSI Relief"] = new JapanReliefMapProvider(this);
+
+    for (const QString& type : _providersTable.keys()) {
+        _checkTileKeyIndex(type);
+    }
 }
 
 void UrlFactory::registerProvider(QString name, MapProvider* provider) {
     _providersTable[name] = provider;
+    _checkTileKeyIndex(name);
+}
+
+//-- Tiles of a provider without a tile key index get key 0, they are neither cached nor downloaded
+void UrlFactory::_checkTileKeyIndex(const QString& type) {
+    if (!getTileKeyIndex(getIdFromType(type))) {
+        qWarning() << "UrlFactory: map provider missing from kTileKeyProviders, its tiles can't be cached:" << type;
+        Q_ASSERT_X(false, "UrlFactory", "map provider missing from kTileKeyProviders");
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -178,6 +237,10 @@ MapProvider* UrlFactory::getMapProviderFromId(int id)
 // generate similar hash for different types
 int UrlFactory::getIdFromType(QString type) { return (int)(qHash(type)>>1); }
 
+int UrlFactory::getTileKeyIndex(int id) { return _tileKeyIndexes.value(id, 0); }
+
+int UrlFactory::getIdFromTileKeyIndex(int index) { return index > 0 && index < _tileKeyIds.count() ? _tileKeyIds[index] : -1; }
+
 //-----------------------------------------------------------------------------
 int
 UrlFactory::long2tileX(QString mapType, double lon, int z)
@@ -24,6 +24,9 @@
 #include "MapboxMapProvider.h"
 #include "ElevationMapProvider.h"
 
+#include <QHash>
+#include <QVector>
+
 #define MAX_MAP_ZOOM (23.0)
 
 class UrlFactory : public QObject {
@@ -50,6 +53,11 @@ public:
     QString getTypeFromId(int id);
     MapProvider* getMapProviderFromId(int id);
 
+    //-- Stable provider index used in tile keys, 0 if the provider has none
+    int getTileKeyIndex(int id);
+    int getIdFromTileKeyIndex(int index);
+    int getTileKeyIndexCount() { return _tileKeyIds.count(); }
+
     QGCTileSet getTileCount(int zoom, double topleftLon, double topleftLat,
                             double bottomRightLon, double bottomRightLat,
                             QString mapType);
@@ -59,7 +67,10 @@ public:
   private:
     int             _timeout;
     QHash<QString, MapProvider*> _providersTable;
+    QHash<int, int> _tileKeyIndexes;    ///< Tile key index by provider id
+    QVector<int>    _tileKeyIds;        ///< Provider id by tile key index
     void registerProvider(QString Name, MapProvider* provider);
+    void _checkTileKeyIndex(const QString& type);
 
 };
 
@@ -0,0 +1,255 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Cache Reader Threads
+ *
+ */
+
+#include "QGCTileCacheReader.h"
+#include "QGCMapEngine.h"
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QSqlError>
+#include <QReadLocker>
+
+#include <algorithm>
+
+static const QString    kReaderSession  = QStringLiteral("QGeoTileReaderSession%1");
+
+//-- Number of reader threads and connections
+#define READER_COUNT        2
+//-- Number of most recent fetches used for the latency percentiles
+#define LATENCY_SAMPLES     1000
+//-- Fetch latency is logged every this many fetches
+#define LATENCY_LOG_COUNT   500
+//-- The cache worker is woken to store access times every this many accessed tiles
+#define ACCESS_FLUSH_COUNT  256
+
+//-----------------------------------------------------------------------------
+QGCTileCacheReader::QGCTileCacheReader(QGCTileCacheReaderPool* pool, int index)
+    : _pool(pool)
+    , _index(index)
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReader::run()
+{
+    while(true) {
+        QGCFetchTileTask* task = _pool->_waitForTask();
+        if(!task) {
+            break;
+        }
+        _pool->_readTasks(_index, task);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCTileCacheReaderPool::QGCTileCacheReaderPool()
+{
+    _latencies.resize(LATENCY_SAMPLES);
+}
+
+//-----------------------------------------------------------------------------
+QGCTileCacheReaderPool::~QGCTileCacheReaderPool()
+{
+    quit();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReaderPool::enqueueTask(QGCFetchTileTask* task)
+{
+    _mutex.lock();
+    if(_stop) {
+        _mutex.unlock();
+        task->setError("Tile cache closed");
+        task->deleteLater();
+        return;
+    }
+    if(task->lowPriority()) {
+        _lowPriorityQueue.enqueue(task);
+    } else {
+        _taskQueue.enqueue(task);
+    }
+    if(_readers.isEmpty()) {
+        for(int i = 0; i < READER_COUNT; i++) {
+            QGCTileCacheReader* reader = new QGCTileCacheReader(this, i);
+            _readers.append(reader);
+            //-- Map display waits on these, they go ahead of the worker thread
+            reader->start(QThread::HighPriority);
+        }
+    }
+    _waitc.wakeOne();
+    _mutex.unlock();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReaderPool::quit()
+{
+    _mutex.lock();
+    _stop = true;
+    while(_taskQueue.count()) {
+        delete _taskQueue.dequeue();
+    }
+    while(_lowPriorityQueue.count()) {
+        delete _lowPriorityQueue.dequeue();
+    }
+    QList<QGCTileCacheReader*> readers = _readers;
+    _readers.clear();
+    _waitc.wakeAll();
+    _mutex.unlock();
+    for(QGCTileCacheReader* reader: readers) {
+        reader->wait();
+        delete reader;
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCFetchTileTask*
+QGCTileCacheReaderPool::_waitForTask()
+{
+    QMutexLocker lock(&_mutex);
+    while(!_stop && _taskQueue.isEmpty() && _lowPriorityQueue.isEmpty()) {
+        _waitc.wait(&_mutex);
+    }
+    return _stop ? nullptr : _dequeueTask();
+}
+
+//-----------------------------------------------------------------------------
+QGCFetchTileTask*
+QGCTileCacheReaderPool::_takeTask()
+{
+    QMutexLocker lock(&_mutex);
+    return _stop ? nullptr : _dequeueTask();
+}
+
+//-----------------------------------------------------------------------------
+QGCFetchTileTask*
+QGCTileCacheReaderPool::_dequeueTask()
+{
+    //-- Called with the mutex held
+    if(_taskQueue.count()) {
+        return _taskQueue.dequeue();
+    }
+    return _lowPriorityQueue.isEmpty() ? nullptr : _lowPriorityQueue.dequeue();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReaderPool::_readTasks(int index, QGCFetchTileTask* task)
+{
+    //-- The connection stays open while there are tasks queued and is closed once the reader goes idle. That way
+    //   lockDatabase only has to wait for the readers which are busy.
+    QReadLocker databaseLock(&_databaseLock);
+    QString     sessionName = kReaderSession.arg(index);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", sessionName);
+        db.setDatabaseName(_databasePath);
+        //-- No shared cache, it would lock tables between the readers and the writer
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=1000");
+        bool        open = db.open();
+        QSqlQuery   query(db);
+        if(open) {
+            query.prepare("SELECT COALESCE(I.tile, T.tile), T.format, T.type FROM Tiles T LEFT JOIN TileImages I ON I.imageID = T.imageID WHERE T.tileID = ?");
+        } else {
+            qCWarning(QGCTileCacheLog) << "Map Cache SQL error (open reader db):" << db.lastError().text();
+        }
+        while(task) {
+            bool found = false;
+            if(open) {
+                query.bindValue(0, static_cast<qint64>(task->key()));
+                if(query.exec() && query.next()) {
+                    QByteArray ar   = query.value(0).toByteArray();
+                    QString format  = query.value(1).toString();
+                    int mapId       = query.value(2).toInt();
+                    qCDebug(QGCTileCacheLog) << "_readTasks() (Found in DB) KEY:" << task->key();
+                    task->setTileFetched(new QGCCacheTile(task->key(), ar, format, mapId));
+                    found = true;
+                    _accessMutex.lock();
+                    int  accessedCount  = _accessed.count();
+                    _accessed.insert(task->key());
+                    bool flush          = _accessed.count() != accessedCount && _accessed.count() % ACCESS_FLUSH_COUNT == 0;
+                    _accessMutex.unlock();
+                    //-- Map display alone never queues worker tasks, so the worker is woken from here
+                    if(flush && _accessedHandler) {
+                        _accessedHandler();
+                    }
+                }
+                query.finish();
+            }
+            if(!found) {
+                qCDebug(QGCTileCacheLog) << "_readTasks() (NOT in DB) KEY:" << task->key();
+                task->setError("Tile not in cache database");
+            }
+            _recordLatency(task->elapsedNsecs());
+            task->deleteLater();
+            task = _takeTask();
+        }
+    }
+    QSqlDatabase::removeDatabase(sessionName);
+}
+
+//-----------------------------------------------------------------------------
+QSet<quint64>
+QGCTileCacheReaderPool::takeAccessed()
+{
+    QMutexLocker lock(&_accessMutex);
+    QSet<quint64> accessed;
+    accessed.swap(_accessed);
+    return accessed;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReaderPool::_recordLatency(qint64 nsecs)
+{
+    QMutexLocker lock(&_latencyMutex);
+    _latencies[_latencyIndex] = nsecs;
+    _latencyIndex = (_latencyIndex + 1) % _latencies.count();
+    _latencyCount = qMin(_latencyCount + 1, _latencies.count());
+    if(++_fetchCount % LATENCY_LOG_COUNT == 0 && QGCTileCacheLog().isDebugEnabled()) {
+        lock.unlock();
+        Latency_t latency = fetchLatency();
+        qCDebug(QGCTileCacheLog) << "Tile fetch latency msecs p50:" << latency.p50Msecs << "p90:" << latency.p90Msecs << "p99:" << latency.p99Msecs << "max:" << latency.maxMsecs;
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCTileCacheReaderPool::Latency_t
+QGCTileCacheReaderPool::fetchLatency()
+{
+    Latency_t       latency = { 0, 0, 0, 0, 0 };
+    QVector<qint64> samples;
+
+    _latencyMutex.lock();
+    samples = _latencies.mid(0, _latencyCount);
+    _latencyMutex.unlock();
+
+    if(samples.isEmpty()) {
+        return latency;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) -> double {
+        int index = qMin(static_cast<int>(p * samples.count()), samples.count() - 1);
+        return samples[index] / 1000000.0;
+    };
+    latency.count       = samples.count();
+    latency.p50Msecs    = percentile(0.50);
+    latency.p90Msecs    = percentile(0.90);
+    latency.p99Msecs    = percentile(0.99);
+    latency.maxMsecs    = samples.last() / 1000000.0;
+    return latency;
+}
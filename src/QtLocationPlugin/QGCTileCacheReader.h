@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Cache Reader Threads
+ *
+ *   Tile fetches for the map are served by a pool of reader threads, each with its own read only SQLite
+ *   connection. They run concurrently with the cache worker thread, which does all the writes. With the WAL
+ *   journal readers see the last committed state while the worker writes.
+ *
+ */
+
+#ifndef QGC_TILE_CACHE_READER_H
+#define QGC_TILE_CACHE_READER_H
+
+#include <QString>
+#include <QThread>
+#include <QQueue>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QVector>
+#include <QList>
+#include <QSet>
+
+#include <functional>
+
+class QGCFetchTileTask;
+class QGCTileCacheReaderPool;
+
+//-----------------------------------------------------------------------------
+class QGCTileCacheReader : public QThread
+{
+    Q_OBJECT
+public:
+    QGCTileCacheReader  (QGCTileCacheReaderPool* pool, int index);
+
+protected:
+    void    run         () final;
+
+private:
+    QGCTileCacheReaderPool* _pool;
+    int                     _index;
+};
+
+//-----------------------------------------------------------------------------
+class QGCTileCacheReaderPool
+{
+public:
+    typedef struct {
+        int     count;          ///< Number of fetches the percentiles are computed from
+        double  p50Msecs;
+        double  p90Msecs;
+        double  p99Msecs;
+        double  maxMsecs;
+    } Latency_t;
+
+    QGCTileCacheReaderPool  ();
+    ~QGCTileCacheReaderPool ();
+
+    void        setDatabaseFile (const QString& path) { _databasePath = path; }
+    void        enqueueTask     (QGCFetchTileTask* task);
+    void        quit            ();
+
+    //-- Waits for the readers to close their connections and keeps them closed until unlockDatabase. Used by the
+    //   cache worker while it replaces the database file.
+    void        lockDatabase    () { _databaseLock.lockForWrite(); }
+    void        unlockDatabase  () { _databaseLock.unlock(); }
+
+    //-- Time from creating a fetch task to its result, over the last fetches
+    Latency_t   fetchLatency    ();
+
+    //-- Keys of the tiles found since the last call. The readers can't write, the cache worker stores the access
+    //   times when it is idle.
+    QSet<quint64> takeAccessed  ();
+
+    //-- Called from a reader thread each time enough tiles were accessed for their times to be stored. Set before
+    //   the first task is queued.
+    void        setAccessedHandler(std::function<void()> handler) { _accessedHandler = handler; }
+
+private:
+    friend class QGCTileCacheReader;
+
+    QGCFetchTileTask*   _waitForTask    ();
+    QGCFetchTileTask*   _takeTask       ();
+    QGCFetchTileTask*   _dequeueTask    ();
+    void                _readTasks      (int index, QGCFetchTileTask* task);
+    void                _recordLatency  (qint64 nsecs);
+
+    QString                     _databasePath;
+    QList<QGCTileCacheReader*>  _readers;
+    QQueue<QGCFetchTileTask*>   _taskQueue;
+    QQueue<QGCFetchTileTask*>   _lowPriorityQueue;              ///< Prefetches, after the map display's fetches
+    QMutex                      _mutex;
+    QWaitCondition              _waitc;
+    QReadWriteLock              _databaseLock;
+    bool                        _stop           = false;
+    QMutex                      _latencyMutex;
+    QVector<qint64>             _latencies;                 ///< Circular, nsecs
+    int                         _latencyIndex   = 0;
+    int                         _latencyCount   = 0;
+    quint64                     _fetchCount     = 0;
+    QMutex                      _accessMutex;
+    QSet<quint64>               _accessed;
+    std::function<void()>       _accessedHandler;
+};
+
+#endif // QGC_TILE_CACHE_READER_H
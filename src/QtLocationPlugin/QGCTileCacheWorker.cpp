@@ -22,11 +22,16 @@
 #include <QVariant>
 #include <QtSql/QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QDebug>
 #include <QDateTime>
 #include <QApplication>
 #include <QFile>
+#include <QFileInfo>
 #include <QSettings>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QtEndian>
 
 #include "time.h"
 
@@ -41,6 +46,186 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-- Maximum number of queued tile writes committed in a single transaction
+#define WRITE_BATCH_MAX     500
+
+//-- Least recently used tiles are evicted in transactions of this many while idle, until the default set is back
+//   under this percentage of the disk cache limit
+#define EVICT_BATCH_MAX     64
+#define EVICT_LOW_WATER     90
+
+//-- Tile sets are exported and imported in transactions of this many tiles
+#define TRANSFER_BATCH_MAX  2000
+
+//-- Tiles are moved to the shared image table in transactions of this many
+#define DEDUP_BATCH_MAX     200
+
+//-- Tiles are keyed by QGCMapEngine::getTileKey. Their image is in TileImages, tiles saved before images were
+//   shared and imported ones still have it in tile until they are deduplicated.
+static const char* kCreateTilesTable =
+    "CREATE TABLE IF NOT EXISTS Tiles ("
+    "tileID INTEGER PRIMARY KEY NOT NULL, "
+    "format TEXT NOT NULL, "
+    "tile BLOB NULL, "
+    "size INTEGER, "
+    "type INTEGER, "
+    "date INTEGER DEFAULT 0, "
+    "imageID INTEGER)";
+
+//-- Identical images, such as open sea or "no tile" responses, are stored once. They are found by a hash of their
+//   content and kept while any tile has them: refCount is kept up to date by triggers.
+static const char* kCreateTileImagesStatements[] = {
+    "CREATE TABLE IF NOT EXISTS TileImages ("
+    "imageID INTEGER PRIMARY KEY NOT NULL, "
+    "hash INTEGER NOT NULL, "
+    "tile BLOB NOT NULL, "
+    "size INTEGER, "
+    "refCount INTEGER DEFAULT 0)",
+
+    "CREATE INDEX IF NOT EXISTS TileImagesHash ON TileImages(hash)",
+
+    "CREATE TRIGGER IF NOT EXISTS TilesInsertImage AFTER INSERT ON Tiles WHEN NEW.imageID IS NOT NULL BEGIN "
+    "UPDATE TileImages SET refCount = refCount + 1 WHERE imageID = NEW.imageID; "
+    "END",
+
+    "CREATE TRIGGER IF NOT EXISTS TilesUpdateImage AFTER UPDATE OF imageID ON Tiles BEGIN "
+    "UPDATE TileImages SET refCount = refCount + 1 WHERE imageID = NEW.imageID; "
+    "UPDATE TileImages SET refCount = refCount - 1 WHERE imageID = OLD.imageID; "
+    "DELETE FROM TileImages WHERE imageID = OLD.imageID AND refCount <= 0; "
+    "END",
+
+    "CREATE TRIGGER IF NOT EXISTS TilesDeleteImage AFTER DELETE ON Tiles WHEN OLD.imageID IS NOT NULL BEGIN "
+    "UPDATE TileImages SET refCount = refCount - 1 WHERE imageID = OLD.imageID; "
+    "DELETE FROM TileImages WHERE imageID = OLD.imageID AND refCount <= 0; "
+    "END",
+};
+
+//-- The tile date is when it was last served, eviction takes the oldest first
+static const char* kCreateTilesDateIndex =
+    "CREATE INDEX IF NOT EXISTS TilesDate ON Tiles(date)";
+
+static const char* kCreateTilesDownloadTable =
+    "CREATE TABLE IF NOT EXISTS TilesDownload ("
+    "setID INTEGER, "
+    "tileKey INTEGER NOT NULL UNIQUE, "
+    "type INTEGER, "
+    "x INTEGER, "
+    "y INTEGER, "
+    "z INTEGER, "
+    "state INTEGER DEFAULT 0)";
+
+//-- Totals are kept up to date by triggers, so they are read in constant time instead of aggregated over Tiles. The
+//   totals of a set are the tiles it has and the tiles only it has. Deleting a tile also removes it from its sets.
+static const char* kCreateStatsStatements[] = {
+    "CREATE TABLE IF NOT EXISTS CacheStats ("
+    "id INTEGER PRIMARY KEY NOT NULL, "
+    "tileCount INTEGER DEFAULT 0, "
+    "tileSize INTEGER DEFAULT 0)",
+
+    "CREATE TABLE IF NOT EXISTS SetStats ("
+    "setID INTEGER PRIMARY KEY NOT NULL, "
+    "tileCount INTEGER DEFAULT 0, "
+    "tileSize INTEGER DEFAULT 0, "
+    "uniqueCount INTEGER DEFAULT 0, "
+    "uniqueSize INTEGER DEFAULT 0)",
+
+    "CREATE INDEX IF NOT EXISTS SetTilesTileID ON SetTiles(tileID)",
+    "CREATE INDEX IF NOT EXISTS SetTilesSetID ON SetTiles(setID)",
+
+    "CREATE TRIGGER IF NOT EXISTS TilesInsertStats AFTER INSERT ON Tiles BEGIN "
+    "UPDATE CacheStats SET tileCount = tileCount + 1, tileSize = tileSize + COALESCE(NEW.size, 0) WHERE id = 0; "
+    "END",
+
+    "CREATE TRIGGER IF NOT EXISTS TilesDeleteStats BEFORE DELETE ON Tiles BEGIN "
+    "DELETE FROM SetTiles WHERE tileID = OLD.tileID; "
+    "UPDATE CacheStats SET tileCount = tileCount - 1, tileSize = tileSize - COALESCE(OLD.size, 0) WHERE id = 0; "
+    "END",
+
+    //-- A tile going from one set to two is no longer unique to the first one
+    "CREATE TRIGGER IF NOT EXISTS SetTilesInsertStats AFTER INSERT ON SetTiles WHEN EXISTS (SELECT 1 FROM Tiles WHERE tileID = NEW.tileID) BEGIN "
+    "INSERT OR IGNORE INTO SetStats(setID) VALUES(NEW.setID); "
+    "UPDATE SetStats SET tileCount = tileCount + 1, tileSize = tileSize + (SELECT COALESCE(size, 0) FROM Tiles WHERE tileID = NEW.tileID) "
+        "WHERE setID = NEW.setID; "
+    "UPDATE SetStats SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + (SELECT COALESCE(size, 0) FROM Tiles WHERE tileID = NEW.tileID) "
+        "WHERE setID = NEW.setID AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 1; "
+    "UPDATE SetStats SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - (SELECT COALESCE(size, 0) FROM Tiles WHERE tileID = NEW.tileID) "
+        "WHERE setID = (SELECT setID FROM SetTiles WHERE tileID = NEW.tileID AND rowid <> NEW.rowid) AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 2; "
+    "END",
+
+    //-- A tile going from two sets to one becomes unique to the remaining one
+    "CREATE TRIGGER IF NOT EXISTS SetTilesDeleteStats AFTER DELETE ON SetTiles WHEN EXISTS (SELECT 1 FROM Tiles WHERE tileID = OLD.tileID) BEGIN "
+    "UPDATE SetStats SET tileCount = tileCount - 1, tileSize = tileSize - (SELECT COALESCE(size, 0) FROM Tiles WHERE tileID = OLD.tileID) "
+        "WHERE setID = OLD.setID; "
+    "UPDATE SetStats SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - (SELECT COALESCE(size, 0) FROM Tiles WHERE tileID = OLD.tileID) "
+        "WHERE setID = OLD.setID AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 0; "
+    "UPDATE SetStats SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + (SELECT COALESCE(size, 0) FROM Tiles WHERE tileID = OLD.tileID) "
+        "WHERE setID = (SELECT setID FROM SetTiles WHERE tileID = OLD.tileID) AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 1; "
+    "END",
+};
+
+//-- Computes the totals from scratch, for databases created before they were kept
+static const char* kRebuildStatsStatements[] = {
+    //-- Pruning used to leave tiles behind in their sets
+    "DELETE FROM SetTiles WHERE tileID NOT IN (SELECT tileID FROM Tiles)",
+    "DELETE FROM CacheStats",
+    "INSERT INTO CacheStats(id, tileCount, tileSize) SELECT 0, COUNT(*), COALESCE(SUM(size), 0) FROM Tiles",
+    "DELETE FROM SetStats",
+    "INSERT INTO SetStats(setID, tileCount, tileSize) SELECT B.setID, COUNT(*), COALESCE(SUM(A.size), 0) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID GROUP BY B.setID",
+    "UPDATE SetStats SET "
+    "uniqueCount = (SELECT COUNT(*) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = SetStats.setID AND (SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = A.tileID) = 1), "
+    "uniqueSize = (SELECT COALESCE(SUM(A.size), 0) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = SetStats.setID AND (SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = A.tileID) = 1)",
+};
+
+//-- Keys of the tiles being exported or imported, with where to find them in the source database: the tileID of
+//   a QGC database, or zoom, column and row of an MBTiles file
+static const char* kCreateTransferTilesTable =
+    "CREATE TEMP TABLE IF NOT EXISTS TransferTiles ("
+    "tileKey INTEGER PRIMARY KEY NOT NULL, "
+    "srcID INTEGER, "
+    "z INTEGER, "
+    "x INTEGER, "
+    "y INTEGER)";
+
+//-- Adds the staged tiles now in the cache to a set, tiles already in it are skipped
+static const char* kLinkTransferTiles =
+    "INSERT INTO main.SetTiles(tileID, setID) SELECT I.tileKey, :setID FROM TransferTiles I "
+    "WHERE I.tileKey > :first AND I.tileKey <= :last AND EXISTS (SELECT 1 FROM main.Tiles E WHERE E.tileID = I.tileKey) "
+    "AND NOT EXISTS (SELECT 1 FROM main.SetTiles S WHERE S.tileID = I.tileKey AND S.setID = :setID)";
+
+//-- MBTiles 1.1 layout. The unique index is created once the tiles are in.
+static const char* kCreateMBTilesStatements[] = {
+    "CREATE TABLE Transfer.metadata (name TEXT, value TEXT)",
+    "CREATE TABLE Transfer.tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)",
+};
+
+//-- Metadata naming the map type of exported MBTiles, so they are imported as the same one
+static const char* kMBTilesMapTypeKey = "qgc_map_type";
+
+//-- Tile images are found by the first 64 bits of their SHA-1
+static qint64
+_tileImageHash(const QByteArray& image)
+{
+    QByteArray digest = QCryptographicHash::hash(image, QCryptographicHash::Sha1);
+    return qFromLittleEndian<qint64>(reinterpret_cast<const uchar*>(digest.constData()));
+}
+
+//-- Tile key from the 29 character text hash caches used to be keyed by: "%010d%08d%08d%03d" of provider id, x, y and
+//   zoom. %1 is the table holding the hash, the provider is joined from TileKeyProviders as P.
+static QString
+_hashToTileKeySql(const QString& table)
+{
+    return QString("((P.keyIndex << %1) | (CAST(substr(%2.hash, 27, 3) AS INTEGER) << %3) | (CAST(substr(%2.hash, 11, 8) AS INTEGER) << %4) | CAST(substr(%2.hash, 19, 8) AS INTEGER))")
+        .arg(TILE_KEY_PROVIDER_SHIFT).arg(table).arg(TILE_KEY_ZOOM_SHIFT).arg(TILE_KEY_X_SHIFT);
+}
+
+//-- Only hashes which fit in a tile key are migrated
+static QString
+_hashInKeyRangeSql(const QString& table)
+{
+    return QString("LENGTH(%1.hash) = 29 AND CAST(substr(%1.hash, 11, 8) AS INTEGER) < %2 AND CAST(substr(%1.hash, 19, 8) AS INTEGER) < %2 AND CAST(substr(%1.hash, 27, 3) AS INTEGER) < %3")
+        .arg(table).arg(1 << TILE_KEY_XY_BITS).arg(1 << (TILE_KEY_PROVIDER_SHIFT - TILE_KEY_ZOOM_SHIFT));
+}
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
     : _db(nullptr)
@@ -54,7 +239,12 @@ QGCCacheWorker::QGCCacheWorker()
     , _lastUpdate(0)
     , _updateTimeout(SHORT_TIMEOUT)
     , _hostLookupID(0)
+    , _maxDiskCache(0)
+    , _evicting(false)
+    , _evictDate(0)
+    , _quitting(false)
 {
+    _readerPool.setAccessedHandler([this]() { _wakeForIdleWork(); });
 }
 
 //-----------------------------------------------------------------------------
@@ -62,11 +252,25 @@ QGCCacheWorker::~QGCCacheWorker()
 {
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::setMaxDiskCache(quint64 size)
+{
+    _mutex.lock();
+    _maxDiskCache = size;
+    _mutex.unlock();
+    //-- Eviction starts once the worker is idle
+    if(this->isRunning()) {
+        _waitc.wakeAll();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::setDatabaseFile(const QString& path)
 {
     _databasePath = path;
+    _readerPool.setDatabaseFile(path);
 }
 
 //-----------------------------------------------------------------------------
@@ -76,17 +280,37 @@ QGCCacheWorker::quit()
     if(_hostLookupID) {
         QHostInfo::abortHostLookup(_hostLookupID);
     }
+    _readerPool.quit();
     _mutex.lock();
     while(_taskQueue.count()) {
         QGCMapTask* task = _taskQueue.dequeue();
         delete task;
     }
+    _quitting = true;
     _mutex.unlock();
+    //-- The worker stores the pending access times before it stops
+    _wakeForIdleWork();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_wakeForIdleWork()
+{
     if(this->isRunning()) {
         _waitc.wakeAll();
+    } else if(_valid) {
+        this->start(QThread::NormalPriority);
     }
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_isQuitting()
+{
+    QMutexLocker lock(&_mutex);
+    return _quitting;
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::enqueueTask(QGCMapTask* task)
@@ -97,13 +321,18 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
         task->deleteLater();
         return false;
     }
+    //-- Tile fetches are served by the reader threads, they don't wait behind the tasks queued here
+    if(task->type() == QGCMapTask::taskFetchTile) {
+        _readerPool.enqueueTask(static_cast<QGCFetchTileTask*>(task));
+        return true;
+    }
     _mutex.lock();
     _taskQueue.enqueue(task);
     _mutex.unlock();
     if(this->isRunning()) {
         _waitc.wakeAll();
     } else {
-        this->start(QThread::HighPriority);
+        this->start(QThread::NormalPriority);
     }
     return true;
 }
@@ -116,10 +345,7 @@ QGCCacheWorker::run()
         _init();
     }
     if(_valid) {
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-        _db->setDatabaseName(_databasePath);
-        _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        _valid = _db->open();
+        _valid = _connectDB();
     }
     _deleteBingNoTileTiles();
     while(true) {
@@ -132,10 +358,10 @@ QGCCacheWorker::run()
                 case QGCMapTask::taskInit:
                     break;
                 case QGCMapTask::taskCacheTile:
-                    _saveTile(task);
+                    _runWriteBatch(task);
                     break;
                 case QGCMapTask::taskFetchTile:
-                    _getTile(task);
+                    //-- Served by the reader pool, see enqueueTask()
                     break;
                 case QGCMapTask::taskFetchTileSets:
                     _getTileSets(task);
@@ -147,7 +373,7 @@ QGCCacheWorker::run()
                     _getTileDownloadList(task);
                     break;
                 case QGCMapTask::taskUpdateTileDownloadState:
-                    _updateTileDownloadState(task);
+                    _runWriteBatch(task);
                     break;
                 case QGCMapTask::taskDeleteTileSet:
                     _deleteTileSet(task);
@@ -167,6 +393,9 @@ QGCCacheWorker::run()
                 case QGCMapTask::taskImport:
                     _importSets(task);
                     break;
+                case QGCMapTask::taskDeduplicate:
+                    _deduplicateTiles(task);
+                    break;
                 case QGCMapTask::taskTestInternet:
                     _testInternet();
                     break;
@@ -184,6 +413,14 @@ QGCCacheWorker::run()
                     _updateTotals();
                 }
             }
+        } else if(_isQuitting()) {
+            //-- Access times are kept, eviction waits for the next run
+            if(_valid) {
+                _storeAccessTimes();
+            }
+            break;
+        } else if(_valid && _runIdleWork()) {
+            //-- Tasks queued meanwhile go first, the idle work resumes after them
         } else {
             //-- Wait a bit before shutting things down
             _waitmutex.lock();
@@ -191,14 +428,65 @@ QGCCacheWorker::run()
             _waitc.wait(&_waitmutex, timeout);
             _waitmutex.unlock();
             _mutex.lock();
+            bool idle = !_taskQueue.count() && !_quitting;
+            _mutex.unlock();
             //-- If nothing to do, close db and leave thread
-            if(!_taskQueue.count()) {
-                _mutex.unlock();
+            if(idle && !(_valid && _runIdleWork())) {
                 break;
             }
-            _mutex.unlock();
         }
     }
+    _disconnectDB();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_connectDB()
+{
+    _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+    _db->setDatabaseName(_databasePath);
+    _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+    if(!_db->open()) {
+        qCritical() << "Map Cache SQL error (open db):" << _db->lastError();
+        return false;
+    }
+    //-- With a write ahead log, commits only append to the log. It is synced to the database at checkpoints.
+    QSqlQuery query(*_db);
+    if(!query.exec("PRAGMA journal_mode=WAL")) {
+        qCWarning(QGCTileCacheLog) << "Unable to enable WAL journal:" << query.lastError().text();
+    }
+    query.exec("PRAGMA synchronous=NORMAL");
+    _insertTileQuery = new QSqlQuery(*_db);
+    _insertTileQuery->prepare("INSERT INTO Tiles(tileID, format, tile, size, type, date, imageID) VALUES(?, ?, ?, ?, ?, ?, ?)");
+    _findImageQuery = new QSqlQuery(*_db);
+    _findImageQuery->prepare("SELECT imageID, tile FROM TileImages WHERE hash = ?");
+    _insertImageQuery = new QSqlQuery(*_db);
+    _insertImageQuery->prepare("INSERT INTO TileImages(hash, tile, size) VALUES(?, ?, ?)");
+    _deleteUnusedImageQuery = new QSqlQuery(*_db);
+    _deleteUnusedImageQuery->prepare("DELETE FROM TileImages WHERE imageID = ? AND refCount <= 0");
+    _insertSetTileQuery = new QSqlQuery(*_db);
+    _insertSetTileQuery->prepare("INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)");
+    _deleteDownloadQuery = new QSqlQuery(*_db);
+    _deleteDownloadQuery->prepare("DELETE FROM TilesDownload WHERE setID = ? AND tileKey = ?");
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_disconnectDB()
+{
+    delete _insertTileQuery;
+    _insertTileQuery = nullptr;
+    delete _findImageQuery;
+    _findImageQuery = nullptr;
+    delete _insertImageQuery;
+    _insertImageQuery = nullptr;
+    delete _deleteUnusedImageQuery;
+    _deleteUnusedImageQuery = nullptr;
+    delete _insertSetTileQuery;
+    _insertSetTileQuery = nullptr;
+    delete _deleteDownloadQuery;
+    _deleteDownloadQuery = nullptr;
     if(_db) {
         delete _db;
         _db = nullptr;
@@ -228,13 +516,13 @@ QGCCacheWorker::_deleteBingNoTileTiles()
     QSqlQuery query(*_db);
     QString s;
     //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, tile, hash FROM Tiles WHERE LENGTH(tile) = %1").arg(noTileBytes.count());
+    s = QString("SELECT T.tileID, COALESCE(I.tile, T.tile) FROM Tiles T LEFT JOIN TileImages I ON I.imageID = T.imageID WHERE T.size = %1").arg(noTileBytes.count());
     QList<quint64> idsToDelete;
     if (query.exec(s)) {
         while(query.next()) {
             if (query.value(1).toByteArray() == noTileBytes) {
                 idsToDelete.append(query.value(0).toULongLong());
-                qCDebug(QGCTileCacheLog) << "_deleteBingNoTileTiles HASH:" << query.value(2).toString();
+                qCDebug(QGCTileCacheLog) << "_deleteBingNoTileTiles KEY:" << query.value(0).toULongLong();
             }
         }
         for (const quint64 tileId: idsToDelete) {
@@ -280,32 +568,84 @@ QGCCacheWorker::_getDefaultTileSet()
     return 1L;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_runWriteBatch(QGCMapTask* mtask)
+{
+    //-- Take the tile writes queued behind this one. Only consecutive ones, so they stay in order with other tasks.
+    QList<QGCMapTask*> tasks;
+    tasks.append(mtask);
+    _mutex.lock();
+    while(tasks.count() < WRITE_BATCH_MAX && _taskQueue.count() &&
+          (_taskQueue.head()->type() == QGCMapTask::taskCacheTile || _taskQueue.head()->type() == QGCMapTask::taskUpdateTileDownloadState)) {
+        tasks.append(_taskQueue.dequeue());
+    }
+    _mutex.unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+    //-- A single transaction means a single commit, instead of one per statement
+    bool transaction = _valid && _db->transaction();
+    int tileCount = 0;
+    for(QGCMapTask* task: tasks) {
+        if(task->type() == QGCMapTask::taskCacheTile) {
+            _saveTile(task);
+            tileCount++;
+        } else {
+            _updateTileDownloadState(task);
+        }
+    }
+    if(_valid) {
+        _insertTileQuery->finish();
+        _insertSetTileQuery->finish();
+        _deleteDownloadQuery->finish();
+    }
+    if(transaction && !_db->commit()) {
+        qWarning() << "Map Cache SQL error (commit tile batch):" << _db->lastError().text();
+        _db->rollback();
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    qCDebug(QGCTileCacheLog) << "_runWriteBatch() tasks:" << tasks.count() << "tiles:" << tileCount
+                             << "msecs:" << elapsed / 1000000.0
+                             << "tiles/s:" << (elapsed ? (tileCount * 1e9) / elapsed : 0.0)
+                             << "commits:" << (transaction ? 1 : tasks.count());
+    for(int i = 1; i < tasks.count(); i++) {
+        tasks[i]->deleteLater();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
-        query.addBindValue(task->tile()->format());
-        query.addBindValue(task->tile()->img());
-        query.addBindValue(task->tile()->img().size());
-        query.addBindValue(task->tile()->type());
-        query.addBindValue(QDateTime::currentDateTime().toTime_t());
-        if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
+        qint64 key = static_cast<qint64>(task->tile()->key());
+        //-- The image is kept inline if it can't be shared
+        quint64 imageID = _storeTileImage(task->tile()->img());
+        _insertTileQuery->bindValue(0, key);
+        _insertTileQuery->bindValue(1, task->tile()->format());
+        _insertTileQuery->bindValue(2, imageID ? QVariant(QVariant::ByteArray) : QVariant(task->tile()->img()));
+        _insertTileQuery->bindValue(3, task->tile()->img().size());
+        _insertTileQuery->bindValue(4, task->tile()->mapId());
+        _insertTileQuery->bindValue(5, QDateTime::currentDateTime().toTime_t());
+        _insertTileQuery->bindValue(6, imageID ? QVariant(static_cast<qint64>(imageID)) : QVariant(QVariant::LongLong));
+        if(_insertTileQuery->exec()) {
             quint64 setID = task->tile()->set() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->set();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+            _insertSetTileQuery->bindValue(0, key);
+            _insertSetTileQuery->bindValue(1, setID);
+            if(!_insertSetTileQuery->exec()) {
+                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << _insertSetTileQuery->lastError().text();
             }
-            qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
+            qCDebug(QGCTileCacheLog) << "_saveTile() KEY:" << task->tile()->key();
         } else {
             //-- Tile was already there.
             //   QtLocation some times requests the same tile twice in a row. The first is saved, the second is already there.
+            //   Its image is dropped if it was stored for this tile.
+            if(imageID) {
+                _deleteUnusedImageQuery->bindValue(0, static_cast<qint64>(imageID));
+                _deleteUnusedImageQuery->exec();
+            }
         }
     } else {
         qWarning() << "Map Cache SQL error (saveTile() open db):" << _db->lastError();
@@ -313,31 +653,32 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 }
 
 //-----------------------------------------------------------------------------
-void
-QGCCacheWorker::_getTile(QGCMapTask* mtask)
+//  Returns the image ID of an image identical to the given one, storing it if there is none. The tile referencing it
+//  must be saved in the same transaction, or the image is left unused. Returns 0 on error.
+quint64
+QGCCacheWorker::_storeTileImage(const QByteArray& image)
 {
-    if(!_testTask(mtask)) {
-        return;
-    }
-    bool found = false;
-    QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
-    if(query.exec(s)) {
-        if(query.next()) {
-            QByteArray ar   = query.value(0).toByteArray();
-            QString format  = query.value(1).toString();
-            QString type = getQGCMapEngine()->urlFactory()->getTypeFromId(query.value(2).toInt());
-            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
-            QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
-            task->setTileFetched(tile);
-            found = true;
+    qint64 hash = _tileImageHash(image);
+    _findImageQuery->bindValue(0, hash);
+    if(_findImageQuery->exec()) {
+        //-- Hashes may collide, the image is only shared if it is the same
+        while(_findImageQuery->next()) {
+            if(_findImageQuery->value(1).toByteArray() == image) {
+                quint64 imageID = _findImageQuery->value(0).toULongLong();
+                _findImageQuery->finish();
+                return imageID;
+            }
         }
     }
-    if(!found) {
-        qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
-        task->setError("Tile not in cache database");
+    _findImageQuery->finish();
+    _insertImageQuery->bindValue(0, hash);
+    _insertImageQuery->bindValue(1, image);
+    _insertImageQuery->bindValue(2, image.size());
+    if(!_insertImageQuery->exec()) {
+        qWarning() << "Map Cache SQL error (add tile image):" << _insertImageQuery->lastError().text();
+        return 0;
     }
+    return _insertImageQuery->lastInsertId().toULongLong();
 }
 
 //-----------------------------------------------------------------------------
@@ -389,48 +730,41 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
         set->setTotalTileSize(_defaultSize);
         return;
     }
+    quint32 ucount = 0;
+    quint64 usize  = 0;
+    set->setSavedTileCount(0);
+    set->setSavedTileSize(0);
     QSqlQuery subquery(*_db);
-    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
-    qCDebug(QGCTileCacheLog) << "_updateSetTotals(): " << sq;
-    if(subquery.exec(sq)) {
-        if(subquery.next()) {
-            set->setSavedTileCount(subquery.value(0).toUInt());
-            set->setSavedTileSize(subquery.value(1).toULongLong());
-            qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
-            //-- Update (estimated) size
-            quint64 avg = getQGCMapEngine()->urlFactory()->averageSizeForType(set->type());
-            if(set->totalTileCount() <= set->savedTileCount()) {
-                //-- We're done so the saved size is the total size
-                set->setTotalTileSize(set->savedTileSize());
-            } else {
-                //-- Otherwise we need to estimate it.
-                if(set->savedTileCount() > 10 && set->savedTileSize()) {
-                    avg = set->savedTileSize() / set->savedTileCount();
-                }
-                set->setTotalTileSize(avg * set->totalTileCount());
-            }
-            //-- Now figure out the count for tiles unique to this set
-            quint32 ucount = 0;
-            quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
-            if(subquery.exec(sq)) {
-                if(subquery.next()) {
-                    //-- This is only accurate when all tiles are downloaded
-                    ucount = subquery.value(0).toUInt();
-                    usize  = subquery.value(1).toULongLong();
-                }
-            }
-            //-- If we haven't downloaded it all, estimate size of unique tiles
-            quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
-            if(!ucount) {
-                usize = expectedUcount * avg;
-            } else {
-                expectedUcount = ucount;
-            }
-            set->setUniqueTileCount(expectedUcount);
-            set->setUniqueTileSize(usize);
+    QString sq = QString("SELECT tileCount, tileSize, uniqueCount, uniqueSize FROM SetStats WHERE setID = %1").arg(set->id());
+    if(subquery.exec(sq) && subquery.next()) {
+        set->setSavedTileCount(subquery.value(0).toUInt());
+        set->setSavedTileSize(subquery.value(1).toULongLong());
+        //-- This is only accurate when all tiles are downloaded
+        ucount = subquery.value(2).toUInt();
+        usize  = subquery.value(3).toULongLong();
+    }
+    qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
+    //-- Update (estimated) size
+    quint64 avg = getQGCMapEngine()->urlFactory()->averageSizeForType(set->type());
+    if(set->totalTileCount() <= set->savedTileCount()) {
+        //-- We're done so the saved size is the total size
+        set->setTotalTileSize(set->savedTileSize());
+    } else {
+        //-- Otherwise we need to estimate it.
+        if(set->savedTileCount() > 10 && set->savedTileSize()) {
+            avg = set->savedTileSize() / set->savedTileCount();
         }
+        set->setTotalTileSize(avg * set->totalTileCount());
+    }
+    //-- If we haven't downloaded it all, estimate size of unique tiles
+    quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
+    if(!ucount) {
+        usize = expectedUcount * avg;
+    } else {
+        expectedUcount = ucount;
     }
+    set->setUniqueTileCount(expectedUcount);
+    set->setUniqueTileSize(usize);
 }
 
 //-----------------------------------------------------------------------------
@@ -439,16 +773,17 @@ QGCCacheWorker::_updateTotals()
 {
     QSqlQuery query(*_db);
     QString s;
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
+    s = QString("SELECT tileCount, tileSize FROM CacheStats WHERE id = 0");
     if(query.exec(s)) {
         if(query.next()) {
             _totalCount = query.value(0).toUInt();
             _totalSize  = query.value(1).toULongLong();
         }
     }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
+    //-- Tiles only in the default set
+    s = QString("SELECT uniqueCount, uniqueSize FROM SetStats WHERE setID = %1").arg(_getDefaultTileSet());
+    _defaultCount = 0;
+    _defaultSize  = 0;
     if(query.exec(s)) {
         if(query.next()) {
             _defaultCount = query.value(0).toUInt();
@@ -460,17 +795,12 @@ QGCCacheWorker::_updateTotals()
 }
 
 //-----------------------------------------------------------------------------
-quint64 QGCCacheWorker::_findTile(const QString hash)
+bool QGCCacheWorker::_findTile(quint64 key)
 {
-    quint64 tileID = 0;
     QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
-    if(query.exec(s)) {
-        if(query.next()) {
-            tileID = query.value(0).toULongLong();
-        }
-    }
-    return tileID;
+    query.prepare("SELECT tileID FROM Tiles WHERE tileID = ?");
+    query.addBindValue(static_cast<qint64>(key));
+    return query.exec() && query.next();
 }
 
 //-----------------------------------------------------------------------------
@@ -510,18 +840,20 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                     task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
                     task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), task->tileSet()->type());
                 tileCount += set.tileCount;
-                QString type = task->tileSet()->type();
+                int mapId = getQGCMapEngine()->urlFactory()->getIdFromType(task->tileSet()->type());
                 for(int x = set.tileX0; x <= set.tileX1; x++) {
                     for(int y = set.tileY0; y <= set.tileY1; y++) {
                         //-- See if tile is already downloaded
-                        QString hash = QGCMapEngine::getTileHash(type, x, y, z);
-                        quint64 tileID = _findTile(hash);
-                        if(!tileID) {
+                        quint64 key = QGCMapEngine::getTileKey(mapId, x, y, z);
+                        if(!key) {
+                            continue;
+                        }
+                        if(!_findTile(key)) {
                             //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
+                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, tileKey, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
                             query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(type));
+                            query.addBindValue(static_cast<qint64>(key));
+                            query.addBindValue(mapId);
                             query.addBindValue(x);
                             query.addBindValue(y);
                             query.addBindValue(z);
@@ -534,12 +866,12 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                                 actual_count++;
                         } else {
                             //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
+                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(key).arg(setID);
                             query.prepare(s);
                             if(!query.exec()) {
                                 qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
                             }
-                            qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached HASH:" << hash;
+                            qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached KEY:" << key;
                         }
                     }
                 }
@@ -564,20 +896,23 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     QList<QGCTile*> tiles;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
+    QString s = QString("SELECT tileKey, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
     if(query.exec(s)) {
         while(query.next()) {
             QGCTile* tile = new QGCTile;
-            tile->setHash(query.value("hash").toString());
+            tile->setKey(query.value("tileKey").toULongLong());
             tile->setType(getQGCMapEngine()->urlFactory()->getTypeFromId(query.value("type").toInt()));
             tile->setX(query.value("x").toInt());
             tile->setY(query.value("y").toInt());
             tile->setZ(query.value("z").toInt());
             tiles.append(tile);
         }
+        query.prepare("UPDATE TilesDownload SET state = ? WHERE setID = ? AND tileKey = ?");
         for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
-            if(!query.exec(s)) {
+            query.bindValue(0, static_cast<int>(QGCTile::StateDownloading));
+            query.bindValue(1, task->setID());
+            query.bindValue(2, static_cast<qint64>(tiles[i]->key()));
+            if(!query.exec()) {
                 qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
             }
         }
@@ -593,19 +928,32 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
         return;
     }
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
-    } else {
-        if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
-        } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+        for(quint64 key: task->keys()) {
+            _deleteDownloadQuery->bindValue(0, task->setID());
+            _deleteDownloadQuery->bindValue(1, static_cast<qint64>(key));
+            if(!_deleteDownloadQuery->exec()) {
+                qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << _deleteDownloadQuery->lastError().text();
+            }
         }
+        return;
     }
-    if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+    QSqlQuery query(*_db);
+    if(task->keys().isEmpty()) {
+        QString s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
+        if(!query.exec(s)) {
+            qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+        }
+        return;
+    }
+    query.prepare("UPDATE TilesDownload SET state = ? WHERE setID = ? AND tileKey = ?");
+    for(quint64 key: task->keys()) {
+        query.bindValue(0, static_cast<int>(task->state()));
+        query.bindValue(1, task->setID());
+        query.bindValue(2, static_cast<qint64>(key));
+        if(!query.exec()) {
+            qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+        }
     }
 }
 
@@ -617,26 +965,127 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
         return;
     }
     QGCPruneCacheTask* task = static_cast<QGCPruneCacheTask*>(mtask);
+    quint64 amount = task->amount();
+    _evictDate = 0;
+    while(amount) {
+        quint64 evicted = _evictTiles(amount);
+        if(!evicted) {
+            break;
+        }
+        amount -= qMin(evicted, amount);
+    }
+    task->setPruned();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_runIdleWork()
+{
+    if(_storeAccessTimes()) {
+        return true;
+    }
+    _mutex.lock();
+    quint64 maxSize = _maxDiskCache;
+    _mutex.unlock();
+    if(!maxSize) {
+        return false;
+    }
+    if(!_evicting) {
+        if(_defaultSize <= maxSize) {
+            return false;
+        }
+        _evicting = true;
+        _evictDate = 0;
+        qCDebug(QGCTileCacheLog) << "Evicting tiles, default set size:" << _defaultSize << "limit:" << maxSize;
+    }
+    quint64 target = maxSize / 100 * EVICT_LOW_WATER;
+    quint64 evicted = _defaultSize > target ? _evictTiles(_defaultSize - target) : 0;
+    if(!evicted || _defaultSize <= target) {
+        //-- Done, or nothing left which can be evicted
+        _evicting = false;
+        _updateTotals();
+        return evicted > 0;
+    }
+    if(time(nullptr) - _lastUpdate > _updateTimeout) {
+        _updateTotals();
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_storeAccessTimes()
+{
+    QSet<quint64> accessed = _readerPool.takeAccessed();
+    if(accessed.isEmpty()) {
+        return false;
+    }
     QSqlQuery query(*_db);
-    QString s;
-    //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
-    qint64 amount = (qint64)task->amount();
-    QList<quint64> tlist;
-    if(query.exec(s)) {
-        while(query.next() && amount >= 0) {
-            tlist << query.value(0).toULongLong();
-            amount -= query.value(1).toULongLong();
-            qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << query.value(2).toString();
+    query.prepare("UPDATE Tiles SET date = ? WHERE tileID = ?");
+    uint now = QDateTime::currentDateTime().toTime_t();
+    _db->transaction();
+    for(quint64 key: accessed) {
+        query.bindValue(0, now);
+        query.bindValue(1, static_cast<qint64>(key));
+        if(!query.exec()) {
+            qWarning() << "Map Cache SQL error (store access times):" << query.lastError().text();
+            break;
         }
-        while(tlist.count()) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
-            tlist.removeFirst();
-            if(!query.exec(s))
-                break;
+    }
+    query.finish();
+    if(!_db->commit()) {
+        _db->rollback();
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+quint64
+QGCCacheWorker::_evictTiles(quint64 amount)
+{
+    //-- Least recently used first. Tiles in any other set belong to the user and are never evicted. The scan
+    //   continues from the date evicted last, so older user tiles are only passed over once per eviction run.
+    QSqlQuery query(*_db);
+    QString s = QString("SELECT tileID, size, date FROM Tiles A WHERE date >= %3 AND NOT EXISTS (SELECT 1 FROM SetTiles B WHERE B.tileID = A.tileID AND B.setID <> %1) ORDER BY date ASC LIMIT %2")
+        .arg(_getDefaultTileSet()).arg(EVICT_BATCH_MAX).arg(_evictDate);
+    QList<quint64> tlist;
+    quint64 size = 0;
+    quint64 date = _evictDate;
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (select tiles to evict):" << query.lastError().text();
+        return 0;
+    }
+    while(size < amount && query.next()) {
+        tlist << query.value(0).toULongLong();
+        size += query.value(1).toULongLong();
+        date  = query.value(2).toULongLong();
+    }
+    query.finish();
+    if(tlist.isEmpty()) {
+        return 0;
+    }
+    //-- One short transaction per batch, so the reader threads and queued tasks are never held up for long
+    _db->transaction();
+    query.prepare("DELETE FROM Tiles WHERE tileID = ?");
+    for(quint64 key: tlist) {
+        query.bindValue(0, static_cast<qint64>(key));
+        if(!query.exec()) {
+            qWarning() << "Map Cache SQL error (evict tile):" << query.lastError().text();
+            _db->rollback();
+            return 0;
         }
-        task->setPruned();
     }
+    if(!_db->commit()) {
+        qWarning() << "Map Cache SQL error (commit eviction):" << _db->lastError().text();
+        _db->rollback();
+        return 0;
+    }
+    qCDebug(QGCTileCacheLog) << "_evictTiles() tiles:" << tlist.count() << "bytes:" << size;
+    _evictDate = date;
+    //-- Kept current between the (throttled) total updates
+    _defaultSize  -= qMin(size, _defaultSize);
+    _defaultCount -= qMin(static_cast<quint32>(tlist.count()), _defaultCount);
+    return size;
 }
 
 //-----------------------------------------------------------------------------
@@ -666,6 +1115,8 @@ QGCCacheWorker::_deleteTileSet(qulonglong id)
     query.exec(s);
     s = QString("DELETE FROM SetTiles WHERE setID = %1").arg(id);
     query.exec(s);
+    s = QString("DELETE FROM SetStats WHERE setID = %1").arg(id);
+    query.exec(s);
     _updateTotals();
 }
 
@@ -693,6 +1144,15 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    _resetDB();
+    task->setResetCompleted();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_resetDB()
+{
+    _readerPool.lockDatabase();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -703,8 +1163,100 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     query.exec(s);
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
+    s = QString("DROP TABLE CacheStats");
+    query.exec(s);
+    s = QString("DROP TABLE SetStats");
+    query.exec(s);
+    s = QString("DROP TABLE TileImages");
+    query.exec(s);
     _valid = _createDB(_db);
-    task->setResetCompleted();
+    _readerPool.unlockDatabase();
+    return _valid;
+}
+
+//-----------------------------------------------------------------------------
+//  Moves the images tiles still have inline, saved before images were shared or imported, to TileImages. Identical
+//  ones end up stored once. Reports how many tiles share how many images and the bytes that saves.
+void
+QGCCacheWorker::_deduplicateTiles(QGCMapTask* mtask)
+{
+    if(!_testTask(mtask)) {
+        return;
+    }
+    QGCDeduplicateTask* task = static_cast<QGCDeduplicateTask*>(mtask);
+    QElapsedTimer timer;
+    timer.start();
+    QSqlQuery query(*_db);
+    quint64 tileCount = 0;
+    if(query.exec("SELECT COUNT(*) FROM Tiles WHERE tile IS NOT NULL") && query.next()) {
+        tileCount = query.value(0).toULongLong();
+    }
+    QSqlQuery selectQuery(*_db);
+    selectQuery.prepare("SELECT tileID, tile FROM Tiles WHERE tileID > ? AND tile IS NOT NULL ORDER BY tileID LIMIT ?");
+    QSqlQuery updateQuery(*_db);
+    updateQuery.prepare("UPDATE Tiles SET imageID = ?, tile = NULL WHERE tileID = ?");
+    quint64 currentCount = 0;
+    int lastProgress = -1;
+    qint64 after = 0;
+    while(true) {
+        //-- The batch is read before it is written, the walk goes on from its last tile
+        QList<QPair<qint64, QByteArray>> tiles;
+        selectQuery.bindValue(0, after);
+        selectQuery.bindValue(1, DEDUP_BATCH_MAX);
+        if(selectQuery.exec()) {
+            while(selectQuery.next()) {
+                tiles.append(qMakePair(selectQuery.value(0).toLongLong(), selectQuery.value(1).toByteArray()));
+            }
+        }
+        selectQuery.finish();
+        if(tiles.isEmpty()) {
+            break;
+        }
+        if(!_db->transaction()) {
+            task->setError("Error deduplicating tiles");
+            break;
+        }
+        for(const QPair<qint64, QByteArray>& tile: tiles) {
+            quint64 imageID = _storeTileImage(tile.second);
+            if(imageID) {
+                updateQuery.bindValue(0, static_cast<qint64>(imageID));
+                updateQuery.bindValue(1, tile.first);
+                if(!updateQuery.exec()) {
+                    qWarning() << "Map Cache SQL error (deduplicate tile):" << updateQuery.lastError().text();
+                }
+            }
+        }
+        if(!_db->commit()) {
+            qWarning() << "Map Cache SQL error (commit deduplicated tiles):" << _db->lastError().text();
+            _db->rollback();
+            task->setError("Error deduplicating tiles");
+            break;
+        }
+        after = tiles.last().first;
+        currentCount += static_cast<quint64>(tiles.count());
+        int progress = tileCount ? static_cast<int>(qMin(static_cast<double>(currentCount) / static_cast<double>(tileCount), 1.0) * 100.0) : 100;
+        if(lastProgress != progress) {
+            lastProgress = progress;
+            task->setProgress(progress);
+        }
+    }
+    //-- Report
+    quint32 sharedTiles = 0;
+    quint64 sharedSize  = 0;
+    quint32 imageCount  = 0;
+    quint64 imageSize   = 0;
+    if(query.exec("SELECT COUNT(*), COALESCE(SUM(size), 0) FROM Tiles WHERE imageID IS NOT NULL") && query.next()) {
+        sharedTiles = query.value(0).toUInt();
+        sharedSize  = query.value(1).toULongLong();
+    }
+    if(query.exec("SELECT COUNT(*), COALESCE(SUM(size), 0) FROM TileImages") && query.next()) {
+        imageCount  = query.value(0).toUInt();
+        imageSize   = query.value(1).toULongLong();
+    }
+    quint64 savedSize = sharedSize > imageSize ? sharedSize - imageSize : 0;
+    qCDebug(QGCTileCacheLog) << "_deduplicateTiles() moved:" << currentCount << "tiles:" << sharedTiles << "images:" << imageCount
+                             << "saved:" << savedSize << "msecs:" << timer.elapsed();
+    task->setDeduplicateCompleted(sharedTiles, imageCount, savedSize);
 }
 
 //-----------------------------------------------------------------------------
@@ -715,14 +1267,25 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         return;
     }
     QGCImportTileTask* task = static_cast<QGCImportTileTask*>(mtask);
-    //-- If replacing, simply copy over it
-    if(task->replace()) {
-        //-- Close and delete old database
-        if(_db) {
-            delete _db;
-            _db = nullptr;
-            QSqlDatabase::removeDatabase(kSession);
+    //-- The format is told by the tables the file has
+    TransferFormat format = TransferUnknown;
+    if(QFile::exists(task->path()) && _attachTransfer(task->path())) {
+        if(_transferHasTable("TileSets")) {
+            format = TransferQGC;
+        } else if(_transferHasTable("metadata") && _transferHasTable("tiles")) {
+            format = TransferMBTiles;
         }
+        if(format == TransferUnknown || (format == TransferQGC && task->replace())) {
+            _detachTransfer();
+        }
+    }
+    if(format == TransferUnknown) {
+        task->setError("Error opening import database");
+    } else if(format == TransferQGC && task->replace()) {
+        //-- If replacing, simply copy over it
+        //-- Close and delete old database
+        _readerPool.lockDatabase();
+        _disconnectDB();
         QFile file(_databasePath);
         file.remove();
         //-- Copy given database
@@ -731,166 +1294,249 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         _init();
         if(_valid) {
             task->setProgress(50);
-            _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-            _db->setDatabaseName(_databasePath);
-            _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            _valid = _db->open();
+            _valid = _connectDB();
         }
+        _readerPool.unlockDatabase();
         task->setProgress(100);
     } else {
-        //-- Open imported set
-        QSqlDatabase* dbImport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-        dbImport->setDatabaseName(task->path());
-        dbImport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (dbImport->open()) {
-            QSqlQuery query(*dbImport);
-            //-- Prepare progress report
-            quint64 tileCount = 0;
-            quint64 currentCount = 0;
-            int lastProgress = -1;
-            QString s;
-            s = QString("SELECT COUNT(tileID) FROM Tiles");
-            if(query.exec(s)) {
-                if(query.next()) {
-                    //-- Total number of tiles in imported database
-                    tileCount  = query.value(0).toULongLong();
+        if(format == TransferQGC) {
+            _importQGCSets(task);
+        } else {
+            _importMBTiles(task);
+        }
+        _detachTransfer();
+    }
+    task->setImportCompleted();
+}
+
+//-----------------------------------------------------------------------------
+//  Each set is imported with all of its tiles. Tiles already in the cache are left out by joining against it, so
+//  their image is never read from the imported database.
+void
+QGCCacheWorker::_importQGCSets(QGCImportTileTask* task)
+{
+    QSqlQuery query(*_db);
+    //-- Prepare progress report
+    quint64 tileCount = 0;
+    quint64 currentCount = 0;
+    quint64 importedCount = 0;
+    int lastProgress = -1;
+    if(query.exec("SELECT COUNT(*) FROM Transfer.SetTiles") && query.next()) {
+        tileCount = query.value(0).toULongLong();
+    }
+    //-- Databases exported before tiles had integer keys are keyed by text hash
+    QString stageSelect;
+    if(_transferHasColumn("Tiles", "hash")) {
+        if(!_createTileKeyProviders(_db)) {
+            tileCount = 0;
+        }
+        stageSelect = QString("SELECT %1, T.tileID, NULL, NULL, NULL FROM Transfer.SetTiles S JOIN Transfer.Tiles T ON T.tileID = S.tileID "
+                              "JOIN TileKeyProviders P ON P.mapId = CAST(substr(T.hash, 1, 10) AS INTEGER) WHERE S.setID = :setID AND %2")
+            .arg(_hashToTileKeySql("T")).arg(_hashInKeyRangeSql("T"));
+    } else {
+        stageSelect = QString("SELECT tileID, tileID, NULL, NULL, NULL FROM Transfer.SetTiles WHERE setID = :setID");
+    }
+    QSqlQuery stageQuery(*_db);
+    stageQuery.prepare(QString("INSERT OR IGNORE INTO TransferTiles(tileKey, srcID, z, x, y) ") + stageSelect);
+    QSqlQuery copyQuery(*_db);
+    //-- A cache database may be imported as is, its images may be shared
+    QString tileImage = "T.tile";
+    QString tileImageJoin;
+    if(_transferHasTable("TileImages")) {
+        tileImage       = "COALESCE(TI.tile, T.tile)";
+        tileImageJoin   = "LEFT JOIN Transfer.TileImages TI ON TI.imageID = T.imageID ";
+    }
+    copyQuery.prepare(QString("INSERT OR IGNORE INTO main.Tiles(tileID, format, tile, size, type, date) "
+                              "SELECT I.tileKey, T.format, %1, LENGTH(%1), T.type, :date FROM TransferTiles I "
+                              "JOIN Transfer.Tiles T ON T.tileID = I.srcID %2LEFT JOIN main.Tiles E ON E.tileID = I.tileKey "
+                              "WHERE I.tileKey > :first AND I.tileKey <= :last AND E.tileID IS NULL").arg(tileImage).arg(tileImageJoin));
+    QSqlQuery linkQuery(*_db);
+    linkQuery.prepare(kLinkTransferTiles);
+    if(tileCount) {
+        //-- Iterate Tile Sets
+        if(query.exec("SELECT * FROM Transfer.TileSets ORDER BY defaultSet DESC, name ASC")) {
+            while(query.next()) {
+                QString name            = query.value("name").toString();
+                quint64 setID           = query.value("setID").toULongLong();
+                int     defaultSet      = query.value("defaultSet").toInt();
+                quint64 insertSetID     = _getDefaultTileSet();
+                //-- If not default set, create new one
+                if(!defaultSet) {
+                    name = _uniqueTileSetName(name);
+                    if(!_insertTileSet(name, query.value("typeStr").toString(),
+                                       query.value("topleftLat").toDouble(), query.value("topleftLon").toDouble(),
+                                       query.value("bottomRightLat").toDouble(), query.value("bottomRightLon").toDouble(),
+                                       query.value("minZoom").toInt(), query.value("maxZoom").toInt(),
+                                       query.value("type").toInt(), query.value("numTiles").toUInt(), insertSetID)) {
+                        task->setError("Error adding imported tile set to database");
+                        break;
+                    }
                 }
-            }
-            if(tileCount) {
-                //-- Iterate Tile Sets
-                s = QString("SELECT * FROM TileSets ORDER BY defaultSet DESC, name ASC");
-                if(query.exec(s)) {
-                    while(query.next()) {
-                        QString name            = query.value("name").toString();
-                        quint64 setID           = query.value("setID").toULongLong();
-                        QString mapType         = query.value("typeStr").toString();
-                        double  topleftLat      = query.value("topleftLat").toDouble();
-                        double  topleftLon      = query.value("topleftLon").toDouble();
-                        double  bottomRightLat  = query.value("bottomRightLat").toDouble();
-                        double  bottomRightLon  = query.value("bottomRightLon").toDouble();
-                        int     minZoom         = query.value("minZoom").toInt();
-                        int     maxZoom         = query.value("maxZoom").toInt();
-                        int     type            = query.value("type").toInt();
-                        quint32 numTiles        = query.value("numTiles").toUInt();
-                        int     defaultSet      = query.value("defaultSet").toInt();
-                        quint64 insertSetID     = _getDefaultTileSet();
-                        //-- If not default set, create new one
-                        if(!defaultSet) {
-                            //-- Check if we have this tile set already
-                            if(_findTileSetID(name, insertSetID)) {
-                                int testCount = 0;
-                                //-- Set with this name already exists. Make name unique.
-                                while (true) {
-                                    auto testName = QString::asprintf("%s %02d", name.toLatin1().data(), ++testCount);
-                                    if(!_findTileSetID(testName, insertSetID) || testCount > 99) {
-                                        name = testName;
-                                        break;
-                                    }
-                                }
-                            }
-                            //-- Create new set
-                            QSqlQuery cQuery(*_db);
-                            cQuery.prepare("INSERT INTO TileSets("
-                                "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                            cQuery.addBindValue(name);
-                            cQuery.addBindValue(mapType);
-                            cQuery.addBindValue(topleftLat);
-                            cQuery.addBindValue(topleftLon);
-                            cQuery.addBindValue(bottomRightLat);
-                            cQuery.addBindValue(bottomRightLon);
-                            cQuery.addBindValue(minZoom);
-                            cQuery.addBindValue(maxZoom);
-                            cQuery.addBindValue(type);
-                            cQuery.addBindValue(numTiles);
-                            cQuery.addBindValue(defaultSet);
-                            cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                            if(!cQuery.exec()) {
-                                task->setError("Error adding imported tile set to database");
-                                break;
-                            } else {
-                                //-- Get just created (auto-incremented) setID
-                                insertSetID = cQuery.lastInsertId().toULongLong();
-                            }
-                        }
-                        //-- Find set tiles
-                        QSqlQuery cQuery(*_db);
-                        QSqlQuery subQuery(*dbImport);
-                        QString sb = QString("SELECT * FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
-                        if(subQuery.exec(sb)) {
-                            quint64 tilesFound = 0;
-                            quint64 tilesSaved = 0;
-                            _db->transaction();
-                            while(subQuery.next()) {
-                                tilesFound++;
-                                QString hash    = subQuery.value("hash").toString();
-                                QString format  = subQuery.value("format").toString();
-                                QByteArray img  = subQuery.value("tile").toByteArray();
-                                int type        = subQuery.value("type").toInt();
-                                //-- Save tile
-                                cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                cQuery.addBindValue(hash);
-                                cQuery.addBindValue(format);
-                                cQuery.addBindValue(img);
-                                cQuery.addBindValue(img.size());
-                                cQuery.addBindValue(type);
-                                cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                if(cQuery.exec()) {
-                                    tilesSaved++;
-                                    quint64 importTileID = cQuery.lastInsertId().toULongLong();
-                                    QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(importTileID).arg(insertSetID);
-                                    cQuery.prepare(s);
-                                    cQuery.exec();
-                                    currentCount++;
-                                    if(tileCount) {
-                                        int progress = (int)((double)currentCount / (double)tileCount * 100.0);
-                                        //-- Avoid calling this if (int) progress hasn't changed.
-                                        if(lastProgress != progress) {
-                                            lastProgress = progress;
-                                            task->setProgress(progress);
-                                        }
-                                    }
-                                }
-                            }
-                            _db->commit();
-                            if(tilesSaved) {
-                                //-- Update tile count (if any added)
-                                s = QString("SELECT COUNT(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(insertSetID);
-                                if(cQuery.exec(s)) {
-                                    if(cQuery.next()) {
-                                        quint64 count  = cQuery.value(0).toULongLong();
-                                        s = QString("UPDATE TileSets SET numTiles = %1 WHERE setID = %2").arg(count).arg(insertSetID);
-                                        cQuery.exec(s);
-                                    }
-                                }
-                            }
-                            qint64 uniqueTiles = tilesFound - tilesSaved;
-                            if((quint64)uniqueTiles < tileCount) {
-                                tileCount -= uniqueTiles;
-                            } else {
-                                tileCount = 0;
-                            }
-                            //-- If there was nothing new in this set, remove it.
-                            if(!tilesSaved && !defaultSet) {
-                                qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
-                                _deleteTileSet(insertSetID);
-                            }
-                        }
+                //-- Find set tiles
+                _clearTransferTiles();
+                stageQuery.bindValue(":setID", static_cast<qint64>(setID));
+                if(!stageQuery.exec()) {
+                    qWarning() << "Map Cache SQL error (stage imported tiles):" << stageQuery.lastError().text();
+                    continue;
+                }
+                quint64 stagedCount = static_cast<quint64>(stageQuery.numRowsAffected());
+                quint64 tilesStaged = 0;
+                quint64 tilesSaved  = 0;
+                copyQuery.bindValue(":date", QDateTime::currentDateTime().toTime_t());
+                linkQuery.bindValue(":setID", static_cast<qint64>(insertSetID));
+                quint64 first = 0;
+                quint64 last  = 0;
+                while(_nextTransferBatch(first, last)) {
+                    qint64 saved = _runTransferBatch({ &copyQuery, &linkQuery }, first, last);
+                    if(saved < 0) {
+                        break;
+                    }
+                    first = last;
+                    tilesSaved  += static_cast<quint64>(saved);
+                    tilesStaged  = qMin(tilesStaged + TRANSFER_BATCH_MAX, stagedCount);
+                    int progress = static_cast<int>(qMin(static_cast<double>(currentCount + tilesStaged) / static_cast<double>(tileCount), 1.0) * 100.0);
+                    //-- Avoid calling this if (int) progress hasn't changed.
+                    if(lastProgress != progress) {
+                        lastProgress = progress;
+                        task->setProgress(progress);
                     }
-                } else {
-                    task->setError("No tile set in database");
                 }
-            }
-            delete dbImport;
-            QSqlDatabase::removeDatabase(kExportSession);
-            if(!tileCount) {
-                task->setError("No unique tiles in imported database");
+                currentCount  += stagedCount;
+                importedCount += tilesSaved;
+                if(tilesSaved) {
+                    //-- Update tile count (if any added)
+                    QSqlQuery cQuery(*_db);
+                    cQuery.exec(QString("UPDATE TileSets SET numTiles = (SELECT tileCount FROM SetStats WHERE setID = %1) WHERE setID = %1").arg(insertSetID));
+                }
+                //-- If there was nothing new in this set, remove it.
+                if(!tilesSaved && !defaultSet) {
+                    qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
+                    _deleteTileSet(insertSetID);
+                }
             }
         } else {
-            task->setError("Error opening import database");
+            task->setError("No tile set in database");
         }
     }
-    task->setImportCompleted();
+    if(!importedCount) {
+        task->setError("No unique tiles in imported database");
+    }
+}
+
+//-----------------------------------------------------------------------------
+//  An MBTiles file holds a single tile set of one map type, its tiles are keyed by zoom, column and TMS row
+void
+QGCCacheWorker::_importMBTiles(QGCImportTileTask* task)
+{
+    QSqlQuery query(*_db);
+    QHash<QString, QString> metadata;
+    if(query.exec("SELECT name, value FROM Transfer.metadata")) {
+        while(query.next()) {
+            metadata[query.value(0).toString()] = query.value(1).toString();
+        }
+    }
+    //-- Files exported by QGC name the map type, others may only be told apart by their name
+    UrlFactory* urlFactory = getQGCMapEngine()->urlFactory();
+    QString mapType = metadata.value(kMBTilesMapTypeKey);
+    if(urlFactory->getTypeFromId(urlFactory->getIdFromType(mapType)) != mapType || mapType.isEmpty()) {
+        mapType = metadata.value("name");
+    }
+    if(mapType.isEmpty() || urlFactory->getTypeFromId(urlFactory->getIdFromType(mapType)) != mapType) {
+        task->setError("Unknown map type in MBTiles file");
+        return;
+    }
+    int mapId       = urlFactory->getIdFromType(mapType);
+    int keyIndex    = urlFactory->getTileKeyIndex(mapId);
+    QString format  = metadata.value("format", "png");
+    if(format == "jpeg") {
+        format = "jpg";
+    }
+    if(!keyIndex || format == "pbf") {
+        task->setError("Map type of MBTiles file can't be cached");
+        return;
+    }
+    //-- Find tiles
+    _clearTransferTiles();
+    QString s = QString("INSERT OR IGNORE INTO TransferTiles(tileKey, srcID, z, x, y) "
+                        "SELECT (%1 << %2) | (zoom_level << %3) | (tile_column << %4) | ((1 << zoom_level) - 1 - tile_row), NULL, zoom_level, tile_column, tile_row "
+                        "FROM Transfer.tiles WHERE zoom_level BETWEEN 0 AND %5 "
+                        "AND tile_column BETWEEN 0 AND (1 << zoom_level) - 1 AND tile_row BETWEEN 0 AND (1 << zoom_level) - 1")
+        .arg(keyIndex).arg(TILE_KEY_PROVIDER_SHIFT).arg(TILE_KEY_ZOOM_SHIFT).arg(TILE_KEY_X_SHIFT).arg(TILE_KEY_XY_BITS);
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (stage MBTiles tiles):" << query.lastError().text();
+        task->setError("Error reading MBTiles file");
+        return;
+    }
+    quint64 tileCount = 0;
+    int minZoom = 0;
+    int maxZoom = 0;
+    if(query.exec("SELECT COUNT(*), MIN(z), MAX(z) FROM TransferTiles") && query.next()) {
+        tileCount   = query.value(0).toULongLong();
+        minZoom     = query.value(1).toInt();
+        maxZoom     = query.value(2).toInt();
+    }
+    if(!tileCount) {
+        task->setError("No tiles in MBTiles file");
+        return;
+    }
+    //-- The cache is only dropped once the file is known to be one that can be imported
+    if(task->replace() && !_resetDB()) {
+        task->setError("Error resetting tile cache");
+        return;
+    }
+    //-- Bounds are "left,bottom,right,top"
+    QStringList bounds = metadata.value("bounds").split(",");
+    if(bounds.count() != 4) {
+        bounds = QStringList({ "0", "0", "0", "0" });
+    }
+    QString name = metadata.value("name");
+    if(name.isEmpty() || name == mapType) {
+        name = QFileInfo(task->path()).completeBaseName();
+    }
+    name = _uniqueTileSetName(name);
+    quint64 insertSetID = 0;
+    if(!_insertTileSet(name, mapType, bounds[3].toDouble(), bounds[0].toDouble(), bounds[1].toDouble(), bounds[2].toDouble(),
+                       minZoom, maxZoom, mapId, static_cast<quint32>(tileCount), insertSetID)) {
+        task->setError("Error adding imported tile set to database");
+        return;
+    }
+    QSqlQuery copyQuery(*_db);
+    copyQuery.prepare("INSERT OR IGNORE INTO main.Tiles(tileID, format, tile, size, type, date) "
+                      "SELECT I.tileKey, :format, M.tile_data, LENGTH(M.tile_data), :type, :date FROM TransferTiles I "
+                      "JOIN Transfer.tiles M ON M.zoom_level = I.z AND M.tile_column = I.x AND M.tile_row = I.y "
+                      "LEFT JOIN main.Tiles E ON E.tileID = I.tileKey "
+                      "WHERE I.tileKey > :first AND I.tileKey <= :last AND E.tileID IS NULL");
+    copyQuery.bindValue(":format", format);
+    copyQuery.bindValue(":type", mapId);
+    copyQuery.bindValue(":date", QDateTime::currentDateTime().toTime_t());
+    QSqlQuery linkQuery(*_db);
+    linkQuery.prepare(kLinkTransferTiles);
+    linkQuery.bindValue(":setID", static_cast<qint64>(insertSetID));
+    quint64 currentCount = 0;
+    quint64 tilesSaved = 0;
+    int lastProgress = -1;
+    quint64 first = 0;
+    quint64 last  = 0;
+    while(_nextTransferBatch(first, last)) {
+        qint64 saved = _runTransferBatch({ &copyQuery, &linkQuery }, first, last);
+        if(saved < 0) {
+            task->setError("Error importing MBTiles file");
+            break;
+        }
+        first = last;
+        tilesSaved  += static_cast<quint64>(saved);
+        currentCount = qMin(currentCount + TRANSFER_BATCH_MAX, tileCount);
+        int progress = static_cast<int>(static_cast<double>(currentCount) / static_cast<double>(tileCount) * 100.0);
+        if(lastProgress != progress) {
+            lastProgress = progress;
+            task->setProgress(progress);
+        }
+    }
+    if(!tilesSaved) {
+        qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
+        _deleteTileSet(insertSetID);
+        task->setError("No unique tiles in imported database");
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -901,107 +1547,420 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
         return;
     }
     QGCExportTileTask* task = static_cast<QGCExportTileTask*>(mtask);
+    bool mbtiles = task->path().endsWith(".mbtiles", Qt::CaseInsensitive);
     //-- Delete target if it exists
     QFile file(task->path());
     file.remove();
-    //-- Create exported database
-    QSqlDatabase *dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-    dbExport->setDatabaseName(task->path());
-    dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-    if (dbExport->open()) {
-        if(_createDB(dbExport, false)) {
-            //-- Prepare progress report
-            quint64 tileCount = 0;
-            quint64 currentCount = 0;
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Default set has no unique tiles
-                if(set->defaultSet()) {
-                    tileCount += set->totalTileCount();
-                } else {
-                    tileCount += set->uniqueTileCount();
-                }
+    bool created = true;
+    if(!mbtiles) {
+        //-- Create exported database
+        QSqlDatabase *dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
+        dbExport->setDatabaseName(task->path());
+        dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+        if (dbExport->open()) {
+            if(!_createDB(dbExport, false)) {
+                task->setError("Error creating export database");
+                created = false;
             }
-            if(!tileCount) {
-                tileCount = 1;
-            }
-            //-- Iterate sets to save
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Create Tile Exported Set
-                QSqlQuery exportQuery(*dbExport);
-                exportQuery.prepare("INSERT INTO TileSets("
-                    "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                    ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                exportQuery.addBindValue(set->name());
-                exportQuery.addBindValue(set->mapTypeStr());
-                exportQuery.addBindValue(set->topleftLat());
-                exportQuery.addBindValue(set->topleftLon());
-                exportQuery.addBindValue(set->bottomRightLat());
-                exportQuery.addBindValue(set->bottomRightLon());
-                exportQuery.addBindValue(set->minZoom());
-                exportQuery.addBindValue(set->maxZoom());
-                exportQuery.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(set->type()));
-                exportQuery.addBindValue(set->totalTileCount());
-                exportQuery.addBindValue(set->defaultSet());
-                exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                if(!exportQuery.exec()) {
-                    task->setError("Error adding tile set to exported database");
-                    break;
-                } else {
-                    //-- Get just created (auto-incremented) setID
-                    quint64 exportSetID = exportQuery.lastInsertId().toULongLong();
-                    //-- Find set tiles
-                    QString s = QString("SELECT * FROM SetTiles WHERE setID = %1").arg(set->id());
-                    QSqlQuery query(*_db);
-                    if(query.exec(s)) {
-                        dbExport->transaction();
-                        while(query.next()) {
-                            quint64 tileID = query.value("tileID").toULongLong();
-                            //-- Get tile
-                            QString s = QString("SELECT * FROM Tiles WHERE tileID = \"%1\"").arg(tileID);
-                            QSqlQuery subQuery(*_db);
-                            if(subQuery.exec(s)) {
-                                if(subQuery.next()) {
-                                    QString hash    = subQuery.value("hash").toString();
-                                    QString format  = subQuery.value("format").toString();
-                                    QByteArray img  = subQuery.value("tile").toByteArray();
-                                    int type        = subQuery.value("type").toInt();
-                                    //-- Save tile
-                                    exportQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                    exportQuery.addBindValue(hash);
-                                    exportQuery.addBindValue(format);
-                                    exportQuery.addBindValue(img);
-                                    exportQuery.addBindValue(img.size());
-                                    exportQuery.addBindValue(type);
-                                    exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                    if(exportQuery.exec()) {
-                                        quint64 exportTileID = exportQuery.lastInsertId().toULongLong();
-                                        QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(exportTileID).arg(exportSetID);
-                                        exportQuery.prepare(s);
-                                        exportQuery.exec();
-                                        currentCount++;
-                                        task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    dbExport->commit();
-                }
+        } else {
+            qCritical() << "Map Cache SQL error (create export database):" << dbExport->lastError();
+            task->setError("Error opening export database");
+            created = false;
+        }
+        delete dbExport;
+        QSqlDatabase::removeDatabase(kExportSession);
+    }
+    bool exported = false;
+    if(created) {
+        if(_attachTransfer(task->path())) {
+            //-- A failed export is deleted below, so the file needs no journal
+            QSqlQuery query(*_db);
+            query.exec("PRAGMA Transfer.journal_mode=OFF");
+            query.exec("PRAGMA Transfer.synchronous=OFF");
+            if(mbtiles) {
+                exported = _exportMBTiles(task);
+            } else {
+                exported = _exportQGCSets(task);
             }
+            _detachTransfer();
         } else {
-            task->setError("Error creating export database");
+            task->setError("Error opening export database");
         }
-    } else {
-        qCritical() << "Map Cache SQL error (create export database):" << dbExport->lastError();
-        task->setError("Error opening export database");
     }
-    delete dbExport;
-    QSqlDatabase::removeDatabase(kExportSession);
+    //-- Without a journal a failed export may leave the file corrupt, it must not be imported later
+    if(!exported) {
+        file.remove();
+    }
     task->setExportCompleted();
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_exportQGCSets(QGCExportTileTask* task)
+{
+    //-- Prepare progress report
+    quint64 tileCount = 0;
+    quint64 currentCount = 0;
+    int lastProgress = -1;
+    for(int i = 0; i < task->sets().count(); i++) {
+        tileCount += task->sets()[i]->savedTileCount();
+    }
+    if(!tileCount) {
+        tileCount = 1;
+    }
+    QSqlQuery stageQuery(*_db);
+    stageQuery.prepare("INSERT OR IGNORE INTO TransferTiles(tileKey, srcID, z, x, y) SELECT tileID, tileID, NULL, NULL, NULL FROM main.SetTiles WHERE setID = :setID");
+    QSqlQuery copyQuery(*_db);
+    copyQuery.prepare("INSERT OR IGNORE INTO Transfer.Tiles(tileID, format, tile, size, type, date) "
+                      "SELECT I.tileKey, T.format, COALESCE(TI.tile, T.tile), T.size, T.type, :date FROM TransferTiles I "
+                      "JOIN main.Tiles T ON T.tileID = I.tileKey LEFT JOIN main.TileImages TI ON TI.imageID = T.imageID "
+                      "LEFT JOIN Transfer.Tiles E ON E.tileID = I.tileKey "
+                      "WHERE I.tileKey > :first AND I.tileKey <= :last AND E.tileID IS NULL");
+    QSqlQuery linkQuery(*_db);
+    linkQuery.prepare("INSERT INTO Transfer.SetTiles(tileID, setID) SELECT I.tileKey, :setID FROM TransferTiles I "
+                      "WHERE I.tileKey > :first AND I.tileKey <= :last AND EXISTS (SELECT 1 FROM Transfer.Tiles E WHERE E.tileID = I.tileKey)");
+    //-- Iterate sets to save
+    for(int i = 0; i < task->sets().count(); i++) {
+        QGCCachedTileSet* set = task->sets()[i];
+        //-- Create Tile Exported Set
+        QSqlQuery exportQuery(*_db);
+        exportQuery.prepare("INSERT INTO Transfer.TileSets("
+            "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+            ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        exportQuery.addBindValue(set->name());
+        exportQuery.addBindValue(set->mapTypeStr());
+        exportQuery.addBindValue(set->topleftLat());
+        exportQuery.addBindValue(set->topleftLon());
+        exportQuery.addBindValue(set->bottomRightLat());
+        exportQuery.addBindValue(set->bottomRightLon());
+        exportQuery.addBindValue(set->minZoom());
+        exportQuery.addBindValue(set->maxZoom());
+        exportQuery.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(set->type()));
+        exportQuery.addBindValue(set->totalTileCount());
+        exportQuery.addBindValue(set->defaultSet());
+        exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
+        if(!exportQuery.exec()) {
+            task->setError("Error adding tile set to exported database");
+            return false;
+        }
+        //-- Get just created (auto-incremented) setID
+        quint64 exportSetID = exportQuery.lastInsertId().toULongLong();
+        //-- Find set tiles
+        _clearTransferTiles();
+        stageQuery.bindValue(":setID", static_cast<qint64>(set->id()));
+        if(!stageQuery.exec()) {
+            qWarning() << "Map Cache SQL error (stage exported tiles):" << stageQuery.lastError().text();
+            task->setError("Error exporting tile set");
+            return false;
+        }
+        quint64 stagedCount = static_cast<quint64>(stageQuery.numRowsAffected());
+        quint64 tilesStaged = 0;
+        copyQuery.bindValue(":date", QDateTime::currentDateTime().toTime_t());
+        linkQuery.bindValue(":setID", static_cast<qint64>(exportSetID));
+        quint64 first = 0;
+        quint64 last  = 0;
+        while(_nextTransferBatch(first, last)) {
+            if(_runTransferBatch({ &copyQuery, &linkQuery }, first, last) < 0) {
+                task->setError("Error exporting tile set");
+                return false;
+            }
+            first = last;
+            tilesStaged  = qMin(tilesStaged + TRANSFER_BATCH_MAX, stagedCount);
+            int progress = static_cast<int>(qMin(static_cast<double>(currentCount + tilesStaged) / static_cast<double>(tileCount), 1.0) * 100.0);
+            if(lastProgress != progress) {
+                lastProgress = progress;
+                task->setProgress(progress);
+            }
+        }
+        currentCount += stagedCount;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  An MBTiles file holds tiles of a single map type: the one of the selected sets, or of most tiles if only the
+//  default set is selected. Its tiles are keyed by zoom, column and TMS row, which counts rows from the south.
+bool
+QGCCacheWorker::_exportMBTiles(QGCExportTileTask* task)
+{
+    UrlFactory* urlFactory = getQGCMapEngine()->urlFactory();
+    QString mapType;
+    QStringList names;
+    double west  =  180.0;
+    double south =   90.0;
+    double east  = -180.0;
+    double north =  -90.0;
+    QSqlQuery stageQuery(*_db);
+    stageQuery.prepare(QString("INSERT OR IGNORE INTO TransferTiles(tileKey, srcID, z, x, y) "
+                               "SELECT tileID, NULL, (tileID >> %1) & %2, (tileID >> %3) & %4, (1 << ((tileID >> %1) & %2)) - 1 - (tileID & %4) "
+                               "FROM main.SetTiles WHERE setID = :setID")
+        .arg(TILE_KEY_ZOOM_SHIFT).arg((1 << (TILE_KEY_PROVIDER_SHIFT - TILE_KEY_ZOOM_SHIFT)) - 1)
+        .arg(TILE_KEY_X_SHIFT).arg((1 << TILE_KEY_XY_BITS) - 1));
+    _clearTransferTiles();
+    for(int i = 0; i < task->sets().count(); i++) {
+        QGCCachedTileSet* set = task->sets()[i];
+        if(!set->defaultSet()) {
+            if(!mapType.isEmpty() && mapType != set->type()) {
+                task->setError("MBTiles files hold tiles of a single map type");
+                return false;
+            }
+            mapType = set->type();
+            names.append(set->name());
+            west    = qMin(west,  set->topleftLon());
+            south   = qMin(south, set->bottomRightLat());
+            east    = qMax(east,  set->bottomRightLon());
+            north   = qMax(north, set->topleftLat());
+        }
+        stageQuery.bindValue(":setID", static_cast<qint64>(set->id()));
+        if(!stageQuery.exec()) {
+            qWarning() << "Map Cache SQL error (stage exported tiles):" << stageQuery.lastError().text();
+            task->setError("Error exporting tile set");
+            return false;
+        }
+    }
+    QSqlQuery query(*_db);
+    int keyIndex = urlFactory->getTileKeyIndex(urlFactory->getIdFromType(mapType));
+    if(mapType.isEmpty()) {
+        if(query.exec(QString("SELECT tileKey >> %1 AS provider FROM TransferTiles GROUP BY provider ORDER BY COUNT(*) DESC LIMIT 1").arg(TILE_KEY_PROVIDER_SHIFT)) && query.next()) {
+            keyIndex = query.value(0).toInt();
+            mapType  = urlFactory->getTypeFromId(urlFactory->getIdFromTileKeyIndex(keyIndex));
+        }
+        names.append(mapType);
+    }
+    if(!keyIndex) {
+        task->setError("No tiles to export");
+        return false;
+    }
+    //-- Tiles of other map types in the default set are left out
+    query.exec(QString("DELETE FROM TransferTiles WHERE (tileKey >> %1) <> %2").arg(TILE_KEY_PROVIDER_SHIFT).arg(keyIndex));
+    quint64 tileCount = 0;
+    int minZoom = 0;
+    int maxZoom = 0;
+    if(query.exec("SELECT COUNT(*), MIN(z), MAX(z) FROM TransferTiles") && query.next()) {
+        tileCount   = query.value(0).toULongLong();
+        minZoom     = query.value(1).toInt();
+        maxZoom     = query.value(2).toInt();
+    }
+    QString format = "png";
+    if(query.exec("SELECT T.format FROM TransferTiles I JOIN main.Tiles T ON T.tileID = I.tileKey LIMIT 1") && query.next()) {
+        format = query.value(0).toString();
+    }
+    for(const char* statement: kCreateMBTilesStatements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (create MBTiles):" << query.lastError().text();
+            task->setError("Error creating export database");
+            return false;
+        }
+    }
+    QSqlQuery copyQuery(*_db);
+    copyQuery.prepare("INSERT INTO Transfer.tiles(zoom_level, tile_column, tile_row, tile_data) "
+                      "SELECT I.z, I.x, I.y, COALESCE(TI.tile, T.tile) FROM TransferTiles I JOIN main.Tiles T ON T.tileID = I.tileKey "
+                      "LEFT JOIN main.TileImages TI ON TI.imageID = T.imageID WHERE I.tileKey > :first AND I.tileKey <= :last");
+    quint64 currentCount = 0;
+    int lastProgress = -1;
+    quint64 first = 0;
+    quint64 last  = 0;
+    while(_nextTransferBatch(first, last)) {
+        if(_runTransferBatch({ &copyQuery }, first, last) < 0) {
+            task->setError("Error exporting tile set");
+            return false;
+        }
+        first = last;
+        currentCount = qMin(currentCount + TRANSFER_BATCH_MAX, tileCount);
+        int progress = static_cast<int>(static_cast<double>(currentCount) / static_cast<double>(qMax(tileCount, static_cast<quint64>(1))) * 100.0);
+        if(lastProgress != progress) {
+            lastProgress = progress;
+            task->setProgress(progress);
+        }
+    }
+    //-- Indexed once all tiles are in, tile keys are unique so the rows are too
+    if(!query.exec("CREATE UNIQUE INDEX Transfer.tile_index ON tiles (zoom_level, tile_column, tile_row)")) {
+        qWarning() << "Map Cache SQL error (index MBTiles):" << query.lastError().text();
+    }
+    QList<QPair<QString, QString>> metadata;
+    metadata.append({ "name",               names.join(", ") });
+    metadata.append({ "format",             format });
+    metadata.append({ "type",               "baselayer" });
+    metadata.append({ "version",            "1.1" });
+    metadata.append({ "description",        "Exported from QGroundControl" });
+    metadata.append({ "minzoom",            QString::number(minZoom) });
+    metadata.append({ "maxzoom",            QString::number(maxZoom) });
+    metadata.append({ kMBTilesMapTypeKey,   mapType });
+    if(west < east && south < north) {
+        metadata.append({ "bounds", QString("%1,%2,%3,%4").arg(west, 0, 'f', 6).arg(south, 0, 'f', 6).arg(east, 0, 'f', 6).arg(north, 0, 'f', 6) });
+    }
+    query.prepare("INSERT INTO Transfer.metadata(name, value) VALUES(?, ?)");
+    for(const QPair<QString, QString>& entry: metadata) {
+        query.bindValue(0, entry.first);
+        query.bindValue(1, entry.second);
+        query.exec();
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Tile sets are exported to and imported from a database attached to the worker connection as "Transfer". Tiles
+//  move between the two in INSERT ... SELECT statements, so no tile passes through Qt.
+bool
+QGCCacheWorker::_attachTransfer(const QString& path)
+{
+    QSqlQuery query(*_db);
+    query.prepare("ATTACH DATABASE ? AS Transfer");
+    query.addBindValue(path);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (attach transfer database):" << query.lastError().text();
+        return false;
+    }
+    if(!query.exec(kCreateTransferTilesTable)) {
+        qWarning() << "Map Cache SQL error (create TransferTiles):" << query.lastError().text();
+        query.exec("DETACH DATABASE Transfer");
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_detachTransfer()
+{
+    QSqlQuery query(*_db);
+    query.exec("DROP TABLE IF EXISTS TransferTiles");
+    if(!query.exec("DETACH DATABASE Transfer")) {
+        qWarning() << "Map Cache SQL error (detach transfer database):" << query.lastError().text();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_clearTransferTiles()
+{
+    QSqlQuery query(*_db);
+    query.exec("DELETE FROM TransferTiles");
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_transferHasTable(const QString& name)
+{
+    QSqlQuery query(*_db);
+    query.prepare("SELECT 1 FROM Transfer.sqlite_master WHERE type IN ('table', 'view') AND name = ? COLLATE NOCASE");
+    query.addBindValue(name);
+    return query.exec() && query.next();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_transferHasColumn(const QString& table, const QString& column)
+{
+    QSqlQuery query(*_db);
+    if(query.exec(QString("PRAGMA Transfer.table_info(%1)").arg(table))) {
+        while(query.next()) {
+            if(query.value("name").toString() == column) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//  Staged tiles are transferred in key order, TRANSFER_BATCH_MAX at a time. Gives the last key of the batch after
+//  the given key, false once none are left.
+bool
+QGCCacheWorker::_nextTransferBatch(quint64 after, quint64& last)
+{
+    QSqlQuery query(*_db);
+    query.prepare("SELECT COALESCE("
+                  "(SELECT tileKey FROM TransferTiles WHERE tileKey > :after ORDER BY tileKey LIMIT 1 OFFSET :offset), "
+                  "(SELECT MAX(tileKey) FROM TransferTiles WHERE tileKey > :after))");
+    query.bindValue(":after", static_cast<qint64>(after));
+    query.bindValue(":offset", TRANSFER_BATCH_MAX - 1);
+    if(!query.exec() || !query.next() || query.value(0).isNull()) {
+        return false;
+    }
+    last = query.value(0).toULongLong();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Runs the statements over a batch of staged tiles in one transaction. Each selects the batch with
+//  "I.tileKey > :first AND I.tileKey <= :last". Returns the rows the first one wrote, -1 on error.
+qint64
+QGCCacheWorker::_runTransferBatch(const QList<QSqlQuery*>& statements, quint64 first, quint64 last)
+{
+    if(!_db->transaction()) {
+        qWarning() << "Map Cache SQL error (transfer transaction):" << _db->lastError().text();
+        return -1;
+    }
+    qint64 written = 0;
+    for(int i = 0; i < statements.count(); i++) {
+        QSqlQuery* query = statements[i];
+        query->bindValue(":first", static_cast<qint64>(first));
+        query->bindValue(":last", static_cast<qint64>(last));
+        if(!query->exec()) {
+            qWarning() << "Map Cache SQL error (transfer tiles):" << query->lastError().text();
+            _db->rollback();
+            return -1;
+        }
+        if(!i) {
+            written = query->numRowsAffected();
+        }
+    }
+    if(!_db->commit()) {
+        qWarning() << "Map Cache SQL error (commit transfer):" << _db->lastError().text();
+        _db->rollback();
+        return -1;
+    }
+    return written;
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCacheWorker::_uniqueTileSetName(const QString& name)
+{
+    quint64 setID = 0;
+    if(!_findTileSetID(name, setID)) {
+        return name;
+    }
+    int testCount = 0;
+    //-- Set with this name already exists. Make name unique.
+    while (true) {
+        auto testName = QString::asprintf("%s %02d", name.toLatin1().data(), ++testCount);
+        if(!_findTileSetID(testName, setID) || testCount > 99) {
+            return testName;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_insertTileSet(const QString& name, const QString& mapType, double topleftLat, double topleftLon, double bottomRightLat, double bottomRightLon, int minZoom, int maxZoom, int type, quint32 numTiles, quint64& setID)
+{
+    QSqlQuery cQuery(*_db);
+    cQuery.prepare("INSERT INTO TileSets("
+        "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+        ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    cQuery.addBindValue(name);
+    cQuery.addBindValue(mapType);
+    cQuery.addBindValue(topleftLat);
+    cQuery.addBindValue(topleftLon);
+    cQuery.addBindValue(bottomRightLat);
+    cQuery.addBindValue(bottomRightLon);
+    cQuery.addBindValue(minZoom);
+    cQuery.addBindValue(maxZoom);
+    cQuery.addBindValue(type);
+    cQuery.addBindValue(numTiles);
+    cQuery.addBindValue(0);
+    cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
+    if(!cQuery.exec()) {
+        qWarning() << "Map Cache SQL error (add tile set):" << cQuery.lastError().text();
+        return false;
+    }
+    //-- Get just created (auto-incremented) setID
+    setID = cQuery.lastInsertId().toULongLong();
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 bool QGCCacheWorker::_testTask(QGCMapTask* mtask)
 {
@@ -1019,22 +1978,14 @@ QGCCacheWorker::_init()
     _failed = false;
     if(!_databasePath.isEmpty()) {
         qCDebug(QGCTileCacheLog) << "Mapping cache directory:" << _databasePath;
-        //-- Initialize Database
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-        _db->setDatabaseName(_databasePath);
-        _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (_db->open()) {
-            _valid = _createDB(_db);
-            if(!_valid) {
-                _failed = true;
+        _initDB();
+        //-- A cache which could not be migrated is moved aside and a new one is started in its place
+        if(_migrationFailed) {
+            _migrationFailed = false;
+            if(_backupDB()) {
+                _initDB();
             }
-        } else {
-            qCritical() << "Map Cache SQL error (init() open db):" << _db->lastError();
-            _failed = true;
         }
-        delete _db;
-        _db = nullptr;
-        QSqlDatabase::removeDatabase(kSession);
     } else {
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
@@ -1043,23 +1994,208 @@ QGCCacheWorker::_init()
     return _failed;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_initDB()
+{
+    _failed = false;
+    //-- Initialize Database
+    _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+    _db->setDatabaseName(_databasePath);
+    _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+    if (_db->open()) {
+        _valid = _createDB(_db);
+        if(!_valid) {
+            _failed = true;
+        }
+    } else {
+        qCritical() << "Map Cache SQL error (init() open db):" << _db->lastError();
+        _failed = true;
+    }
+    delete _db;
+    _db = nullptr;
+    QSqlDatabase::removeDatabase(kSession);
+}
+
+//-----------------------------------------------------------------------------
+//  Keeps a cache which could not be migrated next to the new one, so its tiles and offline sets are not lost
+bool
+QGCCacheWorker::_backupDB()
+{
+    QString backupPath = QString("%1.%2.bak").arg(_databasePath).arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    if(!QFile::rename(_databasePath, backupPath)) {
+        qCritical() << "Map cache could not be migrated or moved aside, map caching is disabled:" << _databasePath;
+        return false;
+    }
+    qCritical() << "Map cache could not be migrated, it was kept as" << backupPath << "and a new cache was started";
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Maps provider ids to their tile key index, for converting text hashes to tile keys in SQL
+bool
+QGCCacheWorker::_createTileKeyProviders(QSqlDatabase* db)
+{
+    QSqlQuery query(*db);
+    if(!query.exec("CREATE TEMP TABLE IF NOT EXISTS TileKeyProviders (mapId INTEGER PRIMARY KEY NOT NULL, keyIndex INTEGER)")) {
+        qWarning() << "Map Cache SQL error (create TileKeyProviders):" << query.lastError().text();
+        return false;
+    }
+    query.exec("DELETE FROM TileKeyProviders");
+    UrlFactory* urlFactory = getQGCMapEngine()->urlFactory();
+    query.prepare("INSERT OR IGNORE INTO TileKeyProviders(mapId, keyIndex) VALUES(?, ?)");
+    for(int i = 1; i < urlFactory->getTileKeyIndexCount(); i++) {
+        query.bindValue(0, urlFactory->getIdFromTileKeyIndex(i));
+        query.bindValue(1, i);
+        if(!query.exec()) {
+            qWarning() << "Map Cache SQL error (fill TileKeyProviders):" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Caches created before tiles had integer keys have an autoincrement tileID and a text hash. Tiles are rewritten
+//  with their tile key as tileID, set membership and pending downloads are converted to match. Tiles of providers
+//  without a tile key index are dropped, their number is logged.
+bool
+QGCCacheWorker::_migrateTileKeys(QSqlDatabase* db)
+{
+    bool tilesHaveHash      = db->record("Tiles").contains("hash");
+    bool downloadsHaveHash  = db->record("TilesDownload").contains("hash");
+    if(!tilesHaveHash && !downloadsHaveHash) {
+        return true;
+    }
+    qCDebug(QGCTileCacheLog) << "Migrating map cache to integer tile keys";
+    QElapsedTimer timer;
+    timer.start();
+    QSqlQuery query(*db);
+    if(!_createTileKeyProviders(db) || !db->transaction()) {
+        return false;
+    }
+    QStringList statements;
+    if(tilesHaveHash) {
+        statements << "CREATE TEMP TABLE TileKeyMap (oldID INTEGER PRIMARY KEY NOT NULL, tileKey INTEGER NOT NULL, mapId INTEGER)"
+                   << QString("INSERT INTO TileKeyMap(oldID, tileKey, mapId) SELECT T.tileID, %1, P.mapId FROM Tiles T JOIN TileKeyProviders P ON P.mapId = CAST(substr(T.hash, 1, 10) AS INTEGER) WHERE %2")
+                        .arg(_hashToTileKeySql("T")).arg(_hashInKeyRangeSql("T"))
+                   << "ALTER TABLE Tiles RENAME TO TilesOld"
+                   << kCreateTilesTable
+                   << "INSERT OR IGNORE INTO Tiles(tileID, format, tile, size, type, date) SELECT M.tileKey, O.format, O.tile, O.size, M.mapId, O.date FROM TilesOld O JOIN TileKeyMap M ON M.oldID = O.tileID"
+                   << "DROP TABLE TilesOld"
+                   << "UPDATE SetTiles SET tileID = (SELECT tileKey FROM TileKeyMap WHERE oldID = SetTiles.tileID)"
+                   << "DELETE FROM SetTiles WHERE tileID IS NULL";
+    }
+    if(downloadsHaveHash) {
+        statements << "ALTER TABLE TilesDownload RENAME TO TilesDownloadOld"
+                   << kCreateTilesDownloadTable
+                   << QString("INSERT OR IGNORE INTO TilesDownload(setID, tileKey, type, x, y, z, state) SELECT O.setID, (P.keyIndex << %1) | (O.z << %2) | (O.x << %3) | O.y, O.type, O.x, O.y, O.z, O.state FROM TilesDownloadOld O JOIN TileKeyProviders P ON P.mapId = O.type")
+                        .arg(TILE_KEY_PROVIDER_SHIFT).arg(TILE_KEY_ZOOM_SHIFT).arg(TILE_KEY_X_SHIFT)
+                   << "DROP TABLE TilesDownloadOld";
+    }
+    qint64 oldTileCount     = tilesHaveHash     ? _rowCount(db, "Tiles")          : 0;
+    qint64 oldDownloadCount = downloadsHaveHash ? _rowCount(db, "TilesDownload")  : 0;
+    for(const QString& statement: statements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (migrate tile keys):" << query.lastError().text();
+            db->rollback();
+            return false;
+        }
+    }
+    qint64 droppedTiles     = tilesHaveHash     ? oldTileCount - _rowCount(db, "TileKeyMap")          : 0;
+    qint64 droppedDownloads = downloadsHaveHash ? oldDownloadCount - _rowCount(db, "TilesDownload")   : 0;
+    if(tilesHaveHash && !query.exec("DROP TABLE TileKeyMap")) {
+        qWarning() << "Map Cache SQL error (migrate tile keys):" << query.lastError().text();
+        db->rollback();
+        return false;
+    }
+    if(!db->commit()) {
+        qWarning() << "Map Cache SQL error (commit tile key migration):" << db->lastError().text();
+        db->rollback();
+        return false;
+    }
+    if(droppedTiles > 0 || droppedDownloads > 0) {
+        qWarning() << "Map cache migration dropped" << droppedTiles << "tiles and" << droppedDownloads << "pending downloads which could not be mapped to a tile key";
+    }
+    qCDebug(QGCTileCacheLog) << "Map cache migrated to integer tile keys in" << timer.elapsed() << "ms";
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+qint64
+QGCCacheWorker::_rowCount(QSqlDatabase* db, const QString& table)
+{
+    QSqlQuery query(*db);
+    if(query.exec(QString("SELECT COUNT(*) FROM %1").arg(table)) && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_createStats(QSqlDatabase* db)
+{
+    QSqlQuery query(*db);
+    for(const char* statement: kCreateStatsStatements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (create stats):" << query.lastError().text();
+            return false;
+        }
+    }
+    //-- The row is created along with the totals
+    if(query.exec("SELECT id FROM CacheStats WHERE id = 0") && query.next()) {
+        return true;
+    }
+    qCDebug(QGCTileCacheLog) << "Computing map cache totals";
+    db->transaction();
+    for(const char* statement: kRebuildStatsStatements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (compute stats):" << query.lastError().text();
+            db->rollback();
+            return false;
+        }
+    }
+    return db->commit();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_createTileImages(QSqlDatabase* db)
+{
+    QSqlQuery query(*db);
+    //-- Caches created before images were shared
+    if(!db->record("Tiles").contains("imageID") && !query.exec("ALTER TABLE Tiles ADD COLUMN imageID INTEGER")) {
+        qWarning() << "Map Cache SQL error (add Tiles imageID):" << query.lastError().text();
+        return false;
+    }
+    for(const char* statement: kCreateTileImagesStatements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (create TileImages):" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
 {
     bool res = false;
     QSqlQuery query(*db);
-    if(!query.exec(
-        "CREATE TABLE IF NOT EXISTS Tiles ("
-        "tileID INTEGER PRIMARY KEY NOT NULL, "
-        "hash TEXT NOT NULL UNIQUE, "
-        "format TEXT NOT NULL, "
-        "tile BLOB NULL, "
-        "size INTEGER, "
-        "type INTEGER, "
-        "date INTEGER DEFAULT 0)"))
-    {
+    if(!_migrateTileKeys(db)) {
+        //-- The migration was rolled back, the database still holds the user's tiles and offline sets so it is not removed
+        qWarning() << "Map Cache SQL error (migrate tile keys)";
+        _migrationFailed = true;
+        return false;
+    }
+    if(!query.exec(kCreateTilesTable)) {
         qWarning() << "Map Cache SQL error (create Tiles db):" << query.lastError().text();
+    } else if(!query.exec(kCreateTilesDateIndex)) {
+        qWarning() << "Map Cache SQL error (create Tiles date index):" << query.lastError().text();
+    } else if(!_createTileImages(db)) {
+        qWarning() << "Map Cache SQL error (create TileImages)";
     } else {
         if(!query.exec(
             "CREATE TABLE IF NOT EXISTS TileSets ("
@@ -1086,18 +2222,9 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
             {
                 qWarning() << "Map Cache SQL error (create SetTiles db):" << query.lastError().text();
             } else {
-                if(!query.exec(
-                    "CREATE TABLE IF NOT EXISTS TilesDownload ("
-                    "setID INTEGER, "
-                    "hash TEXT NOT NULL UNIQUE, "
-                    "type INTEGER, "
-                    "x INTEGER, "
-                    "y INTEGER, "
-                    "z INTEGER, "
-                    "state INTEGER DEFAULT 0)"))
-                {
+                if(!query.exec(kCreateTilesDownloadTable)) {
                     qWarning() << "Map Cache SQL error (create TilesDownload db):" << query.lastError().text();
-                } else {
+                } else if(_createStats(db)) {
                     //-- Database it ready for use
                     res = true;
                 }
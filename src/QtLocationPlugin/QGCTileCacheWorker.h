@@ -25,15 +25,20 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <QMutexLocker>
+#include <QSet>
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
 #include <QHostInfo>
 
 #include "QGCLoggingCategory.h"
+#include "QGCTileCacheReader.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheLog)
 
 class QGCMapTask;
 class QGCCachedTileSet;
+class QGCExportTileTask;
+class QGCImportTileTask;
 
 //-----------------------------------------------------------------------------
 class QGCCacheWorker : public QThread
@@ -46,6 +51,9 @@ public:
     void    quit            ();
     bool    enqueueTask     (QGCMapTask* task);
     void    setDatabaseFile (const QString& path);
+    void    setMaxDiskCache (quint64 size);     ///< Bytes, the default set is trimmed to it while idle. 0 disables it.
+
+    QGCTileCacheReaderPool::Latency_t tileFetchLatency() { return _readerPool.fetchLatency(); }
 
 protected:
     void    run             ();
@@ -55,7 +63,7 @@ private slots:
 
 private:
     void        _saveTile               (QGCMapTask* mtask);
-    void        _getTile                (QGCMapTask* mtask);
+    void        _runWriteBatch          (QGCMapTask* mtask);
     void        _getTileSets            (QGCMapTask* mtask);
     void        _createTileSet          (QGCMapTask* mtask);
     void        _getTileDownloadList    (QGCMapTask* mtask);
@@ -64,34 +72,79 @@ private:
     void        _renameTileSet          (QGCMapTask* mtask);
     void        _resetCacheDatabase     (QGCMapTask* mtask);
     void        _pruneCache             (QGCMapTask* mtask);
+    bool        _runIdleWork            ();
+    void        _wakeForIdleWork        ();
+    bool        _isQuitting             ();
+    bool        _storeAccessTimes       ();
+    quint64     _evictTiles             (quint64 amount);
     void        _exportSets             (QGCMapTask* mtask);
+    bool        _exportQGCSets          (QGCExportTileTask* task);
+    bool        _exportMBTiles          (QGCExportTileTask* task);
     void        _importSets             (QGCMapTask* mtask);
+    void        _deduplicateTiles       (QGCMapTask* mtask);
+    quint64     _storeTileImage         (const QByteArray& image);
+    void        _importQGCSets          (QGCImportTileTask* task);
+    void        _importMBTiles          (QGCImportTileTask* task);
+    bool        _attachTransfer         (const QString& path);
+    void        _detachTransfer         ();
+    void        _clearTransferTiles     ();
+    bool        _transferHasTable       (const QString& name);
+    bool        _transferHasColumn      (const QString& table, const QString& column);
+    bool        _nextTransferBatch      (quint64 after, quint64& last);
+    qint64      _runTransferBatch       (const QList<QSqlQuery*>& statements, quint64 first, quint64 last);
+    QString     _uniqueTileSetName      (const QString& name);
+    bool        _insertTileSet          (const QString& name, const QString& mapType, double topleftLat, double topleftLon, double bottomRightLat, double bottomRightLon, int minZoom, int maxZoom, int type, quint32 numTiles, quint64& setID);
     bool        _testTask               (QGCMapTask* mtask);
     void        _testInternet           ();
     void        _deleteBingNoTileTiles  ();
 
-    quint64     _findTile               (const QString hash);
+    bool        _findTile               (quint64 key);
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
     bool        _init                   ();
+    void        _initDB                 ();
+    bool        _backupDB               ();
+    bool        _connectDB              ();
+    void        _disconnectDB           ();
     bool        _createDB               (QSqlDatabase *db, bool createDefault = true);
+    bool        _resetDB                ();
+    bool        _migrateTileKeys        (QSqlDatabase *db);
+    qint64      _rowCount               (QSqlDatabase *db, const QString& table);
+    bool        _createStats            (QSqlDatabase *db);
+    bool        _createTileImages       (QSqlDatabase *db);
+    bool        _createTileKeyProviders (QSqlDatabase *db);
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
     void        _deleteTileSet          (qulonglong id);
 
+    //-- Layout of a database tile sets are imported from
+    enum TransferFormat {
+        TransferUnknown,
+        TransferQGC,
+        TransferMBTiles
+    };
+
 signals:
     void        updateTotals            (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void        internetStatus          (bool active);
 
 private:
     QQueue<QGCMapTask*>     _taskQueue;
+    QGCTileCacheReaderPool  _readerPool;
     QMutex                  _mutex;
     QMutex                  _waitmutex;
     QWaitCondition          _waitc;
     QString                 _databasePath;
     QSqlDatabase*           _db;
+    QSqlQuery*              _insertTileQuery        = nullptr;  ///< Statements used for every tile, prepared once per connection
+    QSqlQuery*              _insertSetTileQuery     = nullptr;
+    QSqlQuery*              _deleteDownloadQuery    = nullptr;
+    QSqlQuery*              _findImageQuery         = nullptr;
+    QSqlQuery*              _insertImageQuery       = nullptr;
+    QSqlQuery*              _deleteUnusedImageQuery = nullptr;
     bool                    _valid;
     bool                    _failed;
+    bool                    _migrationFailed        = false;    ///< Set by _createDB when an old cache could not be migrated, the file is left as is
     quint64                 _defaultSet;
     quint64                 _totalSize;
     quint32                 _totalCount;
@@ -100,6 +153,10 @@ private:
     time_t                  _lastUpdate;
     int                     _updateTimeout;
     int                     _hostLookupID;
+    quint64                 _maxDiskCache;
+    bool                    _evicting;
+    quint64                 _evictDate;                         ///< Tiles older than this were passed over by the current eviction run
+    bool                    _quitting;
 };
 
 #endif // QGC_TILE_CACHE_WORKER_H
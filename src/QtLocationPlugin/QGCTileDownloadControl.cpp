@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Download Control
+ *
+ */
+
+#include "QGCTileDownloadControl.h"
+
+//-- Concurrency grows while the smoothed latency is under this many times the lowest one, shrinks above the other
+#define LATENCY_GROW_FACTOR     2.0
+#define LATENCY_SHRINK_FACTOR   4.0
+//-- Latencies under this are treated as equal, so a fast local server does not look congested
+#define LATENCY_FLOOR_MSECS     20
+#define LATENCY_SMOOTHING       0.2
+
+#define BACKOFF_MIN_MSECS       1000
+#define BACKOFF_MAX_MSECS       60000
+
+#define RATE_WINDOW_MSECS       5000
+
+//-----------------------------------------------------------------------------
+QGCTileDownloadControl::QGCTileDownloadControl(int initialConcurrency, int maxConcurrency)
+    : _initialConcurrency(qMax(1, initialConcurrency))
+    , _maxConcurrency(qMax(_initialConcurrency, maxConcurrency))
+{
+    reset(0);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadControl::reset(qint64 nowMsecs)
+{
+    _concurrency    = _initialConcurrency;
+    _roundReplies   = 0;
+    _minLatency     = -1;
+    _avgLatency     = -1;
+    _backoff        = 0;
+    _resumeAt       = 0;
+    _startMsecs     = nowMsecs;
+    _replyTimes.clear();
+}
+
+//-----------------------------------------------------------------------------
+qint64
+QGCTileDownloadControl::backoffMsecs(qint64 nowMsecs) const
+{
+    return qMax(static_cast<qint64>(0), _resumeAt - nowMsecs);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadControl::replySucceeded(qint64 latencyMsecs, qint64 nowMsecs)
+{
+    _replyTimes.enqueue(nowMsecs);
+    _pruneReplies(nowMsecs);
+    latencyMsecs = qMax(latencyMsecs, static_cast<qint64>(LATENCY_FLOOR_MSECS));
+    if(_minLatency < 0) {
+        _minLatency = latencyMsecs;
+        _avgLatency = latencyMsecs;
+    } else {
+        _minLatency = qMin(_minLatency, latencyMsecs);
+        _avgLatency += LATENCY_SMOOTHING * (latencyMsecs - _avgLatency);
+    }
+    //-- One change per round, so each one is judged on replies to requests sent after it
+    if(++_roundReplies < _concurrency) {
+        return;
+    }
+    _roundReplies = 0;
+    //-- A full round without throttling
+    _backoff = 0;
+    if(_avgLatency > _minLatency * LATENCY_SHRINK_FACTOR) {
+        _concurrency = qMax(1, _concurrency - 1);
+    } else if(_avgLatency <= _minLatency * LATENCY_GROW_FACTOR) {
+        _concurrency = qMin(_maxConcurrency, _concurrency + 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadControl::replyThrottled(qint64 retryAfterMsecs, qint64 nowMsecs)
+{
+    //-- Replies to requests sent before backing off don't count again
+    if(nowMsecs < _resumeAt) {
+        return;
+    }
+    if(retryAfterMsecs > 0) {
+        _backoff = qMin(retryAfterMsecs, static_cast<qint64>(BACKOFF_MAX_MSECS));
+    } else {
+        _backoff = _backoff ? qMin(_backoff * 2, static_cast<qint64>(BACKOFF_MAX_MSECS)) : BACKOFF_MIN_MSECS;
+    }
+    _resumeAt       = nowMsecs + _backoff;
+    _concurrency    = qMax(1, _concurrency / 2);
+    _roundReplies   = 0;
+}
+
+//-----------------------------------------------------------------------------
+double
+QGCTileDownloadControl::tilesPerSecond(qint64 nowMsecs)
+{
+    _pruneReplies(nowMsecs);
+    qint64 window = qMin(static_cast<qint64>(RATE_WINDOW_MSECS), nowMsecs - _startMsecs);
+    return window > 0 ? _replyTimes.count() * 1000.0 / window : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadControl::_pruneReplies(qint64 nowMsecs)
+{
+    while(_replyTimes.count() && _replyTimes.head() <= nowMsecs - RATE_WINDOW_MSECS) {
+        _replyTimes.dequeue();
+    }
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Download Control
+ *
+ *   Decides how many tile requests a tile set download keeps in flight. Concurrency grows by one after each round of
+ *   replies while their latency stays close to the lowest seen, and shrinks by one when it climbs well above it.
+ *   A throttled reply (HTTP 429 or 503) halves it and holds new requests back, for the time the server asks for or
+ *   with an exponential backoff.
+ *
+ *   Times are passed in by the caller, in msecs from any fixed origin.
+ *
+ */
+
+#ifndef QGC_TILE_DOWNLOAD_CONTROL_H
+#define QGC_TILE_DOWNLOAD_CONTROL_H
+
+#include <QtGlobal>
+#include <QQueue>
+
+//-----------------------------------------------------------------------------
+class QGCTileDownloadControl
+{
+public:
+    QGCTileDownloadControl  (int initialConcurrency, int maxConcurrency);
+
+    void    reset           (qint64 nowMsecs);
+    int     concurrency     () const { return _concurrency; }
+
+    //-- Time until new requests may be sent, 0 unless backing off
+    qint64  backoffMsecs    (qint64 nowMsecs) const;
+
+    void    replySucceeded  (qint64 latencyMsecs, qint64 nowMsecs);
+    //-- retryAfterMsecs is from the Retry-After header of the reply, 0 if it had none
+    void    replyThrottled  (qint64 retryAfterMsecs, qint64 nowMsecs);
+
+    //-- Successful replies per second, over the last few seconds
+    double  tilesPerSecond  (qint64 nowMsecs);
+
+private:
+    void    _pruneReplies   (qint64 nowMsecs);
+
+    int             _initialConcurrency;
+    int             _maxConcurrency;
+    int             _concurrency;
+    int             _roundReplies;      ///< Successful replies since concurrency last changed
+    qint64          _minLatency;        ///< Lowest latency seen, -1 until the first reply
+    double          _avgLatency;        ///< Smoothed latency, -1 until the first reply
+    qint64          _backoff;           ///< Current backoff, 0 when not throttled
+    qint64          _resumeAt;          ///< Requests are held back until then
+    qint64          _startMsecs;
+    QQueue<qint64>  _replyTimes;        ///< Successful replies within the rate window
+};
+
+#endif // QGC_TILE_DOWNLOAD_CONTROL_H
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileDownloadControlTest.h"
+#include "QGCTileDownloadControl.h"
+
+qint64 QGCTileDownloadControlTest::_replyRound(QGCTileDownloadControl& control, qint64 latencyMsecs, qint64 nowMsecs)
+{
+    int replies = control.concurrency();
+
+    for (int i=0; i<replies; i++) {
+        nowMsecs += 10;
+        control.replySucceeded(latencyMsecs, nowMsecs);
+    }
+    return nowMsecs;
+}
+
+void QGCTileDownloadControlTest::_testGrow(void)
+{
+    QGCTileDownloadControl  control(4, 6);
+    qint64                  now = 0;
+
+    QCOMPARE(control.concurrency(), 4);
+
+    // Steady latency grows concurrency by one per round, up to the maximum
+    now = _replyRound(control, 100, now);
+    QCOMPARE(control.concurrency(), 5);
+    now = _replyRound(control, 100, now);
+    QCOMPARE(control.concurrency(), 6);
+    now = _replyRound(control, 100, now);
+    QCOMPARE(control.concurrency(), 6);
+
+    // Part of a round changes nothing
+    control.replySucceeded(100, now + 10);
+    QCOMPARE(control.concurrency(), 6);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(0));
+}
+
+void QGCTileDownloadControlTest::_testShrinkOnLatency(void)
+{
+    QGCTileDownloadControl  control(8, 16);
+    qint64                  now = 0;
+
+    now = _replyRound(control, 100, now);
+    QCOMPARE(control.concurrency(), 9);
+
+    // Latency well above the lowest one means the server or link is saturated
+    for (int i=0; i<5; i++) {
+        now = _replyRound(control, 2000, now);
+    }
+    QVERIFY(control.concurrency() < 9);
+    QVERIFY(control.concurrency() >= 1);
+}
+
+void QGCTileDownloadControlTest::_testThrottle(void)
+{
+    QGCTileDownloadControl  control(8, 16);
+    qint64                  now = 1000;
+
+    // First throttle halves concurrency and backs off for the minimum time
+    control.replyThrottled(0, now);
+    QCOMPARE(control.concurrency(), 4);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(1000));
+    QCOMPARE(control.backoffMsecs(now + 400), Q_INT64_C(600));
+
+    // Throttled replies to requests sent before backing off don't count again
+    control.replyThrottled(0, now + 500);
+    QCOMPARE(control.concurrency(), 4);
+    QCOMPARE(control.backoffMsecs(now + 500), Q_INT64_C(500));
+
+    // Throttled again after resuming, the backoff doubles
+    now += 1000;
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(0));
+    control.replyThrottled(0, now);
+    QCOMPARE(control.concurrency(), 2);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(2000));
+
+    // It is capped and concurrency never drops below one
+    for (int i=0; i<10; i++) {
+        now += control.backoffMsecs(now);
+        control.replyThrottled(0, now);
+    }
+    QCOMPARE(control.concurrency(), 1);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(60000));
+
+    // A full round without throttling resets the backoff
+    now += control.backoffMsecs(now);
+    now = _replyRound(control, 100, now);
+    control.replyThrottled(0, now);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(1000));
+}
+
+void QGCTileDownloadControlTest::_testRetryAfter(void)
+{
+    QGCTileDownloadControl  control(8, 16);
+    qint64                  now = 0;
+
+    // The time the server asks for is used as is
+    control.replyThrottled(5000, now);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(5000));
+    QCOMPARE(control.concurrency(), 4);
+
+    // Within limits
+    now += 5000;
+    control.replyThrottled(3600 * 1000, now);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(60000));
+
+    // reset starts over
+    control.reset(now);
+    QCOMPARE(control.concurrency(), 8);
+    QCOMPARE(control.backoffMsecs(now), Q_INT64_C(0));
+}
+
+void QGCTileDownloadControlTest::_testTilesPerSecond(void)
+{
+    QGCTileDownloadControl control(4, 4);
+
+    QCOMPARE(control.tilesPerSecond(0), 0.0);
+
+    // 20 tiles per second for 10 seconds
+    for (qint64 now=50; now<=10000; now+=50) {
+        control.replySucceeded(100, now);
+    }
+    QCOMPARE(control.tilesPerSecond(10000), 20.0);
+
+    // Only the last few seconds count, an early start period is averaged over the time elapsed
+    QCOMPARE(control.tilesPerSecond(20000), 0.0);
+    control.reset(20000);
+    control.replySucceeded(100, 20500);
+    control.replySucceeded(100, 21000);
+    QCOMPARE(control.tilesPerSecond(21000), 2.0);
+}
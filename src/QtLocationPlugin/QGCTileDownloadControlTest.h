@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCTileDownloadControl;
+
+class QGCTileDownloadControlTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testGrow(void);
+    void _testShrinkOnLatency(void);
+    void _testThrottle(void);
+    void _testRetryAfter(void);
+    void _testTilesPerSecond(void);
+
+private:
+    /// Completes a full round of replies at the current concurrency
+    /// @return Time after the round
+    qint64 _replyRound(QGCTileDownloadControl& control, qint64 latencyMsecs, qint64 nowMsecs);
+};
@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Memory Cache
+ *
+ */
+
+#include "QGCTileMemoryCache.h"
+#include "QGCTileCacheWorker.h"
+
+#include <QMutexLocker>
+
+#include <climits>
+
+const int QGCTileMemoryCache::_shardCount;
+
+//-- Hit rate is logged after this many lookups
+#define STATS_LOG_COUNT     1000
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::QGCTileMemoryCache()
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::setMaxBytes(quint64 maxBytes)
+{
+    _maxBytes = maxBytes;
+    //-- QCache costs are ints
+    int shardBytes = static_cast<int>(qMin(maxBytes / _shardCount, static_cast<quint64>(INT_MAX)));
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.setMaxCost(shardBytes);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::Shard_t&
+QGCTileMemoryCache::_shard(quint64 key)
+{
+    //-- Neighbouring tiles differ in the low bits of x and y, mix both in
+    return _shards[(key ^ (key >> 24)) % _shardCount];
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileMemoryCache::find(quint64 key, QByteArray& image, QString& format)
+{
+    Shard_t&    shard   = _shard(key);
+    bool        found   = false;
+    quint64     lookups;
+    {
+        QMutexLocker lock(&shard.mutex);
+        //-- QCache::object moves the tile to the front of the LRU order
+        Tile_t* tile = key ? shard.tiles.object(key) : nullptr;
+        if(tile) {
+            //-- Implicitly shared, no copy of the image data
+            image   = tile->image;
+            format  = tile->format;
+            found   = true;
+            shard.hits++;
+        } else {
+            shard.misses++;
+        }
+        lookups = shard.hits + shard.misses;
+    }
+    if(lookups % (STATS_LOG_COUNT / _shardCount) == 0 && QGCTileCacheLog().isDebugEnabled()) {
+        _logStats();
+    }
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::insert(quint64 key, const QByteArray& image, const QString& format)
+{
+    if(!key || image.isEmpty()) {
+        return;
+    }
+    Shard_t& shard = _shard(key);
+    QMutexLocker lock(&shard.mutex);
+    //-- Tiles larger than the shard are dropped by QCache
+    shard.tiles.insert(key, new Tile_t{ image, format }, image.size());
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::clear()
+{
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::Stats_t
+QGCTileMemoryCache::stats()
+{
+    Stats_t stats = { 0, 0, 0, 0, _maxBytes };
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        stats.hits      += shard.hits;
+        stats.misses    += shard.misses;
+        stats.tiles     += static_cast<quint64>(shard.tiles.count());
+        stats.bytes     += static_cast<quint64>(shard.tiles.totalCost());
+    }
+    return stats;
+}
+
+//-----------------------------------------------------------------------------
+double
+QGCTileMemoryCache::hitRate(const Stats_t& stats)
+{
+    quint64 lookups = stats.hits + stats.misses;
+    return lookups ? static_cast<double>(stats.hits) / lookups : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::_logStats()
+{
+    Stats_t s = stats();
+    qCDebug(QGCTileCacheLog) << "Tile memory cache hits:" << s.hits << "misses:" << s.misses
+                             << "hit rate:" << hitRate(s) << "tiles:" << s.tiles
+                             << "KB:" << s.bytes / 1024 << "of" << s.maxBytes / 1024;
+}
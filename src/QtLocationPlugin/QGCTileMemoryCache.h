@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Memory Cache
+ *
+ *   Recently served map tiles, keyed by tile key and bounded by the total size of the tile images. Hits are answered
+ *   synchronously by the caller, without a round trip through the cache reader threads and the database. The cache
+ *   is split in shards, each with its own lock and LRU order, so lookups from different threads rarely contend.
+ *
+ *   Images are kept encoded, as stored in the database. QtLocation keeps its own cache of decoded textures.
+ *
+ */
+
+#ifndef QGC_TILE_MEMORY_CACHE_H
+#define QGC_TILE_MEMORY_CACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+//-----------------------------------------------------------------------------
+class QGCTileMemoryCache
+{
+public:
+    typedef struct {
+        quint64 hits;
+        quint64 misses;
+        quint64 tiles;          ///< Tiles currently held
+        quint64 bytes;          ///< Size of the images currently held
+        quint64 maxBytes;
+    } Stats_t;
+
+    QGCTileMemoryCache  ();
+
+    void        setMaxBytes (quint64 maxBytes);
+    bool        find        (quint64 key, QByteArray& image, QString& format);
+    void        insert      (quint64 key, const QByteArray& image, const QString& format);
+    void        clear       ();
+    Stats_t     stats       ();
+
+    //-- Fraction of lookups which were hits, 0 if there were none
+    static double hitRate   (const Stats_t& stats);
+
+private:
+    typedef struct {
+        QByteArray  image;
+        QString     format;
+    } Tile_t;
+
+    typedef struct {
+        QMutex                  mutex;
+        QCache<quint64, Tile_t> tiles;      ///< Cost is the image size
+        quint64                 hits    = 0;
+        quint64                 misses  = 0;
+    } Shard_t;
+
+    static const int _shardCount = 8;
+
+    Shard_t&    _shard      (quint64 key);
+    void        _logStats   ();
+
+    Shard_t     _shards[_shardCount];
+    quint64     _maxBytes   = 0;
+};
+
+#endif // QGC_TILE_MEMORY_CACHE_H
@@ -0,0 +1,316 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Prefetcher
+ *
+ */
+
+#include "QGCTilePrefetcher.h"
+#include "QGCMapEngine.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QtMath>
+
+QGC_LOGGING_CATEGORY(QGCTilePrefetcherLog, "QGCTilePrefetcherLog")
+
+//-- Rate limit: at most this many tiles started per interval, with at most this many lookups and downloads in flight
+#define PREFETCH_INTERVAL_MSECS     250
+#define PREFETCH_PER_INTERVAL       2
+#define PREFETCH_MAX_IN_FLIGHT      4
+#define PREFETCH_MAX_QUEUED         4000
+
+//-- Tiles on each side of the path
+#define CORRIDOR_RADIUS             1
+
+//-- The vehicle corridor covers where it will be in this long, within the distance limits
+#define LOOKAHEAD_SECS              90
+#define LOOKAHEAD_MIN_METERS        300.0
+#define LOOKAHEAD_MAX_METERS        5000.0
+#define LOOKAHEAD_MIN_SPEED         1.0
+#define VEHICLE_UPDATE_MSECS        1000
+
+//-----------------------------------------------------------------------------
+QGCTilePrefetcher::QGCTilePrefetcher(QObject* parent)
+    : QObject(parent)
+    , _enabled(true)
+    , _zoom(0)
+    , _networkManager(nullptr)
+{
+    _timer.setInterval(PREFETCH_INTERVAL_MSECS);
+    connect(&_timer, &QTimer::timeout, this, &QGCTilePrefetcher::_fetchNext);
+}
+
+//-----------------------------------------------------------------------------
+QGCTilePrefetcher::~QGCTilePrefetcher()
+{
+    _reset();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::setEnabled(bool enabled)
+{
+    if(_enabled != enabled) {
+        _enabled = enabled;
+        if(_enabled) {
+            _queueCorridor(_missionPath, false);
+        } else {
+            _reset();
+        }
+        emit enabledChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::setMapType(const QString& mapType)
+{
+    if(_mapType != mapType) {
+        _reset();
+        _mapType = mapType;
+        _queueCorridor(_missionPath, false);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::setZoomLevel(double zoomLevel)
+{
+    int zoom = qBound(1, static_cast<int>(qFloor(zoomLevel)), static_cast<int>(MAX_MAP_ZOOM));
+    if(_zoom != zoom) {
+        _reset();
+        _zoom = zoom;
+        _queueCorridor(_missionPath, false);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::setMissionPath(const QVariantList& path)
+{
+    _missionPath.clear();
+    for(const QVariant& variant: path) {
+        QGeoCoordinate coordinate = variant.value<QGeoCoordinate>();
+        //-- An empty mission is a path of two 0,0 coordinates
+        if(coordinate.isValid() && !(qFuzzyIsNull(coordinate.latitude()) && qFuzzyIsNull(coordinate.longitude()))) {
+            _missionPath.append(coordinate);
+        }
+    }
+    _queueCorridor(_missionPath, false);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::updateVehicle(const QGeoCoordinate& coordinate, double headingDegrees, double groundSpeed)
+{
+    if(!_enabled || !coordinate.isValid()) {
+        return;
+    }
+    if(_vehicleUpdate.isValid() && _vehicleUpdate.elapsed() < VEHICLE_UPDATE_MSECS) {
+        return;
+    }
+    _vehicleUpdate.start();
+    QList<QGeoCoordinate> path;
+    path.append(coordinate);
+    if(!qIsNaN(headingDegrees) && !qIsNaN(groundSpeed) && groundSpeed >= LOOKAHEAD_MIN_SPEED) {
+        double distance = qBound(LOOKAHEAD_MIN_METERS, groundSpeed * LOOKAHEAD_SECS, LOOKAHEAD_MAX_METERS);
+        path.append(coordinate.atDistanceAndAzimuth(distance, headingDegrees));
+    }
+    _queueCorridor(path, true);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::cancel()
+{
+    _reset();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_reset()
+{
+    _timer.stop();
+    _queue.clear();
+    _queued.clear();
+    //-- Lookups still in progress are ignored when they complete
+    _lookups.clear();
+    QHash<QNetworkReply*, Tile_t> replies;
+    replies.swap(_replies);
+    for(QNetworkReply* reply: replies.keys()) {
+        reply->abort();
+        reply->deleteLater();
+    }
+    emit pendingCountChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_queueCorridor(const QList<QGeoCoordinate>& path, bool urgent)
+{
+    if(!_enabled || _mapType.isEmpty() || !_zoom || path.isEmpty()) {
+        return;
+    }
+    QList<Tile_t> tiles;
+    for(int zoom = _zoom; zoom <= qMin(_zoom + 1, static_cast<int>(MAX_MAP_ZOOM)); zoom++) {
+        if(path.count() == 1) {
+            _queueSegment(path[0], path[0], zoom, tiles);
+        }
+        for(int i = 1; i < path.count(); i++) {
+            _queueSegment(path[i - 1], path[i], zoom, tiles);
+        }
+    }
+    int count = tiles.count();
+    if(!count) {
+        return;
+    }
+    if(urgent) {
+        tiles.append(_queue);
+        _queue.swap(tiles);
+    } else {
+        _queue.append(tiles);
+    }
+    //-- Past the limit the furthest tiles are dropped, they can be queued again later
+    while(_queue.count() > PREFETCH_MAX_QUEUED) {
+        _queued.remove(_queue.takeLast().key);
+    }
+    qCDebug(QGCTilePrefetcherLog) << "Queued" << count << (urgent ? "ahead of the vehicle" : "along the mission") << "pending" << _queue.count();
+    emit pendingCountChanged();
+    if(!_timer.isActive()) {
+        _timer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_queueSegment(const QGeoCoordinate& from, const QGeoCoordinate& to, int zoom, QList<Tile_t>& tiles)
+{
+    UrlFactory* urlFactory = getQGCMapEngine()->urlFactory();
+    int maxTile = (1 << zoom) - 1;
+    int x0 = urlFactory->long2tileX(_mapType, from.longitude(), zoom);
+    int y0 = urlFactory->lat2tileY(_mapType, from.latitude(), zoom);
+    int x1 = urlFactory->long2tileX(_mapType, to.longitude(), zoom);
+    int y1 = urlFactory->lat2tileY(_mapType, to.latitude(), zoom);
+    //-- Samples half a tile apart, so no tile the path crosses is skipped
+    int steps = qMax(qAbs(x1 - x0), qAbs(y1 - y0)) * 2 + 1;
+    for(int i = 0; i <= steps; i++) {
+        double t    = static_cast<double>(i) / steps;
+        double lat  = from.latitude() + (t * (to.latitude() - from.latitude()));
+        double lon  = from.longitude() + (t * (to.longitude() - from.longitude()));
+        int cx      = urlFactory->long2tileX(_mapType, lon, zoom);
+        int cy      = urlFactory->lat2tileY(_mapType, lat, zoom);
+        for(int dy = -CORRIDOR_RADIUS; dy <= CORRIDOR_RADIUS; dy++) {
+            for(int dx = -CORRIDOR_RADIUS; dx <= CORRIDOR_RADIUS; dx++) {
+                int x = cx + dx;
+                int y = cy + dy;
+                if(x < 0 || y < 0 || x > maxTile || y > maxTile) {
+                    continue;
+                }
+                quint64 key = QGCMapEngine::getTileKey(_mapType, x, y, zoom);
+                if(!key || _queued.contains(key)) {
+                    continue;
+                }
+                _queued.insert(key);
+                tiles.append({ key, x, y, zoom });
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_fetchNext()
+{
+    for(int i = 0; i < PREFETCH_PER_INTERVAL && _queue.count() && (_lookups.count() + _replies.count()) < PREFETCH_MAX_IN_FLIGHT; i++) {
+        Tile_t tile = _queue.takeFirst();
+        _lookups.insert(tile.key, tile);
+        //-- Low priority, the map display's own fetches go first
+        QGCFetchTileTask* task = new QGCFetchTileTask(tile.key, true);
+        connect(task, &QGCFetchTileTask::tileFetched, this, &QGCTilePrefetcher::_tileFound);
+        connect(task, &QGCMapTask::error, this, &QGCTilePrefetcher::_tileNotFound);
+        getQGCMapEngine()->addTask(task);
+    }
+    if(_queue.isEmpty()) {
+        _timer.stop();
+    }
+    emit pendingCountChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_tileFound(QGCCacheTile* tile)
+{
+    //-- Already cached
+    _lookups.remove(tile->key());
+    tile->deleteLater();
+    emit pendingCountChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_tileNotFound()
+{
+    QGCFetchTileTask* task = qobject_cast<QGCFetchTileTask*>(QObject::sender());
+    if(!task) {
+        return;
+    }
+    auto lookup = _lookups.find(task->key());
+    if(lookup == _lookups.end()) {
+        //-- Cancelled meanwhile
+        return;
+    }
+    Tile_t tile = lookup.value();
+    _lookups.erase(lookup);
+    if(getQGCMapEngine()->isInternetActive()) {
+        if(!_networkManager) {
+            _networkManager = new QNetworkAccessManager(this);
+#if !defined(__mobile__)
+            QNetworkProxy proxy;
+            proxy.setType(QNetworkProxy::DefaultProxy);
+            _networkManager->setProxy(proxy);
+#endif
+        }
+        QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(_mapType, tile.x, tile.y, tile.z, _networkManager);
+        QNetworkReply* reply = _networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, this, &QGCTilePrefetcher::_networkReplyFinished);
+        _replies.insert(reply, tile);
+    }
+    emit pendingCountChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_networkReplyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
+    if(!reply) {
+        return;
+    }
+    auto download = _replies.find(reply);
+    if(download != _replies.end()) {
+        Tile_t tile = download.value();
+        _replies.erase(download);
+        if(reply->error() == QNetworkReply::NoError) {
+            QByteArray image = reply->readAll();
+            QString format = getQGCMapEngine()->urlFactory()->getImageFormat(_mapType, image);
+            if(!format.isEmpty()) {
+                qCDebug(QGCTilePrefetcherLog) << "Prefetched" << tile.x << tile.y << tile.z;
+                getQGCMapEngine()->cacheTile(tile.key, image, format);
+            }
+        } else {
+            qCDebug(QGCTilePrefetcherLog) << "Prefetch failed" << tile.x << tile.y << tile.z << reply->errorString();
+        }
+        emit pendingCountChanged();
+    }
+    reply->deleteLater();
+}
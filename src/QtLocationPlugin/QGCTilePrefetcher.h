@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Map Tile Prefetcher
+ *
+ *   Caches the map tiles the Fly view is about to show: a corridor along the mission path and one ahead of the
+ *   vehicle, at the current zoom level and the next one. Tiles ahead of the vehicle go first. Tiles are looked up in
+ *   the cache at low priority and only the missing ones are downloaded, a few at a time so the map display and tile
+ *   set downloads are not held up.
+ *
+ */
+
+#ifndef QGC_TILE_PREFETCHER_H
+#define QGC_TILE_PREFETCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantList>
+#include <QGeoCoordinate>
+#include <QNetworkReply>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTilePrefetcherLog)
+
+class QNetworkAccessManager;
+class QGCCacheTile;
+
+//-----------------------------------------------------------------------------
+class QGCTilePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    QGCTilePrefetcher   (QObject* parent = nullptr);
+    ~QGCTilePrefetcher  ();
+
+    Q_PROPERTY(bool     enabled         READ    enabled         WRITE   setEnabled  NOTIFY enabledChanged)
+    Q_PROPERTY(int      pendingCount    READ    pendingCount    NOTIFY  pendingCountChanged)
+
+    //-- Map type name as in the map provider table, e.g. "Google Satellite"
+    Q_INVOKABLE void    setMapType      (const QString& mapType);
+    Q_INVOKABLE void    setZoomLevel    (double zoomLevel);
+    Q_INVOKABLE void    setMissionPath  (const QVariantList& path);
+    Q_INVOKABLE void    updateVehicle   (const QGeoCoordinate& coordinate, double headingDegrees, double groundSpeed);
+    //-- Drops the queued tiles and the fetches in progress
+    Q_INVOKABLE void    cancel          ();
+
+    bool    enabled         () { return _enabled; }
+    int     pendingCount    () { return _queue.count() + _lookups.count() + _replies.count(); }
+
+    void    setEnabled      (bool enabled);
+
+signals:
+    void    enabledChanged      ();
+    void    pendingCountChanged ();
+
+private slots:
+    void    _fetchNext              ();
+    void    _tileFound              (QGCCacheTile* tile);
+    void    _tileNotFound           ();
+    void    _networkReplyFinished   ();
+
+private:
+    typedef struct {
+        quint64 key;
+        int     x;
+        int     y;
+        int     z;
+    } Tile_t;
+
+    void    _queueCorridor  (const QList<QGeoCoordinate>& path, bool urgent);
+    void    _queueSegment   (const QGeoCoordinate& from, const QGeoCoordinate& to, int zoom, QList<Tile_t>& tiles);
+    void    _reset          ();
+
+    bool                    _enabled;
+    QString                 _mapType;
+    int                     _zoom;
+    QList<QGeoCoordinate>   _missionPath;
+    QList<Tile_t>           _queue;
+    QSet<quint64>           _queued;        ///< Every tile queued since the last reset, so none is fetched twice
+    QHash<quint64, Tile_t>  _lookups;       ///< Cache lookups in progress
+    QHash<QNetworkReply*, Tile_t> _replies;
+    QNetworkAccessManager*  _networkManager;
+    QTimer                  _timer;
+    QElapsedTimer           _vehicleUpdate;
+};
+
+#endif // QGC_TILE_PREFETCHER_H
@@ -62,6 +62,7 @@ QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager
     , _reply(nullptr)
     , _request(request)
     , _networkManager(networkManager)
+    , _tileKey(QGCMapEngine::getTileKey(spec.mapId(), spec.x(), spec.y(), spec.zoom()))
 {
     if (_bingNoTileImage.count() == 0) {
         QFile file(":/res/BingNoTileBytes.dat");
@@ -80,7 +81,17 @@ QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager
         setFinished(true);
         setCached(false);
     } else {
-        QGCFetchTileTask* task = getQGCMapEngine()->createFetchTileTask(getQGCMapEngine()->urlFactory()->getTypeFromId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
+        //-- Recently served tiles are answered right away. Elevation tiles are never put in the memory cache.
+        QByteArray  image;
+        QString     format;
+        if(getQGCMapEngine()->memoryCache()->find(_tileKey, image, format)) {
+            setMapImageData(image);
+            setMapImageFormat(format);
+            setFinished(true);
+            setCached(true);
+            return;
+        }
+        QGCFetchTileTask* task = new QGCFetchTileTask(_tileKey);
         connect(task, &QGCFetchTileTask::tileFetched, this, &QGeoTiledMapReplyQGC::cacheReply);
         connect(task, &QGCMapTask::error, this, &QGeoTiledMapReplyQGC::cacheError);
         getQGCMapEngine()->addTask(task);
@@ -136,10 +147,7 @@ QGeoTiledMapReplyQGC::networkReplyFinished()
         a = TerrainTile::serialize(a);
         //-- Cache it if valid
         if(!a.isEmpty()) {
-            getQGCMapEngine()->cacheTile(
-                getQGCMapEngine()->urlFactory()->getTypeFromId(
-                    tileSpec().mapId()),
-                tileSpec().x(), tileSpec().y(), tileSpec().zoom(), a, format);
+            getQGCMapEngine()->cacheTile(_tileKey, a, format);
         }
         emit terrainDone(a, QNetworkReply::NoError);
     } else {
@@ -155,7 +163,8 @@ QGeoTiledMapReplyQGC::networkReplyFinished()
             setMapImageData(a);
             if(!format.isEmpty()) {
                 setMapImageFormat(format);
-                getQGCMapEngine()->cacheTile(getQGCMapEngine()->urlFactory()->getTypeFromId(tileSpec().mapId()), tileSpec().x(), tileSpec().y(), tileSpec().zoom(), a, format);
+                getQGCMapEngine()->memoryCache()->insert(_tileKey, a, format);
+                getQGCMapEngine()->cacheTile(_tileKey, a, format);
             }
         }
         setFinished(true);
@@ -231,6 +240,7 @@ QGeoTiledMapReplyQGC::cacheReply(QGCCacheTile* tile)
         emit terrainDone(tile->img(), QNetworkReply::NoError);
     } else {
         //-- Regular map tile
+        getQGCMapEngine()->memoryCache()->insert(tile->key(), tile->img(), tile->format());
         setMapImageData(tile->img());
         setMapImageFormat(tile->format());
         setFinished(true);
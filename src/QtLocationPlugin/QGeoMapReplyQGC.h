@@ -81,6 +81,7 @@ private:
     QByteArray              _badMapbox;
     QByteArray              _badTile;
     QTimer                  _timer;
+    quint64                 _tileKey;
     static QByteArray       _bingNoTileImage;
     static int              _requestCount;
 };
@@ -211,7 +211,7 @@ Item {
     QGCFileDialog {
         id:             fileDialog
         folder:         QGroundControl.settingsManager.appSettings.missionSavePath
-        nameFilters:    ["Tile Sets (*.qgctiledb)"]
+        nameFilters:    ["Tile Sets (*.qgctiledb)", "MBTiles (*.mbtiles)"]
 
         onAcceptedForSave: {
             if (QGroundControl.mapEngineManager.exportSets(file)) {
@@ -301,6 +301,24 @@ Item {
                         text:           qsTr("Memory cache changes require a restart to take effect.")
                     }
 
+                    Item { width: 1; height: 1 }
+
+                    QGCButton {
+                        text:           qsTr("Deduplicate Tiles")
+                        enabled:        !QGroundControl.mapEngineManager.deduplicating
+                        onClicked:      QGroundControl.mapEngineManager.deduplicateTiles()
+                    }
+
+                    QGCLabel {
+                        anchors.left:   parent.left
+                        anchors.right:  parent.right
+                        wrapMode:       Text.WordWrap
+                        font.pointSize: _adjustableFontPointSize
+                        text:           QGroundControl.mapEngineManager.deduplicateStatus !== "" ?
+                                            QGroundControl.mapEngineManager.deduplicateStatus :
+                                            qsTr("Stores identical tile images, such as open sea, only once.")
+                    }
+
                     Item { width: 1; height: 1; visible: _mapboxFact ? _mapboxFact.visible : false }
                     QGCLabel { text: qsTr("Mapbox Access Token"); visible: _mapboxFact ? _mapboxFact.visible : false }
                     FactTextField {
@@ -531,6 +549,13 @@ Item {
                         QGCLabel {  text: qsTr("Error Count:"); width: infoView._labelWidth; }
                         QGCLabel {  text: offlineMapView._currentSelection ? offlineMapView._currentSelection.errorCountStr : ""; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
                     }
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        visible:    offlineMapView && offlineMapView._currentSelection && !_defaultSet && offlineMapView._currentSelection.downloading
+                        QGCLabel {  text: qsTr("Rate:"); width: infoView._labelWidth; }
+                        QGCLabel {  text: offlineMapView._currentSelection ? (offlineMapView._currentSelection.tilesPerSecondStr + " " + qsTr("tiles/s")) : ""; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
+                    }
                     //-- Default Tile Set
                     Row {
                         spacing:    ScreenTools.defaultFontPixelWidth
@@ -44,6 +44,7 @@ QGCMapEngineManager::QGCMapEngineManager(QGCApplication* app, QGCToolbox* toolbo
     , _actionProgress(0)
     , _importAction(ActionNone)
     , _importReplace(false)
+    , _deduplicating(false)
 {
 
 }
@@ -61,6 +62,7 @@ QGCMapEngineManager::setToolbox(QGCToolbox *toolbox)
    QGCTool::setToolbox(toolbox);
    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
    qmlRegisterUncreatableType<QGCMapEngineManager>("QGroundControl.QGCMapEngineManager", 1, 0, "QGCMapEngineManager", "Reference only");
+   qmlRegisterUncreatableType<QGCTilePrefetcher>("QGroundControl.QGCMapEngineManager", 1, 0, "QGCTilePrefetcher", "Reference only");
    connect(getQGCMapEngine(), &QGCMapEngine::updateTotals, this, &QGCMapEngineManager::_updateTotals);
    _updateDiskFreeSpace();
 }
@@ -367,6 +369,13 @@ QGCMapEngineManager::taskError(QGCMapTask::TaskType type, QString error)
     case QGCMapTask::taskExport:
         task = "Export Tile Sets";
         break;
+    case QGCMapTask::taskDeduplicate:
+        task = "Deduplicate Tiles";
+        if(_deduplicating) {
+            _deduplicating = false;
+            emit deduplicatingChanged();
+        }
+        break;
     default:
         task = "Database Error";
         break;
@@ -544,6 +553,44 @@ QGCMapEngineManager::resetAction()
     emit importActionChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::deduplicateTiles()
+{
+    if(_deduplicating) {
+        return;
+    }
+    _deduplicating = true;
+    emit deduplicatingChanged();
+    _deduplicateProgress(0);
+    QGCDeduplicateTask* task = new QGCDeduplicateTask();
+    connect(task, &QGCDeduplicateTask::deduplicateCompleted, this, &QGCMapEngineManager::_deduplicateCompleted);
+    connect(task, &QGCDeduplicateTask::actionProgress, this, &QGCMapEngineManager::_deduplicateProgress);
+    connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+    getQGCMapEngine()->addTask(task);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::_deduplicateProgress(int percentage)
+{
+    _deduplicateStatus = tr("Deduplicating tiles: %1%").arg(percentage);
+    emit deduplicateStatusChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::_deduplicateCompleted(quint32 tileCount, quint32 imageCount, quint64 savedSize)
+{
+    _deduplicating = false;
+    emit deduplicatingChanged();
+    _deduplicateStatus = tr("%1 tiles share %2 images, saving %3.")
+        .arg(QGCMapEngine::numberToString(tileCount))
+        .arg(QGCMapEngine::numberToString(imageCount))
+        .arg(QGCMapEngine::bigSizeToString(savedSize));
+    emit deduplicateStatusChanged();
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCMapEngineManager::getUniqueName()
@@ -19,6 +19,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTilePrefetcher.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCMapEngineManagerLog)
 
@@ -57,6 +58,11 @@ public:
     Q_PROPERTY(ImportAction         importAction    READ    importAction    WRITE  setImportAction   NOTIFY importActionChanged)
 
     Q_PROPERTY(bool                 importReplace   READ    importReplace   WRITE   setImportReplace   NOTIFY importReplaceChanged)
+    //-- Storing identical tile images once
+    Q_PROPERTY(bool                 deduplicating       READ    deduplicating       NOTIFY deduplicatingChanged)
+    Q_PROPERTY(QString              deduplicateStatus   READ    deduplicateStatus   NOTIFY deduplicateStatusChanged)
+    //-- Caches the tiles the Fly view map is about to show
+    Q_PROPERTY(QGCTilePrefetcher*   tilePrefetcher  READ    tilePrefetcher  CONSTANT)
 
     Q_INVOKABLE void                loadTileSets            ();
     Q_INVOKABLE void                updateForCurrentView    (double lon0, double lat0, double lon1, double lat1, int minZoom, int maxZoom, const QString& mapName);
@@ -72,6 +78,7 @@ public:
     Q_INVOKABLE bool                exportSets              (QString path = QString());
     Q_INVOKABLE bool                importSets              (QString path = QString());
     Q_INVOKABLE void                resetAction             ();
+    Q_INVOKABLE void                deduplicateTiles        ();
 
     quint64                         tileCount               () { return _imageSet.tileCount + _elevationSet.tileCount; }
     QString                         tileCountStr            ();
@@ -91,6 +98,9 @@ public:
     int                             actionProgress          () { return _actionProgress; }
     ImportAction                    importAction            () { return _importAction; }
     bool                            importReplace           () { return _importReplace; }
+    bool                            deduplicating           () { return _deduplicating; }
+    QString                         deduplicateStatus       () { return _deduplicateStatus; }
+    QGCTilePrefetcher*              tilePrefetcher          () { return &_tilePrefetcher; }
 
     void                            setMaxMemCache          (quint32 size);
     void                            setMaxDiskCache         (quint32 size);
@@ -115,6 +125,8 @@ signals:
     void actionProgressChanged  ();
     void importActionChanged    ();
     void importReplaceChanged   ();
+    void deduplicatingChanged   ();
+    void deduplicateStatusChanged();
 
 public slots:
     void taskError              (QGCMapTask::TaskType type, QString error);
@@ -127,6 +139,8 @@ private slots:
     void _resetCompleted        ();
     void _actionCompleted       ();
     void _actionProgressHandler (int percentage);
+    void _deduplicateProgress   (int percentage);
+    void _deduplicateCompleted  (quint32 tileCount, quint32 imageCount, quint64 savedSize);
 
 private:
     void _updateDiskFreeSpace   ();
@@ -149,6 +163,9 @@ private:
     int         _actionProgress;
     ImportAction _importAction;
     bool        _importReplace;
+    bool        _deduplicating;
+    QString     _deduplicateStatus;
+    QGCTilePrefetcher _tilePrefetcher;
 };
 
 #endif
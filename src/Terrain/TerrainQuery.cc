@@ -421,13 +421,13 @@ bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>&
     error = false;
 
     for (const QGeoCoordinate& coordinate: coordinates) {
-        QString tileHash = _getTileHash(coordinate);
-        qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
+        quint64 tileKey = _getTileKey(coordinate);
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates key:coordinate" << tileKey << coordinate;
 
         _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            if (_tiles[tileHash].isIn(coordinate)) {
-                double elevation = _tiles[tileHash].elevation(coordinate);
+        if (_tiles.contains(tileKey)) {
+            if (_tiles[tileKey].isIn(coordinate)) {
+                double elevation = _tiles[tileKey].elevation(coordinate);
                 if (qIsNaN(elevation)) {
                     error = true;
                     qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
@@ -489,7 +489,7 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
 
     // remove from download queue
     QGeoTileSpec spec = reply->tileSpec();
-    QString hash = QGCMapEngine::getTileHash("Airmap Elevation", spec.x(), spec.y(), spec.zoom());
+    quint64 key = QGCMapEngine::getTileKey(spec.mapId(), spec.x(), spec.y(), spec.zoom());
 
     // handle potential errors
     if (error != QNetworkReply::NoError) {
@@ -510,8 +510,8 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
     TerrainTile* terrainTile = new TerrainTile(responseBytes);
     if (terrainTile->isValid()) {
         _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
+        if (!_tiles.contains(key)) {
+            _tiles.insert(key, *terrainTile);
         } else {
             delete terrainTile;
         }
@@ -553,14 +553,14 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
     }
 }
 
-QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
+quint64 TerrainTileManager::_getTileKey(const QGeoCoordinate& coordinate)
 {
-    QString ret = QGCMapEngine::getTileHash(
+    quint64 ret = QGCMapEngine::getTileKey(
         "Airmap Elevation",
         getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1),
         getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1),
         1);
-    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile hash for " << coordinate << ret;
+    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile key for " << coordinate << ret;
 
     return ret;
 }
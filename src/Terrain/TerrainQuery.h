@@ -144,14 +144,14 @@ private:
     } QueuedRequestInfo_t;
 
     void    _tileFailed                         (void);
-    QString _getTileHash                        (const QGeoCoordinate& coordinate);
+    quint64 _getTileKey                         (const QGeoCoordinate& coordinate);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
     State                       _state = State::Idle;
     QNetworkAccessManager       _networkManager;
 
     QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    QHash<quint64, TerrainTile> _tiles;
 };
 
 /// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together
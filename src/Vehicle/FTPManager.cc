@@ -587,6 +587,20 @@ bool FTPManager::download(const QString& from, const QString& toDir)
     return _downloadWorker(from, toDir);
 }
 
+void FTPManager::cancelDownload(void)
+{
+    switch (_waitState) {
+    case MavlinkFTP::kCmdOpenFileRO:
+    case MavlinkFTP::kCmdBurstReadFile:
+    case MavlinkFTP::kCmdReadFile:
+        qCDebug(FTPManagerLog) << "cancelDownload" << _downloadState.fileName;
+        _downloadComplete(tr("Download cancelled"));
+        break;
+    default:
+        break;
+    }
+}
+
 bool FTPManager::_downloadWorker(const QString& from, const QString& toDir)
 {
     if (_waitState != MavlinkFTP::kCmdNone) {
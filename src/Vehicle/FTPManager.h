@@ -43,6 +43,10 @@ public:
     /// @return true: download has started, false: error, no download
     /// Signals downloadComplete, commandError, commandProgress
     bool burstDownload(const QString& from, const QString& toDir);
+
+    /// Cancels the download in progress, if any. The download file is closed and downloadComplete is signalled
+    /// with an error before this returns, so the download directory can be removed afterwards.
+    void cancelDownload(void);
 	
 	/// Lists the specified directory. Emits listEntry signal for each entry, followed by listComplete signal.
 	///		@param dirPath Fully qualified path to list
@@ -113,12 +113,15 @@ MAVLinkLogFiles::setUploaded(bool uploaded)
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 MAVLinkLogProcessor::MAVLinkLogProcessor()
-    : _fd(nullptr)
-    , _written(0)
-    , _sequence(-1)
-    , _numDrops(0)
+    : _stop(false)
+    , _highestSequence(-1)
+    , _nextSequence(-1)
+    , _lastPacketTime(0)
     , _gotHeader(false)
+    , _resync(false)
     , _error(false)
+    , _fd(nullptr)
+    , _written(0)
     , _record(nullptr)
 {
 }
@@ -133,7 +136,15 @@ MAVLinkLogProcessor::~MAVLinkLogProcessor()
 void
 MAVLinkLogProcessor::close()
 {
+    if(isRunning()) {
+        _mutex.lock();
+        _stop = true;
+        _waitc.wakeAll();
+        _mutex.unlock();
+        wait();
+    }
     if(_fd) {
+        _flush();
         fclose(_fd);
         _fd = nullptr;
     }
@@ -150,7 +161,7 @@ MAVLinkLogProcessor::valid()
 bool
 MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint8_t id)
 {
-    _fileName.asprintf("%s/%03d-%s%s",
+    _fileName = QString::asprintf("%s/%03d-%s%s",
                       path.toLatin1().data(),
                       id,
                       QDateTime::currentDateTime().toString("yyyy-MM-dd-hh-mm-ss-zzz").toLocal8Bit().data(),
@@ -159,61 +170,185 @@ MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint
     if(_fd) {
         _record = new MAVLinkLogFiles(manager, _fileName, true);
         _record->setWriting(true);
-        _sequence = -1;
+        //-- Size updates come from the writer thread
+        connect(this, &MAVLinkLogProcessor::bytesWritten, _record, &MAVLinkLogFiles::setSize);
+        _clock.start();
+        start();
         return true;
     }
     return false;
 }
 
 //-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
+MAVLinkLogProcessor::Stats
+MAVLinkLogProcessor::stats()
 {
-    num_drops = 0;
-    //-- Check if a sequence is newer than the one previously received and if
-    //   there were dropped messages between the last one and this.
-    if(_sequence == -1) {
-        _sequence = seq;
-        return true;
-    }
-    if((uint16_t)_sequence == seq) {
-        return false;
+    QMutexLocker lock(&_mutex);
+    return _publishedStats;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
+{
+    Packet_t packet;
+    packet.timestamp    = _clock.elapsed();
+    packet.firstMessage = first_message;
+    packet.data         = data;
+    QMutexLocker lock(&_mutex);
+    //-- Unwrap the 16 bit sequence relative to the newest one seen so far
+    if(_highestSequence < 0) {
+        packet.sequence = sequence;
+    } else {
+        packet.sequence = _highestSequence + static_cast<int16_t>(sequence - static_cast<uint16_t>(_highestSequence));
     }
-    if(seq > (uint16_t)_sequence) {
-        // Account for wrap-arounds, sequence is 2 bytes
-        if((seq - _sequence) > (1 << 15)) { // Assume reordered
-            return false;
+    _highestSequence = qMax(_highestSequence, packet.sequence);
+    _incoming.enqueue(packet);
+    _waitc.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::run()
+{
+    QElapsedTimer flushTimer;
+    flushTimer.start();
+    while(true) {
+        QQueue<Packet_t> batch;
+        bool stop;
+        _mutex.lock();
+        if(_incoming.isEmpty() && !_stop) {
+            _waitc.wait(&_mutex, _reorderTimeoutMsecs);
         }
-        num_drops = seq - _sequence - 1;
-        _numDrops += num_drops;
-        _sequence = seq;
-        return true;
-    } else {
-        if((_sequence - seq) > (1 << 15)) {
-            num_drops = (1 << 16) - _sequence - 1 + seq;
-            _numDrops += num_drops;
-            _sequence = seq;
-            return true;
+        batch.swap(_incoming);
+        stop = _stop;
+        _mutex.unlock();
+        for(Packet_t& packet: batch) {
+            _receivePacket(packet);
+        }
+        _drainPending(stop);
+        if(stop || _buffer.size() >= _flushSize || flushTimer.elapsed() >= _flushIntervalMsecs) {
+            _flush();
+            flushTimer.restart();
+        }
+        _mutex.lock();
+        _publishedStats = _stats;
+        _mutex.unlock();
+        if(_error) {
+            qCWarning(MAVLinkLogManagerLog) << "File IO error writing" << _fileName;
+            emit writeFailed();
+            break;
+        }
+        if(stop) {
+            break;
         }
-        return false;
     }
 }
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogProcessor::_writeData(void* data, int len)
+MAVLinkLogProcessor::_receivePacket(Packet_t& packet)
 {
-    if(!_error) {
-        _error = fwrite(data, 1, len, _fd) != (size_t)len;
-        if(!_error) {
-            _written += len;
-            if(_record) {
-                _record->setSize(_written);
-            }
+    _stats.received++;
+    if(_nextSequence < 0) {
+        _nextSequence = packet.sequence;
+    }
+    if(packet.sequence < _nextSequence || _pending.contains(packet.sequence)) {
+        _stats.discarded++;
+        return;
+    }
+    if(!_pending.isEmpty() && packet.sequence < _pending.lastKey()) {
+        _stats.reordered++;
+    }
+    _pending.insert(packet.sequence, packet);
+    if(packet.sequence != _nextSequence) {
+        _stats.maxReorderDepth = qMax(_stats.maxReorderDepth, static_cast<quint32>(_pending.count()));
+    }
+    _drainPending(false);
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_drainPending(bool flushAll)
+{
+    //-- Write out everything which is in sequence. A gap is held open until either the
+    //   reorder window fills up or the oldest waiting packet times out. It is then declared
+    //   lost and a dropout is written.
+    qint64 now = _clock.elapsed();
+    while(!_pending.isEmpty() && !_error) {
+        auto it = _pending.begin();
+        if(it.key() == _nextSequence) {
+            _processPacket(it.value(), 0);
+        } else if(flushAll || _pending.count() > _reorderWindow || (now - it.value().timestamp) > _reorderTimeoutMsecs) {
+            _stats.lost += static_cast<quint32>(it.key() - _nextSequence);
+            _processPacket(it.value(), qMax(it.value().timestamp - _lastPacketTime, static_cast<qint64>(1)));
         } else {
-            qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
+            break;
+        }
+        _nextSequence = it.key() + 1;
+        _pending.erase(it);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_processPacket(Packet_t& packet, qint64 dropoutMsecs)
+{
+    QByteArray& data = packet.data;
+    uint8_t first_message = packet.firstMessage;
+    _lastPacketTime = packet.timestamp;
+    //-- The first 16 bytes need special treatment (this sounds awfully brittle)
+    if(!_gotHeader) {
+        if(data.size() < 16) {
+            //-- Shouldn't happen but if it does, we might as well close shop.
+            qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
+            _error = true;
+            return;
+        }
+        //-- Write header
+        _writeData(data.data(), 16);
+        data.remove(0, 16);
+        _gotHeader = true;
+        dropoutMsecs = 0;
+    }
+    if(dropoutMsecs > 0) {
+        //-- Whatever partial message we were holding is gone for good
+        _ulogMessage.clear();
+        _writeDropout(dropoutMsecs);
+        _resync = true;
+    }
+    if(_resync) {
+        //-- Nothing useful until we see the start of a message again
+        if(first_message == 255) {
+            return;
         }
+        data.remove(0, first_message);
+        first_message = 0;
+        _resync = false;
+    }
+    if(first_message == 255) {
+        _ulogMessage.append(data);
+        return;
+    }
+    if(_ulogMessage.length()) {
+        _ulogMessage.append(data.left(first_message));
+        _writeData(_ulogMessage.data(), _ulogMessage.length());
+        _ulogMessage.clear();
     }
+    data.remove(0, first_message);
+    _ulogMessage = _writeUlogMessage(data);
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_writeDropout(qint64 msecs)
+{
+    //-- ULog DROPOUT ('O') message: 2 byte size, type, 2 byte duration (ms)
+    uint16_t duration = static_cast<uint16_t>(qMin(msecs, static_cast<qint64>(UINT16_MAX)));
+    const char dropout[] = { 2, 0, 'O', static_cast<char>(duration & 0xff), static_cast<char>(duration >> 8) };
+    _writeData(dropout, sizeof(dropout));
+    _stats.dropouts++;
+    _stats.dropoutMsecs += duration;
 }
 
 //-----------------------------------------------------------------------------
@@ -222,76 +357,43 @@ MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
 {
     //-- Write ulog data w/o integrity checking, assuming data starts with a
     //   valid ulog message. returns the remaining data at the end.
-    while(data.length() > 2) {
-        uint8_t* ptr = (uint8_t*)data.data();
+    int offset = 0;
+    while(data.length() - offset > 2) {
+        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.constData()) + offset;
         int message_length = ptr[0] + (ptr[1] * 256) + 3; // 3 = ULog msg header
-        if(message_length > data.length())
+        if(offset + message_length > data.length())
             break;
-        _writeData(data.data(), message_length);
-        data.remove(0, message_length);
+        offset += message_length;
     }
-    return data;
+    _writeData(data.constData(), offset);
+    return data.mid(offset);
 }
 
 //-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
+void
+MAVLinkLogProcessor::_writeData(const char* data, int len)
 {
-    int num_drops = 0;
-    _error = false;
-    while(_checkSequence(sequence, num_drops)) {
-        //-- The first 16 bytes need special treatment (this sounds awfully brittle)
-        if(!_gotHeader) {
-            if(data.size() < 16) {
-                //-- Shouldn't happen but if it does, we might as well close shop.
-                qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
-                return false;
-            }
-            //-- Write header
-            _writeData(data.data(), 16);
-            data.remove(0, 16);
-            _gotHeader = true;
-            // What about data start offset now that we removed 16 bytes off the start?
-        }
-        if(_gotHeader && num_drops > 0) {
-            if(num_drops > 25) num_drops = 25;
-            //-- Hocus Pocus
-            //   Write a dropout message. We don't really know the actual duration,
-            //   so just use the number of drops * 10 ms
-            uint8_t bogus[] = {2, 0, 79, 0, 0};
-            bogus[3] = num_drops * 10;
-            _writeData(bogus, sizeof(bogus));
-        }
-        if(num_drops > 0) {
-            _writeUlogMessage(_ulogMessage);
-            _ulogMessage.clear();
-            //-- If no useful information in this message. Drop it.
-            if(first_message == 255) {
-                break;
-            }
-            if(first_message > 0) {
-                data.remove(0, first_message);
-                first_message = 0;
-            }
-        }
-        if(first_message == 255 && _ulogMessage.length() > 0) {
-            _ulogMessage.append(data);
-            break;
-        }
-        if(_ulogMessage.length()) {
-            _writeData(_ulogMessage.data(), _ulogMessage.length());
-            if(first_message) {
-                _writeData(data.left(first_message).data(), first_message);
-            }
-            _ulogMessage.clear();
-        }
-        if(first_message) {
-            data.remove(0, first_message);
-        }
-        _ulogMessage = _writeUlogMessage(data);
-        break;
+    if(len > 0) {
+        _buffer.append(data, len);
     }
-    return !_error;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_flush()
+{
+    if(_error || !_fd || _buffer.isEmpty()) {
+        return;
+    }
+    _error = fwrite(_buffer.constData(), 1, static_cast<size_t>(_buffer.size()), _fd) != static_cast<size_t>(_buffer.size());
+    if(!_error) {
+        _written += static_cast<quint32>(_buffer.size());
+        fflush(_fd);
+        emit bytesWritten(_written);
+    } else {
+        qCDebug(MAVLinkLogManagerLog) << "File IO error:" << _buffer.size() << "bytes into" << _fileName;
+    }
+    _buffer.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -637,6 +739,14 @@ MAVLinkLogManager::stopLogging()
     }
     if(_logProcessor) {
         _logProcessor->close();
+        MAVLinkLogProcessor::Stats stats = _logProcessor->stats();
+        qCDebug(MAVLinkLogManagerLog) << "Log stream closed:" << _logProcessor->fileName()
+                                      << "received" << stats.received
+                                      << "lost" << stats.lost
+                                      << "reordered" << stats.reordered
+                                      << "discarded" << stats.discarded
+                                      << "dropouts" << stats.dropouts << "(" << stats.dropoutMsecs << "ms )"
+                                      << "max reorder depth" << stats.maxReorderDepth;
         if(_logProcessor->record()) {
             _logProcessor->record()->setWriting(false);
             if(_enableAutoUpload) {
@@ -866,19 +976,28 @@ void
 MAVLinkLogManager::_mavlinkLogData(Vehicle* /*vehicle*/, uint8_t /*target_system*/, uint8_t /*target_component*/, uint16_t sequence, uint8_t first_message, QByteArray data, bool /*acked*/)
 {
     if(_logProcessor && _logProcessor->valid()) {
-        if(!_logProcessor->processStreamData(sequence, first_message, data)) {
-            qCWarning(MAVLinkLogManagerLog) << "Error writing MAVLink log file:" << _logProcessor->fileName();
-            delete _logProcessor;
-            _logProcessor = nullptr;
-            _logRunning = false;
-            _vehicle->stopMavlinkLog();
-            emit logRunningChanged();
-        }
+        _logProcessor->processStreamData(sequence, first_message, data);
     } else {
         qCWarning(MAVLinkLogManagerLog) << "MAVLink log data received when not expected.";
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_logWriteFailed()
+{
+    if(_logProcessor && sender() == _logProcessor) {
+        qCWarning(MAVLinkLogManagerLog) << "Error writing MAVLink log file:" << _logProcessor->fileName();
+        delete _logProcessor;
+        _logProcessor = nullptr;
+        _logRunning = false;
+        if(_vehicle) {
+            _vehicle->stopMavlinkLog();
+        }
+        emit logRunningChanged();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 MAVLinkLogManager::_mavCommandResult(int vehicleId, int component, int command, int result, bool noReponseFromVehicle)
@@ -931,6 +1050,7 @@ MAVLinkLogManager::_createNewLog()
     delete _logProcessor;
     _logProcessor = new MAVLinkLogProcessor;
     if(_logProcessor->create(this, _logPath, static_cast<uint8_t>(_vehicle->id()))) {
+        connect(_logProcessor, &MAVLinkLogProcessor::writeFailed, this, &MAVLinkLogManager::_logWriteFailed);
         _insertNewLog(_logProcessor->record());
         emit logFilesChanged();
     } else {
@@ -12,6 +12,12 @@
 #define MAVLinkLogManager_H
 
 #include <QObject>
+#include <QThread>
+#include <QQueue>
+#include <QMap>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 
 #include "QmlObjectListModel.h"
 #include "QGCLoggingCategory.h"
@@ -73,29 +79,87 @@ private:
 };
 
 //-----------------------------------------------------------------------------
-class MAVLinkLogProcessor
+/// Writes a streamed ULog (LOGGING_DATA/LOGGING_DATA_ACKED) to disk from a worker thread.
+/// Packets are queued from the GUI thread, put back in sequence through a small reorder
+/// buffer and written out in batches. Gaps which cannot be filled are recorded in the log
+/// as a ULog DROPOUT message carrying the measured duration of the gap.
+class MAVLinkLogProcessor : public QThread
 {
+    Q_OBJECT
 public:
     MAVLinkLogProcessor();
     ~MAVLinkLogProcessor();
+
+    struct Stats {
+        quint32 received        = 0;    ///< Packets handed to the processor
+        quint32 discarded       = 0;    ///< Duplicate packets or packets which arrived after their gap was closed
+        quint32 reordered       = 0;    ///< Packets which arrived out of sequence but were put back in place
+        quint32 lost            = 0;    ///< Packets never received
+        quint32 dropouts        = 0;    ///< DROPOUT messages written into the log
+        quint32 dropoutMsecs    = 0;    ///< Total duration of all dropouts
+        quint32 maxReorderDepth = 0;    ///< Largest number of packets held waiting for a gap to fill
+    };
+
     void                close       ();
     bool                valid       ();
     bool                create      (MAVLinkLogManager *manager, const QString path, uint8_t id);
     MAVLinkLogFiles*    record      () { return _record; }
     QString             fileName    () { return _fileName; }
-    bool                processStreamData(uint16_t _sequence, uint8_t first_message, QByteArray data);
-private:
-    bool                _checkSequence(uint16_t seq, int &num_drops);
-    QByteArray          _writeUlogMessage(QByteArray &data);
-    void                _writeData(void* data, int len);
+    Stats               stats       ();
+
+    /// Queues a packet for the writer thread. Safe to call at any message rate from the GUI thread.
+    void                processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data);
+
+signals:
+    void                bytesWritten    (quint32 bytes);
+    void                writeFailed     ();
+
+protected:
+    void                run         ();
+
 private:
-    FILE*               _fd;
-    quint32             _written;
-    int                 _sequence;
-    int                 _numDrops;
+    typedef struct {
+        qint64      timestamp;      ///< Receive time in msecs since the log was created
+        qint64      sequence;       ///< Unwrapped sequence number
+        uint8_t     firstMessage;
+        QByteArray  data;
+    } Packet_t;
+
+    void                _receivePacket      (Packet_t& packet);
+    void                _drainPending       (bool flushAll);
+    void                _processPacket      (Packet_t& packet, qint64 dropoutMsecs);
+    void                _writeDropout       (qint64 msecs);
+    QByteArray          _writeUlogMessage   (QByteArray& data);
+    void                _writeData          (const char* data, int len);
+    void                _flush              ();
+
+    static const int    _reorderWindow      = 32;   ///< Max packets held while waiting for a missing one
+    static const int    _reorderTimeoutMsecs= 250;  ///< Max time a gap is held open before declaring loss
+    static const int    _flushSize          = 64 * 1024;
+    static const int    _flushIntervalMsecs = 1000;
+
+    // Shared between the GUI and worker threads (guarded by _mutex)
+    QQueue<Packet_t>    _incoming;
+    QMutex              _mutex;
+    QWaitCondition      _waitc;
+    bool                _stop;
+    Stats               _publishedStats;
+    qint64              _highestSequence;
+
+    // Worker thread only
+    QMap<qint64, Packet_t> _pending;
+    qint64              _nextSequence;
+    qint64              _lastPacketTime;
+    QByteArray          _buffer;
+    QByteArray          _ulogMessage;
+    Stats               _stats;
     bool                _gotHeader;
+    bool                _resync;
     bool                _error;
-    QByteArray          _ulogMessage;
+
+    FILE*               _fd;
+    quint32             _written;
+    QElapsedTimer       _clock;
     QString             _fileName;
     MAVLinkLogFiles*    _record;
 };
@@ -194,6 +258,7 @@ private slots:
     void _mavlinkLogData            (Vehicle* vehicle, uint8_t target_system, uint8_t target_component, uint16_t sequence, uint8_t first_message, QByteArray data, bool acked);
     void _armedChanged              (bool armed);
     void _mavCommandResult          (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
+    void _logWriteFailed            ();
 
 private:
     bool _sendLog                   (const QString& logFile);
@@ -0,0 +1,360 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryRecorder.h"
+#include "FactGroup.h"
+#include "QGCLoggingCategory.h"
+
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QTextStream>
+#include <QtEndian>
+#include <QtConcurrent>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TelemetryRecorderLog, "TelemetryRecorderLog")
+
+const char  TelemetryRecorder::_magic[4]        = { 'Q', 'G', 'C', 'T' };
+const char* TelemetryRecorder::fileExtension    = "qgctlm";
+
+template<typename T>
+static void _appendLittleEndian(QByteArray& bytes, T value)
+{
+    T littleEndian = qToLittleEndian<T>(value);
+    bytes.append(reinterpret_cast<const char*>(&littleEndian), sizeof(T));
+}
+
+static void _appendDouble(QByteArray& bytes, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    _appendLittleEndian<quint64>(bytes, bits);
+}
+
+static void _appendString(QByteArray& bytes, const QString& string)
+{
+    QByteArray utf8 = string.toUtf8().left(0xFFFF);
+    _appendLittleEndian<quint16>(bytes, static_cast<quint16>(utf8.length()));
+    bytes.append(utf8);
+}
+
+TelemetryRecorder::TelemetryRecorder(QObject* parent)
+    : QThread(parent)
+{
+
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    close();
+}
+
+bool TelemetryRecorder::open(FactGroup* factGroup, const QString& fileName, const QString& csvFileName)
+{
+    if (_open) {
+        qCWarning(TelemetryRecorderLog) << "Recording already open" << _fileName;
+        return false;
+    }
+
+    _fileName = fileName;
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(TelemetryRecorderLog) << "Unable to create recording" << fileName << _file.errorString();
+        return false;
+    }
+
+    _columns.clear();
+    _incoming.clear();
+    _buffer.clear();
+    _buffer.reserve(_flushSize);
+    _rowCount       = 0;
+    _stop           = false;
+    _error          = false;
+    _csvFileName    = csvFileName;
+
+    QByteArray columnsHeader;
+    _addColumns(factGroup, QString(), columnsHeader);
+
+    QByteArray header;
+    header.append(_magic, sizeof(_magic));
+    _appendLittleEndian<quint32>(header, _version);
+    _appendLittleEndian<quint32>(header, static_cast<quint32>(_columns.count()));
+    header.append(columnsHeader);
+    _incoming.enqueue(header);
+
+    _rowSizeHint = static_cast<int>(sizeof(quint32) + sizeof(qint64) + (_columns.count() * sizeof(double)));
+
+    qCDebug(TelemetryRecorderLog) << "Recording started" << fileName << "columns:" << _columns.count();
+
+    _open = true;
+    start(QThread::LowPriority);
+
+    return true;
+}
+
+void TelemetryRecorder::_addColumns(FactGroup* factGroup, const QString& prefix, QByteArray& header)
+{
+    for (const QString& factName: factGroup->factNames()) {
+        Fact* fact = factGroup->getFact(factName);
+        if (!fact) {
+            continue;
+        }
+
+        Column_t column;
+        column.fact = fact;
+        // Other types keep their cooked value string, as it reads in the ui
+        column.type = fact->type() == FactMetaData::valueTypeDouble || fact->type() == FactMetaData::valueTypeFloat ? ColumnTypeDouble : ColumnTypeString;
+        _columns.append(column);
+
+        header.append(static_cast<char>(column.type));
+        header.append(static_cast<char>(qBound(0, fact->decimalPlaces(), 127)));
+        _appendString(header, prefix + factName);
+        _appendString(header, fact->cookedUnits());
+    }
+
+    // Only a single level of groups, same as FactGroup::getFact supports
+    if (prefix.isEmpty()) {
+        for (const QString& groupName: factGroup->factGroupNames()) {
+            _addColumns(factGroup->getFactGroup(groupName), groupName + QStringLiteral("."), header);
+        }
+    }
+}
+
+void TelemetryRecorder::close(void)
+{
+    if (!_open) {
+        return;
+    }
+    _open = false;
+
+    if (isRunning()) {
+        _mutex.lock();
+        _stop = true;
+        _waitc.wakeAll();
+        _mutex.unlock();
+        wait();
+        qCDebug(TelemetryRecorderLog) << "Recording stopped" << _fileName << "rows:" << _rowCount;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+
+    // Converting a long flight takes a while, so it is not done on the thread closing the recording
+    if (!_error && !_csvFileName.isEmpty()) {
+        QString recordingFile   = _fileName;
+        QString csvFile         = _csvFileName;
+        _csvConversion = QtConcurrent::run([recordingFile, csvFile]() -> bool {
+            QString errorString;
+            if (!convertToCsv(recordingFile, csvFile, errorString)) {
+                qCWarning(TelemetryRecorderLog) << "Conversion to csv failed" << csvFile << errorString;
+                return false;
+            }
+            // The csv holds everything the recording did, keeping both would double the disk use of every flight.
+            // A recording which failed to convert is kept so it can be converted later.
+            if (!QFile::remove(recordingFile)) {
+                qCWarning(TelemetryRecorderLog) << "Unable to remove converted recording" << recordingFile;
+            }
+            return true;
+        });
+    }
+}
+
+void TelemetryRecorder::recordRow(qint64 msecsSinceEpoch)
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    QByteArray row;
+    row.reserve(_rowSizeHint);
+
+    _appendLittleEndian<quint32>(row, 0);   // Row length, filled in below
+    _appendLittleEndian<qint64>(row, msecsSinceEpoch);
+    for (const Column_t& column: _columns) {
+        if (column.type == ColumnTypeDouble) {
+            _appendDouble(row, column.fact->cookedValueDouble());
+        } else {
+            _appendString(row, column.fact->cookedValueString());
+        }
+    }
+    qToLittleEndian<quint32>(static_cast<quint32>(row.length() - static_cast<int>(sizeof(quint32))), row.data());
+    _rowSizeHint = qMax(_rowSizeHint, row.length());
+
+    _mutex.lock();
+    _incoming.enqueue(row);
+    _waitc.wakeAll();
+    _mutex.unlock();
+
+    _rowCount++;
+}
+
+void TelemetryRecorder::run(void)
+{
+    QElapsedTimer flushTimer;
+    flushTimer.start();
+
+    while (true) {
+        QQueue<QByteArray>  batch;
+        bool                stop;
+
+        _mutex.lock();
+        if (_incoming.isEmpty() && !_stop) {
+            _waitc.wait(&_mutex, _flushIntervalMsecs);
+        }
+        batch.swap(_incoming);
+        stop = _stop;
+        _mutex.unlock();
+
+        for (const QByteArray& bytes: batch) {
+            _buffer.append(bytes);
+        }
+        if (stop || _buffer.length() >= _flushSize || flushTimer.elapsed() >= _flushIntervalMsecs) {
+            _flush();
+            flushTimer.restart();
+        }
+        if (_error) {
+            qCWarning(TelemetryRecorderLog) << "File IO error writing" << _file.fileName() << _file.errorString();
+            emit writeFailed();
+            break;
+        }
+        if (stop) {
+            break;
+        }
+    }
+
+    _file.close();
+}
+
+void TelemetryRecorder::_flush(void)
+{
+    if (_buffer.isEmpty()) {
+        return;
+    }
+    if (_file.write(_buffer) != _buffer.length() || !_file.flush()) {
+        _error = true;
+    }
+    _buffer.resize(0);
+}
+
+bool TelemetryRecorder::convertToCsv(const QString& recordingFile, const QString& csvFile, QString& errorString)
+{
+    errorString.clear();
+
+    QFile inFile(recordingFile);
+    if (!inFile.open(QIODevice::ReadOnly)) {
+        errorString = tr("Unable to open %1: %2").arg(recordingFile, inFile.errorString());
+        return false;
+    }
+
+    QByteArray bytes = inFile.read(sizeof(_magic) + (2 * sizeof(quint32)));
+    if (bytes.length() != static_cast<int>(sizeof(_magic) + (2 * sizeof(quint32))) || memcmp(bytes.constData(), _magic, sizeof(_magic))) {
+        errorString = tr("%1 is not a telemetry recording").arg(recordingFile);
+        return false;
+    }
+    quint32 version     = qFromLittleEndian<quint32>(bytes.constData() + sizeof(_magic));
+    quint32 columnCount = qFromLittleEndian<quint32>(bytes.constData() + sizeof(_magic) + sizeof(quint32));
+    if (version != _version) {
+        errorString = tr("Unsupported telemetry recording version %1").arg(version);
+        return false;
+    }
+
+    auto readString = [&inFile](QString& string) -> bool {
+        QByteArray lengthBytes = inFile.read(sizeof(quint16));
+        if (lengthBytes.length() != static_cast<int>(sizeof(quint16))) {
+            return false;
+        }
+        int length = qFromLittleEndian<quint16>(lengthBytes.constData());
+        QByteArray utf8 = inFile.read(length);
+        string = QString::fromUtf8(utf8);
+        return utf8.length() == length;
+    };
+
+    QVector<ColumnType> columnTypes;
+    QVector<int>        columnDecimalPlaces;
+    QStringList         columnNames;
+    for (quint32 i=0; i<columnCount; i++) {
+        QByteArray  typeBytes = inFile.read(2);
+        QString     name;
+        QString     units;
+
+        if (typeBytes.length() != 2 || !readString(name) || !readString(units)) {
+            errorString = tr("Telemetry recording header is truncated");
+            return false;
+        }
+        columnTypes.append(static_cast<ColumnType>(typeBytes[0]));
+        columnDecimalPlaces.append(typeBytes[1]);
+        columnNames.append(name);
+    }
+
+    QFile outFile(csvFile);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        errorString = tr("Unable to create %1: %2").arg(csvFile, outFile.errorString());
+        return false;
+    }
+
+    QTextStream stream(&outFile);
+    stream << "Timestamp," << columnNames.join(",") << "\n";
+
+    quint32 rows = 0;
+    while (true) {
+        QByteArray lengthBytes = inFile.read(sizeof(quint32));
+        if (lengthBytes.length() != static_cast<int>(sizeof(quint32))) {
+            break;
+        }
+        quint32     rowLength   = qFromLittleEndian<quint32>(lengthBytes.constData());
+        QByteArray  row         = inFile.read(rowLength);
+        if (static_cast<quint32>(row.length()) != rowLength || rowLength < sizeof(qint64)) {
+            qCDebug(TelemetryRecorderLog) << "Truncated row ignored" << recordingFile;
+            break;
+        }
+
+        const char* cursor      = row.constData();
+        const char* rowEnd      = cursor + row.length();
+        qint64      timestamp   = qFromLittleEndian<qint64>(cursor);
+        cursor += sizeof(qint64);
+
+        QStringList values;
+        values.append(QDateTime::fromMSecsSinceEpoch(timestamp).toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz")));
+        for (int i=0; i<columnTypes.count(); i++) {
+            if (columnTypes[i] == ColumnTypeDouble) {
+                if (cursor + sizeof(quint64) > rowEnd) {
+                    break;
+                }
+                quint64 bits = qFromLittleEndian<quint64>(cursor);
+                double  value;
+                memcpy(&value, &bits, sizeof(value));
+                cursor += sizeof(quint64);
+                // Same formatting as Fact::cookedValueString
+                values.append(qIsNaN(value) ? QStringLiteral("--.--") : QString("%1").arg(value, 0, 'f', columnDecimalPlaces[i]));
+            } else {
+                if (cursor + sizeof(quint16) > rowEnd) {
+                    break;
+                }
+                int length = qFromLittleEndian<quint16>(cursor);
+                cursor += sizeof(quint16);
+                if (cursor + length > rowEnd) {
+                    break;
+                }
+                QString value = QString::fromUtf8(cursor, length);
+                cursor += length;
+                if (value.contains(QLatin1Char(',')) || value.contains(QLatin1Char('"'))) {
+                    value = QStringLiteral("\"%1\"").arg(value.replace(QLatin1Char('"'), QStringLiteral("\"\"")));
+                }
+                values.append(value);
+            }
+        }
+        stream << values.join(",") << "\n";
+        rows++;
+    }
+
+    stream.flush();
+    qCDebug(TelemetryRecorderLog) << "Converted to csv" << csvFile << "rows:" << rows;
+
+    return outFile.error() == QFile::NoError;
+}
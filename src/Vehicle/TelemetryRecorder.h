@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QVector>
+#include <QFuture>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryRecorderLog)
+
+class Fact;
+class FactGroup;
+
+/// Records the values of a FactGroup hierarchy at a high rate to a compact binary file.
+///
+/// The set of facts recorded is resolved once when the recording is opened. Each call to recordRow snapshots the cooked
+/// value of every fact into a binary row which is handed to a writer thread, so the GUI thread never touches the file.
+/// The writer batches rows and flushes periodically. When the recording is closed the file can optionally be converted
+/// to csv in the background, replacing the recording.
+///
+/// File layout (little endian):
+///     Header:     char magic[4], uint32 version, uint32 column count
+///     Columns:    uint8 column type, uint8 decimal places, uint16 name length, utf8 name, uint16 units length, utf8 units
+///     Rows:       uint32 row length, int64 msecs since epoch, then per column: double for numeric columns,
+///                 uint16 length + utf8 cooked value string for other columns
+class TelemetryRecorder : public QThread
+{
+    Q_OBJECT
+
+public:
+    TelemetryRecorder(QObject* parent = nullptr);
+    ~TelemetryRecorder();
+
+    /// Resolves the columns from the facts of factGroup and its child groups and starts the writer thread
+    ///     @param factGroup    Facts of this group are recorded under their own name, child groups as "group.fact"
+    ///     @param fileName     Binary recording file
+    ///     @param csvFileName  If not empty the recording is converted to this csv file when it is closed. The recording
+    ///                         file is removed once the conversion succeeded.
+    /// @return false: file could not be created
+    bool open(FactGroup* factGroup, const QString& fileName, const QString& csvFileName = QString());
+
+    /// Stops the writer thread after all queued rows are written, then starts the csv conversion if requested. The
+    /// conversion runs on its own, a long recording does not hold up the caller.
+    void close(void);
+
+    bool    isOpen      (void) const { return _open; }
+    QString fileName    (void) const { return _fileName; }
+    int     columnCount (void) const { return _columns.count(); }
+    quint32 rowCount    (void) const { return _rowCount; }
+
+    /// @return Csv conversion started by the last close, true once it succeeded
+    QFuture<bool> csvConversion(void) const { return _csvConversion; }
+
+    /// Snapshots the current value of all columns and queues the row for writing
+    void recordRow(qint64 msecsSinceEpoch);
+
+    /// Converts a binary recording to csv. A truncated final row, as left by a crash, is ignored.
+    ///     @param errorString  Returned: reason for failure
+    /// @return false: conversion failed
+    static bool convertToCsv(const QString& recordingFile, const QString& csvFile, QString& errorString);
+
+    static const char*  fileExtension;
+
+signals:
+    void writeFailed(void);
+
+protected:
+    void run(void) override;
+
+private:
+    enum ColumnType {
+        ColumnTypeDouble = 0,
+        ColumnTypeString = 1,
+    };
+
+    typedef struct {
+        Fact*       fact;
+        ColumnType  type;
+    } Column_t;
+
+    void _addColumns    (FactGroup* factGroup, const QString& prefix, QByteArray& header);
+    void _flush         (void);
+
+    static const char   _magic[4];
+    static const quint32 _version           = 2;
+    static const int    _flushSize          = 64 * 1024;
+    static const int    _flushIntervalMsecs = 1000;
+
+    // GUI thread only
+    bool                _open               = false;
+    QString             _fileName;
+    QVector<Column_t>   _columns;
+    int                 _rowSizeHint        = 0;
+    quint32             _rowCount           = 0;
+    QString             _csvFileName;
+    QFuture<bool>       _csvConversion;
+
+    // Shared between the GUI and writer threads (guarded by _mutex)
+    QQueue<QByteArray>  _incoming;
+    QMutex              _mutex;
+    QWaitCondition      _waitc;
+    bool                _stop               = false;
+
+    // Writer thread only once started
+    QFile               _file;
+    QByteArray          _buffer;
+    bool                _error              = false;
+};
@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryRecorderTest.h"
+#include "TelemetryRecorder.h"
+#include "FactGroup.h"
+
+#include <QTemporaryDir>
+#include <QDateTime>
+
+class TelemetryRecorderTestFactGroup : public FactGroup
+{
+public:
+    TelemetryRecorderTestFactGroup(QObject* parent = nullptr)
+        : FactGroup (50, parent)
+        , rollFact  (0, "roll",     FactMetaData::valueTypeDouble)
+        , modeFact  (0, "mode",     FactMetaData::valueTypeString)
+    {
+        _addFact(&rollFact, "roll");
+        _addFact(&modeFact, "mode");
+    }
+
+    void addFactGroup(FactGroup* factGroup, const QString& name) { _addFactGroup(factGroup, name); }
+
+    Fact rollFact;
+    Fact modeFact;
+};
+
+/// Records rows from a group hierarchy and checks the csv conversion of the binary recording
+void TelemetryRecorderTest::_testRecordAndConvert(void)
+{
+    TelemetryRecorderTestFactGroup parentGroup;
+    TelemetryRecorderTestFactGroup childGroup;
+    parentGroup.addFactGroup(&childGroup, "child");
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString recordingFile   = tempDir.filePath(QStringLiteral("test.%1").arg(TelemetryRecorder::fileExtension));
+    QString csvFile         = tempDir.filePath(QStringLiteral("test.csv"));
+
+    TelemetryRecorder recorder;
+    QVERIFY(recorder.open(&parentGroup, recordingFile, csvFile));
+    QVERIFY(recorder.isOpen());
+    QCOMPARE(recorder.columnCount(), 4);
+
+    // The csv holds the cooked value strings the ui shows at the time of each row
+    QStringList expectedRows;
+    qint64      timestamp = QDateTime::currentMSecsSinceEpoch();
+    parentGroup.rollFact.setRawValue(1.5);
+    parentGroup.modeFact.setRawValue("Hold, \"Loiter\"");
+    childGroup.rollFact.setRawValue(qQNaN());
+    recorder.recordRow(timestamp);
+    expectedRows.append(QStringLiteral("%1,%2,\"Hold, \"\"Loiter\"\"\",%3,%4").arg(
+                            QDateTime::fromMSecsSinceEpoch(timestamp).toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz")),
+                            parentGroup.rollFact.cookedValueString(),
+                            childGroup.rollFact.cookedValueString(),
+                            childGroup.modeFact.cookedValueString()));
+    parentGroup.rollFact.setRawValue(-2.25);
+    childGroup.rollFact.setRawValue(10);
+    recorder.recordRow(timestamp + 40);
+    expectedRows.append(QStringLiteral("%1,%2,\"Hold, \"\"Loiter\"\"\",%3,%4").arg(
+                            QDateTime::fromMSecsSinceEpoch(timestamp + 40).toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz")),
+                            parentGroup.rollFact.cookedValueString(),
+                            childGroup.rollFact.cookedValueString(),
+                            childGroup.modeFact.cookedValueString()));
+    QCOMPARE(recorder.rowCount(), 2u);
+
+    recorder.close();
+    QVERIFY(!recorder.isOpen());
+    QFuture<bool> conversion = recorder.csvConversion();
+    conversion.waitForFinished();
+    QVERIFY(conversion.result());
+    QVERIFY(!QFile::exists(recordingFile));
+
+    QFile file(csvFile);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    QStringList lines = QString::fromUtf8(file.readAll()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(lines.count(), 3);
+    QCOMPARE(lines[0], QStringLiteral("Timestamp,roll,mode,child.roll,child.mode"));
+    QCOMPARE(lines[1], expectedRows[0]);
+    QCOMPARE(lines[2], expectedRows[1]);
+}
+
+/// A file which is not a recording is rejected
+void TelemetryRecorderTest::_testRejectForeignFile(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString foreignFile = tempDir.filePath(QStringLiteral("foreign.csv"));
+
+    QFile file(foreignFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("Timestamp,roll\n");
+    file.close();
+
+    QString errorString;
+    QVERIFY(!TelemetryRecorder::convertToCsv(foreignFile, tempDir.filePath(QStringLiteral("bad.csv")), errorString));
+    QVERIFY(!errorString.isEmpty());
+}
@@ -9,12 +9,33 @@
 
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
+#include "QGCApplication.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QDateTime>
+#include <QtEndian>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TrajectoryPointsLog, "TrajectoryPointsLog")
+
+const char TrajectoryPoints::_magic[4] = { 'Q', 'G', 'T', 'R' };
 
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
     , _vehicle      (vehicle)
     , _lastAzimuth  (qQNaN())
+    , _persist      (!qgcApp()->runningUnitTests())
 {
+    _saveTimer.setInterval(_saveIntervalMsecs);
+    connect(&_saveTimer, &QTimer::timeout, this, &TrajectoryPoints::_save);
+}
+
+TrajectoryPoints::~TrajectoryPoints()
+{
+    // The active flag is left set so the track is resumed if the vehicle is still flying on the next start
+    _save();
 }
 
 void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
@@ -33,39 +54,212 @@ void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
                 // The new position IS NOT colinear with the last segment. Append the new position to the list.
                 _lastAzimuth = _lastPoint.azimuthTo(coordinate);
                 _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
+                _track.append(coordinate);
                 emit pointAdded(coordinate);
             } else {
                 // The new position IS colinear with the last segment. Don't add a new point, just update
                 // the last point to be the new position.
                 _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
+                _track.replaceLast(coordinate);
                 emit updateLastPoint(coordinate);
             }
         }
     } else {
         // Add the very first trajectory point to the list
         _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
+        _track.append(coordinate);
         emit pointAdded(coordinate);
     }
 }
 
+QVariantList TrajectoryPoints::list(void) const
+{
+    QVariantList points;
+
+    points.reserve(_track.count());
+    for (int i=0; i<_track.count(); i++) {
+        points.append(QVariant::fromValue(_track.coordinate(i)));
+    }
+    return points;
+}
+
+QVariantList TrajectoryPoints::viewportList(QGeoCoordinate topLeft, QGeoCoordinate bottomRight, double metersPerPixel) const
+{
+    QVariantList points;
+
+    for (int index: _track.viewportIndices(QGeoRectangle(topLeft, bottomRight), metersPerPixel)) {
+        points.append(QVariant::fromValue(_track.coordinate(index)));
+    }
+    return points;
+}
+
 void TrajectoryPoints::start(void)
 {
-    clear();
+    if (_resumable) {
+        qCDebug(TrajectoryPointsLog) << "Resuming saved track" << _track.count();
+    } else {
+        clear();
+    }
+    _resumable = false;
+
+    _started = true;
     connect(_vehicle, &Vehicle::coordinateChanged, this, &TrajectoryPoints::_vehicleCoordinateChanged);
+
+    // Until the vehicle is identified the track is only kept in memory, saving starts in restore
+    _startSaving();
+}
+
+void TrajectoryPoints::_startSaving(void)
+{
+    if (_persist && _vehicle->vehicleUID() && !_file.isOpen() && _openFile()) {
+        _setFileActive(true);
+        _saveTimer.start();
+    }
 }
 
 void TrajectoryPoints::stop(void)
 {
+    _started = false;
     disconnect(_vehicle, &Vehicle::coordinateChanged, this, &TrajectoryPoints::_vehicleCoordinateChanged);
+
+    _saveTimer.stop();
+    if (_file.isOpen()) {
+        // The last point is final once the vehicle disarms
+        _writePoints(_track.count());
+        _setFileActive(false);
+        _file.close();
+    }
 }
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
+    _track.clear();
     _lastPoint = QGeoCoordinate();
     _lastAzimuth = qQNaN();
+    _savedCount = 0;
+    if (_file.isOpen()) {
+        _file.resize(_headerSize);
+        _file.seek(_headerSize);
+    } else if (_persist && _vehicle->vehicleUID()) {
+        QFile::remove(_fileName());
+    }
     emit pointsCleared();
 }
+
+QString TrajectoryPoints::_fileName(void) const
+{
+    QDir cacheDir(QFileInfo(QSettings().fileName()).dir().absoluteFilePath("TrajectoryCache"));
+    cacheDir.mkpath(QStringLiteral("."));
+    // Keyed by the unique id of the flight controller, different vehicles may share a system id
+    return cacheDir.absoluteFilePath(QStringLiteral("Vehicle%1.qgctrk").arg(_vehicle->vehicleUID(), 16, 16, QLatin1Char('0')));
+}
+
+void TrajectoryPoints::restore(void)
+{
+    if (!_persist || !_vehicle->vehicleUID() || _file.isOpen()) {
+        return;
+    }
+
+    QFile file(_fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QByteArray header = file.read(_headerSize);
+    if (header.length() != _headerSize || memcmp(header.constData(), _magic, sizeof(_magic)) || qFromLittleEndian<quint32>(header.constData() + sizeof(_magic)) != _version) {
+        qCWarning(TrajectoryPointsLog) << "Ignoring invalid saved track" << file.fileName();
+        return;
+    }
+    quint32 flags = qFromLittleEndian<quint32>(header.constData() + _flagsOffset);
+    bool resumable = (flags & _flagActive) && file.fileTime(QFileDevice::FileModificationTime).secsTo(QDateTime::currentDateTime()) < _resumeMaxAgeSecs;
+
+    if (_started) {
+        // The vehicle was seen armed before it was identified. The points since then continue the saved track if
+        // that flight is still in progress, otherwise they start a new one.
+        if (resumable) {
+            TrajectoryTrack track;
+            track.deserialize(file.readAll());
+            _savedCount = track.count();
+            for (int i=0; i<_track.count(); i++) {
+                track.append(_track.coordinate(i));
+            }
+            _track = track;
+            qCDebug(TrajectoryPointsLog) << "Resuming saved track" << file.fileName() << "points:" << _savedCount;
+            emit pointsRestored();
+        } else {
+            _savedCount = 0;
+        }
+        file.close();
+        _startSaving();
+        return;
+    }
+
+    _track.clear();
+    _track.deserialize(file.readAll());
+    _savedCount = _track.count();
+    _lastAzimuth = qQNaN();
+    _lastPoint = _track.isEmpty() ? QGeoCoordinate() : _track.coordinate(_track.count() - 1);
+    _resumable = resumable;
+
+    qCDebug(TrajectoryPointsLog) << "Restored saved track" << file.fileName() << "points:" << _savedCount << "resumable:" << _resumable;
+
+    emit pointsRestored();
+}
+
+bool TrajectoryPoints::_openFile(void)
+{
+    _file.setFileName(_fileName());
+    if (!_file.open(QIODevice::ReadWrite)) {
+        qCWarning(TrajectoryPointsLog) << "Unable to open saved track" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    // Rewrite the file if it does not match the track in memory
+    if (_file.size() != _headerSize + (static_cast<qint64>(_savedCount) * TrajectoryTrack::recordSize)) {
+        QByteArray header(_headerSize, 0);
+        memcpy(header.data(), _magic, sizeof(_magic));
+        qToLittleEndian<quint32>(_version, header.data() + sizeof(_magic));
+
+        _file.resize(0);
+        _file.write(header);
+        _savedCount = 0;
+    }
+    _file.seek(_file.size());
+    _writePoints(_track.count() - 1);
+
+    return true;
+}
+
+void TrajectoryPoints::_setFileActive(bool active)
+{
+    uchar flags[sizeof(quint32)];
+    qToLittleEndian<quint32>(active ? _flagActive : 0, flags);
+
+    _file.seek(_flagsOffset);
+    _file.write(reinterpret_cast<const char*>(flags), sizeof(flags));
+    _file.seek(_file.size());
+    _file.flush();
+}
+
+void TrajectoryPoints::_writePoints(int end)
+{
+    if (end <= _savedCount) {
+        return;
+    }
+    QByteArray bytes = _track.serialize(_savedCount, end);
+    if (_file.write(bytes) != bytes.length() || !_file.flush()) {
+        qCWarning(TrajectoryPointsLog) << "Saving track failed" << _file.fileName() << _file.errorString();
+        _saveTimer.stop();
+        _file.close();
+        return;
+    }
+    _savedCount = end;
+}
+
+void TrajectoryPoints::_save(void)
+{
+    if (_file.isOpen()) {
+        // The last point can still be replaced, it is saved once the next point is added
+        _writePoints(_track.count() - 1);
+    }
+}
@@ -10,19 +10,39 @@
 #pragma once
 
 #include "QmlObjectListModel.h"
+#include "TrajectoryTrack.h"
+#include "QGCLoggingCategory.h"
 
 #include <QGeoCoordinate>
+#include <QFile>
+#include <QTimer>
+
+Q_DECLARE_LOGGING_CATEGORY(TrajectoryPointsLog)
 
 class Vehicle;
 
+/// Flight track of a vehicle while it is armed.
+///
+/// The track is saved to disk as it grows, keyed by the unique id of the vehicle. If QGC is restarted while the vehicle
+/// is still flying the saved track is restored once the vehicle is identified and continued while it is armed.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
 
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
+    ~TrajectoryPoints();
+
+    /// @return All points of the track
+    Q_INVOKABLE QVariantList list(void) const;
+
+    /// @return Points of the track for display in the viewport, simplified to the map resolution
+    Q_INVOKABLE QVariantList viewportList(QGeoCoordinate topLeft, QGeoCoordinate bottomRight, double metersPerPixel) const;
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    const TrajectoryTrack& track(void) const { return _track; }
+
+    /// Loads the saved track of the vehicle. Does nothing until the vehicle UID is known.
+    void restore(void);
 
     void start  (void);
     void stop   (void);
@@ -34,16 +54,38 @@ signals:
     void pointAdded     (QGeoCoordinate coordinate);
     void updateLastPoint(QGeoCoordinate coordinate);
     void pointsCleared  (void);
+    void pointsRestored (void);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
+    void _save(void);
 
 private:
+    QString _fileName       (void) const;
+    bool    _openFile       (void);
+    void    _setFileActive  (bool active);
+    void    _writePoints    (int end);
+    void    _startSaving    (void);
+
     Vehicle*        _vehicle;
-    QVariantList    _points;
+    TrajectoryTrack _track;
     QGeoCoordinate  _lastPoint;
     double          _lastAzimuth;
+    QFile           _file;
+    QTimer          _saveTimer;
+    int             _savedCount     = 0;        ///< Number of points written to _file
+    bool            _persist        = true;
+    bool            _resumable      = false;    ///< true: restored track is from a flight which is still in progress
+    bool            _started        = false;    ///< true: vehicle is armed, track is growing
 
     static constexpr double _distanceTolerance = 2.0;
     static constexpr double _azimuthTolerance = 1.5;
+
+    static const char       _magic[4];
+    static const quint32    _version            = 1;
+    static const int        _headerSize         = 12;       ///< magic, version, flags
+    static const int        _flagsOffset        = 8;
+    static const quint32    _flagActive         = 1;
+    static const int        _saveIntervalMsecs  = 5000;
+    static const int        _resumeMaxAgeSecs   = 600;      ///< Older saved tracks are assumed to be from a finished flight
 };
@@ -0,0 +1,265 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryTrack.h"
+
+#include <QtEndian>
+#include <QtMath>
+#include <cstring>
+
+const int       TrajectoryTrack::levelCount;
+const int       TrajectoryTrack::recordSize;
+const int       TrajectoryTrack::_chunkSize;
+const double    TrajectoryTrack::_levelTolerances[TrajectoryTrack::levelCount] = { 0.0, 3.0, 15.0, 60.0 };
+
+TrajectoryTrack::TrajectoryTrack(void)
+{
+
+}
+
+QGeoCoordinate TrajectoryTrack::coordinate(int index) const
+{
+    const Point_t& point = _points[index];
+    return QGeoCoordinate(point.latitude, point.longitude, static_cast<double>(point.altitude));
+}
+
+void TrajectoryTrack::append(const QGeoCoordinate& coordinate)
+{
+    Point_t point;
+    point.latitude  = coordinate.latitude();
+    point.longitude = coordinate.longitude();
+    point.altitude  = static_cast<float>(coordinate.altitude());
+    _points.append(point);
+
+    _simplifyPending();
+}
+
+void TrajectoryTrack::replaceLast(const QGeoCoordinate& coordinate)
+{
+    if (_points.isEmpty()) {
+        append(coordinate);
+        return;
+    }
+
+    Point_t& point = _points.last();
+    point.latitude  = coordinate.latitude();
+    point.longitude = coordinate.longitude();
+    point.altitude  = static_cast<float>(coordinate.altitude());
+}
+
+void TrajectoryTrack::clear(void)
+{
+    _points.clear();
+    for (Level_t& level: _levels) {
+        level.indices.clear();
+        level.pendingStart = 0;
+    }
+}
+
+double TrajectoryTrack::levelTolerance(int level)
+{
+    return _levelTolerances[qBound(0, level, levelCount - 1)];
+}
+
+int TrajectoryTrack::levelForResolution(double metersPerPixel)
+{
+    int level = 0;
+    while (level < levelCount - 1 && _levelTolerances[level + 1] <= metersPerPixel) {
+        level++;
+    }
+    return level;
+}
+
+void TrajectoryTrack::_simplifyPending(void)
+{
+    // The last point can still be replaced, so the chunk ends at the point before it
+    int pendingStart    = _levels[1].pendingStart;
+    int last            = _points.count() - 2;
+
+    if (last - pendingStart < _chunkSize) {
+        return;
+    }
+    for (int level=1; level<levelCount; level++) {
+        _simplify(pendingStart, last, _levelTolerances[level], _levels[level].indices);
+        _levels[level].pendingStart = last;
+    }
+}
+
+void TrajectoryTrack::_simplify(int first, int last, double tolerance, QVector<int>& kept) const
+{
+    // Points are projected to a local flat plane in meters around the first point of the chunk
+    const double    metersPerDegree = 111319.49;
+    double          originLatitude  = _points[first].latitude;
+    double          originLongitude = _points[first].longitude;
+    double          longitudeScale  = qCos(qDegreesToRadians(originLatitude)) * metersPerDegree;
+
+    auto x = [this, originLongitude, longitudeScale](int i) -> double { return (_points[i].longitude - originLongitude) * longitudeScale; };
+    auto y = [this, originLatitude, metersPerDegree](int i) -> double { return (_points[i].latitude - originLatitude) * metersPerDegree; };
+
+    QVector<bool>           keep(last - first + 1, false);
+    QVector<QPair<int,int>> stack;
+
+    keep[0] = keep[last - first] = true;
+    stack.append(qMakePair(first, last));
+    while (!stack.isEmpty()) {
+        QPair<int,int> segment = stack.takeLast();
+        int     start       = segment.first;
+        int     end         = segment.second;
+        double  startX      = x(start);
+        double  startY      = y(start);
+        double  dx          = x(end) - startX;
+        double  dy          = y(end) - startY;
+        double  lengthSq    = (dx * dx) + (dy * dy);
+        double  maxDistance = 0;
+        int     maxIndex    = -1;
+
+        for (int i=start+1; i<end; i++) {
+            double px = x(i) - startX;
+            double py = y(i) - startY;
+            double distance;
+            if (lengthSq > 0) {
+                // Distance to the segment, not the infinite line, so that back tracking is kept
+                double t = qBound(0.0, ((px * dx) + (py * dy)) / lengthSq, 1.0);
+                distance = qSqrt(qPow(px - (t * dx), 2) + qPow(py - (t * dy), 2));
+            } else {
+                distance = qSqrt((px * px) + (py * py));
+            }
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                maxIndex = i;
+            }
+        }
+
+        if (maxIndex != -1 && maxDistance > tolerance) {
+            keep[maxIndex - first] = true;
+            stack.append(qMakePair(start, maxIndex));
+            stack.append(qMakePair(maxIndex, end));
+        }
+    }
+
+    // The last point is the start of the next chunk, it is added then
+    for (int i=first; i<last; i++) {
+        if (keep[i - first]) {
+            kept.append(i);
+        }
+    }
+}
+
+QVector<int> TrajectoryTrack::levelIndices(int level) const
+{
+    QVector<int> indices;
+
+    if (level <= 0 || level >= levelCount) {
+        indices.reserve(_points.count());
+        for (int i=0; i<_points.count(); i++) {
+            indices.append(i);
+        }
+    } else {
+        const Level_t& levelData = _levels[level];
+        indices.reserve(levelData.indices.count() + _points.count() - levelData.pendingStart);
+        indices.append(levelData.indices);
+        for (int i=levelData.pendingStart; i<_points.count(); i++) {
+            indices.append(i);
+        }
+    }
+    return indices;
+}
+
+bool TrajectoryTrack::_segmentInViewport(int index1, int index2, const QGeoRectangle& viewport) const
+{
+    const Point_t& point1 = _points[index1];
+    const Point_t& point2 = _points[index2];
+
+    QGeoRectangle bounds(QGeoCoordinate(qMax(point1.latitude, point2.latitude), qMin(point1.longitude, point2.longitude)),
+                         QGeoCoordinate(qMin(point1.latitude, point2.latitude), qMax(point1.longitude, point2.longitude)));
+    return viewport.intersects(bounds);
+}
+
+QVector<int> TrajectoryTrack::viewportIndices(const QGeoRectangle& viewport, double metersPerPixel) const
+{
+    QVector<int> fine   = levelIndices(levelForResolution(metersPerPixel));
+    QVector<int> coarse = levelIndices(levelCount - 1);
+    QVector<int> result;
+    int          coarseIndex = 0;
+
+    if (!viewport.isValid()) {
+        return fine;
+    }
+
+    for (int i=0; i<fine.count(); i++) {
+        int index = fine[i];
+
+        bool include = viewport.contains(QGeoCoordinate(_points[index].latitude, _points[index].longitude)) ||
+                (i > 0 && _segmentInViewport(fine[i - 1], index, viewport)) ||
+                (i < fine.count() - 1 && _segmentInViewport(index, fine[i + 1], viewport));
+        if (!include) {
+            // Every coarse point is also in the finer levels
+            while (coarseIndex < coarse.count() && coarse[coarseIndex] < index) {
+                coarseIndex++;
+            }
+            include = coarseIndex < coarse.count() && coarse[coarseIndex] == index;
+        }
+        if (include) {
+            result.append(index);
+        }
+    }
+
+    return result;
+}
+
+QByteArray TrajectoryTrack::serialize(int first, int end) const
+{
+    QByteArray bytes;
+
+    first   = qMax(first, 0);
+    end     = qMin(end, _points.count());
+    if (end <= first) {
+        return bytes;
+    }
+
+    bytes.resize((end - first) * recordSize);
+    char* cursor = bytes.data();
+    for (int i=first; i<end; i++) {
+        const Point_t&  point = _points[i];
+        quint64         latitudeBits;
+        quint64         longitudeBits;
+        quint32         altitudeBits;
+
+        memcpy(&latitudeBits,   &point.latitude,    sizeof(latitudeBits));
+        memcpy(&longitudeBits,  &point.longitude,   sizeof(longitudeBits));
+        memcpy(&altitudeBits,   &point.altitude,    sizeof(altitudeBits));
+        qToLittleEndian<quint64>(latitudeBits,  cursor);
+        qToLittleEndian<quint64>(longitudeBits, cursor + sizeof(quint64));
+        qToLittleEndian<quint32>(altitudeBits,  cursor + (2 * sizeof(quint64)));
+        cursor += recordSize;
+    }
+    return bytes;
+}
+
+int TrajectoryTrack::deserialize(const QByteArray& bytes)
+{
+    int         recordCount = bytes.length() / recordSize;
+    const char* cursor      = bytes.constData();
+
+    _points.reserve(_points.count() + recordCount);
+    for (int i=0; i<recordCount; i++) {
+        quint64 latitudeBits    = qFromLittleEndian<quint64>(cursor);
+        quint64 longitudeBits   = qFromLittleEndian<quint64>(cursor + sizeof(quint64));
+        quint32 altitudeBits    = qFromLittleEndian<quint32>(cursor + (2 * sizeof(quint64)));
+        Point_t point;
+
+        memcpy(&point.latitude,     &latitudeBits,  sizeof(point.latitude));
+        memcpy(&point.longitude,    &longitudeBits, sizeof(point.longitude));
+        memcpy(&point.altitude,     &altitudeBits,  sizeof(point.altitude));
+        _points.append(point);
+        _simplifyPending();
+        cursor += recordSize;
+    }
+    return recordCount;
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QByteArray>
+#include <QGeoCoordinate>
+#include <QGeoRectangle>
+
+/// Compact storage of a vehicle flight track with levels of detail for display.
+///
+/// Points are stored as plain structs instead of boxed QVariant coordinates. Level 0 is the full track, each higher
+/// level is a Douglas-Peucker simplification of it with a larger tolerance. Simplification is incremental: once
+/// _chunkSize new points have accumulated they are simplified and appended to each level, the remaining tail is
+/// shared unsimplified by all levels. The last point is never simplified since it can still be replaced.
+///
+/// Simplification at a larger tolerance keeps a subset of the points kept at a smaller one, all levels share the
+/// chunk boundaries, so every level is a subset of the level below it.
+class TrajectoryTrack
+{
+public:
+    typedef struct {
+        double  latitude;
+        double  longitude;
+        float   altitude;
+    } Point_t;
+
+    static const int levelCount = 4;
+
+    TrajectoryTrack(void);
+
+    int             count       (void) const { return _points.count(); }
+    bool            isEmpty     (void) const { return _points.isEmpty(); }
+    const Point_t&  at          (int index) const { return _points[index]; }
+    QGeoCoordinate  coordinate  (int index) const;
+
+    void append         (const QGeoCoordinate& coordinate);
+    void replaceLast    (const QGeoCoordinate& coordinate);
+    void clear          (void);
+
+    /// @return Simplification tolerance in meters for the level, 0 for level 0
+    static double levelTolerance(int level);
+
+    /// @return Coarsest level which is accurate to within metersPerPixel
+    static int levelForResolution(double metersPerPixel);
+
+    /// @return Indices of the points of the level, in track order
+    QVector<int> levelIndices(int level) const;
+
+    /// @return Points of the level for the resolution which are within or adjacent to the viewport. Stretches of the
+    ///         track outside the viewport are reduced to the coarsest level so the path stays continuous.
+    QVector<int> viewportIndices(const QGeoRectangle& viewport, double metersPerPixel) const;
+
+    /// @return Points [first, end) in the file record format
+    QByteArray  serialize   (int first, int end) const;
+
+    /// Appends the points of a byte array in the file record format, trailing partial records are ignored
+    /// @return Number of points appended
+    int         deserialize (const QByteArray& bytes);
+
+    static const int recordSize = 2 * sizeof(double) + sizeof(float);  ///< Size of a point in the file record format
+
+private:
+    typedef struct {
+        QVector<int>    indices;            ///< Points kept from the simplified chunks
+        int             pendingStart = 0;   ///< Index of the first point which has not been simplified yet
+    } Level_t;
+
+    void _simplifyPending   (void);
+    void _simplify          (int first, int last, double tolerance, QVector<int>& kept) const;
+    bool _segmentInViewport (int index1, int index2, const QGeoRectangle& viewport) const;
+
+    QVector<Point_t>    _points;
+    Level_t             _levels[levelCount];    ///< Level 0 is unused since it is the full track
+
+    static const int    _chunkSize = 256;
+    static const double _levelTolerances[levelCount];
+};
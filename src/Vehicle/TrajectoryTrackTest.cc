@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryTrackTest.h"
+#include "TrajectoryTrack.h"
+
+#include <QtMath>
+
+const int TrajectoryTrackTest::_pointCount;
+
+/// Weaving track heading north, about a meter between points and several chunks long
+void TrajectoryTrackTest::_buildTrack(TrajectoryTrack& track)
+{
+    for (int i=0; i<_pointCount; i++) {
+        track.append(QGeoCoordinate(47.0 + (i * 1e-5), 8.0 + (3e-4 * qSin(i / 25.0)), 100.0 + (i % 7)));
+    }
+}
+
+/// @return Distance in meters of point from the segment start-end
+static double _distanceToSegment(const QGeoCoordinate& point, const QGeoCoordinate& start, const QGeoCoordinate& end)
+{
+    double distance = start.distanceTo(point);
+    double azimuth  = qDegreesToRadians(start.azimuthTo(point) - start.azimuthTo(end));
+    double length   = start.distanceTo(end);
+    double along    = qBound(0.0, distance * qCos(azimuth), length);
+
+    return start.atDistanceAndAzimuth(along, start.azimuthTo(end)).distanceTo(point);
+}
+
+/// Each level is a subset of the level below it and stays within the tolerance of the full track
+void TrajectoryTrackTest::_testLevels(void)
+{
+    TrajectoryTrack track;
+    _buildTrack(track);
+
+    QCOMPARE(track.count(), _pointCount);
+    QCOMPARE(track.levelIndices(0).count(), _pointCount);
+
+    QVector<int> lowerIndices = track.levelIndices(0);
+    for (int level=1; level<TrajectoryTrack::levelCount; level++) {
+        QVector<int> indices    = track.levelIndices(level);
+        double       tolerance  = TrajectoryTrack::levelTolerance(level);
+
+        QVERIFY(indices.count() < lowerIndices.count());
+        QCOMPARE(indices.first(), 0);
+        QCOMPARE(indices.last(), _pointCount - 1);
+
+        for (int i=0; i<indices.count(); i++) {
+            QVERIFY(lowerIndices.contains(indices[i]));
+            if (i == 0) {
+                continue;
+            }
+            QVERIFY(indices[i] > indices[i - 1]);
+
+            // Dropped points are within the tolerance of the segment which replaces them. The track is projected to a
+            // plane for simplification, so allow a little for the difference to the geodesic distance.
+            QGeoCoordinate start    = track.coordinate(indices[i - 1]);
+            QGeoCoordinate end      = track.coordinate(indices[i]);
+            for (int dropped=indices[i - 1]+1; dropped<indices[i]; dropped++) {
+                QVERIFY(_distanceToSegment(track.coordinate(dropped), start, end) <= tolerance + 0.1);
+            }
+        }
+        lowerIndices = indices;
+    }
+
+    QCOMPARE(TrajectoryTrack::levelForResolution(0.0), 0);
+    QCOMPARE(TrajectoryTrack::levelForResolution(TrajectoryTrack::levelTolerance(1)), 1);
+    QCOMPARE(TrajectoryTrack::levelForResolution(1000.0), TrajectoryTrack::levelCount - 1);
+
+    track.clear();
+    QVERIFY(track.isEmpty());
+    for (int level=0; level<TrajectoryTrack::levelCount; level++) {
+        QVERIFY(track.levelIndices(level).isEmpty());
+    }
+}
+
+/// A track restored from its serialized form matches the original, including its levels
+void TrajectoryTrackTest::_testSerializeRestore(void)
+{
+    TrajectoryTrack track;
+    _buildTrack(track);
+
+    QByteArray bytes = track.serialize(0, track.count());
+    QCOMPARE(bytes.length(), _pointCount * TrajectoryTrack::recordSize);
+    QCOMPARE(track.serialize(-10, track.count() + 10), bytes);
+    QVERIFY(track.serialize(10, 10).isEmpty());
+
+    // Saved in two parts the way TrajectoryPoints appends to its file, with a partial record from an interrupted write
+    int        split    = _pointCount / 3;
+    QByteArray saved    = track.serialize(0, split) + track.serialize(split, _pointCount) + QByteArray(5, 0);
+
+    TrajectoryTrack restored;
+    QCOMPARE(restored.deserialize(saved), _pointCount);
+    QCOMPARE(restored.count(), _pointCount);
+    for (int i=0; i<_pointCount; i++) {
+        QCOMPARE(restored.at(i).latitude,  track.at(i).latitude);
+        QCOMPARE(restored.at(i).longitude, track.at(i).longitude);
+        QCOMPARE(restored.at(i).altitude,  track.at(i).altitude);
+    }
+    for (int level=0; level<TrajectoryTrack::levelCount; level++) {
+        QCOMPARE(restored.levelIndices(level), track.levelIndices(level));
+    }
+
+    // Points added after a restore continue the track
+    restored.append(QGeoCoordinate(48.0, 8.0, 100.0));
+    QCOMPARE(restored.count(), _pointCount + 1);
+    QCOMPARE(restored.levelIndices(TrajectoryTrack::levelCount - 1).last(), _pointCount);
+}
+
+/// The viewport keeps full detail inside it and only the coarsest level outside of it
+void TrajectoryTrackTest::_testViewportIndices(void)
+{
+    TrajectoryTrack track;
+    _buildTrack(track);
+
+    // Invalid viewport returns the level for the resolution
+    QCOMPARE(track.viewportIndices(QGeoRectangle(), 0.0), track.levelIndices(0));
+    QCOMPARE(track.viewportIndices(QGeoRectangle(), 20.0), track.levelIndices(TrajectoryTrack::levelForResolution(20.0)));
+
+    // Viewport around the whole track
+    QGeoRectangle all(QGeoCoordinate(48.0, 7.0), QGeoCoordinate(46.0, 9.0));
+    QCOMPARE(track.viewportIndices(all, 0.0), track.levelIndices(0));
+
+    // Viewport around the middle of the track, its edges half way between points
+    int             firstInside = 400;
+    int             lastInside  = 600;
+    QGeoRectangle   middle(QGeoCoordinate(track.at(lastInside).latitude + 0.5e-5, 7.0), QGeoCoordinate(track.at(firstInside).latitude - 0.5e-5, 9.0));
+    QVector<int>    indices     = track.viewportIndices(middle, 0.0);
+    QVector<int>    coarse      = track.levelIndices(TrajectoryTrack::levelCount - 1);
+
+    for (int i=1; i<indices.count(); i++) {
+        QVERIFY(indices[i] > indices[i - 1]);
+    }
+    for (int index=firstInside; index<=lastInside; index++) {
+        QVERIFY(indices.contains(index));
+    }
+    for (int index: coarse) {
+        QVERIFY(indices.contains(index));
+    }
+    for (int index: indices) {
+        // Outside of the viewport only the coarse points and the neighbours of the points inside it remain
+        if (index < firstInside - 1 || index > lastInside + 1) {
+            QVERIFY(coarse.contains(index));
+        }
+    }
+    QVERIFY(indices.count() < _pointCount);
+}
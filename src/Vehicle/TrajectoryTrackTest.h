@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TrajectoryTrack;
+
+class TrajectoryTrackTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testLevels(void);
+    void _testSerializeRestore(void);
+    void _testViewportIndices(void);
+
+private:
+    void _buildTrack(TrajectoryTrack& track);
+
+    static const int _pointCount = 1000;
+};
@@ -240,9 +240,13 @@ Vehicle::Vehicle(LinkInterface*             link,
     _cameraManager = _firmwarePlugin->createCameraManager(this);
     emit cameraManagerChanged();
 
-    // Start csv logger
-    connect(&_csvLogTimer, &QTimer::timeout, this, &Vehicle::_writeCsvLine);
-    _csvLogTimer.start(1000);
+    // Restore the flight track saved by the last run, once the vehicle is known to be the same one
+    connect(this, &Vehicle::vehicleUIDChanged, _trajectoryPoints, &TrajectoryPoints::restore);
+
+    // Start telemetry recorder
+    connect(&_telemetryRecordTimer, &QTimer::timeout, this, &Vehicle::_recordTelemetry);
+    connect(&_telemetryRecorder, &TelemetryRecorder::writeFailed, &_telemetryRecordTimer, &QTimer::stop);
+    _telemetryRecordTimer.start(_telemetryRecordStartCheckMsecs);
 }
 
 // Disconnected Vehicle for offline editing
@@ -445,6 +449,9 @@ Vehicle::~Vehicle()
 {
     qCDebug(VehicleLog) << "~Vehicle" << this;
 
+    _telemetryRecordTimer.stop();
+    _telemetryRecorder.close();
+
     delete _missionManager;
     _missionManager = nullptr;
 
@@ -916,9 +923,9 @@ void Vehicle::_handleVfrHud(mavlink_message_t& message)
     mavlink_vfr_hud_t vfrHud;
     mavlink_msg_vfr_hud_decode(&message, &vfrHud);
 
-    _airSpeedFact.setRawValue(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
-    _groundSpeedFact.setRawValue(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
-    _climbRateFact.setRawValue(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
+    _airSpeedFact.setRawValueDouble(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
+    _groundSpeedFact.setRawValueDouble(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
+    _climbRateFact.setRawValueDouble(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
     _throttlePctFact.setRawValue(static_cast<int16_t>(vfrHud.throttle));
 }
 
@@ -958,9 +965,9 @@ void Vehicle::_handleAttitudeWorker(double rollRadians, double pitchRadians, dou
     // truncate to integer so widget never displays 360
     yaw = trunc(yaw);
 
-    _rollFact.setRawValue(roll);
-    _pitchFact.setRawValue(pitch);
-    _headingFact.setRawValue(yaw);
+    _rollFact.setRawValueDouble(roll);
+    _pitchFact.setRawValueDouble(pitch);
+    _headingFact.setRawValueDouble(yaw);
 }
 
 void Vehicle::_handleAttitude(mavlink_message_t& message)
@@ -1018,7 +1025,7 @@ void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
                 emit coordinateChanged(_coordinate);
             }
             if (!_altitudeMessageAvailable) {
-                _altitudeAMSLFact.setRawValue(gpsRawInt.alt / 1000.0);
+                _altitudeAMSLFact.setRawValueDouble(gpsRawInt.alt / 1000.0);
             }
         }
     }
@@ -1030,8 +1037,8 @@ void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
     mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
 
     if (!_altitudeMessageAvailable) {
-        _altitudeRelativeFact.setRawValue(globalPositionInt.relative_alt / 1000.0);
-        _altitudeAMSLFact.setRawValue(globalPositionInt.alt / 1000.0);
+        _altitudeRelativeFact.setRawValueDouble(globalPositionInt.relative_alt / 1000.0);
+        _altitudeAMSLFact.setRawValueDouble(globalPositionInt.alt / 1000.0);
     }
 
     // ArduPilot sends bogus GLOBAL_POSITION_INT messages with lat/lat 0/0 even when it has no gps signal
@@ -1166,8 +1173,8 @@ void Vehicle::_handleAltitude(mavlink_message_t& message)
 
     // Data from ALTITUDE message takes precedence over gps messages
     _altitudeMessageAvailable = true;
-    _altitudeRelativeFact.setRawValue(altitude.altitude_relative);
-    _altitudeAMSLFact.setRawValue(altitude.altitude_amsl);
+    _altitudeRelativeFact.setRawValueDouble(altitude.altitude_relative);
+    _altitudeAMSLFact.setRawValueDouble(altitude.altitude_amsl);
 }
 
 void Vehicle::_setCapabilities(uint64_t capabilityBits)
@@ -3534,62 +3541,40 @@ void Vehicle::_pidTuningAdjustRates(bool setRatesForTuning)
     _setpointFactGroup.setLiveUpdates(setRatesForTuning);
 }
 
-void Vehicle::_initializeCsv()
+void Vehicle::_startTelemetryRecorder()
 {
     if(!_toolbox->settingsManager()->appSettings()->saveCsvTelemetry()->rawValue().toBool()){
         return;
     }
     QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss");
-    QString fileName = QString("%1 vehicle%2.csv").arg(now).arg(_id);
+    QString fileName = QString("%1 vehicle%2").arg(now).arg(_id);
     QDir saveDir(_toolbox->settingsManager()->appSettings()->telemetrySavePath());
-    _csvLogFile.setFileName(saveDir.absoluteFilePath(fileName));
 
-    if (!_csvLogFile.open(QIODevice::Append)) {
-        qCWarning(VehicleLog) << "unable to open file for csv logging, Stopping csv logging!";
+    // The binary recording is converted to the user visible csv file when recording stops, which then replaces it
+    if (!_telemetryRecorder.open(this,
+                                 saveDir.absoluteFilePath(QString("%1.%2").arg(fileName, TelemetryRecorder::fileExtension)),
+                                 saveDir.absoluteFilePath(QString("%1.csv").arg(fileName)))) {
+        qCWarning(VehicleLog) << "unable to open file for telemetry recording, Stopping telemetry recording!";
         return;
     }
+    qCDebug(VehicleLog) << "Telemetry recording started" << _telemetryRecorder.fileName() << "columns:" << _telemetryRecorder.columnCount();
 
-    QTextStream stream(&_csvLogFile);
-    QStringList allFactNames;
-    allFactNames << factNames();
-    for (const QString& groupName: factGroupNames()) {
-        for(const QString& factName: getFactGroup(groupName)->factNames()){
-            allFactNames << QString("%1.%2").arg(groupName, factName);
-        }
-    }
-    qCDebug(VehicleLog) << "Facts logged to csv:" << allFactNames;
-    stream << "Timestamp," << allFactNames.join(",") << "\n";
+    _telemetryRecordTimer.setInterval(_telemetryRecordIntervalMsecs);
 }
 
-void Vehicle::_writeCsvLine()
+void Vehicle::_recordTelemetry()
 {
     // Only save the logs after the the vehicle gets armed, unless "Save logs even if vehicle was not armed" is checked
-    if(!_csvLogFile.isOpen() &&
+    if(!_telemetryRecorder.isOpen() &&
             (_armed || _toolbox->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool())){
-        _initializeCsv();
+        _startTelemetryRecorder();
     }
 
-    if(!_csvLogFile.isOpen()){
+    if(!_telemetryRecorder.isOpen()){
         return;
     }
 
-    QStringList allFactValues;
-    QTextStream stream(&_csvLogFile);
-
-    // Write timestamp to csv file
-    allFactValues << QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz"));
-    // Write Vehicle's own facts
-    for (const QString& factName : factNames()) {
-        allFactValues << getFact(factName)->cookedValueString();
-    }
-    // write facts from Vehicle's FactGroups
-    for (const QString& groupName: factGroupNames()) {
-        for (const QString& factName : getFactGroup(groupName)->factNames()) {
-            allFactValues << getFactGroup(groupName)->getFact(factName)->cookedValueString();
-        }
-    }
-
-    stream << allFactValues.join(",") << "\n";
+    _telemetryRecorder.recordRow(QDateTime::currentMSecsSinceEpoch());
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
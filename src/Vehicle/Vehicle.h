@@ -39,6 +39,7 @@
 #include "GeoFenceManager.h"
 #include "RallyPointManager.h"
 #include "FTPManager.h"
+#include "TelemetryRecorder.h"
 
 class UAS;
 class UASInterface;
@@ -934,8 +935,8 @@ private:
     void _updateArmed                   (bool armed);
     bool _apmArmingNotRequired          ();
     void _pidTuningAdjustRates          (bool setRatesForTuning);
-    void _initializeCsv                 ();
-    void _writeCsvLine                  ();
+    void _startTelemetryRecorder        ();
+    void _recordTelemetry               ();
     void _flightTimerStart              ();
     void _flightTimerStop               ();
     void _chunkedStatusTextTimeout      (void);
@@ -957,8 +958,11 @@ private:
     QGCToolbox*         _toolbox = nullptr;
     SettingsManager*    _settingsManager = nullptr;
 
-    QTimer              _csvLogTimer;
-    QFile               _csvLogFile;
+    QTimer              _telemetryRecordTimer;
+    TelemetryRecorder   _telemetryRecorder;
+
+    static const int    _telemetryRecordIntervalMsecs       = 40;   ///< 25 Hz once recording has started
+    static const int    _telemetryRecordStartCheckMsecs     = 1000; ///< Check for arming at 1 Hz until recording starts
 
     bool            _joystickEnabled = false;
 
@@ -0,0 +1,224 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageStats.h"
+#include "LinkInterface.h"
+#include "LinkConfiguration.h"
+
+#include <cstring>
+
+MAVLinkMessageStats::MAVLinkMessageStats(QObject* parent)
+    : QObject(parent)
+{
+    _clock.start();
+}
+
+int MAVLinkMessageStats::horizonSeconds(Horizon horizon)
+{
+    switch (horizon) {
+    case Horizon1Sec:
+        return 1;
+    case Horizon10Sec:
+        return 10;
+    case Horizon60Sec:
+    default:
+        return 60;
+    }
+}
+
+void MAVLinkMessageStats::record(LinkInterface* link, const mavlink_message_t& message)
+{
+    uint8_t channel = link->mavlinkChannel();
+    quint64 key     = _key(channel, message.sysid, message.compid, message.msgid);
+    qint64  second  = _clock.elapsed() / 1000;
+
+    int index;
+    auto iter = _entryIndex.constFind(key);
+    if (iter == _entryIndex.constEnd()) {
+        Entry_t entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.channel       = channel;
+        entry.sysid         = message.sysid;
+        entry.compid        = message.compid;
+        entry.msgid         = message.msgid;
+        entry.lastSecond    = second;
+
+        index = _entries.count();
+        _entries.append(entry);
+        _entryIndex.insert(key, index);
+
+        SharedLinkConfigurationPtr config = link->linkConfiguration();
+        if (config) {
+            _linkNames[channel] = config->name();
+        }
+    } else {
+        index = iter.value();
+    }
+
+    Entry_t& entry = _entries[index];
+
+    // Clear the buckets of the seconds which had no messages
+    if (second != entry.lastSecond) {
+        for (qint64 s=qMax(entry.lastSecond + 1, second - _bucketCount + 1); s<=second; s++) {
+            entry.messageBuckets[s % _bucketCount]  = 0;
+            entry.byteBuckets[s % _bucketCount]     = 0;
+        }
+        entry.lastSecond = second;
+    }
+
+    quint32 bytes = mavlink_msg_get_send_buffer_length(&message);
+    entry.messages++;
+    entry.bytes += bytes;
+    entry.messageBuckets[second % _bucketCount]++;
+    entry.byteBuckets[second % _bucketCount] += bytes;
+}
+
+void MAVLinkMessageStats::resetChannel(uint8_t channel)
+{
+    QVector<Entry_t> entries;
+
+    entries.reserve(_entries.count());
+    for (const Entry_t& entry: _entries) {
+        if (entry.channel != channel) {
+            entries.append(entry);
+        }
+    }
+    _entries = entries;
+
+    _entryIndex.clear();
+    for (int i=0; i<_entries.count(); i++) {
+        const Entry_t& entry = _entries[i];
+        _entryIndex.insert(_key(entry.channel, entry.sysid, entry.compid, entry.msgid), i);
+    }
+
+    _linkNames[channel].clear();
+}
+
+void MAVLinkMessageStats::_clearTotals(Totals_t& totals) const
+{
+    memset(&totals, 0, sizeof(totals));
+}
+
+void MAVLinkMessageStats::_addEntry(const Entry_t& entry, Totals_t& totals, qint64 currentSecond) const
+{
+    totals.messages += entry.messages;
+    totals.bytes    += entry.bytes;
+
+    // Sum the full seconds before the current one. Buckets past lastSecond have not been cleared yet and read as zero.
+    for (int horizon=0; horizon<HorizonCount; horizon++) {
+        int     seconds     = horizonSeconds(static_cast<Horizon>(horizon));
+        quint64 messages    = 0;
+        quint64 bytes       = 0;
+
+        for (qint64 s=currentSecond - seconds; s<currentSecond; s++) {
+            if (s >= 0 && s <= entry.lastSecond && s > entry.lastSecond - _bucketCount) {
+                messages    += entry.messageBuckets[s % _bucketCount];
+                bytes       += entry.byteBuckets[s % _bucketCount];
+            }
+        }
+        totals.messagesPerSecond[horizon]   += static_cast<double>(messages) / seconds;
+        totals.bytesPerSecond[horizon]      += static_cast<double>(bytes) / seconds;
+    }
+}
+
+MAVLinkMessageStats::Totals_t MAVLinkMessageStats::messageTotals(int channel, uint8_t sysid, uint8_t compid, uint32_t msgid) const
+{
+    Totals_t    totals;
+    qint64      currentSecond = _clock.elapsed() / 1000;
+
+    _clearTotals(totals);
+    if (channel >= 0) {
+        auto iter = _entryIndex.constFind(_key(static_cast<uint8_t>(channel), sysid, compid, msgid));
+        if (iter != _entryIndex.constEnd()) {
+            _addEntry(_entries[iter.value()], totals, currentSecond);
+        }
+    } else {
+        for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+            auto iter = _entryIndex.constFind(_key(i, sysid, compid, msgid));
+            if (iter != _entryIndex.constEnd()) {
+                _addEntry(_entries[iter.value()], totals, currentSecond);
+            }
+        }
+    }
+    return totals;
+}
+
+MAVLinkMessageStats::Totals_t MAVLinkMessageStats::channelTotals(uint8_t channel) const
+{
+    Totals_t    totals;
+    qint64      currentSecond = _clock.elapsed() / 1000;
+
+    _clearTotals(totals);
+    for (const Entry_t& entry: _entries) {
+        if (entry.channel == channel) {
+            _addEntry(entry, totals, currentSecond);
+        }
+    }
+    return totals;
+}
+
+QVariantMap MAVLinkMessageStats::_totalsMap(const Totals_t& totals) const
+{
+    QVariantMap map;
+
+    map[QStringLiteral("messages")]         = totals.messages;
+    map[QStringLiteral("bytes")]            = totals.bytes;
+    map[QStringLiteral("hz1")]              = totals.messagesPerSecond[Horizon1Sec];
+    map[QStringLiteral("hz10")]             = totals.messagesPerSecond[Horizon10Sec];
+    map[QStringLiteral("hz60")]             = totals.messagesPerSecond[Horizon60Sec];
+    map[QStringLiteral("bytesPerSec1")]     = totals.bytesPerSecond[Horizon1Sec];
+    map[QStringLiteral("bytesPerSec10")]    = totals.bytesPerSecond[Horizon10Sec];
+    map[QStringLiteral("bytesPerSec60")]    = totals.bytesPerSecond[Horizon60Sec];
+    return map;
+}
+
+QVariantList MAVLinkMessageStats::linkStats(void) const
+{
+    QVariantList    list;
+    bool            channelUsed[MAVLINK_COMM_NUM_BUFFERS] = {};
+
+    for (const Entry_t& entry: _entries) {
+        channelUsed[entry.channel] = true;
+    }
+    for (uint8_t channel=0; channel<MAVLINK_COMM_NUM_BUFFERS; channel++) {
+        if (channelUsed[channel]) {
+            QVariantMap map = _totalsMap(channelTotals(channel));
+            map[QStringLiteral("channel")]  = channel;
+            map[QStringLiteral("link")]     = _linkNames[channel];
+            list.append(map);
+        }
+    }
+    return list;
+}
+
+QVariantList MAVLinkMessageStats::messageStats(void) const
+{
+    QVariantList    list;
+    qint64          currentSecond = _clock.elapsed() / 1000;
+
+    for (const Entry_t& entry: _entries) {
+        Totals_t totals;
+        _clearTotals(totals);
+        _addEntry(entry, totals, currentSecond);
+
+        mavlink_message_t message;
+        message.msgid = entry.msgid;
+        const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
+
+        QVariantMap map = _totalsMap(totals);
+        map[QStringLiteral("channel")]  = entry.channel;
+        map[QStringLiteral("link")]     = _linkNames[entry.channel];
+        map[QStringLiteral("sysid")]    = entry.sysid;
+        map[QStringLiteral("compid")]   = entry.compid;
+        map[QStringLiteral("msgid")]    = entry.msgid;
+        map[QStringLiteral("name")]     = msgInfo ? QString(msgInfo->name) : QString::number(entry.msgid);
+        list.append(map);
+    }
+    return list;
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QVariantList>
+
+class LinkInterface;
+
+/// Message and byte counts for each (link, system, component, message id) received.
+///
+/// record is called by MAVLinkProtocol for every received message. It does a hash lookup and a few increments, no
+/// locking or allocation once a message has been seen. Counts are also kept in one second buckets so rates can be
+/// queried over a sliding window of 1, 10 or 60 seconds. Only full seconds are used for rates, the current second is
+/// still being counted.
+///
+/// Counting and queries happen on the thread MAVLinkProtocol runs on.
+class MAVLinkMessageStats : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMessageStats(QObject* parent = nullptr);
+
+    enum Horizon {
+        Horizon1Sec = 0,
+        Horizon10Sec,
+        Horizon60Sec,
+        HorizonCount
+    };
+
+    typedef struct {
+        quint64 messages;
+        quint64 bytes;
+        double  messagesPerSecond[HorizonCount];
+        double  bytesPerSecond[HorizonCount];
+    } Totals_t;
+
+    /// Ingest path: counts one received message
+    void record(LinkInterface* link, const mavlink_message_t& message);
+
+    /// Drops all counts for the channel. Called when the channel is reassigned to a new link.
+    void resetChannel(uint8_t channel);
+
+    /// @return Totals for a single message, over all links if channel is -1
+    Totals_t messageTotals(int channel, uint8_t sysid, uint8_t compid, uint32_t msgid) const;
+
+    /// @return Totals of all messages received on the channel
+    Totals_t channelTotals(uint8_t channel) const;
+
+    static int horizonSeconds(Horizon horizon);
+
+    /// @return One map per link with keys: channel, link, messages, bytes, hz1, hz10, hz60, bytesPerSec1, bytesPerSec10, bytesPerSec60
+    Q_INVOKABLE QVariantList linkStats(void) const;
+
+    /// @return One map per (link, system, component, message) with keys as in linkStats plus sysid, compid, msgid, name
+    Q_INVOKABLE QVariantList messageStats(void) const;
+
+private:
+    static const int _bucketCount = 60; ///< Seconds of history, must cover the longest horizon
+
+    typedef struct {
+        uint8_t     channel;
+        uint8_t     sysid;
+        uint8_t     compid;
+        uint32_t    msgid;
+        quint64     messages;
+        quint64     bytes;
+        qint64      lastSecond;                         ///< Second of the last recorded message
+        quint32     messageBuckets  [_bucketCount];
+        quint32     byteBuckets     [_bucketCount];
+    } Entry_t;
+
+    static quint64 _key(uint8_t channel, uint8_t sysid, uint8_t compid, uint32_t msgid) { return (static_cast<quint64>(channel) << 40) | (static_cast<quint64>(sysid) << 32) | (static_cast<quint64>(compid) << 24) | msgid; }
+
+    void        _addEntry   (const Entry_t& entry, Totals_t& totals, qint64 currentSecond) const;
+    void        _clearTotals(Totals_t& totals) const;
+    QVariantMap _totalsMap  (const Totals_t& totals) const;
+
+    QElapsedTimer           _clock;
+    QVector<Entry_t>        _entries;
+    QHash<quint64, int>     _entryIndex;                            ///< Index into _entries by _key
+    QString                 _linkNames[MAVLINK_COMM_NUM_BUFFERS];   ///< Name of the link last seen on each channel
+};
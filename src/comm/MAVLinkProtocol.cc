@@ -150,6 +150,7 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
         firstMessage[channel][i] =  1;
     }
     link->setDecodedFirstMavlinkPacket(false);
+    _messageStats.resetChannel(static_cast<uint8_t>(channel));
 }
 
 /**
@@ -223,6 +224,7 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
             uint8_t expectedSeq = lastSeq + 1;
             // Increase receive counter
             totalReceiveCounter[mavlinkChannel]++;
+            _messageStats.record(link, _message);
             // Determine what the next expected sequence number is, accounting for
             // never having seen a message for this system/component pair.
             if(firstMessage[_message.sysid][_message.compid]) {
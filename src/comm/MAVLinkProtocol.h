@@ -23,6 +23,7 @@
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
 #include "QGCToolbox.h"
+#include "MAVLinkMessageStats.h"
 
 class LinkManager;
 class MultiVehicleManager;
@@ -63,6 +64,10 @@ public:
     unsigned getCurrentVersion() {
         return _current_version;
     }
+    /** @brief Message and byte counts and rates per link and message */
+    MAVLinkMessageStats* messageStats() {
+        return &_messageStats;
+    }
     /**
      * Reset the counters for all metadata for this link.
      */
@@ -170,5 +175,6 @@ private:
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+    MAVLinkMessageStats     _messageStats;
 };
 
@@ -48,6 +48,10 @@
 #include "MissionCommandTreeEditorTest.h"
 #include "VehicleLinkManagerTest.h"
 #include "LandingComplexItemTest.h"
+#include "QmlObjectListModelTest.h"
+#include "QGCTileDownloadControlTest.h"
+#include "TelemetryRecorderTest.h"
+#include "TrajectoryTrackTest.h"
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
@@ -82,6 +86,10 @@ UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
 UT_REGISTER_TEST(FWLandingPatternTest)
 UT_REGISTER_TEST(LandingComplexItemTest)
+UT_REGISTER_TEST(QmlObjectListModelTest)
+UT_REGISTER_TEST(QGCTileDownloadControlTest)
+UT_REGISTER_TEST(TelemetryRecorderTest)
+UT_REGISTER_TEST(TrajectoryTrackTest)
 
 UT_REGISTER_TEST_STANDALONE(MissionCommandTreeEditorTest)
 